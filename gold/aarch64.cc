@@ -3764,6 +3764,9 @@ Target_aarch64<size, big_endian>::rela_dyn_section(Layout* layout)
       layout->add_output_section_data(".rela.dyn", elfcpp::SHT_RELA,
 				      elfcpp::SHF_ALLOC, this->rela_dyn_,
 				      ORDER_DYNAMIC_RELOCS, false);
+      if (parameters->options().pack_relative_relocs())
+	this->rela_dyn_->set_pack_relative_relocs(
+	    layout, elfcpp::R_AARCH64_RELATIVE);
     }
   return this->rela_dyn_;
 }
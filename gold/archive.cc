@@ -25,6 +25,8 @@
 #include <cerrno>
 #include <cstring>
 #include <climits>
+#include <algorithm>
+#include <set>
 #include <vector>
 #include "libiberty.h"
 #include "filenames.h"
@@ -40,6 +42,7 @@
 #include "archive.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "stats.h"
 
 namespace gold
 {
@@ -178,6 +181,7 @@ struct Archive::Archive_header
 unsigned int Archive::total_archives;
 unsigned int Archive::total_members;
 unsigned int Archive::total_members_loaded;
+size_t Archive::total_armap_checks;
 
 // Archive methods.
 
@@ -199,9 +203,11 @@ Archive::Archive(const std::string& name, Input_file* input_file,
                  bool is_thin_archive, Dirsearch* dirpath, Task* task)
   : Library_base(task), name_(name), input_file_(input_file), armap_(),
     armap_names_(), extended_names_(), armap_checked_(), seen_offsets_(),
-    members_(), is_thin_archive_(is_thin_archive), included_member_(false),
-    nested_archives_(), dirpath_(dirpath), num_members_(0),
-    included_all_members_(false)
+    armap_index_(), armap_indexed_(false), use_armap_index_(false),
+    undefined_pos_(0), prefetched_members_(), members_(),
+    is_thin_archive_(is_thin_archive),
+    included_member_(false), nested_archives_(), dirpath_(dirpath),
+    num_members_(0), included_all_members_(false)
 {
   this->no_export_ =
     parameters->options().check_excluded_libs(input_file->found_name());
@@ -224,6 +230,18 @@ Archive::setup()
     return;
 
   section_size_type armap_size = convert_to_section_size_type(header_size);
+
+  // With --prefetch-inputs, ask the system to read the whole symbol
+  // map at once, rather than one page fault at a time.
+  if (parameters->options().prefetch_inputs()
+      && (armap_name.empty() || armap_name == "/SYM64/"))
+    {
+      File_read::Prefetch_ranges ranges;
+      ranges.push_back(std::make_pair(sarmag + sizeof(Archive_header),
+				      armap_size));
+      this->input_file_->file().prefetch(0, &ranges);
+    }
+
   off_t off = sarmag;
   if (armap_name.empty())
     {
@@ -776,6 +794,14 @@ Archive::read_symbols(off_t off)
 // the normal case, false if the first member we tried to add from
 // this archive had an incompatible target.
 
+// In an archive group we come back here every time the group adds
+// new undefined symbols.  Walking the whole archive map every time
+// is quadratic when there are many large archives, so after the
+// first pass we only look at the entries for the symbols which the
+// symbol table has recorded as becoming undefined.  We visit those
+// entries in the same order as a full pass would, so we include the
+// same members in the same order.
+
 bool
 Archive::add_symbols(Symbol_table* symtab, Layout* layout,
 		     Input_objects* input_objects, Mapfile* mapfile)
@@ -790,81 +816,317 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
 
   input_objects->archive_start(this);
 
-  const size_t armap_size = this->armap_.size();
-
-  // This is a quick optimization, since we usually see many symbols
-  // in a row with the same offset.  last_seen_offset holds the last
-  // offset we saw that was present in the seen_offsets_ set.
-  off_t last_seen_offset = -1;
-
-  // Track which symbols in the symbol table we've already found to be
-  // defined.
+  // With a plugin, a symbol may become undefined when its claimed
+  // file is replaced, and an incremental link adds symbols from the
+  // incremental inputs.  The symbol table does not record those, so
+  // in those cases we always walk the whole archive map.
+  const bool use_index = (!parameters->options().has_plugins()
+			  && !parameters->incremental());
 
   char* tmpbuf = NULL;
   size_t tmpbuflen = 0;
+  bool ret = true;
   bool added_new_object;
   do
     {
-      added_new_object = false;
-      for (size_t i = 0; i < armap_size; ++i)
+      if (parameters->options().prefetch_inputs())
+	this->prefetch_members(symtab, layout,
+			       (this->use_armap_index_
+				? this->undefined_pos_
+				: 0),
+			       &tmpbuf, &tmpbuflen);
+
+      if (this->use_armap_index_)
+	ret = this->add_indexed_symbols(symtab, layout, input_objects,
+					mapfile, &tmpbuf, &tmpbuflen,
+					&added_new_object);
+      else
 	{
-          if (this->armap_checked_[i])
-            continue;
-	  if (this->armap_[i].file_offset == last_seen_offset)
-            {
-              this->armap_checked_[i] = true;
-              continue;
-            }
-	  if (this->seen_offsets_.find(this->armap_[i].file_offset)
-              != this->seen_offsets_.end())
+	  size_t undefined_pos = symtab->strong_undefined_count();
+	  ret = this->add_armap_symbols(symtab, layout, input_objects,
+					mapfile, &tmpbuf, &tmpbuflen,
+					&added_new_object);
+	  if (use_index)
 	    {
-              this->armap_checked_[i] = true;
-	      last_seen_offset = this->armap_[i].file_offset;
-	      continue;
+	      this->use_armap_index_ = true;
+	      this->undefined_pos_ = undefined_pos;
 	    }
+	}
+    }
+  while (ret && added_new_object);
 
-	  const char* sym_name = (this->armap_names_.data()
-				  + this->armap_[i].name_offset);
+  if (tmpbuf != NULL)
+    free(tmpbuf);
 
-          Symbol* sym;
-          std::string why;
-          Archive::Should_include t =
-	    Archive::should_include_member(symtab, layout, sym_name, &sym,
-					   &why, &tmpbuf, &tmpbuflen);
+  if (!ret)
+    return false;
 
-	  if (t == Archive::SHOULD_INCLUDE_NO
-              || t == Archive::SHOULD_INCLUDE_YES)
-	    this->armap_checked_[i] = true;
+  input_objects->archive_stop(this);
 
-	  if (t != Archive::SHOULD_INCLUDE_YES)
-	    continue;
+  return true;
+}
 
-	  // We want to include this object in the link.
-	  last_seen_offset = this->armap_[i].file_offset;
-	  this->seen_offsets_.insert(last_seen_offset);
+// Make one pass over the whole archive map.  Set *ADDED_NEW_OBJECT
+// if we included a member.  Return false if the member had an
+// incompatible target, as for add_symbols.
 
-	  if (!this->include_member(symtab, layout, input_objects,
-				    last_seen_offset, mapfile, sym,
-				    why.c_str()))
-	    {
-	      if (tmpbuf != NULL)
-		free(tmpbuf);
-	      return false;
-	    }
+bool
+Archive::add_armap_symbols(Symbol_table* symtab, Layout* layout,
+			   Input_objects* input_objects, Mapfile* mapfile,
+			   char** tmpbufp, size_t* tmpbuflen,
+			   bool* added_new_object)
+{
+  const size_t armap_size = this->armap_.size();
 
-	  added_new_object = true;
+  // This is a quick optimization, since we usually see many symbols
+  // in a row with the same offset.  last_seen_offset holds the last
+  // offset we saw that was present in the seen_offsets_ set.
+  off_t last_seen_offset = -1;
+
+  *added_new_object = false;
+  for (size_t i = 0; i < armap_size; ++i)
+    {
+      if (this->armap_checked_[i])
+	continue;
+      if (this->armap_[i].file_offset == last_seen_offset)
+	{
+	  this->armap_checked_[i] = true;
+	  continue;
+	}
+      if (this->seen_offsets_.find(this->armap_[i].file_offset)
+	  != this->seen_offsets_.end())
+	{
+	  this->armap_checked_[i] = true;
+	  last_seen_offset = this->armap_[i].file_offset;
+	  continue;
 	}
+
+      const char* sym_name = (this->armap_names_.data()
+			      + this->armap_[i].name_offset);
+
+      ++Archive::total_armap_checks;
+      Symbol* sym;
+      std::string why;
+      Archive::Should_include t =
+	Archive::should_include_member(symtab, layout, sym_name, &sym,
+				       &why, tmpbufp, tmpbuflen);
+
+      if (t == Archive::SHOULD_INCLUDE_NO
+	  || t == Archive::SHOULD_INCLUDE_YES)
+	this->armap_checked_[i] = true;
+
+      if (t != Archive::SHOULD_INCLUDE_YES)
+	continue;
+
+      // We want to include this object in the link.
+      last_seen_offset = this->armap_[i].file_offset;
+      this->seen_offsets_.insert(last_seen_offset);
+
+      if (!this->include_member(symtab, layout, input_objects,
+				last_seen_offset, mapfile, sym,
+				why.c_str()))
+	return false;
+
+      *added_new_object = true;
     }
-  while (added_new_object);
 
-  if (tmpbuf != NULL)
-    free(tmpbuf);
+  return true;
+}
 
-  input_objects->archive_stop(this);
+// Make one pass over the archive map entries for the symbols which
+// became strong undefined symbols since the last pass started.  When
+// we include a member, any later entries for the symbols it makes
+// undefined are looked at in this pass, just as they would be in a
+// pass over the whole map.  Earlier entries are left for the next
+// pass, which starts with every symbol recorded during this one.
+
+bool
+Archive::add_indexed_symbols(Symbol_table* symtab, Layout* layout,
+			     Input_objects* input_objects, Mapfile* mapfile,
+			     char** tmpbufp, size_t* tmpbuflen,
+			     bool* added_new_object)
+{
+  if (!this->armap_indexed_)
+    this->index_armap();
+
+  size_t start = this->undefined_pos_;
+  size_t end = symtab->strong_undefined_count();
+  this->undefined_pos_ = end;
+
+  std::set<size_t> entries;
+  this->find_armap_entries(symtab, start, end, 0, &entries);
+
+  *added_new_object = false;
+  while (!entries.empty())
+    {
+      size_t i = *entries.begin();
+      entries.erase(entries.begin());
+
+      if (this->armap_checked_[i])
+	continue;
+      if (this->seen_offsets_.find(this->armap_[i].file_offset)
+	  != this->seen_offsets_.end())
+	{
+	  this->armap_checked_[i] = true;
+	  continue;
+	}
+
+      const char* sym_name = (this->armap_names_.data()
+			      + this->armap_[i].name_offset);
+
+      ++Archive::total_armap_checks;
+      Symbol* sym;
+      std::string why;
+      Archive::Should_include t =
+	Archive::should_include_member(symtab, layout, sym_name, &sym,
+				       &why, tmpbufp, tmpbuflen);
+
+      if (t == Archive::SHOULD_INCLUDE_NO
+	  || t == Archive::SHOULD_INCLUDE_YES)
+	this->armap_checked_[i] = true;
+
+      if (t != Archive::SHOULD_INCLUDE_YES)
+	continue;
+
+      off_t off = this->armap_[i].file_offset;
+      this->seen_offsets_.insert(off);
+
+      if (!this->include_member(symtab, layout, input_objects, off,
+				mapfile, sym, why.c_str()))
+	return false;
+
+      *added_new_object = true;
+
+      size_t new_end = symtab->strong_undefined_count();
+      this->find_armap_entries(symtab, end, new_end, i + 1, &entries);
+      end = new_end;
+    }
 
   return true;
 }
 
+// Return the length of the symbol name in an archive map entry,
+// without any version.
+
+static size_t
+armap_name_length(const char* name)
+{
+  const char* ver = strchr(name, '@');
+  return ver != NULL ? static_cast<size_t>(ver - name) : strlen(name);
+}
+
+// Index the archive map entries which are not yet checked by the hash
+// code of their symbol names.
+
+void
+Archive::index_armap()
+{
+  gold_assert(!this->armap_indexed_);
+  const size_t armap_size = this->armap_.size();
+  for (size_t i = 0; i < armap_size; ++i)
+    {
+      if (this->armap_checked_[i])
+	continue;
+      const char* name = (this->armap_names_.data()
+			  + this->armap_[i].name_offset);
+      Armap_index_entry e;
+      e.hash_code = string_hash<char>(name, armap_name_length(name));
+      e.armap_index = i;
+      this->armap_index_.push_back(e);
+    }
+  std::sort(this->armap_index_.begin(), this->armap_index_.end());
+  this->armap_indexed_ = true;
+}
+
+// Find the unchecked archive map entries with index at least
+// MIN_INDEX for the strong undefined symbols recorded by SYMTAB from
+// START to END, and add them to *ENTRIES.
+
+void
+Archive::find_armap_entries(const Symbol_table* symtab, size_t start,
+			    size_t end, size_t min_index,
+			    std::set<size_t>* entries) const
+{
+  for (size_t i = start; i < end; ++i)
+    {
+      const char* name = symtab->strong_undefined(i)->name();
+      size_t len = strlen(name);
+      Armap_index_entry key;
+      key.hash_code = string_hash<char>(name, len);
+      key.armap_index = 0;
+      std::pair<std::vector<Armap_index_entry>::const_iterator,
+		std::vector<Armap_index_entry>::const_iterator> range =
+	std::equal_range(this->armap_index_.begin(), this->armap_index_.end(),
+			 key);
+      for (std::vector<Armap_index_entry>::const_iterator p = range.first;
+	   p != range.second;
+	   ++p)
+	{
+	  size_t j = p->armap_index;
+	  if (j < min_index || this->armap_checked_[j])
+	    continue;
+	  const char* armap_name = (this->armap_names_.data()
+				    + this->armap_[j].name_offset);
+	  if (armap_name_length(armap_name) == len
+	      && memcmp(armap_name, name, len) == 0)
+	    entries->insert(j);
+	}
+    }
+}
+
+// With --prefetch-inputs, ask the system to start reading the member
+// header and the ELF file header of each member we are about to
+// include, which are those we need for the strong undefined symbols
+// recorded by SYMTAB from START on.  This is called by the
+// Add_archive_symbols task at the start of each pass over the archive
+// map, so that the members are read while we include the ones before
+// them.  The rest of each member is prefetched by prefetch_sections
+// once its section headers have been read.
+
+void
+Archive::prefetch_members(Symbol_table* symtab, Layout* layout, size_t start,
+			  char** tmpbufp, size_t* tmpbuflen)
+{
+  // The members of a thin archive are in other files.
+  if (this->is_thin_archive_)
+    return;
+
+  if (!this->armap_indexed_)
+    this->index_armap();
+
+  std::set<size_t> entries;
+  this->find_armap_entries(symtab, start, symtab->strong_undefined_count(),
+			   0, &entries);
+
+  File_read::Prefetch_ranges ranges;
+  for (std::set<size_t>::const_iterator p = entries.begin();
+       p != entries.end();
+       ++p)
+    {
+      off_t off = this->armap_[*p].file_offset;
+      if (this->seen_offsets_.find(off) != this->seen_offsets_.end()
+	  || (this->prefetched_members_.find(off)
+	      != this->prefetched_members_.end()))
+	continue;
+
+      const char* sym_name = (this->armap_names_.data()
+			      + this->armap_[*p].name_offset);
+      Symbol* sym;
+      std::string why;
+      if (Archive::should_include_member(symtab, layout, sym_name, &sym,
+					 &why, tmpbufp, tmpbuflen)
+	  != Archive::SHOULD_INCLUDE_YES)
+	continue;
+
+      this->prefetched_members_.insert(off);
+      ranges.push_back(std::make_pair(off,
+				      (sizeof(Archive_header)
+				       + elfcpp::Elf_sizes<64>::ehdr_size)));
+    }
+
+  this->input_file_->file().prefetch(0, &ranges);
+}
+
 // Return whether the archive includes a member which defines the
 // symbol SYM.
 
@@ -1085,17 +1347,27 @@ Archive::do_for_all_unused_symbols(Symbol_visitor_base* v) const
     }
 }
 
-// Print statistical information to stderr.  This is used for --stats.
+// Print statistical information to stderr for --stats, and record it
+// for --stats-json.
 
 void
 Archive::print_stats()
 {
-  fprintf(stderr, _("%s: archive libraries: %u\n"),
-          program_name, Archive::total_archives);
-  fprintf(stderr, _("%s: total archive members: %u\n"),
-          program_name, Archive::total_members);
-  fprintf(stderr, _("%s: loaded archive members: %u\n"),
-          program_name, Archive::total_members_loaded);
+  if (parameters->options().stats())
+    {
+      fprintf(stderr, _("%s: archive libraries: %u\n"),
+	      program_name, Archive::total_archives);
+      fprintf(stderr, _("%s: total archive members: %u\n"),
+	      program_name, Archive::total_members);
+      fprintf(stderr, _("%s: loaded archive members: %u\n"),
+	      program_name, Archive::total_members_loaded);
+      fprintf(stderr, _("%s: archive map entries checked: %zu\n"),
+	      program_name, Archive::total_armap_checks);
+    }
+  record_stat("archive libraries", Archive::total_archives);
+  record_stat("total archive members", Archive::total_members);
+  record_stat("loaded archive members", Archive::total_members_loaded);
+  record_stat("archive map entries checked", Archive::total_armap_checks);
 }
 
 // Add_archive_symbols methods.
@@ -1319,17 +1591,24 @@ Lib_group::do_for_all_unused_symbols(Symbol_visitor_base* v) const
     }
 }
 
-// Print statistical information to stderr.  This is used for --stats.
+// Print statistical information to stderr for --stats, and record it
+// for --stats-json.
 
 void
 Lib_group::print_stats()
 {
-  fprintf(stderr, _("%s: lib groups: %u\n"),
-          program_name, Lib_group::total_lib_groups);
-  fprintf(stderr, _("%s: total lib groups members: %u\n"),
-          program_name, Lib_group::total_members);
-  fprintf(stderr, _("%s: loaded lib groups members: %u\n"),
-          program_name, Lib_group::total_members_loaded);
+  if (parameters->options().stats())
+    {
+      fprintf(stderr, _("%s: lib groups: %u\n"),
+	      program_name, Lib_group::total_lib_groups);
+      fprintf(stderr, _("%s: total lib groups members: %u\n"),
+	      program_name, Lib_group::total_members);
+      fprintf(stderr, _("%s: loaded lib groups members: %u\n"),
+	      program_name, Lib_group::total_members_loaded);
+    }
+  record_stat("lib groups", Lib_group::total_lib_groups);
+  record_stat("total lib groups members", Lib_group::total_members);
+  record_stat("loaded lib groups members", Lib_group::total_members_loaded);
 }
 
 Task_token*
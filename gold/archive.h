@@ -23,6 +23,7 @@
 #ifndef GOLD_ARCHIVE_H
 #define GOLD_ARCHIVE_H
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -286,6 +287,8 @@ class Archive : public Library_base
   static unsigned int total_members;
   // Number of archive members loaded.
   static unsigned int total_members_loaded;
+  // Number of archive map entries looked up in the symbol table.
+  static size_t total_armap_checks;
 
   // Get a view into the underlying file.
   const unsigned char*
@@ -340,6 +343,38 @@ class Archive : public Library_base
   include_member(Symbol_table*, Layout*, Input_objects*, off_t off,
 		 Mapfile*, Symbol*, const char* why);
 
+  // Make one pass over the whole archive map, including the members
+  // we need.
+  bool
+  add_armap_symbols(Symbol_table*, Layout*, Input_objects*, Mapfile*,
+		    char** tmpbufp, size_t* tmpbuflen, bool* added_new_object);
+
+  // Make one pass over the archive map entries for symbols which have
+  // become undefined since the last pass, including the members we
+  // need.
+  bool
+  add_indexed_symbols(Symbol_table*, Layout*, Input_objects*, Mapfile*,
+		      char** tmpbufp, size_t* tmpbuflen,
+		      bool* added_new_object);
+
+  // Build armap_index_.
+  void
+  index_armap();
+
+  // Add to *ENTRIES the indexes of the unchecked archive map entries,
+  // at least MIN_INDEX, for the strong undefined symbols recorded in
+  // the symbol table from START to END.
+  void
+  find_armap_entries(const Symbol_table*, size_t start, size_t end,
+		     size_t min_index, std::set<size_t>* entries) const;
+
+  // Ask the system to start reading the headers of the members we
+  // need for the strong undefined symbols recorded in the symbol
+  // table from START on.
+  void
+  prefetch_members(Symbol_table*, Layout*, size_t start, char** tmpbufp,
+		   size_t* tmpbuflen);
+
   // Return whether we found this archive by searching a directory.
   bool
   searched_for() const
@@ -369,6 +404,19 @@ class Archive : public Library_base
     off_t file_offset;
   };
 
+  // An entry in the index of the archive map by symbol name.
+  struct Armap_index_entry
+  {
+    // The hash code of the symbol name, without any version.
+    size_t hash_code;
+    // The index in armap_.
+    size_t armap_index;
+
+    bool
+    operator<(const Armap_index_entry& e) const
+    { return this->hash_code < e.hash_code; }
+  };
+
   // A simple hash code for off_t values.
   class Seen_hash
   {
@@ -395,6 +443,21 @@ class Archive : public Library_base
   std::vector<bool> armap_checked_;
   // Track which elements have been included by offset.
   Unordered_set<off_t, Seen_hash> seen_offsets_;
+  // The archive map entries which were not checked by the first pass,
+  // sorted by the hash code of the symbol name.  This is built when
+  // we start the second pass, or before the first pass with
+  // --prefetch-inputs.
+  std::vector<Armap_index_entry> armap_index_;
+  // True if we have built armap_index_.
+  bool armap_indexed_;
+  // True if we have made a pass over the whole archive map, and from
+  // now on only need to look at the entries for new undefined symbols.
+  bool use_armap_index_;
+  // The number of strong undefined symbols recorded in the symbol
+  // table when we started the last pass over the archive map.
+  size_t undefined_pos_;
+  // The offsets of the members passed to prefetch_members.
+  Unordered_set<off_t, Seen_hash> prefetched_members_;
   // Table of objects whose symbols have been pre-read.
   std::map<off_t, Archive_member> members_;
   // True if this is a thin archive.
@@ -0,0 +1,460 @@
+// call-graph.cc -- order functions using a call graph profile
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "elfcpp.h"
+#include "symtab.h"
+#include "layout.h"
+#include "output.h"
+#include "call-graph.h"
+
+namespace gold
+{
+
+// We do not let a cluster grow beyond this size.  Merging larger
+// clusters gains little, as the calls between them then cross pages
+// anyhow.  This is the value used by the LLVM linker.
+
+static const uint64_t max_cluster_size = 1024 * 1024;
+
+// We do not merge a cluster into the cluster of its caller if that
+// would make the density of the caller's cluster drop by more than
+// this factor.
+
+static const uint64_t max_density_degradation = 8;
+
+// Read the call graph.
+
+void
+Call_graph::read(const char* filename)
+{
+  std::ifstream in;
+  in.open(filename);
+  if (!in)
+    gold_fatal(_("unable to open --call-graph-ordering-file file %s: %s"),
+	       filename, strerror(errno));
+
+  std::string line;
+  unsigned int lineno = 0;
+  while (std::getline(in, line))
+    {
+      ++lineno;
+      if (!line.empty() && line[line.length() - 1] == '\r')   // Windows
+	line.resize(line.length() - 1);
+      if (line.empty() || line[0] == '#')
+	continue;
+
+      std::istringstream fields(line);
+      std::string caller;
+      std::string callee;
+      std::string weight;
+      std::string extra;
+      fields >> caller >> callee >> weight >> extra;
+      if (caller.empty())
+	continue;
+
+      char* end;
+      errno = 0;
+      unsigned long long w = strtoull(weight.c_str(), &end, 10);
+      if (weight.empty()
+	  || weight[0] == '-'
+	  || *end != '\0'
+	  || errno != 0
+	  || !extra.empty())
+	{
+	  gold_error(_("%s:%u: expected CALLER CALLEE WEIGHT"),
+		     filename, lineno);
+	  continue;
+	}
+
+      this->edges_.push_back(Edge(caller, callee, w));
+    }
+}
+
+// Set *ID to the section which defines the global symbol NAME, or to
+// a Section_id with a NULL object if the symbol is not defined in a
+// section of a regular object.  Return false if there is no global
+// symbol NAME.
+
+static bool
+global_symbol_section(const Symbol_table* symtab, const std::string& name,
+		      Section_id* id)
+{
+  *id = Section_id(NULL, 0);
+
+  const Symbol* sym = symtab->lookup(name.c_str());
+  if (sym == NULL)
+    return false;
+  if (sym->is_forwarder())
+    sym = symtab->resolve_forwards(sym);
+  if (sym->source() != Symbol::FROM_OBJECT)
+    return true;
+
+  bool is_ordinary;
+  unsigned int shndx = sym->shndx(&is_ordinary);
+  if (!is_ordinary || shndx == elfcpp::SHN_UNDEF)
+    return true;
+
+  Object* object = sym->object();
+  if (object->is_dynamic() || object->pluginobj() != NULL)
+    return true;
+
+  *id = Section_id(static_cast<Relobj*>(object), shndx);
+  return true;
+}
+
+// Find the section which defines each function named in the call
+// graph.  A name which is not a global symbol may be a static
+// function, so we look for it in the local symbols of the objects, in
+// input order, and use the first one we find.  We warn about the names
+// we do not find at all.
+
+void
+Call_graph::find_sections(const Task* task,
+			  const Input_objects* input_objects,
+			  const Symbol_table* symtab,
+			  Symbol_sections* symbol_sections) const
+{
+  Unordered_set<std::string> locals;
+  for (std::vector<Edge>::const_iterator p = this->edges_.begin();
+       p != this->edges_.end();
+       ++p)
+    {
+      const std::string* names[2] = { &p->caller, &p->callee };
+      for (int i = 0; i < 2; ++i)
+	{
+	  if (symbol_sections->find(*names[i]) != symbol_sections->end()
+	      || locals.find(*names[i]) != locals.end())
+	    continue;
+	  Section_id id;
+	  if (global_symbol_section(symtab, *names[i], &id))
+	    (*symbol_sections)[*names[i]] = id;
+	  else
+	    locals.insert(*names[i]);
+	}
+    }
+
+  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+       p != input_objects->relobj_end() && !locals.empty();
+       ++p)
+    {
+      Relobj::Local_functions found;
+      {
+	Task_lock_obj<Object> tl(task, *p);
+	(*p)->find_local_functions(locals, &found);
+      }
+      for (Relobj::Local_functions::const_iterator q = found.begin();
+	   q != found.end();
+	   ++q)
+	{
+	  symbol_sections->insert(std::make_pair(q->first,
+						 Section_id(*p, q->second)));
+	  locals.erase(q->first);
+	}
+    }
+
+  std::vector<std::string> missing(locals.begin(), locals.end());
+  std::sort(missing.begin(), missing.end());
+  for (std::vector<std::string>::const_iterator p = missing.begin();
+       p != missing.end();
+       ++p)
+    gold_warning(_("%s: no function named %s"),
+		 parameters->options().call_graph_ordering_file(),
+		 p->c_str());
+}
+
+namespace
+{
+
+// A section which appears in the call graph.
+
+struct Call_graph_node
+{
+  Call_graph_node(Section_id a_id, uint64_t a_size)
+    : id(a_id), size(a_size), weight(0), best_pred(-1), best_pred_weight(0)
+  { }
+
+  // The section.
+  Section_id id;
+  // The size of the section.
+  uint64_t size;
+  // The total weight of the calls into the section.
+  uint64_t weight;
+  // The index of the node with the heaviest calls into this one, or -1.
+  int best_pred;
+  // The weight of the calls from best_pred.
+  uint64_t best_pred_weight;
+};
+
+// A cluster of sections which are placed together.
+
+struct Call_graph_cluster
+{
+  Call_graph_cluster(int node, uint64_t a_size, uint64_t a_weight)
+    : nodes(1, node), size(a_size), weight(a_weight)
+  { }
+
+  double
+  density() const
+  {
+    return (static_cast<double>(this->weight)
+	    / std::max<uint64_t>(this->size, 1));
+  }
+
+  // The nodes in the cluster, in order.
+  std::vector<int> nodes;
+  // The total size of the sections in the cluster.
+  uint64_t size;
+  // The total weight of the calls into the cluster.
+  uint64_t weight;
+};
+
+// Sort clusters, or the initial single node clusters, by decreasing
+// density.
+
+class Call_graph_density_compare
+{
+ public:
+  Call_graph_density_compare(const std::vector<Call_graph_cluster>* clusters)
+    : clusters_(clusters)
+  { }
+
+  bool
+  operator()(int i1, int i2) const
+  {
+    return ((*this->clusters_)[i1].density()
+	    > (*this->clusters_)[i2].density());
+  }
+
+ private:
+  const std::vector<Call_graph_cluster>* clusters_;
+};
+
+} // End anonymous namespace.
+
+// Compute the order of the sections.
+
+void
+Call_graph::compute_order(const Task* task,
+			  const Input_objects* input_objects,
+			  const Symbol_table* symtab, const Layout* layout,
+			  Section_layout_order* order_map) const
+{
+  Symbol_sections symbol_sections;
+  this->find_sections(task, input_objects, symtab, &symbol_sections);
+
+  // Find the output section and the size of each input section which
+  // holds code.  We only order sections within an output section.
+  typedef std::pair<const Output_section*, uint64_t> Section_info;
+  typedef Unordered_map<Section_id, Section_info, Section_id_hash>
+    Section_info_map;
+  Section_info_map sections;
+  const Layout::Section_list& section_list(layout->section_list());
+  for (Layout::Section_list::const_iterator p = section_list.begin();
+       p != section_list.end();
+       ++p)
+    {
+      if (((*p)->flags() & elfcpp::SHF_EXECINSTR) == 0)
+	continue;
+      const Output_section::Input_section_list& isl((*p)->input_sections());
+      for (Output_section::Input_section_list::const_iterator q =
+	     isl.begin();
+	   q != isl.end();
+	   ++q)
+	if (q->is_input_section())
+	  sections[Section_id(q->relobj(), q->shndx())] =
+	    Section_info(*p, q->data_size());
+    }
+
+  // Build the graph of the sections.  Calls between functions in the
+  // same pair of sections are combined.
+  std::vector<Call_graph_node> nodes;
+  Unordered_map<Section_id, int, Section_id_hash> node_index;
+  std::map<std::pair<int, int>, uint64_t> graph_edges;
+  for (std::vector<Edge>::const_iterator p = this->edges_.begin();
+       p != this->edges_.end();
+       ++p)
+    {
+      Symbol_sections::const_iterator from_sym =
+	symbol_sections.find(p->caller);
+      Symbol_sections::const_iterator to_sym =
+	symbol_sections.find(p->callee);
+      if (from_sym == symbol_sections.end()
+	  || to_sym == symbol_sections.end()
+	  || from_sym->second.first == NULL
+	  || to_sym->second.first == NULL)
+	continue;
+      Section_id from_id(from_sym->second);
+      Section_id to_id(to_sym->second);
+
+      Section_info_map::const_iterator from = sections.find(from_id);
+      Section_info_map::const_iterator to = sections.find(to_id);
+      if (from == sections.end()
+	  || to == sections.end()
+	  || from->second.first != to->second.first)
+	continue;
+
+      int from_node;
+      int to_node;
+      Section_id ids[2] = { from_id, to_id };
+      int* indexes[2] = { &from_node, &to_node };
+      uint64_t sizes[2] = { from->second.second, to->second.second };
+      for (int i = 0; i < 2; ++i)
+	{
+	  std::pair<Unordered_map<Section_id, int, Section_id_hash>::iterator,
+		    bool> ins =
+	    node_index.insert(std::make_pair(ids[i], nodes.size()));
+	  if (ins.second)
+	    nodes.push_back(Call_graph_node(ids[i], sizes[i]));
+	  *indexes[i] = ins.first->second;
+	}
+
+      nodes[to_node].weight += p->weight;
+      if (from_node != to_node)
+	graph_edges[std::make_pair(from_node, to_node)] += p->weight;
+    }
+
+  if (nodes.empty())
+    return;
+
+  // Remember the heaviest caller of each section.
+  for (std::map<std::pair<int, int>, uint64_t>::const_iterator p =
+	 graph_edges.begin();
+       p != graph_edges.end();
+       ++p)
+    {
+      Call_graph_node& to(nodes[p->first.second]);
+      if (to.best_pred < 0 || to.best_pred_weight < p->second)
+	{
+	  to.best_pred = p->first.first;
+	  to.best_pred_weight = p->second;
+	}
+    }
+
+  // Start with every section in a cluster of its own.  The cluster
+  // with index I is only used while node I is its leader.
+  int node_count = nodes.size();
+  std::vector<Call_graph_cluster> clusters;
+  std::vector<int> leader(node_count);
+  std::vector<int> sorted(node_count);
+  clusters.reserve(node_count);
+  for (int i = 0; i < node_count; ++i)
+    {
+      clusters.push_back(Call_graph_cluster(i, nodes[i].size,
+					    nodes[i].weight));
+      leader[i] = i;
+      sorted[i] = i;
+    }
+
+  // Visit the sections from the most to the least dense, and move
+  // each cluster after the cluster of the section's heaviest caller.
+  // A section's cluster is never merged away before the section is
+  // visited, so when we visit node I it is still the leader of
+  // cluster I.
+  std::stable_sort(sorted.begin(), sorted.end(),
+		   Call_graph_density_compare(&clusters));
+  for (std::vector<int>::const_iterator p = sorted.begin();
+       p != sorted.end();
+       ++p)
+    {
+      int i = *p;
+      Call_graph_cluster& c(clusters[i]);
+      if (c.size > max_cluster_size || nodes[i].best_pred < 0)
+	continue;
+
+      int pred = leader[nodes[i].best_pred];
+      if (pred == i)
+	continue;
+      Call_graph_cluster& pred_c(clusters[pred]);
+      if (c.size + pred_c.size > max_cluster_size)
+	continue;
+
+      double new_density = (static_cast<double>(c.weight + pred_c.weight)
+			    / std::max<uint64_t>(c.size + pred_c.size, 1));
+      if (new_density < pred_c.density() / max_density_degradation)
+	continue;
+
+      for (std::vector<int>::const_iterator q = c.nodes.begin();
+	   q != c.nodes.end();
+	   ++q)
+	leader[*q] = pred;
+      pred_c.nodes.insert(pred_c.nodes.end(), c.nodes.begin(), c.nodes.end());
+      pred_c.size += c.size;
+      pred_c.weight += c.weight;
+      c.nodes.clear();
+    }
+
+  // Place the clusters from the most to the least dense.
+  std::vector<int> order;
+  for (int i = 0; i < node_count; ++i)
+    if (leader[i] == i)
+      order.push_back(i);
+  std::stable_sort(order.begin(), order.end(),
+		   Call_graph_density_compare(&clusters));
+
+  unsigned int position = 1;
+  Unordered_set<const Output_section*> ordered_sections;
+  for (std::vector<int>::const_iterator p = order.begin();
+       p != order.end();
+       ++p)
+    {
+      const std::vector<int>& cnodes(clusters[*p].nodes);
+      for (std::vector<int>::const_iterator q = cnodes.begin();
+	   q != cnodes.end();
+	   ++q)
+	{
+	  (*order_map)[nodes[*q].id] = position++;
+	  ordered_sections.insert(sections[nodes[*q].id].first);
+	}
+    }
+
+  // Sections which are not in the order map keep an index of 0, and
+  // Input_section_sort_section_order_index_compare puts those first.
+  // The sections in the call graph are the hot ones, so we want them
+  // first instead.  Give the other input sections of the same output
+  // sections the following positions, in their current order.
+  for (Layout::Section_list::const_iterator p = section_list.begin();
+       p != section_list.end();
+       ++p)
+    {
+      if (ordered_sections.find(*p) == ordered_sections.end())
+	continue;
+      const Output_section::Input_section_list& isl((*p)->input_sections());
+      for (Output_section::Input_section_list::const_iterator q =
+	     isl.begin();
+	   q != isl.end();
+	   ++q)
+	if (q->is_input_section())
+	  order_map->insert(std::make_pair(Section_id(q->relobj(),
+						       q->shndx()),
+					   position++));
+    }
+}
+
+} // End namespace gold.
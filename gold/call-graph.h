@@ -0,0 +1,110 @@
+// call-graph.h -- order functions using a call graph profile  -*- C++ -*-
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_CALL_GRAPH_H
+#define GOLD_CALL_GRAPH_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "object.h"
+
+namespace gold
+{
+
+class Input_objects;
+class Layout;
+class Symbol_table;
+class Task;
+
+// Call_graph holds a weighted call graph read from the file named by
+// --call-graph-ordering-file, and uses it to compute an order for the
+// input sections which contain functions.  Each line of the file is
+// "CALLER CALLEE WEIGHT", where CALLER and CALLEE are symbol names and
+// WEIGHT is the number of times the call was seen, typically from
+// perf or LBR samples.  Lines starting with '#' are ignored.
+
+// The order is computed with the C3 heuristic described in
+// "Optimizing Function Placement for Large-Scale Data-Center
+// Applications" by Ottoni and Maher, CGO 2017.  Sections are grouped
+// into clusters by merging each section into the cluster of its
+// hottest caller, as long as the cluster stays small; the clusters are
+// then placed in order of decreasing density, so that the hottest code
+// is packed into as few pages as possible.  The sections in the call
+// graph go before the other sections of their output section.  This
+// only works well when functions are in separate sections, i.e., with
+// -ffunction-sections.
+
+class Call_graph
+{
+ public:
+  typedef std::map<Section_id, unsigned int> Section_layout_order;
+
+  Call_graph()
+    : edges_()
+  { }
+
+  // Read the call graph from FILENAME.
+  void
+  read(const char* filename);
+
+  // Compute the order of the input sections in LAYOUT, using SYMTAB
+  // and the local symbols of INPUT_OBJECTS to find the section
+  // defining each symbol.  TASK is the running task, used to lock the
+  // objects.  Store the position of each ordered section in
+  // ORDER_MAP, starting from 1.  The other input sections of the
+  // output sections which hold ordered sections follow them, in
+  // their current order.
+  void
+  compute_order(const Task* task, const Input_objects* input_objects,
+		const Symbol_table* symtab, const Layout* layout,
+		Section_layout_order* order_map) const;
+
+ private:
+  // Map a symbol name to the section defining it.
+  typedef Unordered_map<std::string, Section_id> Symbol_sections;
+
+  // Find the section defining each symbol in the call graph.
+  void
+  find_sections(const Task*, const Input_objects*, const Symbol_table*,
+		Symbol_sections*) const;
+
+  // An edge of the call graph, as read from the file.
+  struct Edge
+  {
+    Edge(const std::string& a_caller, const std::string& a_callee,
+	 uint64_t a_weight)
+      : caller(a_caller), callee(a_callee), weight(a_weight)
+    { }
+
+    std::string caller;
+    std::string callee;
+    uint64_t weight;
+  };
+
+  // The edges of the call graph.
+  std::vector<Edge> edges_;
+};
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_CALL_GRAPH_H)
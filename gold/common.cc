@@ -36,12 +36,20 @@ namespace gold
 
 // Allocate_commons_task methods.
 
+Allocate_commons_task::~Allocate_commons_task()
+{
+  if (this->this_blocker_ != NULL)
+    delete this->this_blocker_;
+}
+
 // This task allocates the common symbols.  We arrange to run it
-// before anything else which needs to access the symbol table.
+// before anything else which needs to change the symbol table.
 
 Task_token*
 Allocate_commons_task::is_runnable()
 {
+  if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+    return this->this_blocker_;
   return NULL;
 }
 
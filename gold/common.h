@@ -35,11 +35,17 @@ class Symbol_table;
 class Allocate_commons_task : public Task
 {
  public:
+  // THIS_BLOCKER, if not NULL, prevents this task from running until
+  // the relocations have been prescanned.  BLOCKER is unblocked when
+  // this task is done.
   Allocate_commons_task(Symbol_table* symtab, Layout* layout, Mapfile* mapfile,
-			Task_token* blocker)
-    : symtab_(symtab), layout_(layout), mapfile_(mapfile), blocker_(blocker)
+			Task_token* this_blocker, Task_token* blocker)
+    : symtab_(symtab), layout_(layout), mapfile_(mapfile),
+      this_blocker_(this_blocker), blocker_(blocker)
   { }
 
+  ~Allocate_commons_task();
+
   // The standard Task methods.
 
   Task_token*
@@ -59,6 +65,7 @@ class Allocate_commons_task : public Task
   Symbol_table* symtab_;
   Layout* layout_;
   Mapfile* mapfile_;
+  Task_token* this_blocker_;
   Task_token* blocker_;
 };
 
@@ -22,56 +22,141 @@
 
 #include "gold.h"
 #include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #include "parameters.h"
 #include "options.h"
+#include "workqueue.h"
 #include "compressed_output.h"
 
 namespace gold
 {
 
-// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
-// if it successfully compressed, false if it failed for any reason
-// (including not having zlib support in the library).  If it returns
-// true, it allocates memory for the compressed data using new, and
-// sets *COMPRESSED_DATA and *COMPRESSED_SIZE to appropriate values.
-// It also writes a header before COMPRESSED_DATA: 4 bytes saying
-// "ZLIB", and 8 bytes indicating the uncompressed size, in big-endian
-// order.
+// Return whether to use zstd rather than zlib.
 
 static bool
-zlib_compress(int header_size,
-              const unsigned char* uncompressed_data,
-              unsigned long uncompressed_size,
-              unsigned char** compressed_data,
-              unsigned long* compressed_size)
+use_zstd()
 {
-  *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
-  *compressed_data = new unsigned char[*compressed_size + header_size];
+  return strcmp(parameters->options().compress_debug_sections(), "zstd") == 0;
+}
+
+// Return the compression level to use.
 
-  int compress_level;
-  if (parameters->options().optimize() >= 1)
-    compress_level = 9;
+static int
+compression_level()
+{
+  int level = parameters->options().compress_debug_sections_level();
+  if (level >= 0)
+    return level;
+  else if (parameters->options().optimize() >= 1)
+    return 9;
   else
-    compress_level = 1;
-
-  int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
-                     compressed_size,
-                     reinterpret_cast<const Bytef*>(uncompressed_data),
-                     uncompressed_size,
-                     compress_level);
-  if (rc == Z_OK)
+    return 1;
+}
+
+// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE as a raw
+// deflate stream, with no zlib header or trailer.  DICTIONARY holds
+// the DICTIONARY_SIZE bytes which immediately precede
+// UNCOMPRESSED_DATA; they are used to prime the compressor so that
+// the result may refer back to them.  If IS_LAST is false, the
+// stream ends with a full flush, leaving it byte aligned so that the
+// next chunk may be appended; otherwise the final block is marked
+// as such.  Returns true if it successfully compressed, and sets
+// *COMPRESSED_DATA to memory allocated with new and
+// *COMPRESSED_SIZE to its size.
+
+static bool
+deflate_chunk(int level,
+	      const unsigned char* dictionary,
+	      unsigned long dictionary_size,
+	      const unsigned char* uncompressed_data,
+	      unsigned long uncompressed_size,
+	      bool is_last,
+	      unsigned char** compressed_data,
+	      unsigned long* compressed_size)
+{
+  z_stream strm;
+  memset(&strm, 0, sizeof strm);
+  if (deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8,
+		   Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  if (dictionary_size > 0
+      && deflateSetDictionary(&strm,
+			      reinterpret_cast<const Bytef*>(dictionary),
+			      dictionary_size) != Z_OK)
     {
-      *compressed_size += header_size;
-      return true;
+      deflateEnd(&strm);
+      return false;
     }
-  else
+
+  // A full flush may add an empty stored block, which deflateBound
+  // does not account for.
+  unsigned long buffer_size = deflateBound(&strm, uncompressed_size) + 16;
+  unsigned char* buffer = new unsigned char[buffer_size];
+
+  strm.next_in = const_cast<Bytef*>(uncompressed_data);
+  strm.avail_in = uncompressed_size;
+  strm.next_out = buffer;
+  strm.avail_out = buffer_size;
+  int rc = deflate(&strm, is_last ? Z_FINISH : Z_FULL_FLUSH);
+  bool ok = (is_last
+	     ? rc == Z_STREAM_END
+	     : rc == Z_OK && strm.avail_in == 0 && strm.avail_out > 0);
+  deflateEnd(&strm);
+
+  if (!ok)
+    {
+      delete[] buffer;
+      return false;
+    }
+
+  *compressed_data = buffer;
+  *compressed_size = buffer_size - strm.avail_out;
+  return true;
+}
+
+// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE as a single
+// zstd frame.  Frames are independent, and a sequence of frames
+// decompresses to the concatenation of their contents.  Returns
+// true if it successfully compressed, and sets *COMPRESSED_DATA to
+// memory allocated with new and *COMPRESSED_SIZE to its size.
+
+#ifdef HAVE_ZSTD
+
+static bool
+zstd_compress_chunk(int level,
+		    const unsigned char* uncompressed_data,
+		    unsigned long uncompressed_size,
+		    unsigned char** compressed_data,
+		    unsigned long* compressed_size)
+{
+  size_t buffer_size = ZSTD_compressBound(uncompressed_size);
+  unsigned char* buffer = new unsigned char[buffer_size];
+  size_t ret = ZSTD_compress(buffer, buffer_size, uncompressed_data,
+			     uncompressed_size, level);
+  if (ZSTD_isError(ret))
     {
-      delete[] *compressed_data;
-      *compressed_data = NULL;
+      delete[] buffer;
       return false;
     }
+  *compressed_data = buffer;
+  *compressed_size = ret;
+  return true;
 }
 
+#else // defined(HAVE_ZSTD)
+
+static bool
+zstd_compress_chunk(int, const unsigned char*, unsigned long,
+		    unsigned char**, unsigned long*)
+{
+  gold_unreachable();
+}
+
+#endif // defined(HAVE_ZSTD)
+
 // Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, into a buffer
 // UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns TRUE if it
 // decompressed successfully, false if it failed.  The buffer, of
@@ -115,6 +200,35 @@ zlib_decompress(const unsigned char* compressed_data,
   return true;
 }
 
+// Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, a sequence of
+// zstd frames, into a buffer UNCOMPRESSED_DATA of size
+// UNCOMPRESSED_SIZE.  Returns true if it decompressed successfully,
+// false if it failed, including when zstd support was not built in.
+
+#ifdef HAVE_ZSTD
+
+static bool
+zstd_decompress(const unsigned char* compressed_data,
+		unsigned long compressed_size,
+		unsigned char* uncompressed_data,
+		unsigned long uncompressed_size)
+{
+  size_t ret = ZSTD_decompress(uncompressed_data, uncompressed_size,
+			       compressed_data, compressed_size);
+  return !ZSTD_isError(ret) && ret == uncompressed_size;
+}
+
+#else // defined(HAVE_ZSTD)
+
+static bool
+zstd_decompress(const unsigned char*, unsigned long, unsigned char*,
+		unsigned long)
+{
+  return false;
+}
+
+#endif // defined(HAVE_ZSTD)
+
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
 
@@ -148,45 +262,37 @@ decompress_input_section(const unsigned char* compressed_data,
   if ((sh_flags & elfcpp::SHF_COMPRESSED) != 0)
     {
       unsigned int compression_header_size;
+      elfcpp::Elf_Word ch_type;
       if (size == 32)
 	{
 	  compression_header_size = elfcpp::Elf_sizes<32>::chdr_size;
 	  if (big_endian)
-	    {
-	      elfcpp::Chdr<32, true> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
-	    }
+	    ch_type = elfcpp::Chdr<32, true>(compressed_data).get_ch_type();
 	  else
-	    {
-	      elfcpp::Chdr<32, false> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
-	    }
+	    ch_type = elfcpp::Chdr<32, false>(compressed_data).get_ch_type();
 	}
       else if (size == 64)
 	{
 	  compression_header_size = elfcpp::Elf_sizes<64>::chdr_size;
 	  if (big_endian)
-	    {
-	      elfcpp::Chdr<64, true> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
-	    }
+	    ch_type = elfcpp::Chdr<64, true>(compressed_data).get_ch_type();
 	  else
-	    {
-	      elfcpp::Chdr<64, false> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
-	    }
+	    ch_type = elfcpp::Chdr<64, false>(compressed_data).get_ch_type();
 	}
       else
 	gold_unreachable();
 
-      return zlib_decompress(compressed_data + compression_header_size,
-			     compressed_size - compression_header_size,
-			     uncompressed_data,
-			     uncompressed_size);
+      if (ch_type == elfcpp::ELFCOMPRESS_ZLIB)
+	return zlib_decompress(compressed_data + compression_header_size,
+			       compressed_size - compression_header_size,
+			       uncompressed_data,
+			       uncompressed_size);
+      else if (ch_type == elfcpp::ELFCOMPRESS_ZSTD)
+	return zstd_decompress(compressed_data + compression_header_size,
+			       compressed_size - compression_header_size,
+			       uncompressed_data,
+			       uncompressed_size);
+      return false;
     }
 
   const unsigned int zlib_header_size = 12;
@@ -209,36 +315,278 @@ decompress_input_section(const unsigned char* compressed_data,
   return false;
 }
 
+// A Compress_chunk_task compresses one chunk of an
+// Output_compressed_section.
+
+class Compress_chunk_task : public Task
+{
+ public:
+  Compress_chunk_task(Output_compressed_section* os, size_t chunk,
+		      Task_token* final_blocker)
+    : os_(os), chunk_(chunk), final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->os_->compress_chunk(this->chunk_); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Compress_chunk_task " + std::string(this->os_->name()); }
+
+ private:
+  Output_compressed_section* const os_;
+  const size_t chunk_;
+  Task_token* const final_blocker_;
+};
+
 // Class Output_compressed_section.
 
-// Set the final data size of a compressed section.  This is where
-// we actually compress the section data.
+Output_compressed_section::~Output_compressed_section()
+{
+  this->free_chunks();
+}
+
+// Split the postprocessing buffer into chunks of the size given by
+// --compress-debug-sections-chunk-size.  The chunk boundaries depend
+// only on the size of the section, so the output does not depend on
+// whether the chunks are compressed in parallel.
 
 void
-Output_compressed_section::set_final_data_size()
+Output_compressed_section::split_into_chunks()
 {
-  off_t uncompressed_size = this->postprocessing_buffer_size();
+  gold_assert(this->chunks_.empty());
+  section_size_type size = this->postprocessing_buffer_size();
+  section_size_type chunk_size =
+    this->options_->compress_debug_sections_chunk_size();
+  if (chunk_size == 0 || chunk_size > size)
+    chunk_size = size;
+
+  section_size_type offset = 0;
+  do
+    {
+      section_size_type len = std::min(chunk_size, size - offset);
+      this->chunks_.push_back(Compressed_chunk(offset, len));
+      offset += len;
+    }
+  while (offset < size);
+}
 
-  // (Try to) compress the data.
-  unsigned long compressed_size;
-  unsigned char* uncompressed_data = this->postprocessing_buffer();
+// Free the compressed chunks.
+
+void
+Output_compressed_section::free_chunks()
+{
+  for (std::vector<Compressed_chunk>::iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    delete[] p->data;
+  this->chunks_.clear();
+}
 
+// Queue a task to compress each chunk of the section.
+
+void
+Output_compressed_section::queue_compression_tasks(Workqueue* workqueue,
+						   Task_token* blocker)
+{
   // At this point the contents of all regular input sections will
   // have been copied into the postprocessing buffer, and relocations
   // will have been applied.  Now we need to copy in the contents of
   // anything other than a regular input section.
   this->write_to_postprocessing_buffer();
 
+  this->split_into_chunks();
+  this->chunks_queued_ = true;
+
+  size_t count = this->chunks_.size();
+  blocker->add_blockers(count);
+  for (size_t i = 0; i < count; ++i)
+    workqueue->queue(new Compress_chunk_task(this, i, blocker));
+}
+
+// Compress chunk I.  With zlib, the compressor is primed with up to
+// 32K of the data which precedes the chunk, so compressing in pieces
+// costs little in compression ratio.  With zstd, each chunk is an
+// independent frame.
+
+void
+Output_compressed_section::compress_chunk(size_t i)
+{
+  Compressed_chunk* chunk = &this->chunks_[i];
+  const unsigned char* buffer = this->postprocessing_buffer();
+
+  if (use_zstd())
+    {
+      zstd_compress_chunk(compression_level(),
+			  buffer + chunk->offset,
+			  chunk->size,
+			  &chunk->data,
+			  &chunk->data_size);
+      return;
+    }
+
+  const unsigned long window_size = 1UL << MAX_WBITS;
+  unsigned long dictionary_size = std::min<unsigned long>(chunk->offset,
+							  window_size);
+
+  bool is_last = i + 1 == this->chunks_.size();
+  if (!deflate_chunk(compression_level(),
+		     buffer + chunk->offset - dictionary_size,
+		     dictionary_size,
+		     buffer + chunk->offset,
+		     chunk->size,
+		     is_last,
+		     &chunk->data,
+		     &chunk->data_size))
+    return;
+
+  chunk->adler = adler32(adler32(0L, Z_NULL, 0),
+			 reinterpret_cast<const Bytef*>(buffer + chunk->offset),
+			 chunk->size);
+}
+
+// Concatenate the compressed chunks into this->data_.  Returns true
+// if it succeeded, false if any chunk failed to compress.  The data
+// starts with HEADER_SIZE bytes of space for the compression header,
+// followed by a two byte zlib header, the compressed chunks, and the
+// Adler-32 checksum of all the uncompressed data, in big-endian
+// order.  Since each chunk but the last ends with a full flush, this
+// is a valid zlib stream which any reader can inflate in one go.
+
+bool
+Output_compressed_section::zlib_compress(int header_size,
+					 unsigned long uncompressed_size,
+					 unsigned long* compressed_size)
+{
+  unsigned long adler = adler32(0L, Z_NULL, 0);
+  unsigned long size = header_size + 2 + 4;
+  for (std::vector<Compressed_chunk>::const_iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      if (p->data == NULL)
+	return false;
+      adler = adler32_combine(adler, p->adler, p->size);
+      size += p->data_size;
+    }
+
+  this->data_ = new unsigned char[size];
+  unsigned char* pov = this->data_ + header_size;
+
+  // The zlib header: deflate with a 32K window, and the compression
+  // level, with a check value which makes it a multiple of 31.
+  int level = compression_level();
+  unsigned int flevel;
+  if (level < 2)
+    flevel = 0;
+  else if (level < 6)
+    flevel = 1;
+  else if (level == 6)
+    flevel = 2;
+  else
+    flevel = 3;
+  unsigned int zlib_header = (((Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8)
+			      | (flevel << 6));
+  zlib_header += 31 - zlib_header % 31;
+  elfcpp::Swap_unaligned<16, true>::writeval(pov, zlib_header);
+  pov += 2;
+
+  for (std::vector<Compressed_chunk>::const_iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      memcpy(pov, p->data, p->data_size);
+      pov += p->data_size;
+    }
+
+  elfcpp::Swap_unaligned<32, true>::writeval(pov, adler);
+  pov += 4;
+
+  gold_assert(static_cast<unsigned long>(pov - this->data_) == size);
+  gold_assert(this->chunks_.back().offset + this->chunks_.back().size
+	      == uncompressed_size);
+  *compressed_size = size;
+  return true;
+}
+
+// Concatenate the compressed chunks, which are zstd frames, into
+// this->data_.  Returns true if it succeeded, false if any chunk
+// failed to compress.  The data starts with HEADER_SIZE bytes of
+// space for the compression header.
+
+bool
+Output_compressed_section::zstd_compress(int header_size,
+					 unsigned long* compressed_size)
+{
+  unsigned long size = header_size;
+  for (std::vector<Compressed_chunk>::const_iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      if (p->data == NULL)
+	return false;
+      size += p->data_size;
+    }
+
+  this->data_ = new unsigned char[size];
+  unsigned char* pov = this->data_ + header_size;
+  for (std::vector<Compressed_chunk>::const_iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      memcpy(pov, p->data, p->data_size);
+      pov += p->data_size;
+    }
+
+  gold_assert(static_cast<unsigned long>(pov - this->data_) == size);
+  *compressed_size = size;
+  return true;
+}
+
+// Set the final data size of a compressed section.  This is where
+// we actually compress the section data, unless that was already
+// done in parallel by queue_compression_tasks.
+
+void
+Output_compressed_section::set_final_data_size()
+{
+  off_t uncompressed_size = this->postprocessing_buffer_size();
+
+  // (Try to) compress the data.
+  unsigned long compressed_size;
+
+  // If the data was not compressed in parallel, then at this point
+  // the contents of all regular input sections will have been copied
+  // into the postprocessing buffer, and relocations will have been
+  // applied.  Now we need to copy in the contents of anything other
+  // than a regular input section.
+  if (!this->chunks_queued_)
+    this->write_to_postprocessing_buffer();
+
   bool success = false;
-  enum { none, gnu_zlib, gabi_zlib } compress;
+  enum { none, gnu_zlib, gabi_zlib, gabi_zstd } compress;
   int compression_header_size = 12;
   const int size = parameters->target().get_size();
   if (strcmp(this->options_->compress_debug_sections(), "zlib-gnu") == 0)
     compress = gnu_zlib;
   else if (strcmp(this->options_->compress_debug_sections(), "zlib-gabi") == 0
-	   || strcmp(this->options_->compress_debug_sections(), "zlib") == 0)
+	   || strcmp(this->options_->compress_debug_sections(), "zlib") == 0
+	   || strcmp(this->options_->compress_debug_sections(), "zstd") == 0)
     {
-      compress = gabi_zlib;
+      if (strcmp(this->options_->compress_debug_sections(), "zstd") == 0)
+	compress = gabi_zstd;
+      else
+	compress = gabi_zlib;
       if (size == 32)
 	compression_header_size = elfcpp::Elf_sizes<32>::chdr_size;
       else if (size == 64)
@@ -249,16 +597,31 @@ Output_compressed_section::set_final_data_size()
   else
     compress = none;
   if (compress != none)
-    success = zlib_compress(compression_header_size, uncompressed_data,
-			    uncompressed_size, &this->data_,
-			    &compressed_size);
+    {
+      if (!this->chunks_queued_)
+	{
+	  this->split_into_chunks();
+	  for (size_t i = 0; i < this->chunks_.size(); ++i)
+	    this->compress_chunk(i);
+	}
+      if (compress == gabi_zstd)
+	success = this->zstd_compress(compression_header_size,
+				      &compressed_size);
+      else
+	success = this->zlib_compress(compression_header_size,
+				      uncompressed_size, &compressed_size);
+      this->free_chunks();
+    }
   if (success)
     {
       elfcpp::Elf_Xword flags = this->flags();
-      if (compress == gabi_zlib)
+      if (compress == gabi_zlib || compress == gabi_zstd)
 	{
 	  // Set the SHF_COMPRESSED bit.
 	  flags |= elfcpp::SHF_COMPRESSED;
+	  const elfcpp::Elf_Word ch_type = (compress == gabi_zstd
+					    ? elfcpp::ELFCOMPRESS_ZSTD
+					    : elfcpp::ELFCOMPRESS_ZLIB);
 	  const bool is_big_endian = parameters->target().is_big_endian();
 	  uint64_t addralign = this->addralign();
 	  if (size == 32)
@@ -266,14 +629,14 @@ Output_compressed_section::set_final_data_size()
 	      if (is_big_endian)
 		{
 		  elfcpp::Chdr_write<32, true> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		}
 	      else
 		{
 		  elfcpp::Chdr_write<32, false> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		}
@@ -283,7 +646,7 @@ Output_compressed_section::set_final_data_size()
 	      if (is_big_endian)
 		{
 		  elfcpp::Chdr_write<64, true> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		  // Clear the reserved field.
@@ -292,7 +655,7 @@ Output_compressed_section::set_final_data_size()
 	      else
 		{
 		  elfcpp::Chdr_write<64, false> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		  // Clear the reserved field.
@@ -317,7 +680,8 @@ Output_compressed_section::set_final_data_size()
     }
   else
     {
-      gold_warning(_("not compressing section data: zlib error"));
+      gold_warning(_("not compressing section data: %s error"),
+		   compress == gabi_zstd ? "zstd" : "zlib");
       gold_assert(this->data_ == NULL);
       this->set_data_size(uncompressed_size);
     }
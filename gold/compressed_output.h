@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -36,6 +37,8 @@ namespace gold
 {
 
 class General_options;
+class Workqueue;
+class Task_token;
 
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
@@ -60,9 +63,24 @@ class Output_compressed_section : public Output_section
 			    const char* name, elfcpp::Elf_Word flags,
 			    elfcpp::Elf_Xword type)
     : Output_section(name, flags, type),
-      options_(options)
+      options_(options), data_(NULL), new_section_name_(), chunks_(),
+      chunks_queued_(false)
   { this->set_requires_postprocessing(); }
 
+  ~Output_compressed_section();
+
+  // Split the contents of the section into chunks, and queue a task
+  // to compress each chunk.  BLOCKER is released as each task
+  // completes.  This is called after all the input sections have
+  // been relocated, and before set_final_data_size.
+  void
+  queue_compression_tasks(Workqueue*, Task_token* blocker);
+
+  // Compress chunk I.  This is called by Compress_chunk_task, and
+  // may run in parallel with the compression of other chunks.
+  void
+  compress_chunk(size_t i);
+
  protected:
   // Set the final data size.
   void
@@ -73,12 +91,55 @@ class Output_compressed_section : public Output_section
   do_write(Output_file*);
 
  private:
+  // A piece of the section contents which is compressed
+  // independently.  The compressed pieces are concatenated to form
+  // a single zlib stream, or a sequence of zstd frames.
+  struct Compressed_chunk
+  {
+    Compressed_chunk(section_size_type o, section_size_type s)
+      : offset(o), size(s), data(NULL), data_size(0), adler(0)
+    { }
+
+    // The offset and size of the uncompressed data.
+    section_size_type offset;
+    section_size_type size;
+    // The compressed data, allocated with new[].  This is NULL if
+    // compression failed.
+    unsigned char* data;
+    unsigned long data_size;
+    // The Adler-32 checksum of the uncompressed data, for zlib.
+    unsigned long adler;
+  };
+
+  // Split the postprocessing buffer into chunks.
+  void
+  split_into_chunks();
+
+  // Free the compressed chunks.
+  void
+  free_chunks();
+
+  // Concatenate the compressed chunks into a zlib stream, preceded
+  // by HEADER_SIZE bytes of space for the section header.
+  bool
+  zlib_compress(int header_size, unsigned long uncompressed_size,
+		unsigned long* compressed_size);
+
+  // Concatenate the compressed chunks, which are zstd frames,
+  // preceded by HEADER_SIZE bytes of space for the section header.
+  bool
+  zstd_compress(int header_size, unsigned long* compressed_size);
+
   // The options--this includes the compression type.
   const General_options* options_;
   // The compressed data.
   unsigned char* data_;
   // The new section name if we do compress.
   std::string new_section_name_;
+  // The chunks of the section contents.
+  std::vector<Compressed_chunk> chunks_;
+  // Whether queue_compression_tasks has been called.
+  bool chunks_queued_;
 };
 
 } // End namespace gold.
@@ -446,10 +446,7 @@ Dwarf_ranges_table::read_range_list(
       if (shndx1 == 0 && start == -1)
 	base = end;
       else if (shndx1 == shndx2)
-	{
-	  if (shndx1 == 0 || object->is_section_included(shndx1))
-	    ranges->add(shndx1, base + start, base + end);
-	}
+	ranges->add(shndx1, base + start, base + end);
       else
 	gold_warning(_("%s: DWARF info may be corrupt; offsets in a "
 		       "range list entry are in different sections"),
@@ -356,7 +356,9 @@ class Dwarf_ranges_table
 		    off_t symtab_size,
 		    unsigned int ranges_shndx);
 
-  // Read the range table from an object file.
+  // Read the range table from an object file.  The list includes
+  // ranges in sections which are discarded from the link; it is up
+  // to the caller to drop them.
   Dwarf_range_list*
   read_range_list(Relobj* object,
 		  const unsigned char* symtab,
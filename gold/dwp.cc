@@ -28,6 +28,10 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <vector>
 #include <algorithm>
@@ -39,12 +43,15 @@
 #include "elfcpp.h"
 #include "elfcpp_file.h"
 #include "dwarf.h"
-#include "dirsearch.h"
+#include "descriptors.h"
 #include "fileread.h"
 #include "object.h"
 #include "compressed_output.h"
 #include "stringpool.h"
 #include "dwarf_reader.h"
+#include "options.h"
+#include "timer.h"
+#include "workqueue.h"
 
 static void
 usage(FILE* fd, int) ATTRIBUTE_NORETURN;
@@ -99,6 +106,22 @@ struct Unit_set
   { }
 };
 
+// The location of a compilation unit or type unit within the
+// .debug_info.dwo or .debug_types.dwo section of an input file.
+
+struct Unit_location
+{
+  uint64_t signature;
+  section_offset_type offset;
+  section_size_type size;
+
+  Unit_location(uint64_t sig, section_offset_type o, section_size_type s)
+    : signature(sig), offset(o), size(s)
+  { }
+};
+
+typedef std::vector<Unit_location> Unit_list;
+
 // An input file.
 // This class may represent a .dwo file, a .dwp file
 // produced by an earlier run, or an executable file whose
@@ -108,20 +131,52 @@ class Dwo_file
 {
  public:
   Dwo_file(const char* name)
-    : name_(name), obj_(NULL), input_file_(NULL), is_compressed_(),
-      sect_offsets_(), str_offset_map_()
-  { }
+    : name_(name), obj_(NULL), input_file_(NULL), file_contents_(NULL),
+      file_size_(0), machine_(0), size_(0), big_endian_(false), osabi_(0),
+      abiversion_(0), is_compressed_(), sect_offsets_(), section_contents_(),
+      debug_types_(), debug_str_(0), debug_cu_index_(0), debug_tu_index_(0),
+      cus_(), tus_(), str_count_(0), str_offset_map_(), str_offsets_(NULL),
+      remapped_str_offsets_(NULL), str_offsets_size_(0)
+  {
+    for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+      this->debug_shndx_[i] = 0;
+  }
 
   ~Dwo_file();
 
+  // Return the file name.
+  const char*
+  name() const
+  { return this->name_; }
+
   // Read the input executable file and extract the list of .dwo files
   // that it references.
   void
   read_executable(File_list* files);
 
-  // Read the input file and send its contents to OUTPUT_FILE.
+  // Read the input file, check it, and find the units and sections
+  // that need to go into the output file.  This does not touch the
+  // output file, so it may run for several input files at once.
   void
-  read(Dwp_output_file* output_file);
+  read();
+
+  // Send the contents of the input file to OUTPUT_FILE.  This must be
+  // called after read(), and for one input file at a time, in the
+  // order of the input files, so that the output is always the same.
+  void
+  add_to_output(Dwp_output_file* output_file);
+
+  // Remap the string offsets in the .debug_str_offsets.dwo section
+  // for the output string table.  This must be called after
+  // add_to_output(), but may run for several input files at once.
+  void
+  remap_str_offsets();
+
+  // Free the decompressed section contents and other data that the
+  // output file does not refer to.  This must be called after
+  // remap_str_offsets().
+  void
+  release_contents();
 
   // Verify a .dwp file given a list of .dwo files referenced by the
   // corresponding executable file.  Returns true if no problems
@@ -144,16 +199,31 @@ class Dwo_file
     { return i1.first < i2.first; }
   };
 
-  // Create a Sized_relobj_dwo of the given size and endianness,
-  // and record the target info.  P is a pointer to the ELF header
-  // in memory.
+  // The contents of an input section, decompressed if necessary.
+  // IN_OUTPUT is set if the output file refers to the contents, so
+  // that they must stay valid until it has been written.
+  struct Section_contents
+  {
+    const unsigned char* contents;
+    section_size_type size;
+    bool is_new;
+    bool in_output;
+
+    Section_contents()
+      : contents(NULL), size(0), is_new(false), in_output(false)
+    { }
+  };
+
+  // Map the input file and create a Sized_relobj_dwo of the given size
+  // and endianness.
   Relobj*
-  make_object(Dwp_output_file* output_file);
+  make_object();
 
+  // Create a Sized_relobj_dwo and save the target info.  P is a
+  // pointer to the ELF header in memory.
   template <int size, bool big_endian>
   Relobj*
-  sized_make_object(const unsigned char* p, Input_file* input_file,
-		    Dwp_output_file* output_file);
+  sized_make_object(const unsigned char* p, Input_file* input_file);
 
   // Return the number of sections in the input object file.
   unsigned int
@@ -171,11 +241,15 @@ class Dwo_file
   { return this->obj_->section_name(shndx); }
 
   // Return a view of the contents of a section, decompressed if necessary.
-  // Set *PLEN to the size.  Set *IS_NEW to true if the contents need to be
-  // deleted by the caller.
+  // Set *PLEN to the size.  The contents remain valid until the Dwo_file
+  // is deleted, so they may be added to the output file without copying.
   const unsigned char*
-  section_contents(unsigned int shndx, section_size_type* plen, bool* is_new)
-  { return this->obj_->decompressed_section_contents(shndx, plen, is_new); }
+  section_contents(unsigned int shndx, section_size_type* plen);
+
+  // Find the compilation units or type units in section SHNDX and
+  // add them to UNITS.
+  void
+  read_units(unsigned int shndx, bool is_type_unit, Unit_list* units);
 
   // Read the .debug_cu_index or .debug_tu_index section of a .dwp file,
   // and process the CU or TU sets.
@@ -200,20 +274,16 @@ class Dwo_file
 
   // Merge the input string table section into the output file.
   void
-  add_strings(Dwp_output_file*, unsigned int);
+  add_strings(Dwp_output_file*);
 
   // Copy a section from the input file to the output file.
   Section_bounds
   copy_section(Dwp_output_file* output_file, unsigned int shndx,
 	       elfcpp::DW_SECT section_id);
 
-  // Remap the string offsets in the .debug_str_offsets.dwo section.
-  const unsigned char*
-  remap_str_offsets(const unsigned char* contents, section_size_type len);
-
   template <bool big_endian>
-  const unsigned char*
-  sized_remap_str_offsets(const unsigned char* contents, section_size_type len);
+  void
+  sized_remap_str_offsets();
 
   // Remap a single string offsets from an offset in the input string table
   // to an offset in the output string table.
@@ -224,7 +294,7 @@ class Dwo_file
   // to OUTPUT_FILE.
   void
   add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
-	       bool is_debug_types);
+	       bool is_debug_types, const Unit_list& units);
 
   // The filename.
   const char* name_;
@@ -232,12 +302,42 @@ class Dwo_file
   Relobj* obj_;
   // The Input_file object.
   Input_file* input_file_;
+  // The contents of the file, which stay mapped until the Dwo_file
+  // is deleted.
+  const unsigned char* file_contents_;
+  // The size of the file.
+  off_t file_size_;
+  // ELF header values, to pass to the output file.
+  int machine_;
+  int size_;
+  bool big_endian_;
+  int osabi_;
+  int abiversion_;
   // Flags indicating which sections are compressed.
   std::vector<bool> is_compressed_;
   // Map input section index onto output section offset and size.
   std::vector<Section_bounds> sect_offsets_;
+  // The section contents we have looked at, indexed by section index.
+  std::vector<Section_contents> section_contents_;
+  // The section indexes of the debug sections, found by read().
+  unsigned int debug_shndx_[elfcpp::DW_SECT_MAX + 1];
+  std::vector<unsigned int> debug_types_;
+  unsigned int debug_str_;
+  unsigned int debug_cu_index_;
+  unsigned int debug_tu_index_;
+  // The compilation units in the .debug_info.dwo section, and the
+  // type units in each .debug_types.dwo section, of a .dwo file.
+  Unit_list cus_;
+  std::vector<Unit_list> tus_;
+  // The number of strings in the .debug_str.dwo section.
+  size_t str_count_;
   // Map input string offsets to output string offsets.
   Str_offset_map str_offset_map_;
+  // The contents of the .debug_str_offsets.dwo section, and the buffer
+  // added to the output file to hold them once they have been remapped.
+  const unsigned char* str_offsets_;
+  unsigned char* remapped_str_offsets_;
+  section_size_type str_offsets_size_;
 };
 
 // An ELF input file.
@@ -432,7 +532,7 @@ class Sized_relobj_dwo : public Sized_relobj<size, big_endian>
 
   // Relocate the input sections and write out the local symbols.
   void
-  do_relocate(const Symbol_table*, const Layout*, Output_file*)
+  do_relocate(const Symbol_table*, const Layout*, Output_file*, Workqueue*)
   { gold_unreachable(); }
 
  private:
@@ -452,7 +552,8 @@ class Dwp_output_file
       abiversion_(0), fd_(NULL), next_file_offset_(0), shnum_(1), sections_(),
       section_id_map_(), shoff_(0), shstrndx_(0), have_strings_(false),
       stringpool_(), shstrtab_(), cu_index_(), tu_index_(), last_type_sig_(0),
-      last_tu_slot_(0)
+      last_tu_slot_(0), cu_count_(0), tu_count_(0), duplicate_tu_count_(0),
+      duplicate_tu_bytes_(0)
   {
     this->section_id_map_.resize(elfcpp::DW_SECT_MAX + 1);
     this->stringpool_.set_no_zero_null();
@@ -468,6 +569,7 @@ class Dwp_output_file
   add_string(const char* str, size_t len);
 
   // Add a section to the output file, and return the new section offset.
+  // CONTENTS must remain valid until finalize() is called.
   section_offset_type
   add_contribution(elfcpp::DW_SECT section_id, const unsigned char* contents,
 		   section_size_type len, int align);
@@ -477,8 +579,10 @@ class Dwp_output_file
   add_cu_set(Unit_set* cu_set);
 
   // Lookup a type signature and return TRUE if we have already seen it.
+  // TU_SIZE is the size of the type unit, which is counted as
+  // deduplicated if we have.
   bool
-  lookup_tu(uint64_t type_sig);
+  lookup_tu(uint64_t type_sig, section_size_type tu_size);
 
   // Add a set of .debug_types and related sections to the output file.
   void
@@ -489,6 +593,10 @@ class Dwp_output_file
   void
   finalize();
 
+  // Print statistics about the units we have seen.
+  void
+  print_stats() const;
+
  private:
   // Contributions to output sections.
   struct Contribution
@@ -677,6 +785,14 @@ class Dwp_output_file
   uint64_t last_type_sig_;
   // Cache of the slot index for the last type signature.
   unsigned int last_tu_slot_;
+  // The number of compilation units added.
+  unsigned int cu_count_;
+  // The number of type units looked up.
+  unsigned int tu_count_;
+  // The number and total size of the type units which were dropped
+  // because we had already seen their signature.
+  unsigned int duplicate_tu_count_;
+  uint64_t duplicate_tu_bytes_;
 };
 
 // A specialization of Dwarf_info_reader, for reading dwo_names from
@@ -711,23 +827,23 @@ class Dwo_name_info_reader : public Dwarf_info_reader
   File_list* files_;
 };
 
-// A specialization of Dwarf_info_reader, for reading DWARF CUs and TUs
-// and adding them to the output file.
+// A specialization of Dwarf_info_reader, for finding the DWARF CUs
+// and TUs in an input file.
 
 class Unit_reader : public Dwarf_info_reader
 {
  public:
   Unit_reader(bool is_type_unit, Relobj* object, unsigned int shndx)
     : Dwarf_info_reader(is_type_unit, object, NULL, 0, shndx, 0, 0),
-      output_file_(NULL), sections_(NULL)
+      units_(NULL)
   { }
 
   ~Unit_reader()
   { }
 
-  // Read the CUs or TUs and add them to the output file.
+  // Read the CUs or TUs and add their locations to UNITS.
   void
-  add_units(Dwp_output_file*, unsigned int debug_abbrev, Section_bounds*);
+  read_units(unsigned int debug_abbrev, Unit_list* units);
 
  protected:
   // Visit a compilation unit.
@@ -740,8 +856,8 @@ class Unit_reader : public Dwarf_info_reader
 		  uint64_t signature, Dwarf_die*);
 
  private:
-  Dwp_output_file* output_file_;
-  Section_bounds* sections_;
+  // The list of units to populate.
+  Unit_list* units_;
 };
 
 // Return the name of a DWARF .dwo section.
@@ -828,10 +944,18 @@ Sized_relobj_dwo<size, big_endian>::do_section_contents(
 
 Dwo_file::~Dwo_file()
 {
+  for (unsigned int i = 0; i < this->section_contents_.size(); ++i)
+    if (this->section_contents_[i].is_new)
+      delete[] this->section_contents_[i].contents;
+  if (this->remapped_str_offsets_ != NULL)
+    delete[] this->remapped_str_offsets_;
   if (this->obj_ != NULL)
     delete this->obj_;
   if (this->input_file_ != NULL)
     delete this->input_file_;
+  if (this->file_contents_ != NULL)
+    ::munmap(const_cast<unsigned char*>(this->file_contents_),
+	     this->file_size_);
 }
 
 // Read the input executable file and extract the list of .dwo files
@@ -840,7 +964,7 @@ Dwo_file::~Dwo_file()
 void
 Dwo_file::read_executable(File_list* files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -880,25 +1004,18 @@ Dwo_file::read_executable(File_list* files)
     }
 }
 
-// Read the input file and send its contents to OUTPUT_FILE.
+// Read the input file, check it, and find the units and sections
+// that need to go into the output file.
 
 void
-Dwo_file::read(Dwp_output_file* output_file)
+Dwo_file::read()
 {
-  this->obj_ = this->make_object(output_file);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
-
-  typedef std::vector<unsigned int> Types_list;
-  Types_list debug_types;
-  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
-  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
-    debug_shndx[i] = 0;
-  unsigned int debug_str = 0;
-  unsigned int debug_cu_index = 0;
-  unsigned int debug_tu_index = 0;
+  this->section_contents_.resize(shnum);
 
   // Scan the section table and collect debug sections.
   // (Section index 0 is a dummy section; skip it.)
@@ -918,63 +1035,146 @@ Dwo_file::read(Dwp_output_file* output_file)
       else
 	continue;
       if (strcmp(suffix, "info.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_INFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_INFO] = i;
       else if (strcmp(suffix, "types.dwo") == 0)
-	debug_types.push_back(i);
+	this->debug_types_.push_back(i);
       else if (strcmp(suffix, "abbrev.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_ABBREV] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_ABBREV] = i;
       else if (strcmp(suffix, "line.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LINE] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LINE] = i;
       else if (strcmp(suffix, "loc.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LOC] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LOC] = i;
       else if (strcmp(suffix, "str.dwo") == 0)
-	debug_str = i;
+	this->debug_str_ = i;
       else if (strcmp(suffix, "str_offsets.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_STR_OFFSETS] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_STR_OFFSETS] = i;
       else if (strcmp(suffix, "macinfo.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACINFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACINFO] = i;
       else if (strcmp(suffix, "macro.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACRO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACRO] = i;
       else if (strcmp(suffix, "cu_index") == 0)
-	debug_cu_index = i;
+	this->debug_cu_index_ = i;
       else if (strcmp(suffix, "tu_index") == 0)
-	debug_tu_index = i;
+	this->debug_tu_index_ = i;
+    }
+
+  // Check the input string table, and count the strings in it.
+  section_size_type len;
+  const char* p =
+      reinterpret_cast<const char*>(this->section_contents(this->debug_str_,
+							    &len));
+  const char* pend = p + len;
+  if (pend[-1] != '\0')
+    gold_fatal(_("%s: last entry in string section '%s' "
+		 "is not null terminated"),
+	       this->name_,
+	       this->section_name(this->debug_str_).c_str());
+  for (; p < pend; p += strlen(p) + 1)
+    ++this->str_count_;
+
+  // Get the contents of the related sections, so that compressed
+  // sections are decompressed here rather than while adding them to
+  // the output file.
+  for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
+    {
+      if (this->debug_shndx_[i] == 0)
+	continue;
+      this->section_contents(this->debug_shndx_[i], &len);
+      if (i == elfcpp::DW_SECT_STR_OFFSETS && (len & 3) != 0)
+	gold_fatal(_("%s: .debug_str_offsets.dwo section size "
+		     "not a multiple of 4"),
+		   this->name_);
     }
 
+  // If we found any .dwp index sections, add_to_output will read them.
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
+    {
+      if (this->debug_tu_index_ > 0 && this->debug_types_.size() > 1)
+	gold_fatal(_("%s: .dwp file must have no more than one "
+		     ".debug_types.dwo section"), this->name_);
+      if (this->debug_cu_index_ > 0)
+	this->section_contents(this->debug_cu_index_, &len);
+      if (this->debug_tu_index_ > 0)
+	this->section_contents(this->debug_tu_index_, &len);
+      if (this->debug_shndx_[elfcpp::DW_SECT_INFO] > 0)
+	this->section_contents(this->debug_shndx_[elfcpp::DW_SECT_INFO], &len);
+      if (this->debug_types_.size() == 1)
+	this->section_contents(this->debug_types_[0], &len);
+      return;
+    }
+
+  // If we found no index sections, this is a .dwo file.  Find the
+  // compilation and type units.
+  if (this->debug_shndx_[elfcpp::DW_SECT_INFO] > 0)
+    this->read_units(this->debug_shndx_[elfcpp::DW_SECT_INFO], false,
+		     &this->cus_);
+
+  this->tus_.resize(this->debug_types_.size());
+  for (unsigned int i = 0; i < this->debug_types_.size(); ++i)
+    this->read_units(this->debug_types_[i], true, &this->tus_[i]);
+}
+
+// Find the compilation units or type units in section SHNDX and
+// add them to UNITS.
+
+void
+Dwo_file::read_units(unsigned int shndx, bool is_type_unit, Unit_list* units)
+{
+  if (this->debug_shndx_[elfcpp::DW_SECT_ABBREV] == 0)
+    gold_fatal(_("%s: no .debug_abbrev.dwo section found"), this->name_);
+
+  // Get the section contents, which add_unit_set will use.
+  section_size_type len;
+  this->section_contents(shndx, &len);
+
+  Unit_reader reader(is_type_unit, this->obj_, shndx);
+  reader.read_units(this->debug_shndx_[elfcpp::DW_SECT_ABBREV], units);
+}
+
+// Send the contents of the input file to OUTPUT_FILE.
+
+void
+Dwo_file::add_to_output(Dwp_output_file* output_file)
+{
+  output_file->record_target_info(this->name_, this->machine_, this->size_,
+				  this->big_endian_, this->osabi_,
+				  this->abiversion_);
+
+  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
+  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+    debug_shndx[i] = this->debug_shndx_[i];
+
   // Merge the input string table into the output string table.
-  this->add_strings(output_file, debug_str);
+  this->add_strings(output_file);
 
   // If we found any .dwp index sections, read those and add the section
   // sets to the output file.
-  if (debug_cu_index > 0 || debug_tu_index > 0)
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
     {
-      if (debug_cu_index > 0)
-	this->read_unit_index(debug_cu_index, debug_shndx, output_file, false);
-      if (debug_tu_index > 0)
+      if (this->debug_cu_index_ > 0)
+	this->read_unit_index(this->debug_cu_index_, debug_shndx, output_file,
+			      false);
+      if (this->debug_tu_index_ > 0)
         {
-	  if (debug_types.size() > 1)
-	    gold_fatal(_("%s: .dwp file must have no more than one "
-			 ".debug_types.dwo section"), this->name_);
-          if (debug_types.size() == 1)
-            debug_shndx[elfcpp::DW_SECT_TYPES] = debug_types[0];
+          if (this->debug_types_.size() == 1)
+            debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[0];
           else
             debug_shndx[elfcpp::DW_SECT_TYPES] = 0;
-	  this->read_unit_index(debug_tu_index, debug_shndx, output_file, true);
+	  this->read_unit_index(this->debug_tu_index_, debug_shndx, output_file,
+				true);
 	}
       return;
     }
 
   // If we found no index sections, this is a .dwo file.
   if (debug_shndx[elfcpp::DW_SECT_INFO] > 0)
-    this->add_unit_set(output_file, debug_shndx, false);
+    this->add_unit_set(output_file, debug_shndx, false, this->cus_);
 
   debug_shndx[elfcpp::DW_SECT_INFO] = 0;
-  for (Types_list::const_iterator tp = debug_types.begin();
-       tp != debug_types.end();
-       ++tp)
+  for (unsigned int i = 0; i < this->debug_types_.size(); ++i)
     {
-      debug_shndx[elfcpp::DW_SECT_TYPES] = *tp;
-      this->add_unit_set(output_file, debug_shndx, true);
+      debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[i];
+      this->add_unit_set(output_file, debug_shndx, true, this->tus_[i]);
     }
 }
 
@@ -985,11 +1185,12 @@ Dwo_file::read(Dwp_output_file* output_file)
 bool
 Dwo_file::verify(const File_list& files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
+  this->section_contents_.resize(shnum);
 
   unsigned int debug_cu_index = 0;
 
@@ -1020,27 +1221,42 @@ Dwo_file::verify(const File_list& files)
   return this->verify_dwo_list(debug_cu_index, files);
 }
 
-// Create a Sized_relobj_dwo of the given size and endianness,
-// and record the target info.
+// Map the input file and create a Sized_relobj_dwo of the given size
+// and endianness.
 
 Relobj*
-Dwo_file::make_object(Dwp_output_file* output_file)
+Dwo_file::make_object()
 {
-  // Open the input file.
-  Input_file* input_file = new Input_file(this->name_);
-  this->input_file_ = input_file;
-  Dirsearch dirpath;
-  int index;
-  if (!input_file->open(dirpath, NULL, &index))
+  // Open and map the input file.  We keep the whole file mapped until
+  // the output file has been written, so that section contents can be
+  // written directly from the mapping.  We close the descriptor right
+  // away, so that we don't run out of descriptors when there are many
+  // input files.
+  int descriptor = open_descriptor(-1, this->name_, O_RDONLY);
+  if (descriptor < 0)
     gold_fatal(_("%s: can't open"), this->name_);
-  
+  struct stat s;
+  if (::fstat(descriptor, &s) < 0)
+    gold_fatal(_("%s: fstat failed: %s"), this->name_, strerror(errno));
+  off_t filesize = s.st_size;
+  if (filesize == 0)
+    gold_fatal(_("%s: not an ELF object file"), this->name_);
+  void* p = ::mmap(NULL, filesize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  if (p == MAP_FAILED)
+    gold_fatal(_("%s: mmap failed: %s"), this->name_, strerror(errno));
+  release_descriptor(descriptor, true);
+  this->file_contents_ = static_cast<const unsigned char*>(p);
+  this->file_size_ = filesize;
+
+  Input_file* input_file = new Input_file(NULL, this->name_,
+					  this->file_contents_, filesize);
+  this->input_file_ = input_file;
+
   // Check that it's an ELF file.
-  off_t filesize = input_file->file().filesize();
   int hdrsize = elfcpp::Elf_recognizer::max_header_size;
   if (filesize < hdrsize)
     hdrsize = filesize;
-  const unsigned char* elf_header =
-      input_file->file().get_view(0, 0, hdrsize, true, false);
+  const unsigned char* elf_header = this->file_contents_;
   if (!elfcpp::Elf_recognizer::is_elf_file(elf_header, hdrsize))
     gold_fatal(_("%s: not an ELF object file"), this->name_);
   
@@ -1058,15 +1274,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_32_BIG
-	return this->sized_make_object<32, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<32, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_32_LITTLE
-	return this->sized_make_object<32, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<32, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1075,15 +1289,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_64_BIG
-	return this->sized_make_object<64, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<64, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_64_LITTLE
-	return this->sized_make_object<64, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<64, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1092,26 +1304,38 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     gold_unreachable();
 }
 
-// Function template to create a Sized_relobj_dwo and record the target info.
+// Function template to create a Sized_relobj_dwo and save the target info.
 // P is a pointer to the ELF header in memory.
 
 template <int size, bool big_endian>
 Relobj*
-Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file,
-			    Dwp_output_file* output_file)
+Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file)
 {
   elfcpp::Ehdr<size, big_endian> ehdr(p);
   Sized_relobj_dwo<size, big_endian>* obj =
       new Sized_relobj_dwo<size, big_endian>(this->name_, input_file, ehdr);
   obj->setup();
-  if (output_file != NULL)
-    output_file->record_target_info(
-	this->name_, ehdr.get_e_machine(), size, big_endian,
-	ehdr.get_e_ident()[elfcpp::EI_OSABI],
-	ehdr.get_e_ident()[elfcpp::EI_ABIVERSION]);
+  this->machine_ = ehdr.get_e_machine();
+  this->size_ = size;
+  this->big_endian_ = big_endian;
+  this->osabi_ = ehdr.get_e_ident()[elfcpp::EI_OSABI];
+  this->abiversion_ = ehdr.get_e_ident()[elfcpp::EI_ABIVERSION];
   return obj;
 }
 
+// Return a view of the contents of a section, decompressed if necessary.
+
+const unsigned char*
+Dwo_file::section_contents(unsigned int shndx, section_size_type* plen)
+{
+  Section_contents& sc(this->section_contents_[shndx]);
+  if (sc.contents == NULL)
+    sc.contents = this->obj_->decompressed_section_contents(shndx, &sc.size,
+							    &sc.is_new);
+  *plen = sc.size;
+  return sc.contents;
+}
+
 // Read the .debug_cu_index or .debug_tu_index section of a .dwp file,
 // and process the CU or TU sets.
 
@@ -1142,9 +1366,7 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
   gold_assert(shndx > 0);
 
   section_size_type index_len;
-  bool index_is_new;
-  const unsigned char* contents =
-      this->section_contents(shndx, &index_len, &index_is_new);
+  const unsigned char* contents = this->section_contents(shndx, &index_len);
 
   unsigned int version =
       elfcpp::Swap_unaligned<32, big_endian>::readval(contents);
@@ -1192,10 +1414,13 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
     }
 
   // Get the contents of the .debug_info.dwo or .debug_types.dwo section.
+  // The output file writes the .debug_info.dwo contributions right away,
+  // but keeps those of .debug_types.dwo until it is finalized.
   section_size_type info_len;
-  bool info_is_new;
   const unsigned char* info_contents =
-      this->section_contents(info_shndx, &info_len, &info_is_new);
+      this->section_contents(info_shndx, &info_len);
+  if (info_sect != elfcpp::DW_SECT_INFO)
+    this->section_contents_[info_shndx].in_output = true;
 
   // Loop over the slots of the hash table.
   for (unsigned int i = 0; i < nslots; ++i)
@@ -1204,7 +1429,7 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
           elfcpp::Swap_unaligned<64, big_endian>::readval(phash);
       unsigned int index =
 	  elfcpp::Swap_unaligned<32, big_endian>::readval(pindex);
-      if (index != 0 && (!is_tu_index || !output_file->lookup_tu(signature)))
+      if (index != 0)
 	{
 	  Unit_set* unit_set = new Unit_set();
 	  unit_set->signature = signature;
@@ -1236,32 +1461,23 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
 	      info_contents + unit_set->sections[info_sect].offset;
 	  section_size_type unit_length = unit_set->sections[info_sect].size;
 
-	  // Dwp_output_file::add_contribution writes the .debug_info.dwo
-	  // section directly to the output file, so we only need to
-	  // duplicate contributions for .debug_types.dwo section.
-	  if (is_tu_index)
+	  if (is_tu_index && output_file->lookup_tu(signature, unit_length))
+	    delete unit_set;
+	  else
 	    {
-	      unsigned char *copy = new unsigned char[unit_length];
-	      memcpy(copy, unit_start, unit_length);
-	      unit_start = copy;
+	      section_offset_type off =
+		  output_file->add_contribution(info_sect, unit_start,
+						unit_length, 1);
+	      unit_set->sections[info_sect].offset = off;
+	      if (is_tu_index)
+		output_file->add_tu_set(unit_set);
+	      else
+		output_file->add_cu_set(unit_set);
 	    }
-	  section_offset_type off =
-	      output_file->add_contribution(info_sect, unit_start,
-					    unit_length, 1);
-	  unit_set->sections[info_sect].offset = off;
-	  if (is_tu_index)
-	    output_file->add_tu_set(unit_set);
-	  else
-	    output_file->add_cu_set(unit_set);
 	}
       phash += sizeof(uint64_t);
       pindex += sizeof(uint32_t);
     }
-
-  if (index_is_new)
-    delete[] contents;
-  if (info_is_new)
-    delete[] info_contents;
 }
 
 // Verify the .debug_cu_index section of a .dwp file, comparing it
@@ -1284,9 +1500,7 @@ Dwo_file::sized_verify_dwo_list(unsigned int shndx, const File_list& files)
   gold_assert(shndx > 0);
 
   section_size_type index_len;
-  bool index_is_new;
-  const unsigned char* contents =
-      this->section_contents(shndx, &index_len, &index_is_new);
+  const unsigned char* contents = this->section_contents(shndx, &index_len);
 
   unsigned int version =
       elfcpp::Swap_unaligned<32, big_endian>::readval(contents);
@@ -1354,35 +1568,22 @@ Dwo_file::sized_verify_dwo_list(unsigned int shndx, const File_list& files)
 
   gold_info(_("Found %d missing .dwo files"), nmissing);
 
-  if (index_is_new)
-    delete[] contents;
-
   return nmissing == 0;
 }
 
 // Merge the input string table section into the output file.
 
 void
-Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
+Dwo_file::add_strings(Dwp_output_file* output_file)
 {
+  // read() has already checked that the last string is null terminated,
+  // and counted the strings.
   section_size_type len;
-  bool is_new;
-  const unsigned char* pdata = this->section_contents(debug_str, &len, &is_new);
+  const unsigned char* pdata = this->section_contents(this->debug_str_, &len);
   const char* p = reinterpret_cast<const char*>(pdata);
   const char* pend = p + len;
 
-  // Check that the last string is null terminated.
-  if (pend[-1] != '\0')
-    gold_fatal(_("%s: last entry in string section '%s' "
-		 "is not null terminated"),
-	       this->name_,
-	       this->section_name(debug_str).c_str());
-
-  // Count the number of strings in the section, and size the map.
-  size_t count = 0;
-  for (const char* pt = p; pt < pend; pt += strlen(pt) + 1)
-    ++count;
-  this->str_offset_map_.reserve(count + 1);
+  this->str_offset_map_.reserve(this->str_count_ + 1);
 
   // Add the strings to the output string table, and record the new offsets
   // in the map.
@@ -1398,14 +1599,13 @@ Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
     }
   new_offset = 0;
   this->str_offset_map_.push_back(std::make_pair(i, new_offset));
-  if (is_new)
-    delete[] pdata;
 }
 
 // Copy a section from the input file to the output file.
 // Return the offset and length of this input section's contribution
-// in the output section.  If copying .debug_str_offsets.dwo, remap
-// the string offsets for the output string table.
+// in the output section.  If copying .debug_str_offsets.dwo, set up a
+// buffer for remap_str_offsets to fill with the string offsets for
+// the output string table.
 
 Section_bounds
 Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
@@ -1416,30 +1616,24 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
   if (this->sect_offsets_[shndx].size > 0)
     return this->sect_offsets_[shndx];
 
-  // Get the section contents. Upon return, if IS_NEW is true, the memory
-  // has been allocated via new; if false, the memory is part of the mapped
-  // input file, and we will need to duplicate it so that it will persist
-  // after we close the input file.
+  // Get the section contents.  These stay valid until the Dwo_file is
+  // deleted, after the output file has been written, so we don't need
+  // to duplicate them.
   section_size_type len;
-  bool is_new;
-  const unsigned char* contents = this->section_contents(shndx, &len, &is_new);
+  const unsigned char* contents = this->section_contents(shndx, &len);
 
-  if (section_id == elfcpp::DW_SECT_STR_OFFSETS)
+  if (section_id == elfcpp::DW_SECT_STR_OFFSETS && len > 0)
     {
-      const unsigned char* remapped = this->remap_str_offsets(contents, len);
-      if (is_new)
-	delete[] contents;
-      contents = remapped;
-    }
-  else if (!is_new)
-    {
-      unsigned char* copy = new unsigned char[len];
-      memcpy(copy, contents, len);
-      contents = copy;
+      gold_assert(this->remapped_str_offsets_ == NULL);
+      this->str_offsets_ = contents;
+      this->str_offsets_size_ = len;
+      this->remapped_str_offsets_ = new unsigned char[len];
+      contents = this->remapped_str_offsets_;
     }
+  else
+    this->section_contents_[shndx].in_output = true;
 
   // Add the contents of the input section to the output section.
-  // The output file takes ownership of the memory pointed to by CONTENTS.
   section_offset_type off = output_file->add_contribution(section_id, contents,
 							  len, 1);
 
@@ -1450,29 +1644,27 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
   return bounds;
 }
 
-// Remap the 
-const unsigned char*
-Dwo_file::remap_str_offsets(const unsigned char* contents,
-			    section_size_type len)
+// Remap the string offsets in the .debug_str_offsets.dwo section.
+
+void
+Dwo_file::remap_str_offsets()
 {
-  if ((len & 3) != 0)
-    gold_fatal(_("%s: .debug_str_offsets.dwo section size not a multiple of 4"),
-	       this->name_);
+  if (this->remapped_str_offsets_ == NULL)
+    return;
 
   if (this->obj_->is_big_endian())
-    return this->sized_remap_str_offsets<true>(contents, len);
+    this->sized_remap_str_offsets<true>();
   else
-    return this->sized_remap_str_offsets<false>(contents, len);
+    this->sized_remap_str_offsets<false>();
 }
 
 template <bool big_endian>
-const unsigned char*
-Dwo_file::sized_remap_str_offsets(const unsigned char* contents,
-				  section_size_type len)
+void
+Dwo_file::sized_remap_str_offsets()
 {
-  unsigned char* remapped = new unsigned char[len];
-  const unsigned char* p = contents;
-  unsigned char* q = remapped;
+  section_size_type len = this->str_offsets_size_;
+  const unsigned char* p = this->str_offsets_;
+  unsigned char* q = this->remapped_str_offsets_;
   while (len > 0)
     {
       unsigned int val = elfcpp::Swap_unaligned<32, big_endian>::readval(p);
@@ -1482,7 +1674,6 @@ Dwo_file::sized_remap_str_offsets(const unsigned char* contents,
       p += 4;
       q += 4;
     }
-  return remapped;
 }
 
 unsigned int
@@ -1507,12 +1698,35 @@ Dwo_file::remap_str_offset(section_offset_type val)
   return p->second + (val - p->first);
 }
 
+// Free the decompressed section contents that the output file does
+// not refer to, such as those of the string table and of the
+// .debug_info.dwo section, which has already been written.  Also free
+// the string offset map, which is no longer needed.
+
+void
+Dwo_file::release_contents()
+{
+  for (unsigned int i = 0; i < this->section_contents_.size(); ++i)
+    {
+      Section_contents& sc(this->section_contents_[i]);
+      if (sc.is_new && !sc.in_output)
+	{
+	  delete[] sc.contents;
+	  sc.contents = NULL;
+	  sc.size = 0;
+	  sc.is_new = false;
+	}
+    }
+  this->str_offsets_ = NULL;
+  Str_offset_map().swap(this->str_offset_map_);
+}
+
 // Add a set of .debug_info.dwo or .debug_types.dwo and related sections
 // to OUTPUT_FILE.
 
 void
 Dwo_file::add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
-		       bool is_debug_types)
+		       bool is_debug_types, const Unit_list& units)
 {
   unsigned int shndx = (is_debug_types
 			? debug_shndx[elfcpp::DW_SECT_TYPES]
@@ -1520,9 +1734,6 @@ Dwo_file::add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
 
   gold_assert(shndx != 0);
 
-  if (debug_shndx[elfcpp::DW_SECT_ABBREV] == 0)
-    gold_fatal(_("%s: no .debug_abbrev.dwo section found"), this->name_);
-
   // Copy the related sections and track the section offsets and sizes.
   Section_bounds sections[elfcpp::DW_SECT_MAX + 1];
   for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
@@ -1532,11 +1743,38 @@ Dwo_file::add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
 					 static_cast<elfcpp::DW_SECT>(i));
     }
 
-  // Parse the .debug_info or .debug_types section and add each compilation
-  // or type unit to the output file, along with the contributions to the
-  // related sections.
-  Unit_reader reader(is_debug_types, this->obj_, shndx);
-  reader.add_units(output_file, debug_shndx[elfcpp::DW_SECT_ABBREV], sections);
+  // Add each compilation or type unit found by read() to the output
+  // file, along with the contributions to the related sections.  We
+  // skip type units whose signature we have already seen.
+  elfcpp::DW_SECT section_id = (is_debug_types
+				? elfcpp::DW_SECT_TYPES
+				: elfcpp::DW_SECT_INFO);
+  section_size_type len;
+  const unsigned char* contents = this->section_contents(shndx, &len);
+  if (is_debug_types)
+    this->section_contents_[shndx].in_output = true;
+  for (Unit_list::const_iterator p = units.begin(); p != units.end(); ++p)
+    {
+      if (is_debug_types && output_file->lookup_tu(p->signature, p->size))
+	continue;
+
+      Unit_set* unit_set = new Unit_set();
+      unit_set->signature = p->signature;
+      for (unsigned int i = elfcpp::DW_SECT_ABBREV;
+	   i <= elfcpp::DW_SECT_MAX;
+	   ++i)
+	unit_set->sections[i] = sections[i];
+
+      section_offset_type off =
+	  output_file->add_contribution(section_id, contents + p->offset,
+					p->size, 1);
+      Section_bounds bounds(off, p->size);
+      unit_set->sections[section_id] = bounds;
+      if (is_debug_types)
+	output_file->add_tu_set(unit_set);
+      else
+	output_file->add_cu_set(unit_set);
+    }
 }
 
 // Class Dwp_output_file.
@@ -1614,9 +1852,10 @@ Dwp_output_file::add_output_section(const char* section_name, int align)
 // Add a contribution to a section in the output file, and return the offset
 // of the contribution within the output section.  The .debug_info.dwo section
 // is expected to be the largest one, so we will write the contents of this
-// section directly to the output file as we receive contributions, allowing
-// us to free that memory as soon as possible. We will save the remaining
-// contributions until we finalize the layout of the output file.
+// section directly to the output file as we receive contributions.  We will
+// save the remaining contributions until we finalize the layout of the output
+// file; their contents belong to the input files, which stay mapped until
+// then.
 
 section_offset_type
 Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
@@ -1645,7 +1884,6 @@ Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
   if (section_id == elfcpp::DW_SECT_INFO)
     {
       // Write the .debug_info.dwo section directly.
-      // We do not need to free the memory in this case.
       off_t file_offset = this->next_file_offset_;
       gold_assert(this->size_ > 0 && file_offset > 0);
 
@@ -1695,6 +1933,7 @@ Dwp_output_file::add_cu_set(Unit_set* cu_set)
 {
   uint64_t dwo_id = cu_set->signature;
   unsigned int slot;
+  ++this->cu_count_;
   if (!this->cu_index_.find_or_add(dwo_id, &slot))
     this->cu_index_.enter_set(slot, cu_set);
   else
@@ -1703,11 +1942,19 @@ Dwp_output_file::add_cu_set(Unit_set* cu_set)
 }
 
 // Lookup a type signature and return TRUE if we have already seen it.
+// In that case the caller drops the type unit, and we count TU_SIZE
+// bytes as deduplicated.
+
 bool
-Dwp_output_file::lookup_tu(uint64_t type_sig)
+Dwp_output_file::lookup_tu(uint64_t type_sig, section_size_type tu_size)
 {
   this->last_type_sig_ = type_sig;
-  return this->tu_index_.find_or_add(type_sig, &this->last_tu_slot_);
+  ++this->tu_count_;
+  if (!this->tu_index_.find_or_add(type_sig, &this->last_tu_slot_))
+    return false;
+  ++this->duplicate_tu_count_;
+  this->duplicate_tu_bytes_ += tu_size;
+  return true;
 }
 
 // Add a set of .debug_types and related sections to the output file.
@@ -1927,6 +2174,21 @@ Dwp_output_file::finalize()
   this->fd_ = NULL;
 }
 
+// Print statistics about the units we have seen.
+
+void
+Dwp_output_file::print_stats() const
+{
+  fprintf(stderr, _("%s: compilation units: %u\n"), program_name,
+	  this->cu_count_);
+  fprintf(stderr, _("%s: type units: %u\n"), program_name, this->tu_count_);
+  fprintf(stderr, _("%s: duplicate type units: %u\n"), program_name,
+	  this->duplicate_tu_count_);
+  fprintf(stderr, _("%s: bytes deduplicated by type signature: %llu\n"),
+	  program_name,
+	  static_cast<unsigned long long>(this->duplicate_tu_bytes_));
+}
+
 // Write the contributions to an output section.
 
 void
@@ -1938,7 +2200,6 @@ Dwp_output_file::write_contributions(const Section& sect)
       ::fseek(this->fd_, sect.offset + c.output_offset, SEEK_SET);
       if (::fwrite(c.contents, 1, c.size, this->fd_) < c.size)
 	gold_fatal(_("%s: error writing section '%s'"), this->name_, sect.name);
-      delete[] c.contents;
     }
 }
 
@@ -2220,15 +2481,12 @@ Dwo_name_info_reader::visit_compilation_unit(off_t, off_t, Dwarf_die* die)
 
 // Class Unit_reader.
 
-// Read the CUs or TUs and add them to the output file.
+// Read the CUs or TUs and add their locations to UNITS.
 
 void
-Unit_reader::add_units(Dwp_output_file* output_file,
-		       unsigned int debug_abbrev,
-		       Section_bounds* sections)
+Unit_reader::read_units(unsigned int debug_abbrev, Unit_list* units)
 {
-  this->output_file_ = output_file;
-  this->sections_ = sections;
+  this->units_ = units;
   this->set_abbrev_shndx(debug_abbrev);
   this->parse();
 }
@@ -2241,21 +2499,9 @@ Unit_reader::visit_compilation_unit(off_t, off_t cu_length, Dwarf_die* die)
   if (cu_length == 0)
     return;
 
-  Unit_set* unit_set = new Unit_set();
-  unit_set->signature = die->uint_attribute(elfcpp::DW_AT_GNU_dwo_id);
-  for (unsigned int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
-    unit_set->sections[i] = this->sections_[i];
-
-  // Dwp_output_file::add_contribution writes the .debug_info.dwo section
-  // directly to the output file, so we do not need to duplicate the
-  // section contents, and add_contribution does not need to free the memory.
-  section_offset_type off =
-      this->output_file_->add_contribution(elfcpp::DW_SECT_INFO,
-					   this->buffer_at_offset(0),
-					   cu_length, 1);
-  Section_bounds bounds(off, cu_length);
-  unit_set->sections[elfcpp::DW_SECT_INFO] = bounds;
-  this->output_file_->add_cu_set(unit_set);
+  uint64_t dwo_id = die->uint_attribute(elfcpp::DW_AT_GNU_dwo_id);
+  this->units_->push_back(Unit_location(dwo_id, this->cu_offset(),
+					cu_length));
 }
 
 // Visit a type unit.
@@ -2266,22 +2512,168 @@ Unit_reader::visit_type_unit(off_t, off_t tu_length, off_t,
 {
   if (tu_length == 0)
     return;
-  if (this->output_file_->lookup_tu(signature))
-    return;
 
-  Unit_set* unit_set = new Unit_set();
-  unit_set->signature = signature;
-  for (unsigned int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
-    unit_set->sections[i] = this->sections_[i];
-
-  unsigned char* contents = new unsigned char[tu_length];
-  memcpy(contents, this->buffer_at_offset(0), tu_length);
-  section_offset_type off =
-      this->output_file_->add_contribution(elfcpp::DW_SECT_TYPES, contents,
-					   tu_length, 1);
-  Section_bounds bounds(off, tu_length);
-  unit_set->sections[elfcpp::DW_SECT_TYPES] = bounds;
-  this->output_file_->add_tu_set(unit_set);
+  this->units_->push_back(Unit_location(signature, this->cu_offset(),
+					tu_length));
+}
+
+// Class Dwo_read_task.
+
+// This task reads one input file.  If THIS_BLOCKER_ is not NULL, it
+// waits for it, so that we only read a few files ahead of the one
+// being added to the output file.  The Dwo_add_task for the file
+// waits for NEXT_BLOCKER_.
+
+class Dwo_read_task : public Task
+{
+ public:
+  Dwo_read_task(Dwo_file* dwo_file, Task_token* this_blocker,
+		Task_token* next_blocker)
+    : dwo_file_(dwo_file), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Dwo_read_task()
+  {
+    if (this->this_blocker_ != NULL)
+      delete this->this_blocker_;
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->dwo_file_->read(); }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_read_task ") + this->dwo_file_->name(); }
+
+ private:
+  Dwo_file* dwo_file_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Class Dwo_add_task.
+
+// This task adds the contents of one input file to the output file.
+// It waits until the file has been read (READ_BLOCKER_), and until
+// the previous input file has been added (THIS_BLOCKER_), so that
+// the input files are added in order.  When it is done it releases
+// NEXT_BLOCKER_, for the next input file, and READ_AHEAD_BLOCKER_, for
+// the Dwo_read_task of a later input file.  It then queues a task to
+// remap the string offsets of the file, which may run at the same time
+// as the tasks that add the following input files.
+
+class Dwo_add_task : public Task
+{
+ public:
+  Dwo_add_task(Dwo_file* dwo_file, Dwp_output_file* output_file,
+	       bool verbose, Task_token* read_blocker,
+	       Task_token* this_blocker, Task_token* next_blocker,
+	       Task_token* read_ahead_blocker)
+    : dwo_file_(dwo_file), output_file_(output_file), verbose_(verbose),
+      read_blocker_(read_blocker), this_blocker_(this_blocker),
+      next_blocker_(next_blocker), read_ahead_blocker_(read_ahead_blocker)
+  { }
+
+  ~Dwo_add_task()
+  {
+    delete this->read_blocker_;
+    if (this->this_blocker_ != NULL)
+      delete this->this_blocker_;
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->read_blocker_->is_blocked())
+      return this->read_blocker_;
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    if (this->next_blocker_ != NULL)
+      tl->add(this, this->next_blocker_);
+    if (this->read_ahead_blocker_ != NULL)
+      tl->add(this, this->read_ahead_blocker_);
+  }
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_add_task ") + this->dwo_file_->name(); }
+
+ private:
+  Dwo_file* dwo_file_;
+  Dwp_output_file* output_file_;
+  bool verbose_;
+  Task_token* read_blocker_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+  Task_token* read_ahead_blocker_;
+};
+
+// Class Dwo_remap_task.
+
+// This task remaps the string offsets of one input file for the
+// output string table, and then frees the parts of the file that the
+// output file does not need.
+
+class Dwo_remap_task : public Task
+{
+ public:
+  Dwo_remap_task(Dwo_file* dwo_file)
+    : dwo_file_(dwo_file)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*)
+  {
+    this->dwo_file_->remap_str_offsets();
+    this->dwo_file_->release_contents();
+  }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_remap_task ") + this->dwo_file_->name(); }
+
+ private:
+  Dwo_file* dwo_file_;
+};
+
+void
+Dwo_add_task::run(Workqueue* workqueue)
+{
+  if (this->verbose_)
+    fprintf(stderr, "%s\n", this->dwo_file_->name());
+  this->dwo_file_->add_to_output(this->output_file_);
+  workqueue->queue_soon(new Dwo_remap_task(this->dwo_file_));
 }
 
 }; // End namespace gold
@@ -2292,6 +2684,9 @@ using namespace gold;
 
 enum Dwp_options {
   VERIFY_ONLY = 0x101,
+  STATS,
+  THREADS,
+  THREAD_COUNT
 };
 
 struct option dwp_options[] =
@@ -2299,6 +2694,9 @@ struct option dwp_options[] =
     { "exec", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
     { "output", required_argument, NULL, 'o' },
+    { "stats", no_argument, NULL, STATS },
+    { "threads", no_argument, NULL, THREADS },
+    { "thread-count", required_argument, NULL, THREAD_COUNT },
     { "verbose", no_argument, NULL, 'v' },
     { "verify-only", no_argument, NULL, VERIFY_ONLY },
     { "version", no_argument, NULL, 'V' },
@@ -2315,6 +2713,11 @@ usage(FILE* fd, int exit_status)
   fprintf(fd, _("  -e EXE, --exec EXE       Get list of dwo files from EXE"
 					   " (defaults output to EXE.dwp)\n"));
   fprintf(fd, _("  -o FILE, --output FILE   Set output dwp file name\n"));
+  fprintf(fd, _("  --stats                  Print statistics about the"
+					   " output file\n"));
+  fprintf(fd, _("  --threads                Read input files in"
+					   " parallel\n"));
+  fprintf(fd, _("  --thread-count COUNT     Number of threads to use\n"));
   fprintf(fd, _("  -v, --verbose            Verbose output\n"));
   fprintf(fd, _("  --verify-only            Verify output file against"
 					   " exec file\n"));
@@ -2363,21 +2766,18 @@ main(int argc, char** argv)
   Errors errors(program_name);
   set_parameters_errors(&errors);
 
-  // Initialize gold's global options.  We don't use these in
-  // this program, but they need to be initialized so that
-  // functions we call from libgold work properly.
-  General_options options;
-  set_parameters_options(&options);
-
   // In libiberty; expands @filename to the args in "filename".
   expandargv(&argc, &argv);
 
-  // Collect file names and options.
+  // Collect file names and options.  The options for threads are
+  // passed on to gold's options parser.
   File_list files;
   std::string output_filename;
   const char* exe_filename = NULL;
   bool verbose = false;
   bool verify_only = false;
+  bool stats = false;
+  std::vector<std::string> gold_args;
   int c;
   while ((c = getopt_long(argc, argv, "e:ho:vV", dwp_options, NULL)) != -1)
     {
@@ -2397,6 +2797,15 @@ main(int argc, char** argv)
 	  case VERIFY_ONLY:
 	    verify_only = true;
 	    break;
+	  case STATS:
+	    stats = true;
+	    break;
+	  case THREADS:
+	    gold_args.push_back("--threads");
+	    break;
+	  case THREAD_COUNT:
+	    gold_args.push_back(std::string("--thread-count=") + optarg);
+	    break;
 	  case 'V':
 	    print_version();
 	  case '?':
@@ -2405,6 +2814,22 @@ main(int argc, char** argv)
 	}
     }
 
+  // Initialize gold's global options.  We only use them to set up
+  // threads, but they need to be initialized so that functions we
+  // call from libgold work properly.
+  std::vector<const char*> gold_argv;
+  for (size_t i = 0; i < gold_args.size(); ++i)
+    gold_argv.push_back(gold_args[i].c_str());
+  Command_line command_line;
+  command_line.process(gold_argv.size(),
+		       gold_argv.empty() ? NULL : &gold_argv[0]);
+  set_parameters_options(&command_line.options());
+  const General_options& options(command_line.options());
+
+  Timer timer;
+  if (stats)
+    timer.start();
+
   if (output_filename.empty())
     {
       if (exe_filename == NULL)
@@ -2436,16 +2861,81 @@ main(int argc, char** argv)
       return ok ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
-  // Process each file, adding its contents to the output file.
+  // Process each file, adding its contents to the output file.  The
+  // files are read, and their string offsets remapped, in parallel,
+  // but they are added to the output file one at a time, in order.
+  // The input files stay mapped until the output file is written, but
+  // we free the decompressed sections which are not needed once a file
+  // has been added.  To bound the memory used for files which have
+  // been read but not yet added, the Dwo_read_task for file I waits
+  // until file I - THREAD_COUNT has been added.
   Dwp_output_file output_file(output_filename.c_str());
-  for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+  Workqueue workqueue(options);
+  int thread_count = options.thread_count();
+  if (thread_count == 0)
+    {
+      // Default to one thread for each processor.
+#ifdef _SC_NPROCESSORS_ONLN
+      thread_count = ::sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+      if (thread_count <= 0)
+	thread_count = 1;
+    }
+  workqueue.set_thread_count(thread_count);
+
+  std::vector<Dwo_file*> dwo_files;
+  dwo_files.reserve(files.size());
+  std::vector<Task_token*> read_ahead_blockers(files.size(), NULL);
+  Task_token* this_blocker = NULL;
+  for (size_t i = 0; i < files.size(); ++i)
     {
-      if (verbose)
-	fprintf(stderr, "%s\n", f->dwo_name.c_str());
-      Dwo_file dwo_file(f->dwo_name.c_str());
-      dwo_file.read(&output_file);
+      Dwo_file* dwo_file = new Dwo_file(files[i].dwo_name.c_str());
+      dwo_files.push_back(dwo_file);
+
+      Task_token* read_blocker = new Task_token(true);
+      read_blocker->add_blocker();
+      workqueue.queue(new Dwo_read_task(dwo_file, read_ahead_blockers[i],
+					read_blocker));
+
+      Task_token* next_blocker = NULL;
+      if (i + 1 < files.size())
+	{
+	  next_blocker = new Task_token(true);
+	  next_blocker->add_blocker();
+	}
+      Task_token* read_ahead_blocker = NULL;
+      if (i + thread_count < files.size())
+	{
+	  read_ahead_blocker = new Task_token(true);
+	  read_ahead_blocker->add_blocker();
+	  read_ahead_blockers[i + thread_count] = read_ahead_blocker;
+	}
+      workqueue.queue(new Dwo_add_task(dwo_file, &output_file, verbose,
+				       read_blocker, this_blocker,
+				       next_blocker, read_ahead_blocker));
+      this_blocker = next_blocker;
     }
+
+  workqueue.process(0);
   output_file.finalize();
 
+  for (size_t i = 0; i < dwo_files.size(); ++i)
+    delete dwo_files[i];
+
+  if (stats)
+    {
+      Timer::TimeStats elapsed = timer.get_elapsed_time();
+      fprintf(stderr,
+	      _("%s: total run time: " \
+		"(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
+	      program_name,
+	      elapsed.user / 1000, (elapsed.user % 1000) * 1000,
+	      elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
+	      elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
+      fprintf(stderr, _("%s: input files: %u\n"), program_name,
+	      static_cast<unsigned int>(files.size()));
+      output_file.print_stats();
+    }
+
   return EXIT_SUCCESS;
 }
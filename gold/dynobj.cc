@@ -1546,6 +1546,40 @@ Versions::record_version(const Symbol_table* symtab,
     }
 }
 
+// Record a reference to version NAME of the dynamic object which
+// defines it.  A dynamic object defines an absolute symbol with the
+// same name as each of its versions.
+
+void
+Versions::record_version_need(const Symbol_table* symtab,
+			      Stringpool* dynpool, const char* name)
+{
+  gold_assert(!this->is_finalized_);
+
+  Dynobj* dynobj = Versions::version_need_dynobj(symtab, name);
+  if (dynobj == NULL)
+    return;
+
+  Stringpool::Key version_key;
+  const char* version = dynpool->add(name, false, &version_key);
+  this->add_need(dynpool, dynobj->soname(), version, version_key);
+}
+
+// Return the needed dynamic object which defines version NAME.
+
+Dynobj*
+Versions::version_need_dynobj(const Symbol_table* symtab, const char* name)
+{
+  const Symbol* sym = symtab->lookup(name);
+  if (sym == NULL || !sym->is_from_dynobj())
+    return NULL;
+
+  Dynobj* dynobj = static_cast<Dynobj*>(sym->object());
+  if (!dynobj->is_needed() && dynobj->as_needed())
+    return NULL;
+  return dynobj;
+}
+
 // We've found a symbol SYM defined in version VERSION.
 
 void
@@ -569,6 +569,18 @@ class Versions
   void
   record_version(const Symbol_table* symtab, Stringpool*, const Symbol* sym);
 
+  // Record a reference to version NAME of the dynamic object which
+  // defines the version, even though no symbol uses it.  This does
+  // nothing if no needed dynamic object defines NAME.
+  void
+  record_version_need(const Symbol_table* symtab, Stringpool*,
+		      const char* name);
+
+  // Return the needed dynamic object which defines version NAME, or
+  // NULL if there is none.
+  static Dynobj*
+  version_need_dynobj(const Symbol_table* symtab, const char* name);
+
   // Set the version indexes.  DYNSYM_INDEX is the index we should use
   // for the next dynamic symbol.  We add new dynamic symbols to SYMS
   // and return an updated DYNSYM_INDEX.
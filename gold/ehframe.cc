@@ -84,7 +84,8 @@ Eh_frame_hdr::Eh_frame_hdr(Output_section* eh_frame_section,
     eh_frame_section_(eh_frame_section),
     eh_frame_data_(eh_frame_data),
     fde_offsets_(),
-    any_unrecognized_eh_frame_sections_(false)
+    any_unrecognized_eh_frame_sections_(false),
+    parallel_write_count_(0)
 {
 }
 
@@ -177,36 +178,37 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
       elfcpp::Swap<32, big_endian>::writeval(oview + 8,
 					     this->fde_offsets_.size());
 
+      gold_assert(12 + 8 * static_cast<off_t>(this->fde_offsets_.size())
+		  == oview_size);
+
       // We have the offsets of the FDEs in the .eh_frame section.  We
       // couldn't easily get the PC values before, as they depend on
       // relocations which are, of course, target specific.  This code
       // is run after all those relocations have been applied to the
       // output file.  Here we read the output file again to find the
-      // PC values.  Then we sort the list and write it out.
-
-      Fde_addresses<size> fde_addresses(this->fde_offsets_.size());
-      this->get_fde_addresses<size, big_endian>(of, &this->fde_offsets_,
-						&fde_addresses);
-
-      std::sort(fde_addresses.begin(), fde_addresses.end(),
-		Fde_address_compare<size>());
-
-      typename elfcpp::Elf_types<size>::Elf_Addr output_address;
-      output_address = this->address();
+      // PC values.  Then we sort the list and write it out.  If we
+      // are doing this in parallel, the tasks queued by
+      // queue_write_tasks do it instead.
 
-      unsigned char* pfde = oview + 12;
-      for (typename Fde_addresses<size>::iterator p = fde_addresses.begin();
-	   p != fde_addresses.end();
-	   ++p)
+      if (this->parallel_write_count_ == 0)
 	{
-	  elfcpp::Swap<32, big_endian>::writeval(pfde,
-						 p->first - output_address);
-	  elfcpp::Swap<32, big_endian>::writeval(pfde + 4,
-						 p->second - output_address);
-	  pfde += 8;
+	  typename Fde_addresses<size>::Fde_address_list
+	    fde_addresses(this->fde_offsets_.size());
+	  this->get_fde_addresses<size, big_endian>(of, 0,
+						    this->fde_offsets_.size(),
+						    &fde_addresses[0]);
+
+	  std::sort(fde_addresses.begin(), fde_addresses.end(),
+		    Fde_address_compare<size>());
+
+	  Write_fde_addresses<size, big_endian> write(oview + 12,
+						      this->address());
+	  for (typename Fde_addresses<size>::Fde_address_list::const_iterator
+		 p = fde_addresses.begin();
+	       p != fde_addresses.end();
+	       ++p)
+	    write(p);
 	}
-
-      gold_assert(pfde - oview == oview_size);
     }
 
   of->write_output_view(off, oview_size, oview);
@@ -290,17 +292,18 @@ Eh_frame_hdr::get_fde_pc(
   return pc;
 }
 
-// Given an array of FDE offsets in the .eh_frame section, return an
-// array of offsets from the exception frame header to the FDE's
-// output PC and to the output address of the FDE itself.  We get the
-// FDE's PC by actually looking in the .eh_frame section we just wrote
-// to the output file.
+// Given the FDE offsets from START to END in the .eh_frame section,
+// store the output address of each FDE's PC and of the FDE itself in
+// FDE_ADDRESSES.  We get the FDE's PC by actually looking in the
+// .eh_frame section we just wrote to the output file.
 
 template<int size, bool big_endian>
 void
-Eh_frame_hdr::get_fde_addresses(Output_file* of,
-				const Fde_offsets* fde_offsets,
-				Fde_addresses<size>* fde_addresses)
+Eh_frame_hdr::get_fde_addresses(
+    Output_file* of,
+    size_t start,
+    size_t end,
+    typename Fde_addresses<size>::Fde_address* fde_addresses)
 {
   typename elfcpp::Elf_types<size>::Elf_Addr eh_frame_address;
   eh_frame_address = this->eh_frame_section_->address();
@@ -309,20 +312,142 @@ Eh_frame_hdr::get_fde_addresses(Output_file* of,
   const unsigned char* eh_frame_contents = of->get_input_view(eh_frame_offset,
 							      eh_frame_size);
 
-  for (Fde_offsets::const_iterator p = fde_offsets->begin();
-       p != fde_offsets->end();
-       ++p)
+  for (size_t i = start; i < end; ++i, ++fde_addresses)
     {
+      const Fde_offset& fde(this->fde_offsets_[i]);
       typename elfcpp::Elf_types<size>::Elf_Addr fde_pc;
       fde_pc = this->get_fde_pc<size, big_endian>(eh_frame_address,
 						  eh_frame_contents,
-						  p->first, p->second);
-      fde_addresses->push_back(fde_pc, eh_frame_address + p->first);
+						  fde.first, fde.second);
+      *fde_addresses = std::make_pair(fde_pc, eh_frame_address + fde.first);
     }
 
   of->free_input_view(eh_frame_offset, eh_frame_size, eh_frame_contents);
 }
 
+// This class sorts and writes out the table in parallel.  Each chunk
+// task finds the addresses for its part of the table before sorting
+// it, since reading the PCs from the .eh_frame section is a large
+// part of the work.
+
+template<int size, bool big_endian>
+class Eh_frame_hdr::Parallel_write : public Parallel_sort_table
+{
+ public:
+  typedef typename Fde_addresses<size>::Fde_address_list Fde_address_list;
+
+  Parallel_write(Eh_frame_hdr* hdr, Output_file* of, unsigned int count)
+    : hdr_(hdr), of_(of), fde_addresses_(hdr->fde_offsets_.size()),
+      sort_(&this->fde_addresses_, Fde_address_compare<size>(), count)
+  { }
+
+  void
+  sort_chunk(unsigned int i)
+  {
+    size_t start = this->sort_.chunk_start(i);
+    size_t end = this->sort_.chunk_start(i + 1);
+    if (start < end)
+      this->hdr_->get_fde_addresses<size, big_endian>(
+	  this->of_, start, end, &this->fde_addresses_[start]);
+    this->sort_.sort_chunk(i);
+  }
+
+  void
+  split_into_buckets()
+  { this->sort_.split_into_buckets(); }
+
+  void
+  write_bucket(Output_file* of, unsigned int i)
+  {
+    const off_t off = (this->hdr_->offset() + 12
+		       + this->sort_.bucket_start(i) * 8);
+    const off_t oview_size = this->sort_.bucket_size(i) * 8;
+    if (oview_size == 0)
+      return;
+    unsigned char* const oview = of->get_output_view(off, oview_size);
+
+    Write_fde_addresses<size, big_endian> write(oview,
+						this->hdr_->address());
+    this->sort_.merge_bucket(i, write);
+    gold_assert(write.pov - oview == oview_size);
+
+    of->write_output_view(off, oview_size, oview);
+  }
+
+ private:
+  Eh_frame_hdr* hdr_;
+  Output_file* of_;
+  Fde_address_list fde_addresses_;
+  Parallel_sort<typename Fde_address_list::value_type,
+		Fde_address_compare<size> > sort_;
+};
+
+// Arrange to sort and write out the table in parallel.
+
+unsigned int
+Eh_frame_hdr::set_parallel_write(int thread_count)
+{
+  if (this->any_unrecognized_eh_frame_sections_)
+    return 0;
+  unsigned int count =
+    parallel_sort_chunk_count(this->eh_frame_data_->fde_count(),
+			      thread_count);
+  if (count < 2)
+    return 0;
+  this->parallel_write_count_ = count;
+  return count;
+}
+
+// Queue the tasks to sort and write out the table.
+
+void
+Eh_frame_hdr::queue_write_tasks(Workqueue* workqueue, Output_file* of,
+				Task_token* final_blocker)
+{
+  if (this->parallel_write_count_ == 0)
+    return;
+
+  switch (parameters->size_and_endianness())
+    {
+#ifdef HAVE_TARGET_32_LITTLE
+    case Parameters::TARGET_32_LITTLE:
+      this->sized_queue_write_tasks<32, false>(workqueue, of, final_blocker);
+      break;
+#endif
+#ifdef HAVE_TARGET_32_BIG
+    case Parameters::TARGET_32_BIG:
+      this->sized_queue_write_tasks<32, true>(workqueue, of, final_blocker);
+      break;
+#endif
+#ifdef HAVE_TARGET_64_LITTLE
+    case Parameters::TARGET_64_LITTLE:
+      this->sized_queue_write_tasks<64, false>(workqueue, of, final_blocker);
+      break;
+#endif
+#ifdef HAVE_TARGET_64_BIG
+    case Parameters::TARGET_64_BIG:
+      this->sized_queue_write_tasks<64, true>(workqueue, of, final_blocker);
+      break;
+#endif
+    default:
+      gold_unreachable();
+    }
+}
+
+template<int size, bool big_endian>
+void
+Eh_frame_hdr::sized_queue_write_tasks(Workqueue* workqueue, Output_file* of,
+				      Task_token* final_blocker)
+{
+  // The last of the tasks deletes the table.
+  Parallel_write<size, big_endian>* table =
+    new Parallel_write<size, big_endian>(this, of,
+					 this->parallel_write_count_);
+  queue_parallel_sort_tasks(workqueue, of, table,
+			    this->parallel_write_count_, ".eh_frame_hdr",
+			    final_blocker);
+}
+
 // Class Fde.
 
 bool
@@ -29,6 +29,7 @@
 
 #include "output.h"
 #include "merge.h"
+#include "parallel-sort.h"
 
 namespace gold
 {
@@ -63,6 +64,19 @@ class Eh_frame_hdr : public Output_section_data
       this->fde_offsets_.push_back(std::make_pair(fde_offset, fde_encoding));
   }
 
+  // Arrange to sort and write out the table of FDEs with up to
+  // THREAD_COUNT tasks, rather than in do_write.  This returns the
+  // number of tasks which queue_write_tasks will queue, which is 0 if
+  // the table is too small to be worth it.
+  unsigned int
+  set_parallel_write(int thread_count);
+
+  // Queue the tasks to sort and write out the table of FDEs.  This
+  // must be called after do_write.  Each task unblocks FINAL_BLOCKER,
+  // which the caller must have arranged.
+  void
+  queue_write_tasks(Workqueue*, Output_file*, Task_token* final_blocker);
+
  protected:
   // Set the final data size.
   void
@@ -91,49 +105,70 @@ class Eh_frame_hdr : public Output_section_data
   typedef std::vector<Fde_offset> Fde_offsets;
 
   // When writing out the header, we convert the FDE offsets into FDE
-  // addresses.  This is a list of pairs of the offset from the header
-  // to the FDE PC and to the FDE itself.
+  // addresses.  This is a list of pairs of the address of the FDE PC
+  // and of the FDE itself.
   template<int size>
-  class Fde_addresses
+  struct Fde_addresses
   {
-   public:
     typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
     typedef typename std::pair<Address, Address> Fde_address;
     typedef typename std::vector<Fde_address> Fde_address_list;
-    typedef typename Fde_address_list::iterator iterator;
-
-    Fde_addresses(unsigned int reserve)
-      : fde_addresses_()
-    { this->fde_addresses_.reserve(reserve); }
-
-    void
-    push_back(Address pc_address, Address fde_address)
-    {
-      this->fde_addresses_.push_back(std::make_pair(pc_address, fde_address));
-    }
-
-    iterator
-    begin()
-    { return this->fde_addresses_.begin(); }
-
-    iterator
-    end()
-    { return this->fde_addresses_.end(); }
-
-   private:
-    Fde_address_list fde_addresses_;
   };
 
-  // Compare Fde_address objects.
+  // Compare Fde_address objects.  FDEs for the same PC, as for
+  // functions discarded by --gc-sections or folded by --icf, are
+  // sorted by the address of the FDE, so that the order does not
+  // depend on how the table was sorted.
   template<int size>
   struct Fde_address_compare
   {
     bool
     operator()(const typename Fde_addresses<size>::Fde_address& f1,
 	       const typename Fde_addresses<size>::Fde_address& f2) const
-    { return f1.first < f2.first; }
+    {
+      if (f1.first != f2.first)
+	return f1.first < f2.first;
+      return f1.second < f2.second;
+    }
   };
 
+  // This is passed to Parallel_sort::merge_bucket to write out table
+  // entries.  It is also used when writing the table in do_write.
+  template<int size, bool big_endian>
+  struct Write_fde_addresses
+  {
+    typedef typename Fde_addresses<size>::Fde_address_list::const_iterator
+      const_iterator;
+
+    Write_fde_addresses(unsigned char* a_pov,
+			typename elfcpp::Elf_types<size>::Elf_Addr address)
+      : pov(a_pov), output_address(address)
+    { }
+
+    void
+    operator()(const_iterator p)
+    {
+      elfcpp::Swap<32, big_endian>::writeval(this->pov,
+					     p->first - this->output_address);
+      elfcpp::Swap<32, big_endian>::writeval(this->pov + 4,
+					     p->second - this->output_address);
+      this->pov += 8;
+    }
+
+    unsigned char* pov;
+    typename elfcpp::Elf_types<size>::Elf_Addr output_address;
+  };
+
+  // This is used to sort and write out the table in parallel.
+  template<int size, bool big_endian>
+  class Parallel_write;
+
+  // Queue the tasks to write out the table, for the size and
+  // endianness of the target.
+  template<int size, bool big_endian>
+  void
+  sized_queue_write_tasks(Workqueue*, Output_file*, Task_token*);
+
   // Return the PC to which an FDE refers.
   template<int size, bool big_endian>
   typename elfcpp::Elf_types<size>::Elf_Addr
@@ -141,12 +176,12 @@ class Eh_frame_hdr : public Output_section_data
 	     const unsigned char* eh_frame_contents,
 	     section_offset_type fde_offset, unsigned char fde_encoding);
 
-  // Convert Fde_offsets to Fde_addresses.
+  // Convert the Fde_offsets from START to END to Fde_addresses,
+  // storing them starting at FDE_ADDRESSES.
   template<int size, bool big_endian>
   void
-  get_fde_addresses(Output_file* of,
-		    const Fde_offsets* fde_offsets,
-		    Fde_addresses<size>* fde_addresses);
+  get_fde_addresses(Output_file* of, size_t start, size_t end,
+		    typename Fde_addresses<size>::Fde_address* fde_addresses);
 
   // The .eh_frame section.
   Output_section* eh_frame_section_;
@@ -157,6 +192,9 @@ class Eh_frame_hdr : public Output_section_data
   // Whether we found any .eh_frame sections which we could not
   // process.
   bool any_unrecognized_eh_frame_sections_;
+  // The number of tasks used to sort and write out the table, or 0
+  // if it is written out by do_write.
+  unsigned int parallel_write_count_;
 };
 
 // This class holds an FDE.
@@ -0,0 +1,129 @@
+// fast-hash.cc -- fast non-cryptographic hash for gold
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <algorithm>
+
+#include "elfcpp.h"
+#include "fast-hash.h"
+
+namespace gold
+{
+
+// The MurmurHash3 algorithm was written by Austin Appleby, who placed
+// it in the public domain.
+
+static inline uint64_t
+rotl64(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t
+fmix64(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+static const uint64_t c1 = 0x87c37b91114253d5ULL;
+static const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+void*
+fast_hash_buffer(const char* buffer, size_t len, void* resblock)
+{
+  const unsigned char* data = reinterpret_cast<const unsigned char*>(buffer);
+  const size_t nblocks = len / 16;
+
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+
+  for (size_t i = 0; i < nblocks; ++i, data += 16)
+    {
+      uint64_t k1 = elfcpp::Swap_unaligned<64, false>::readval(data);
+      uint64_t k2 = elfcpp::Swap_unaligned<64, false>::readval(data + 8);
+
+      k1 *= c1;
+      k1 = rotl64(k1, 31);
+      k1 *= c2;
+      h1 ^= k1;
+
+      h1 = rotl64(h1, 27);
+      h1 += h2;
+      h1 = h1 * 5 + 0x52dce729;
+
+      k2 *= c2;
+      k2 = rotl64(k2, 33);
+      k2 *= c1;
+      h2 ^= k2;
+
+      h2 = rotl64(h2, 31);
+      h2 += h1;
+      h2 = h2 * 5 + 0x38495ab5;
+    }
+
+  // The remaining 0 to 15 bytes.
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  const size_t tail = len & 15;
+  for (size_t i = tail; i > 8; --i)
+    k2 ^= static_cast<uint64_t>(data[i - 1]) << ((i - 9) * 8);
+  if (tail > 8)
+    {
+      k2 *= c2;
+      k2 = rotl64(k2, 33);
+      k2 *= c1;
+      h2 ^= k2;
+    }
+  for (size_t i = std::min(tail, static_cast<size_t>(8)); i > 0; --i)
+    k1 ^= static_cast<uint64_t>(data[i - 1]) << ((i - 1) * 8);
+  if (tail > 0)
+    {
+      k1 *= c1;
+      k1 = rotl64(k1, 31);
+      k1 *= c2;
+      h1 ^= k1;
+    }
+
+  h1 ^= len;
+  h2 ^= len;
+
+  h1 += h2;
+  h2 += h1;
+
+  h1 = fmix64(h1);
+  h2 = fmix64(h2);
+
+  h1 += h2;
+  h2 += h1;
+
+  unsigned char* out = static_cast<unsigned char*>(resblock);
+  elfcpp::Swap_unaligned<64, false>::writeval(out, h1);
+  elfcpp::Swap_unaligned<64, false>::writeval(out + 8, h2);
+  return resblock;
+}
+
+} // End namespace gold.
@@ -0,0 +1,43 @@
+// fast-hash.h -- fast non-cryptographic hash for gold  -*- C++ -*-
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_FAST_HASH_H
+#define GOLD_FAST_HASH_H
+
+namespace gold
+{
+
+// The size in bytes of the result of fast_hash_buffer.
+const size_t fast_hash_size = 128 / 8;
+
+// Compute a 128-bit hash of the LEN bytes at BUFFER and store it in
+// the fast_hash_size bytes at RESBLOCK.  This is MurmurHash3 x64_128
+// with a seed of zero, which is several times faster than MD5 or
+// SHA-1 but is not a cryptographic hash.  The input is read as little
+// endian words, so the result does not depend on the host.  Like
+// md5_buffer, this returns RESBLOCK.
+
+extern void*
+fast_hash_buffer(const char* buffer, size_t len, void* resblock);
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_FAST_HASH_H)
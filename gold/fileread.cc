@@ -22,6 +22,7 @@
 
 #include "gold.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cerrno>
 #include <climits>
@@ -47,6 +48,8 @@
 #include "binary.h"
 #include "descriptors.h"
 #include "gold-threads.h"
+#include "task-trace.h"
+#include "stats.h"
 #include "fileread.h"
 
 // For systems without mmap support.
@@ -124,6 +127,9 @@ static Initialize_lock file_counts_initialize_lock(&file_counts_lock);
 unsigned long long File_read::total_mapped_bytes;
 unsigned long long File_read::current_mapped_bytes;
 unsigned long long File_read::maximum_mapped_bytes;
+unsigned long long File_read::total_prefetched_bytes;
+unsigned long long File_read::total_prefetch_read_bytes;
+unsigned long long File_read::total_prefetch_hit_bytes;
 
 // Class File_read::View.
 
@@ -138,7 +144,8 @@ File_read::View::~View()
     case DATA_MMAPPED:
       if (::munmap(const_cast<unsigned char*>(this->data_), this->size_) != 0)
 	gold_warning(_("munmap failed: %s"), strerror(errno));
-      if (!parameters->options_valid() || parameters->options().stats())
+      if (!parameters->options_valid()
+	  || parameters->options().collect_stats())
 	{
 	  file_counts_initialize_lock.initialize();
 	  Hold_optional_lock hl(file_counts_lock);
@@ -259,7 +266,8 @@ File_read::release()
 {
   gold_assert(this->is_locked());
 
-  if (!parameters->options_valid() || parameters->options().stats())
+  if (!parameters->options_valid()
+      || parameters->options().collect_stats())
     {
       file_counts_initialize_lock.initialize();
       Hold_optional_lock hl(file_counts_lock);
@@ -267,9 +275,15 @@ File_read::release()
       File_read::current_mapped_bytes += this->mapped_bytes_;
       if (File_read::current_mapped_bytes > File_read::maximum_mapped_bytes)
 	File_read::maximum_mapped_bytes = File_read::current_mapped_bytes;
+      File_read::total_prefetched_bytes += this->prefetched_bytes_;
+      File_read::total_prefetch_read_bytes += this->prefetch_read_bytes_;
+      File_read::total_prefetch_hit_bytes += this->prefetch_hit_bytes_;
     }
 
   this->mapped_bytes_ = 0;
+  this->prefetched_bytes_ = 0;
+  this->prefetch_read_bytes_ = 0;
+  this->prefetch_hit_bytes_ = 0;
 
   // Only clear views if there is only one attached object.  Otherwise
   // we waste time trying to clear cached archive views.  Similarly
@@ -420,11 +434,50 @@ File_read::do_read(off_t start, section_size_type size, void* p)
 	     static_cast<long long>(start));
 }
 
+// Hold the read lock of a File_read, if it has one.  With
+// --trace-tasks, record any time spent waiting for the lock.
+
+class Hold_read_lock
+{
+ public:
+  Hold_read_lock(Lock* lock, const File_read* file)
+    : lock_(lock)
+  {
+    if (lock == NULL)
+      return;
+    Task_trace* trace = parameters->task_trace();
+    if (trace == NULL)
+      lock->acquire();
+    else if (!lock->try_acquire())
+      {
+	uint64_t start = Task_trace::now();
+	lock->acquire();
+	trace->file_lock_wait(file->filename(), start, Task_trace::now());
+      }
+  }
+
+  ~Hold_read_lock()
+  {
+    if (this->lock_ != NULL)
+      this->lock_->release();
+  }
+
+ private:
+  Hold_read_lock(const Hold_read_lock&);
+  Hold_read_lock& operator=(const Hold_read_lock&);
+
+  Lock* lock_;
+};
+
 // Read data from the file.
 
 void
 File_read::read(off_t start, section_size_type size, void* p)
 {
+  Hold_read_lock hl(this->read_lock_, this);
+
+  this->record_read(start, size);
+
   const File_read::View* pv = this->find_view(start, size, -1U, NULL);
   if (pv != NULL)
     {
@@ -542,6 +595,8 @@ File_read::find_or_make_view(off_t offset, off_t start,
 		   static_cast<long long>(size),
 		   static_cast<long long>(start));
 
+  this->record_read(offset + start, size);
+
   unsigned int byteshift;
   if (offset == 0)
     byteshift = 0;
@@ -615,6 +670,7 @@ const unsigned char*
 File_read::get_view(off_t offset, off_t start, section_size_type size,
 		    bool aligned, bool cache)
 {
+  Hold_read_lock hl(this->read_lock_, this);
   File_read::View* pv = this->find_or_make_view(offset, start, size,
 						aligned, cache);
   return pv->data() + (offset + start - pv->start() + pv->byteshift());
@@ -624,6 +680,7 @@ File_view*
 File_read::get_lasting_view(off_t offset, off_t start, section_size_type size,
 			    bool aligned, bool cache)
 {
+  Hold_read_lock hl(this->read_lock_, this);
   File_read::View* pv = this->find_or_make_view(offset, start, size,
 						aligned, cache);
   pv->lock();
@@ -733,6 +790,7 @@ File_read::read_multiple(off_t base, const Read_multiple& rm)
 	this->read(base + i_off, i_entry.size, i_entry.buffer);
       else
 	{
+	  Hold_read_lock hl(this->read_lock_, this);
 	  File_read::View* view = this->find_view(base + i_off,
 						  end_off - i_off,
 						  -1U, NULL);
@@ -847,15 +905,178 @@ File_read::clear_views(Clear_views_mode mode)
     }
 }
 
-// Print statistical information to stderr.  This is used for --stats.
+// Tell the system that we are going to read RANGES soon.  We use
+// posix_fadvise rather than reading the data ourselves, so that the
+// reads are done by the kernel in the background, and several of them
+// may be in flight at once; this matters most when the files are on
+// a network file system.  The data is then normally in the page cache
+// by the time we map it.
+
+void
+File_read::prefetch(off_t base ATTRIBUTE_UNUSED,
+		    Prefetch_ranges* ranges ATTRIBUTE_UNUSED)
+{
+#ifdef HAVE_POSIX_FADVISE
+  // There is nothing to do if the contents were provided in memory.
+  if (ranges->empty() || this->descriptor_ < 0)
+    return;
+
+  // Merge ranges which are close together, to save system calls.
+  // The kernel reads whole pages anyhow.
+  std::sort(ranges->begin(), ranges->end());
+  Prefetch_ranges::iterator out = ranges->begin();
+  for (Prefetch_ranges::const_iterator p = ranges->begin() + 1;
+       p != ranges->end();
+       ++p)
+    {
+      off_t out_end = out->first + out->second;
+      if (p->first <= out_end + page_size)
+	{
+	  off_t p_end = p->first + p->second;
+	  if (p_end > out_end)
+	    out->second = p_end - out->first;
+	}
+      else
+	*++out = *p;
+    }
+  ranges->erase(out + 1, ranges->end());
+
+  this->reopen_descriptor();
+  const bool stats = parameters->options().collect_stats();
+  for (Prefetch_ranges::const_iterator p = ranges->begin();
+       p != ranges->end();
+       ++p)
+    {
+      off_t start = base + p->first;
+      if (start >= this->size_)
+	continue;
+      section_size_type size = p->second;
+      if (static_cast<off_t>(size) > this->size_ - start)
+	size = this->size_ - start;
+      ::posix_fadvise(this->descriptor_, start, size, POSIX_FADV_WILLNEED);
+      if (stats)
+	{
+	  this->prefetched_.push_back(Prefetched_range(start, size));
+	  this->prefetched_bytes_ += size;
+	}
+    }
+  if (stats)
+    std::sort(this->prefetched_.begin(), this->prefetched_.end());
+#endif
+}
+
+// Record a read of SIZE bytes at START.  This is only called if
+// --stats, once something has been prefetched.  We count the pages of
+// the prefetched ranges which are read for the first time, and how
+// many of them were already in memory.  Since this is called before
+// the data is read, a page is only in memory if the prefetch, or an
+// earlier read of the same file by someone else, brought it in.
+
+void
+File_read::do_record_read(off_t start, section_size_type size)
+{
+  static const off_t sys_page_size = ::sysconf(_SC_PAGESIZE);
+
+  // Start with the last range which starts at or before START.
+  off_t end = start + size;
+  std::vector<Prefetched_range>::iterator p =
+    std::upper_bound(this->prefetched_.begin(), this->prefetched_.end(),
+		     Prefetched_range(start, 0));
+  if (p != this->prefetched_.begin())
+    --p;
+  for (; p != this->prefetched_.end() && p->start < end; ++p)
+    {
+      off_t range_end = p->start + static_cast<off_t>(p->size);
+      off_t read_start = std::max(start, p->start);
+      off_t read_end = std::min(end, range_end);
+      if (read_start >= read_end)
+	continue;
+
+      off_t range_page = p->start / sys_page_size;
+      off_t first_page = read_start / sys_page_size;
+      off_t last_page = (read_end - 1) / sys_page_size;
+      if (p->pages_read.empty())
+	p->pages_read.resize((range_end - 1) / sys_page_size - range_page + 1);
+
+      off_t page = first_page;
+      while (page <= last_page && p->pages_read[page - range_page])
+	++page;
+      if (page > last_page)
+	continue;
+
+      // Ask the system which of the pages are in memory.  This needs
+      // a mapping, but mapping the file does not read it.
+      size_t npages = last_page - page + 1;
+      std::vector<unsigned char> resident(npages, 0);
+#if defined(HAVE_MMAP) && defined(HAVE_MINCORE)
+      this->reopen_descriptor();
+      void* m = ::mmap(NULL, npages * sys_page_size, PROT_READ, MAP_PRIVATE,
+		       this->descriptor_, page * sys_page_size);
+      if (m != MAP_FAILED)
+	{
+	  if (::mincore(m, npages * sys_page_size, &resident[0]) != 0)
+	    std::fill(resident.begin(), resident.end(), 0);
+	  ::munmap(m, npages * sys_page_size);
+	}
+#endif
+
+      for (off_t i = page; i <= last_page; ++i)
+	{
+	  if (p->pages_read[i - range_page])
+	    continue;
+	  p->pages_read[i - range_page] = true;
+	  off_t page_start = std::max(i * sys_page_size, p->start);
+	  off_t page_end = std::min((i + 1) * sys_page_size, range_end);
+	  this->prefetch_read_bytes_ += page_end - page_start;
+	  if ((resident[i - page] & 1) != 0)
+	    this->prefetch_hit_bytes_ += page_end - page_start;
+	}
+    }
+}
+
+// Report statistical information.  This is used for --stats and --stats-json.
 
 void
 File_read::print_stats()
 {
-  fprintf(stderr, _("%s: total bytes mapped for read: %llu\n"),
-	  program_name, File_read::total_mapped_bytes);
-  fprintf(stderr, _("%s: maximum bytes mapped for read at one time: %llu\n"),
-	  program_name, File_read::maximum_mapped_bytes);
+  if (parameters->options().stats())
+    {
+      fprintf(stderr, _("%s: total bytes mapped for read: %llu\n"),
+	      program_name, File_read::total_mapped_bytes);
+      fprintf(stderr,
+	      _("%s: maximum bytes mapped for read at one time: %llu\n"),
+	      program_name, File_read::maximum_mapped_bytes);
+    }
+  record_stat("total bytes mapped for read", File_read::total_mapped_bytes);
+  record_stat("maximum bytes mapped for read at one time",
+	      File_read::maximum_mapped_bytes);
+
+  if (File_read::total_prefetched_bytes > 0)
+    {
+      if (parameters->options().stats())
+	{
+	  fprintf(stderr, _("%s: total bytes prefetched for read: %llu\n"),
+		  program_name, File_read::total_prefetched_bytes);
+	  fprintf(stderr,
+		  _("%s: prefetched bytes later read: %llu (%.1f%%)\n"),
+		  program_name, File_read::total_prefetch_read_bytes,
+		  (100.0 * File_read::total_prefetch_read_bytes
+		   / File_read::total_prefetched_bytes));
+	  if (File_read::total_prefetch_read_bytes > 0)
+	    fprintf(stderr,
+		    _("%s: prefetched bytes in memory when first read: "
+		      "%llu (%.1f%%)\n"),
+		    program_name, File_read::total_prefetch_hit_bytes,
+		    (100.0 * File_read::total_prefetch_hit_bytes
+		     / File_read::total_prefetch_read_bytes));
+	}
+      record_stat("total bytes prefetched for read",
+		  File_read::total_prefetched_bytes);
+      record_stat("prefetched bytes later read",
+		  File_read::total_prefetch_read_bytes);
+      record_stat("prefetched bytes in memory when first read",
+		  File_read::total_prefetch_hit_bytes);
+    }
 }
 
 // Class File_view.
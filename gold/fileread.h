@@ -62,6 +62,7 @@ class Position_dependent_options;
 class Input_file_argument;
 class Dirsearch;
 class File_view;
+class Lock;
 
 // File_read manages a file descriptor and mappings for a file we are
 // reading.
@@ -72,7 +73,9 @@ class File_read
   File_read()
     : name_(), descriptor_(-1), is_descriptor_opened_(false), object_count_(0),
       size_(0), token_(false), views_(), saved_views_(), mapped_bytes_(0),
-      released_(true), whole_file_view_(NULL)
+      released_(true), whole_file_view_(NULL), prefetched_(),
+      prefetched_bytes_(0), prefetch_read_bytes_(0), prefetch_hit_bytes_(0),
+      read_lock_(NULL)
   { }
 
   ~File_read();
@@ -132,6 +135,13 @@ class File_read
   void
   release();
 
+  // Set a lock to hold while reading the file, or NULL for none.
+  // This lets several threads read the file on behalf of the Task
+  // which has it locked.
+  void
+  set_read_lock(Lock* lock)
+  { this->read_lock_ = lock; }
+
   // Return the size of the file.
   off_t
   filesize() const
@@ -203,6 +213,17 @@ class File_read
   void
   read_multiple(off_t base, const Read_multiple&);
 
+  // A list of ranges of the file, as pairs of file offset and size.
+  typedef std::vector<std::pair<off_t, section_size_type> > Prefetch_ranges;
+
+  // Tell the system that we are going to read RANGES soon, so that
+  // it can start reading them into the page cache in the background.
+  // BASE is added to all the offsets.  The ranges are sorted and
+  // merged here.  This is only a hint, and does nothing if the
+  // system does not support it.
+  void
+  prefetch(off_t base, Prefetch_ranges* ranges);
+
   // Dump statistical information to stderr.
   static void
   print_stats();
@@ -247,6 +268,36 @@ class File_read
   // --stats.
   static unsigned long long maximum_mapped_bytes;
 
+  // Total bytes passed to prefetch during the link if --stats.
+  static unsigned long long total_prefetched_bytes;
+
+  // Total bytes in prefetched ranges which were later read during the
+  // link if --stats.
+  static unsigned long long total_prefetch_read_bytes;
+
+  // Total bytes in prefetched ranges which were already in memory
+  // when they were first read during the link if --stats.
+  static unsigned long long total_prefetch_hit_bytes;
+
+  // A range passed to prefetch, for the statistics.
+  struct Prefetched_range
+  {
+    Prefetched_range(off_t s, section_size_type sz)
+      : start(s), size(sz), pages_read()
+    { }
+
+    bool
+    operator<(const Prefetched_range& r) const
+    { return this->start < r.start; }
+
+    // The file offset and size of the range.
+    off_t start;
+    section_size_type size;
+    // Whether each system page which overlaps the range has been
+    // read, starting with the page containing START.
+    std::vector<bool> pages_read;
+  };
+
   // A view into the file.
   class View
   {
@@ -392,6 +443,18 @@ class File_read
   void
   clear_views(Clear_views_mode);
 
+  // Record a read of SIZE bytes at START, for the prefetch
+  // statistics.  This must be called before the data is read.
+  void
+  record_read(off_t start, section_size_type size)
+  {
+    if (!this->prefetched_.empty())
+      this->do_record_read(start, size);
+  }
+
+  void
+  do_record_read(off_t start, section_size_type size);
+
   // The size of a file page for buffering data.
   static const off_t page_size = 8192;
 
@@ -442,6 +505,18 @@ class File_read
   // - The contents was specified in the constructor.  Used only for
   //   testing purposes).
   View* whole_file_view_;
+  // The ranges passed to prefetch, sorted by offset.  This is only
+  // kept if --stats.
+  std::vector<Prefetched_range> prefetched_;
+  // Bytes passed to prefetch, bytes in prefetched ranges which were
+  // later read, and how many of those were already in memory when
+  // they were read.  These are only changed while the file is
+  // locked, and are transferred to the totals like mapped_bytes_.
+  unsigned long long prefetched_bytes_;
+  unsigned long long prefetch_read_bytes_;
+  unsigned long long prefetch_hit_bytes_;
+  // The lock to hold while reading the file, set by set_read_lock.
+  Lock* read_lock_;
 };
 
 // A view of file data that persists even when the file is unlocked.
@@ -498,8 +573,8 @@ class Input_file
   Input_file(const char* name);
 
   // Create an input file with the contents already provided.  This is
-  // only used for testing.  With this path, don't call the open
-  // method.
+  // used for testing, and by dwp for input files it has mapped itself.
+  // With this path, don't call the open method.
   Input_file(const Task*, const char* name, const unsigned char* contents,
 	     off_t size);
 
@@ -22,6 +22,11 @@
 
 
 #include "gold.h"
+
+#include <algorithm>
+
+#include "gold-threads.h"
+#include "workqueue.h"
 #include "object.h"
 #include "gc.h"
 #include "symtab.h"
@@ -29,40 +34,321 @@
 namespace gold
 {
 
+// The work shared between the tasks which do the transitive closure
+// in parallel.  Each task marks sections from a stack of its own, and
+// moves part of that stack to the pool when another task is waiting
+// for work.  The closure is complete when the pool is empty and no
+// task is working.
+
+class Gc_mark_pool
+{
+ public:
+  Gc_mark_pool(const std::vector<unsigned int>& roots)
+    : lock_(), condvar_(this->lock_), pool_(roots), working_(0), waiting_(0)
+  { }
+
+  // Move some sections from the pool to STACK, waiting for them if
+  // need be.  IS_WORKING is true if the caller was working, and is
+  // updated.  Returns false if the closure is complete.
+  bool
+  get_work(std::vector<unsigned int>* stack, bool* is_working);
+
+  // Move half of STACK to the pool if another task is waiting.
+  void
+  share_work(std::vector<unsigned int>* stack);
+
+ private:
+  Lock lock_;
+  Condvar condvar_;
+  // Sections which have been marked but whose references have not
+  // been followed.
+  std::vector<unsigned int> pool_;
+  // The number of tasks marking sections.
+  int working_;
+  // The number of tasks waiting for work.
+  int waiting_;
+};
+
+bool
+Gc_mark_pool::get_work(std::vector<unsigned int>* stack, bool* is_working)
+{
+  Hold_lock hl(this->lock_);
+  if (*is_working)
+    {
+      --this->working_;
+      *is_working = false;
+    }
+  while (this->pool_.empty())
+    {
+      // If nobody is working, nobody can add any more work.
+      if (this->working_ == 0)
+	{
+	  this->condvar_.broadcast();
+	  return false;
+	}
+      ++this->waiting_;
+      this->condvar_.wait();
+      --this->waiting_;
+    }
+
+  // Take a share of the pool, leaving the rest for any other waiting
+  // tasks.
+  size_t count = ((this->pool_.size() + this->waiting_)
+		  / (this->waiting_ + 1));
+  stack->insert(stack->end(), this->pool_.end() - count, this->pool_.end());
+  this->pool_.resize(this->pool_.size() - count);
+  ++this->working_;
+  *is_working = true;
+  return true;
+}
+
+void
+Gc_mark_pool::share_work(std::vector<unsigned int>* stack)
+{
+  Hold_lock hl(this->lock_);
+  if (this->waiting_ == 0 || !this->pool_.empty())
+    return;
+
+  // Give away the bottom of the stack, which is likely to lead to
+  // more sections than the top.
+  size_t count = stack->size() / 2;
+  this->pool_.insert(this->pool_.end(), stack->begin(),
+		     stack->begin() + count);
+  stack->erase(stack->begin(), stack->begin() + count);
+  this->condvar_.broadcast();
+}
+
+// A task which marks reachable sections, in parallel with other such
+// tasks.
+
+class Gc_mark_task : public Task
+{
+ public:
+  Gc_mark_task(Garbage_collection* gc, Task_token* final_blocker)
+    : gc_(gc), final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->gc_->mark_reachable_sections(); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Gc_mark_task"; }
+
+ private:
+  Garbage_collection* gc_;
+  Task_token* const final_blocker_;
+};
+
+// Set the bit for section index I in MARKS, and return true if it was
+// not already set.  This may be called by several threads at once.
+
+static inline bool
+set_mark(unsigned int* marks, unsigned int i)
+{
+  unsigned int* word = marks + i / 32;
+  unsigned int bit = 1U << (i % 32);
+  if ((*word & bit) != 0)
+    return false;
+#ifdef ENABLE_THREADS
+  return (__sync_fetch_and_or(word, bit) & bit) == 0;
+#else
+  *word |= bit;
+  return true;
+#endif
+}
+
+Garbage_collection::~Garbage_collection()
+{
+  delete this->mark_pool_;
+}
+
+// Add a reference from one section to another.  This is called while
+// the relocs of each object are processed in turn, so it does not
+// have to be thread safe.
+
+void
+Garbage_collection::add_reference(Relobj* src_object, unsigned int src_shndx,
+				  Relobj* dst_object, unsigned int dst_shndx)
+{
+  unsigned int src = this->section_index(Section_id(src_object, src_shndx));
+  unsigned int dst = this->section_index(Section_id(dst_object, dst_shndx));
+
+  // The references from a section are normally added one after the
+  // other, and there are often many references to the same few
+  // sections.  Remove duplicates from time to time, to save memory.
+  if (this->references_.empty() || this->references_.back().first != src)
+    {
+      this->segment_start_ = this->references_.size();
+      this->segment_compact_size_ = this->segment_start_ + 64;
+    }
+  else if (this->references_.back().second == dst)
+    return;
+
+  this->references_.push_back(std::make_pair(src, dst));
+
+  if (this->references_.size() >= this->segment_compact_size_)
+    {
+      std::vector<Reference>::iterator start =
+	this->references_.begin() + this->segment_start_;
+      std::sort(start, this->references_.end());
+      this->references_.erase(std::unique(start, this->references_.end()),
+			      this->references_.end());
+      size_t count = this->references_.size() - this->segment_start_;
+      this->segment_compact_size_ = this->segment_start_ + 2 * count + 64;
+    }
+}
+
+// Turn the references into the REFERENCE_OFFSETS_ and
+// REFERENCE_TARGETS_ arrays, without duplicates, and mark the
+// sections on the work list.  Return the marked sections in ROOTS.
+
+void
+Garbage_collection::start_transitive_closure(std::vector<unsigned int>* roots)
+{
+  // Give an index to the sections on the work list first, so that
+  // the arrays cover them.
+  std::vector<unsigned int> work_list;
+  work_list.reserve(this->work_list_.size());
+  for (Worklist_type::const_iterator p = this->work_list_.begin();
+       p != this->work_list_.end();
+       ++p)
+    work_list.push_back(this->section_index(*p));
+  Worklist_type().swap(this->work_list_);
+
+  size_t count = this->section_index_.size();
+  this->marks_.assign((count + 31) / 32, 0);
+
+  // Sort the references by source section.
+  std::vector<size_t>& offsets(this->reference_offsets_);
+  std::vector<unsigned int>& targets(this->reference_targets_);
+  offsets.assign(count + 1, 0);
+  for (std::vector<Reference>::const_iterator p = this->references_.begin();
+       p != this->references_.end();
+       ++p)
+    ++offsets[p->first + 1];
+  for (size_t i = 0; i < count; ++i)
+    offsets[i + 1] += offsets[i];
+  targets.resize(this->references_.size());
+  {
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    for (std::vector<Reference>::const_iterator p = this->references_.begin();
+	 p != this->references_.end();
+	 ++p)
+      targets[next[p->first]++] = p->second;
+  }
+  std::vector<Reference>().swap(this->references_);
+
+  // Remove duplicate references from each section.
+  size_t out = 0;
+  for (size_t i = 0; i < count; ++i)
+    {
+      std::vector<unsigned int>::iterator begin = targets.begin() + offsets[i];
+      std::vector<unsigned int>::iterator end = targets.begin() + offsets[i + 1];
+      std::sort(begin, end);
+      end = std::unique(begin, end);
+      offsets[i] = out;
+      out = std::copy(begin, end, targets.begin() + out) - targets.begin();
+    }
+  offsets[count] = out;
+  targets.resize(out);
+
+  for (std::vector<unsigned int>::const_iterator p = work_list.begin();
+       p != work_list.end();
+       ++p)
+    if (set_mark(&this->marks_[0], *p))
+      roots->push_back(*p);
+}
+
+// Mark every section reachable from the sections in STACK, which are
+// already marked.  If POOL is not NULL, share the work through it with
+// other tasks.
+
+void
+Garbage_collection::mark_from(std::vector<unsigned int>* stack,
+			      Gc_mark_pool* pool)
+{
+  unsigned int* marks = this->marks_.empty() ? NULL : &this->marks_[0];
+  const size_t* offsets = &this->reference_offsets_[0];
+  const unsigned int* targets = (this->reference_targets_.empty()
+				 ? NULL
+				 : &this->reference_targets_[0]);
+  unsigned int count = 0;
+  while (!stack->empty())
+    {
+      unsigned int i = stack->back();
+      stack->pop_back();
+      for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+	if (set_mark(marks, targets[j]))
+	  stack->push_back(targets[j]);
+      if (pool != NULL && (++count % 256) == 0 && stack->size() > 1)
+	pool->share_work(stack);
+    }
+}
+
 // Garbage collection uses a worklist style algorithm to determine the 
 // transitive closure of all referenced sections.
+
 void 
 Garbage_collection::do_transitive_closure()
 {
-  while (!this->worklist().empty())
+  std::vector<unsigned int> stack;
+  this->start_transitive_closure(&stack);
+  this->mark_from(&stack, NULL);
+  this->finish_transitive_closure();
+}
+
+// Queue THREAD_COUNT tasks to do the transitive closure in parallel.
+
+Task_token*
+Garbage_collection::queue_transitive_closure_tasks(Workqueue* workqueue,
+						   int thread_count)
+{
+  std::vector<unsigned int> roots;
+  this->start_transitive_closure(&roots);
+  gold_assert(this->mark_pool_ == NULL);
+  this->mark_pool_ = new Gc_mark_pool(roots);
+
+  Task_token* blocker = new Task_token(true);
+  for (int i = 0; i < thread_count; ++i)
     {
-      // Add elements from the work list to the referenced list
-      // one by one.
-      Section_id entry = this->worklist().back();
-      this->worklist().pop_back();
-      if (!this->referenced_list().insert(entry).second)
-        continue;
-      Garbage_collection::Section_ref::iterator find_it = 
-                this->section_reloc_map().find(entry);
-      if (find_it == this->section_reloc_map().end()) 
-          continue;
-      const Garbage_collection::Sections_reachable &v = find_it->second;
-      // Scan the vector of references for each work_list entry. 
-      for (Garbage_collection::Sections_reachable::const_iterator it_v =
-               v.begin();
-           it_v != v.end();
-           ++it_v)
-        {
-          // Do not add already processed sections to the work_list. 
-          if (this->referenced_list().find(*it_v)
-              == this->referenced_list().end())
-            {
-              this->worklist().push_back(*it_v);
-            }
-        }
+      blocker->add_blocker();
+      workqueue->queue(new Gc_mark_task(this, blocker));
     }
+  return blocker;
+}
+
+// This is run by each Gc_mark_task.
+
+void
+Garbage_collection::mark_reachable_sections()
+{
+  std::vector<unsigned int> stack;
+  bool is_working = false;
+  while (this->mark_pool_->get_work(&stack, &is_working))
+    this->mark_from(&stack, this->mark_pool_);
+}
+
+// Free the reference graph once every reachable section is marked.
+
+void
+Garbage_collection::finish_transitive_closure()
+{
+  delete this->mark_pool_;
+  this->mark_pool_ = NULL;
+  std::vector<size_t>().swap(this->reference_offsets_);
+  std::vector<unsigned int>().swap(this->reference_targets_);
   this->worklist_ready();
 }
 
 } // End namespace gold.
-
@@ -41,13 +41,15 @@ class Sized_relobj_file;
 class Output_section;
 class General_options;
 class Layout;
+class Workqueue;
+class Task_token;
+class Gc_mark_pool;
 
 class Garbage_collection
 {
  public:
 
   typedef Unordered_set<Section_id, Section_id_hash> Sections_reachable;
-  typedef std::map<Section_id, Sections_reachable> Section_ref;
   typedef std::vector<Section_id> Worklist_type;
   // This maps the name of the section which can be represented as a C
   // identifier (cident) to the list of sections that have that name.
@@ -55,18 +57,14 @@ class Garbage_collection
   typedef std::map<std::string, Sections_reachable> Cident_section_map;
 
   Garbage_collection()
-  : is_worklist_ready_(false)
+  : work_list_(), is_worklist_ready_(false), section_index_(),
+    references_(), segment_start_(0), segment_compact_size_(0),
+    reference_offsets_(), reference_targets_(), marks_(), mark_pool_(NULL)
   { }
 
-  // Accessor methods for the private members.
-
-  Sections_reachable&
-  referenced_list()
-  { return referenced_list_; }
+  ~Garbage_collection();
 
-  Section_ref&
-  section_reloc_map()
-  { return this->section_reloc_map_; }
+  // Accessor methods for the private members.
 
   Worklist_type&
   worklist()
@@ -80,13 +78,34 @@ class Garbage_collection
   worklist_ready()
   { this->is_worklist_ready_ = true; }
 
+  // Mark every section reachable from the work list.
   void
   do_transitive_closure();
 
+  // Queue tasks which mark every section reachable from the work
+  // list in parallel.  Returns a blocker which is released when they
+  // are done; finish_transitive_closure must be called after that.
+  Task_token*
+  queue_transitive_closure_tasks(Workqueue*, int thread_count);
+
+  // Finish the transitive closure started by
+  // queue_transitive_closure_tasks.
+  void
+  finish_transitive_closure();
+
+  // Mark the sections reachable from the sections in the mark pool.
+  // This is called by the tasks queued by
+  // queue_transitive_closure_tasks.
+  void
+  mark_reachable_sections();
+
   bool
   is_section_garbage(Relobj* obj, unsigned int shndx)
-  { return (this->referenced_list().find(Section_id(obj, shndx))
-            == this->referenced_list().end()); }
+  {
+    Section_index::const_iterator p =
+      this->section_index_.find(Section_id(obj, shndx));
+    return p == this->section_index_.end() || !this->is_marked(p->second);
+  }
 
   Cident_section_map*
   cident_sections()
@@ -101,20 +120,62 @@ class Garbage_collection
   // DST_SHNDX-th section of DST_OBJECT.
   void
   add_reference(Relobj* src_object, unsigned int src_shndx,
-		Relobj* dst_object, unsigned int dst_shndx)
+		Relobj* dst_object, unsigned int dst_shndx);
+
+ private:
+  // Maps each section that is referenced or that refers to another
+  // section to a dense index.
+  typedef Unordered_map<Section_id, unsigned int,
+			Section_id_hash> Section_index;
+  // A reference from the section with the first index to the section
+  // with the second index.
+  typedef std::pair<unsigned int, unsigned int> Reference;
+
+  // Return the index of SECN, allocating a new one if needed.
+  unsigned int
+  section_index(const Section_id& secn)
   {
-    Section_id src_id(src_object, src_shndx);
-    Section_id dst_id(dst_object, dst_shndx);
-    Sections_reachable& reachable = this->section_reloc_map_[src_id];
-    reachable.insert(dst_id);
+    std::pair<Section_index::iterator, bool> ins =
+      this->section_index_.insert(std::make_pair(secn,
+						 this->section_index_.size()));
+    return ins.first->second;
   }
 
- private:
+  // Whether the section with index I has been marked.
+  bool
+  is_marked(unsigned int i) const
+  {
+    return (i / 32 < this->marks_.size()
+	    && (this->marks_[i / 32] & (1U << (i % 32))) != 0);
+  }
+
+  void
+  start_transitive_closure(std::vector<unsigned int>* roots);
+
+  void
+  mark_from(std::vector<unsigned int>* stack, Gc_mark_pool* pool);
 
   Worklist_type work_list_;
   bool is_worklist_ready_;
-  Section_ref section_reloc_map_;
-  Sections_reachable referenced_list_;
+  Section_index section_index_;
+  // The references added by add_reference.  These are turned into
+  // the REFERENCE_OFFSETS_ and REFERENCE_TARGETS_ arrays before the
+  // transitive closure is done.
+  std::vector<Reference> references_;
+  // The start of the references from the most recent source section,
+  // and the size at which they will next have duplicates removed.
+  size_t segment_start_;
+  size_t segment_compact_size_;
+  // The sections referenced by the section with index I are
+  // REFERENCE_TARGETS_[REFERENCE_OFFSETS_[I]] through
+  // REFERENCE_TARGETS_[REFERENCE_OFFSETS_[I + 1] - 1].
+  std::vector<size_t> reference_offsets_;
+  std::vector<unsigned int> reference_targets_;
+  // A bit for each section index, set once the section is known to
+  // be reachable.
+  std::vector<unsigned int> marks_;
+  // The work shared between tasks doing the transitive closure.
+  Gc_mark_pool* mark_pool_;
   Cident_section_map cident_sections_;
 };
 
@@ -358,16 +419,14 @@ gc_process_relocs(
                 symtab->gc()->cident_sections()->find(std::string(cident_section_name));
               if (ele == symtab->gc()->cident_sections()->end())
                 continue;
-	      Section_id src_id(src_obj, src_indx);
-              Garbage_collection::Sections_reachable&
-                v(symtab->gc()->section_reloc_map()[src_id]);
               Garbage_collection::Sections_reachable& cident_secn(ele->second);
               for (Garbage_collection::Sections_reachable::iterator it_v
                      = cident_secn.begin();
                    it_v != cident_secn.end();
                    ++it_v)
                 {
-                  v.insert(*it_v);
+		  symtab->gc()->add_reference(src_obj, src_indx,
+					      it_v->first, it_v->second);
                 }
             }
         }
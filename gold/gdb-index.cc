@@ -28,6 +28,10 @@
 #include "object.h"
 #include "output.h"
 #include "demangle.h"
+#include "workqueue.h"
+#include "errors.h"
+#include "link-cache.h"
+#include "stats.h"
 
 namespace gold
 {
@@ -171,6 +175,276 @@ mapped_index_string_hash(const unsigned char* str)
   return r;
 }
 
+// This class holds the results of scanning the .debug_info and
+// .debug_types sections of one input object.  The CU and TU indexes
+// it records are local to the object, and are renumbered when the
+// results are added to the index.  When running with threads, each
+// object is scanned in its own task, and the results are added to the
+// index in input order, so the contents of the .gdb_index section do
+// not depend on the number of threads.
+
+class Gdb_index_scan
+{
+ public:
+  // An entry in the type unit list.
+  struct Type_unit
+  {
+    Type_unit(off_t off, off_t toff, uint64_t sig)
+      : tu_offset(off), type_offset(toff), type_signature(sig)
+    { }
+    off_t tu_offset;
+    off_t type_offset;
+    uint64_t type_signature;
+  };
+
+  // A symbol to add to the index.  The name is at NAME_OFFSET in
+  // the names buffer.
+  struct Symbol
+  {
+    Symbol(size_t off, unsigned int hash, int index, uint8_t f)
+      : name_offset(off), hashval(hash), cu_index(index), flags(f)
+    { }
+    size_t name_offset;
+    unsigned int hashval;
+    int cu_index;
+    uint8_t flags;
+  };
+
+  typedef std::vector<std::pair<off_t, off_t> > Comp_unit_list;
+  typedef std::vector<Type_unit> Type_unit_list;
+  // An address range.  We do not check here whether SHNDX is
+  // included in the link, so that the results depend only on the
+  // contents of the object; that is done when the results are added
+  // to the index.
+  struct Range
+  {
+    Range(int index, unsigned int sec, off_t s, off_t e)
+      : cu_index(index), shndx(sec), start(s), end(e)
+    { }
+    int cu_index;
+    unsigned int shndx;
+    off_t start;
+    off_t end;
+  };
+
+  typedef std::vector<Range> Range_list;
+  typedef std::vector<Symbol> Symbol_list;
+
+  // If COPY_SYMBOLS is true, the scan is deferred, so we keep a copy
+  // of the symbol table, which will be gone by the time we read it.
+  Gdb_index_scan(Relobj* object, const unsigned char* symbols,
+		 off_t symbols_size, bool copy_symbols);
+
+  ~Gdb_index_scan();
+
+  // The object being scanned.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // Scan a .debug_info or .debug_types section now.
+  void
+  scan_section(bool is_type_unit, unsigned int shndx,
+	       unsigned int reloc_shndx, unsigned int reloc_type);
+
+  // Record a .debug_info or .debug_types section to scan later.
+  void
+  defer_section(bool is_type_unit, unsigned int shndx,
+		unsigned int reloc_shndx, unsigned int reloc_type)
+  {
+    this->deferred_sections_.push_back(Deferred_section(is_type_unit, shndx,
+							 reloc_shndx,
+							 reloc_type));
+  }
+
+  // Scan the sections recorded by defer_section.
+  void
+  scan_deferred_sections();
+
+  // Add a compilation unit.
+  int
+  add_comp_unit(off_t cu_offset, off_t cu_length)
+  {
+    ++this->cu_count_;
+    this->comp_units_.push_back(std::make_pair(cu_offset, cu_length));
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a type unit.
+  int
+  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  {
+    ++this->tu_count_;
+    this->type_units_.push_back(Type_unit(tu_offset, type_offset, signature));
+    return this->type_units_.size() - 1;
+  }
+
+  // Record that the CU or TU being visited has no pubnames or
+  // pubtypes.
+  void
+  add_unit_without_pubnames(bool is_type_unit)
+  {
+    if (is_type_unit)
+      ++this->tu_nopubnames_count_;
+    else
+      ++this->cu_nopubnames_count_;
+  }
+
+  // Add an address range.
+  void
+  add_address_range(int cu_index, unsigned int shndx, off_t start, off_t end)
+  { this->ranges_.push_back(Range(cu_index, shndx, start, end)); }
+
+  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
+  // the high-byte of the cu_index field.
+  void
+  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
+
+  // Return the offset into the pubnames table for the cu at the given
+  // offset.
+  off_t
+  find_pubname_offset(off_t cu_offset);
+
+  // Return the offset into the pubtypes table for the cu at the
+  // given offset.
+  off_t
+  find_pubtype_offset(off_t cu_offset);
+
+  // Return TRUE if we have already processed the pubnames and types
+  // set of the CUs and TUS associated with the statement list at
+  // OFFSET.
+  bool
+  pubnames_read(off_t offset) const
+  { return this->stmt_list_offset_ == offset; }
+
+  // Record that we have already read the pubnames associated with
+  // OFFSET.
+  void
+  set_pubnames_read(off_t offset)
+  { this->stmt_list_offset_ = offset; }
+
+  // Return a pointer to the given table.
+  Dwarf_pubnames_table*
+  pubnames_table()
+  { return this->pubnames_table_; }
+
+  Dwarf_pubnames_table*
+  pubtypes_table()
+  { return this->pubtypes_table_; }
+
+  // Accessors for the results.
+  const Comp_unit_list&
+  comp_units() const
+  { return this->comp_units_; }
+
+  const Type_unit_list&
+  type_units() const
+  { return this->type_units_; }
+
+  const Range_list&
+  ranges() const
+  { return this->ranges_; }
+
+  const Symbol_list&
+  symbols() const
+  { return this->symbols_; }
+
+  // Return the name of a symbol.
+  const char*
+  symbol_name(const Symbol& sym) const
+  { return this->names_.data() + sym.name_offset; }
+
+  // Add the statistics of this scan to the totals, and clear the
+  // results, which have been added to the index.
+  void
+  clear_results();
+
+  // Print usage statistics.
+  static void
+  print_stats();
+
+ private:
+  // A .debug_info or .debug_types section to scan later.
+  struct Deferred_section
+  {
+    Deferred_section(bool is_tu, unsigned int sec, unsigned int reloc_sec,
+		     unsigned int rel_type)
+      : is_type_unit(is_tu), shndx(sec), reloc_shndx(reloc_sec),
+	reloc_type(rel_type)
+    { }
+    bool is_type_unit;
+    unsigned int shndx;
+    unsigned int reloc_shndx;
+    unsigned int reloc_type;
+  };
+
+  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
+
+  // Create a map from dies to pubnames.
+  Dwarf_pubnames_table*
+  map_pubtable_to_dies(unsigned int attr, Gdb_index_info_reader* dwinfo);
+
+  // Wrapper for map_pubtable_to_dies
+  void
+  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo);
+
+  // Compute the link cache key for the deferred sections.  Returns
+  // false if the results can not be cached.
+  bool
+  link_cache_key(Link_cache_key* key) const;
+
+  // Read the results from a link cache entry.  Returns false if the
+  // entry is not valid.
+  bool
+  read_cache_entry(const unsigned char* data, size_t size);
+
+  // Write the results as a link cache entry.
+  void
+  write_cache_entry(std::string* buf) const;
+
+  // The object being scanned.
+  Relobj* object_;
+  // The symbol table of the object, and whether we own it.
+  const unsigned char* symtab_;
+  off_t symtab_size_;
+  bool owns_symtab_;
+  // The sections to scan later.
+  std::vector<Deferred_section> deferred_sections_;
+  // Maps from CU offsets to the offsets in the pubnames and pubtypes
+  // sections of the object.
+  Pubname_offset_map cu_pubname_map_;
+  Pubname_offset_map cu_pubtype_map_;
+  // Tables to store the pubnames section of the object, once they
+  // have been read.
+  bool pubnames_mapped_;
+  Dwarf_pubnames_table* pubnames_table_;
+  Dwarf_pubnames_table* pubtypes_table_;
+  // Stmt list offset of the CUs and TUs associated with the last read
+  // pubnames and pubtypes sections.
+  off_t stmt_list_offset_;
+  // The results of the scan.
+  Comp_unit_list comp_units_;
+  Type_unit_list type_units_;
+  Range_list ranges_;
+  Symbol_list symbols_;
+  // The names of the symbols, each terminated by a null byte.
+  std::string names_;
+  // Statistics for this scan.
+  unsigned int cu_count_;
+  unsigned int cu_nopubnames_count_;
+  unsigned int tu_count_;
+  unsigned int tu_nopubnames_count_;
+
+  // Total number of DWARF compilation units processed.
+  static unsigned int dwarf_cu_count;
+  // Number of DWARF compilation units with pubnames/pubtypes.
+  static unsigned int dwarf_cu_nopubnames_count;
+  // Total number of DWARF type units processed.
+  static unsigned int dwarf_tu_count;
+  // Number of DWARF type units with pubnames/pubtypes.
+  static unsigned int dwarf_tu_nopubnames_count;
+};
+
 // A specialization of Dwarf_info_reader, for building the .gdb_index.
 
 class Gdb_index_info_reader : public Dwarf_info_reader
@@ -183,19 +457,15 @@ class Gdb_index_info_reader : public Dwarf_info_reader
 			unsigned int shndx,
 			unsigned int reloc_shndx,
 			unsigned int reloc_type,
-			Gdb_index* gdb_index)
+			Gdb_index_scan* scan)
     : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
 			reloc_shndx, reloc_type),
-      gdb_index_(gdb_index), cu_index_(0), cu_language_(0)
+      scan_(scan), cu_index_(0), cu_language_(0)
   { }
 
   ~Gdb_index_info_reader()
   { this->clear_declarations(); }
 
-  // Print usage statistics.
-  static void
-  print_stats();
-
  protected:
   // Visit a compilation unit.
   virtual void
@@ -285,8 +555,8 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   void
   clear_declarations();
 
-  // The Gdb_index section.
-  Gdb_index* gdb_index_;
+  // The scan of the object, which collects the results.
+  Gdb_index_scan* scan_;
   // The current CU index (negative for a TU).
   int cu_index_;
   // The language of the current CU or TU.
@@ -294,35 +564,15 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   // Map from DIE offset to (parent offset, name) pair,
   // for DW_AT_specification.
   Declaration_map declarations_;
-
-  // Statistics.
-  // Total number of DWARF compilation units processed.
-  static unsigned int dwarf_cu_count;
-  // Number of DWARF compilation units with pubnames/pubtypes.
-  static unsigned int dwarf_cu_nopubnames_count;
-  // Total number of DWARF type units processed.
-  static unsigned int dwarf_tu_count;
-  // Number of DWARF type units with pubnames/pubtypes.
-  static unsigned int dwarf_tu_nopubnames_count;
 };
 
-// Total number of DWARF compilation units processed.
-unsigned int Gdb_index_info_reader::dwarf_cu_count = 0;
-// Number of DWARF compilation units without pubnames/pubtypes.
-unsigned int Gdb_index_info_reader::dwarf_cu_nopubnames_count = 0;
-// Total number of DWARF type units processed.
-unsigned int Gdb_index_info_reader::dwarf_tu_count = 0;
-// Number of DWARF type units without pubnames/pubtypes.
-unsigned int Gdb_index_info_reader::dwarf_tu_nopubnames_count = 0;
-
 // Process a compilation unit and parse its child DIE.
 
 void
 Gdb_index_info_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
 					      Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_cu_count;
-  this->cu_index_ = this->gdb_index_->add_comp_unit(cu_offset, cu_length);
+  this->cu_index_ = this->scan_->add_comp_unit(cu_offset, cu_length);
   this->visit_top_die(root_die);
 }
 
@@ -333,10 +583,9 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 				       off_t type_offset, uint64_t signature,
 				       Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_tu_count;
   // Use a negative index to flag this as a TU instead of a CU.
-  this->cu_index_ = -1 - this->gdb_index_->add_type_unit(tu_offset, type_offset,
-							 signature);
+  this->cu_index_ = -1 - this->scan_->add_type_unit(tu_offset, type_offset,
+						    signature);
   this->visit_top_die(root_die);
 }
 
@@ -380,10 +629,8 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 			     this->object()->name().c_str());
 		return;
 	      }
-	    if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	      ++Gdb_index_info_reader::dwarf_cu_nopubnames_count;
-	    else
-	      ++Gdb_index_info_reader::dwarf_tu_nopubnames_count;
+	    this->scan_->add_unit_without_pubnames(
+		die->tag() != elfcpp::DW_TAG_compile_unit);
 	    this->visit_children(die, NULL);
 	  }
 	break;
@@ -437,8 +684,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	    // If the DIE is not a declaration, add it to the index.
 	    std::string full_name = this->get_qualified_name(die, context);
 	    if (!full_name.empty())
-	      this->gdb_index_->add_symbol(this->cu_index_,
-                                           full_name.c_str(), 0);
+	      this->scan_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	  }
 	break;
       case elfcpp::DW_TAG_typedef:
@@ -477,8 +723,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	      if (full_name.empty())
 		full_name = this->get_qualified_name(die, context);
 	      if (!full_name.empty())
-		this->gdb_index_->add_symbol(this->cu_index_,
-					     full_name.c_str(), 0);
+		this->scan_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	    }
 
 	  // We're interested in the children only for namespaces and
@@ -825,8 +1070,15 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
     {
       Dwarf_range_list* ranges = this->read_range_list(shndx, ranges_offset);
       if (ranges != NULL)
-	this->gdb_index_->add_address_range_list(this->object(),
-						 this->cu_index_, ranges);
+	{
+	  for (unsigned int i = 0; i < ranges->size(); ++i)
+	    {
+	      const Dwarf_range_list::Range& range = (*ranges)[i];
+	      this->scan_->add_address_range(this->cu_index_, range.shndx,
+					     range.start, range.end);
+	    }
+	  delete ranges;
+	}
       return;
     }
 
@@ -847,13 +1099,8 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
 		       this->object()->name().c_str());
 	  return;
 	}
-      if (shndx == 0 || this->object()->is_section_included(shndx))
-        {
-	  Dwarf_range_list* ranges = new Dwarf_range_list();
-	  ranges->add(shndx, low_pc, high_pc);
-	  this->gdb_index_->add_address_range_list(this->object(),
-						   this->cu_index_, ranges);
-        }
+      this->scan_->add_address_range(this->cu_index_, shndx, low_pc,
+				     high_pc);
     }
 }
 
@@ -877,7 +1124,7 @@ Gdb_index_info_reader::read_pubtable(Dwarf_pubnames_table* table, off_t offset)
       if (name == NULL)
         break;
 
-      this->gdb_index_->add_symbol(this->cu_index_, name, flag_byte);
+      this->scan_->add_symbol(this->cu_index_, name, flag_byte);
     }
   return true;
 }
@@ -916,8 +1163,7 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
           // have read. If it does, then no need to read the pubnames.
           // If it doesn't, then the caller will have to parse the
           // dies manually to find the names.
-          return this->gdb_index_->pubnames_read(this->object(),
-                                                 stmt_list_off);
+          return this->scan_->pubnames_read(stmt_list_off);
         }
       else
         {
@@ -928,10 +1174,10 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
 
   // We found the attribute, so we can check if the corresponding
   // pubnames have been read.
-  if (this->gdb_index_->pubnames_read(this->object(), stmt_list_off))
+  if (this->scan_->pubnames_read(stmt_list_off))
     return true;
 
-  this->gdb_index_->set_pubnames_read(this->object(), stmt_list_off);
+  this->scan_->set_pubnames_read(stmt_list_off);
 
   // We have an attribute, and the pubnames haven't been read, so read
   // them.
@@ -939,12 +1185,12 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
   // In some of the cases, we could rely on the previous value of
   // offset here, but sorting out which cases complicates the logic
   // enough that it isn't worth it. So just look up the offset again.
-  offset = this->gdb_index_->find_pubname_offset(this->cu_offset());
-  names = this->read_pubtable(this->gdb_index_->pubnames_table(), offset);
+  offset = this->scan_->find_pubname_offset(this->cu_offset());
+  names = this->read_pubtable(this->scan_->pubnames_table(), offset);
 
   bool types = false;
-  offset = this->gdb_index_->find_pubtype_offset(this->cu_offset());
-  types = this->read_pubtable(this->gdb_index_->pubtypes_table(), offset);
+  offset = this->scan_->find_pubtype_offset(this->cu_offset());
+  types = this->read_pubtable(this->scan_->pubtypes_table(), offset);
   return names || types;
 }
 
@@ -964,67 +1210,51 @@ Gdb_index_info_reader::clear_declarations()
   this->declarations_.clear();
 }
 
-// Print usage statistics.
-void
-Gdb_index_info_reader::print_stats()
-{
-  fprintf(stderr, _("%s: DWARF CUs: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_cu_count);
-  fprintf(stderr, _("%s: DWARF CUs without pubnames/pubtypes: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_cu_nopubnames_count);
-  fprintf(stderr, _("%s: DWARF TUs: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_tu_count);
-  fprintf(stderr, _("%s: DWARF TUs without pubnames/pubtypes: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_tu_nopubnames_count);
-}
+// Class Gdb_index_scan.
 
-// Class Gdb_index.
-
-// Construct the .gdb_index section.
-
-Gdb_index::Gdb_index(Output_section* gdb_index_section)
-  : Output_section_data(4),
-    pubnames_table_(NULL),
-    pubtypes_table_(NULL),
-    gdb_index_section_(gdb_index_section),
-    comp_units_(),
-    type_units_(),
-    ranges_(),
-    cu_vector_list_(),
-    cu_vector_offsets_(NULL),
-    stringpool_(),
-    tu_offset_(0),
-    addr_offset_(0),
-    symtab_offset_(0),
-    cu_pool_offset_(0),
-    stringpool_offset_(0),
-    pubnames_object_(NULL),
-    stmt_list_offset_(-1)
+// Total number of DWARF compilation units processed.
+unsigned int Gdb_index_scan::dwarf_cu_count = 0;
+// Number of DWARF compilation units without pubnames/pubtypes.
+unsigned int Gdb_index_scan::dwarf_cu_nopubnames_count = 0;
+// Total number of DWARF type units processed.
+unsigned int Gdb_index_scan::dwarf_tu_count = 0;
+// Number of DWARF type units without pubnames/pubtypes.
+unsigned int Gdb_index_scan::dwarf_tu_nopubnames_count = 0;
+
+Gdb_index_scan::Gdb_index_scan(Relobj* object, const unsigned char* symbols,
+			       off_t symbols_size, bool copy_symbols)
+  : object_(object), symtab_(symbols), symtab_size_(symbols_size),
+    owns_symtab_(false), deferred_sections_(), cu_pubname_map_(),
+    cu_pubtype_map_(), pubnames_mapped_(false), pubnames_table_(NULL),
+    pubtypes_table_(NULL), stmt_list_offset_(-1), comp_units_(),
+    type_units_(), ranges_(), symbols_(), names_(), cu_count_(0),
+    cu_nopubnames_count_(0), tu_count_(0), tu_nopubnames_count_(0)
 {
-  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+  if (copy_symbols && symbols != NULL)
+    {
+      unsigned char* copy = new unsigned char[symbols_size];
+      memcpy(copy, symbols, symbols_size);
+      this->symtab_ = copy;
+      this->owns_symtab_ = true;
+    }
 }
 
-Gdb_index::~Gdb_index()
+Gdb_index_scan::~Gdb_index_scan()
 {
-  // Free the memory used by the symbol table.
-  delete this->gdb_symtab_;
-  // Free the memory used by the CU vectors.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
-    delete this->cu_vector_list_[i];
+  if (this->owns_symtab_)
+    delete[] this->symtab_;
+  delete this->pubnames_table_;
+  delete this->pubtypes_table_;
 }
 
-
 // Scan the pubnames and pubtypes sections and build a map of the
 // various cus and tus they refer to, so we can process the entries
 // when we encounter the die for that cu or tu.
 // Return the just-read table so it can be cached.
 
 Dwarf_pubnames_table*
-Gdb_index::map_pubtable_to_dies(unsigned int attr,
-                                Gdb_index_info_reader* dwinfo,
-                                Relobj* object,
-                                const unsigned char* symbols,
-                                off_t symbols_size)
+Gdb_index_scan::map_pubtable_to_dies(unsigned int attr,
+				     Gdb_index_info_reader* dwinfo)
 {
   uint64_t section_offset = 0;
   Dwarf_pubnames_table* table;
@@ -1042,7 +1272,8 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
     }
 
   map->clear();
-  if (!table->read_section(object, symbols, symbols_size))
+  if (!table->read_section(this->object_, this->symtab_,
+			   this->symtab_size_))
     return NULL;
 
   while (table->read_header(section_offset))
@@ -1057,30 +1288,22 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
 // Wrapper for map_pubtable_to_dies
 
 void
-Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                          Relobj* object,
-                                          const unsigned char* symbols,
-                                          off_t symbols_size)
+Gdb_index_scan::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo)
 {
-  // This is a new object, so reset the relevant variables.
-  this->pubnames_object_ = object;
+  this->pubnames_mapped_ = true;
   this->stmt_list_offset_ = -1;
 
-  delete this->pubnames_table_;
   this->pubnames_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo,
-                                   object, symbols, symbols_size);
-  delete this->pubtypes_table_;
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo);
   this->pubtypes_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo,
-                                   object, symbols, symbols_size);
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo);
 }
 
 // Given a cu_offset, find the associated section of the pubnames
 // table.
 
 off_t
-Gdb_index::find_pubname_offset(off_t cu_offset)
+Gdb_index_scan::find_pubname_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
   if (it != this->cu_pubname_map_.end())
@@ -1092,7 +1315,7 @@ Gdb_index::find_pubname_offset(off_t cu_offset)
 // table.
 
 off_t
-Gdb_index::find_pubtype_offset(off_t cu_offset)
+Gdb_index_scan::find_pubtype_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
   if (it != this->cu_pubtype_map_.end())
@@ -1102,6 +1325,531 @@ Gdb_index::find_pubtype_offset(off_t cu_offset)
 
 // Scan a .debug_info or .debug_types input section.
 
+void
+Gdb_index_scan::scan_section(bool is_type_unit, unsigned int shndx,
+			     unsigned int reloc_shndx,
+			     unsigned int reloc_type)
+{
+  Gdb_index_info_reader dwinfo(is_type_unit, this->object_,
+			       this->symtab_, this->symtab_size_,
+			       shndx, reloc_shndx, reloc_type, this);
+  if (!this->pubnames_mapped_)
+    this->map_pubnames_and_types_to_dies(&dwinfo);
+  dwinfo.parse();
+}
+
+// The kind of the link cache entries which hold the results of a
+// scan, and the version of their format.  The version must be changed
+// whenever the format or the results of a scan change.
+
+static const char gdb_index_cache_kind[] = "gdb-index";
+static const uint64_t gdb_index_cache_version = 1;
+
+// The records in a link cache entry.  They are written in host byte
+// order, and an entry written by a host of the other byte order is
+// rejected by the check of the byte_order field.  The entry starts
+// with a header, followed by the CUs, TUs, ranges and symbols, and
+// then by the symbol names.
+
+struct Gdb_index_cache_header
+{
+  char magic[8];
+  uint32_t byte_order;
+  uint32_t cu_count;
+  uint32_t cu_nopubnames_count;
+  uint32_t tu_count;
+  uint32_t tu_nopubnames_count;
+  uint32_t pad;
+  uint64_t comp_unit_count;
+  uint64_t type_unit_count;
+  uint64_t range_count;
+  uint64_t symbol_count;
+  uint64_t names_size;
+};
+
+static const char gdb_index_cache_magic[8] =
+  { 'G', 'D', 'B', 'I', 'D', 'X', '0', '1' };
+static const uint32_t gdb_index_cache_byte_order = 0x01020304;
+
+struct Gdb_index_cache_comp_unit
+{
+  uint64_t cu_offset;
+  uint64_t cu_length;
+};
+
+struct Gdb_index_cache_type_unit
+{
+  uint64_t tu_offset;
+  uint64_t type_offset;
+  uint64_t type_signature;
+};
+
+struct Gdb_index_cache_range
+{
+  int32_t cu_index;
+  uint32_t shndx;
+  int64_t start;
+  int64_t end;
+};
+
+struct Gdb_index_cache_symbol
+{
+  uint64_t name_offset;
+  uint32_t hashval;
+  int32_t cu_index;
+  uint32_t flags;
+  uint32_t pad;
+};
+
+// Append a record to a link cache entry.
+
+template<typename T>
+static inline void
+append_cache_record(std::string* buf, const T& rec)
+{ buf->append(reinterpret_cast<const char*>(&rec), sizeof rec); }
+
+// Read a record from a link cache entry, advancing *PP.
+
+template<typename T>
+static inline void
+read_cache_record(const unsigned char** pp, T* rec)
+{
+  memcpy(rec, *pp, sizeof *rec);
+  *pp += sizeof *rec;
+}
+
+// Compute the link cache key for the deferred sections.  The results
+// depend only on the unallocated sections of the object, except that
+// when a section has no relocations the reader may look at where the
+// sections were placed in the output, so we do not cache those.
+
+bool
+Gdb_index_scan::link_cache_key(Link_cache_key* key) const
+{
+  key->add_uint64(gdb_index_cache_version);
+  for (std::vector<Deferred_section>::const_iterator p =
+	 this->deferred_sections_.begin();
+       p != this->deferred_sections_.end();
+       ++p)
+    {
+      if (p->reloc_shndx == 0)
+	return false;
+      key->add_uint64(p->is_type_unit);
+      key->add_uint64(p->shndx);
+      key->add_uint64(p->reloc_shndx);
+      key->add_uint64(p->reloc_type);
+    }
+  key->add_unallocated_sections(this->object_);
+  key->finish();
+  return true;
+}
+
+// Read the results from a link cache entry.
+
+bool
+Gdb_index_scan::read_cache_entry(const unsigned char* data, size_t size)
+{
+  Gdb_index_cache_header hdr;
+  if (size < sizeof hdr)
+    return false;
+  const unsigned char* p = data;
+  read_cache_record(&p, &hdr);
+  if (memcmp(hdr.magic, gdb_index_cache_magic, sizeof hdr.magic) != 0
+      || hdr.byte_order != gdb_index_cache_byte_order)
+    return false;
+
+  uint64_t records_size =
+    (hdr.comp_unit_count * sizeof(Gdb_index_cache_comp_unit)
+     + hdr.type_unit_count * sizeof(Gdb_index_cache_type_unit)
+     + hdr.range_count * sizeof(Gdb_index_cache_range)
+     + hdr.symbol_count * sizeof(Gdb_index_cache_symbol));
+  if (hdr.comp_unit_count > size
+      || hdr.type_unit_count > size
+      || hdr.range_count > size
+      || hdr.symbol_count > size
+      || sizeof hdr + records_size + hdr.names_size != size
+      || (hdr.names_size > 0
+	  && data[size - 1] != '\0'))
+    return false;
+
+  this->comp_units_.reserve(hdr.comp_unit_count);
+  for (uint64_t i = 0; i < hdr.comp_unit_count; ++i)
+    {
+      Gdb_index_cache_comp_unit rec;
+      read_cache_record(&p, &rec);
+      this->comp_units_.push_back(std::make_pair(rec.cu_offset,
+						 rec.cu_length));
+    }
+
+  this->type_units_.reserve(hdr.type_unit_count);
+  for (uint64_t i = 0; i < hdr.type_unit_count; ++i)
+    {
+      Gdb_index_cache_type_unit rec;
+      read_cache_record(&p, &rec);
+      this->type_units_.push_back(Type_unit(rec.tu_offset, rec.type_offset,
+					    rec.type_signature));
+    }
+
+  this->ranges_.reserve(hdr.range_count);
+  for (uint64_t i = 0; i < hdr.range_count; ++i)
+    {
+      Gdb_index_cache_range rec;
+      read_cache_record(&p, &rec);
+      this->ranges_.push_back(Range(rec.cu_index, rec.shndx, rec.start,
+				    rec.end));
+    }
+
+  this->symbols_.reserve(hdr.symbol_count);
+  for (uint64_t i = 0; i < hdr.symbol_count; ++i)
+    {
+      Gdb_index_cache_symbol rec;
+      read_cache_record(&p, &rec);
+      if (rec.name_offset >= hdr.names_size)
+	return false;
+      this->symbols_.push_back(Symbol(rec.name_offset, rec.hashval,
+				      rec.cu_index, rec.flags));
+    }
+
+  this->names_.assign(reinterpret_cast<const char*>(p), hdr.names_size);
+
+  this->cu_count_ = hdr.cu_count;
+  this->cu_nopubnames_count_ = hdr.cu_nopubnames_count;
+  this->tu_count_ = hdr.tu_count;
+  this->tu_nopubnames_count_ = hdr.tu_nopubnames_count;
+  return true;
+}
+
+// Write the results as a link cache entry.
+
+void
+Gdb_index_scan::write_cache_entry(std::string* buf) const
+{
+  Gdb_index_cache_header hdr;
+  memset(&hdr, 0, sizeof hdr);
+  memcpy(hdr.magic, gdb_index_cache_magic, sizeof hdr.magic);
+  hdr.byte_order = gdb_index_cache_byte_order;
+  hdr.cu_count = this->cu_count_;
+  hdr.cu_nopubnames_count = this->cu_nopubnames_count_;
+  hdr.tu_count = this->tu_count_;
+  hdr.tu_nopubnames_count = this->tu_nopubnames_count_;
+  hdr.comp_unit_count = this->comp_units_.size();
+  hdr.type_unit_count = this->type_units_.size();
+  hdr.range_count = this->ranges_.size();
+  hdr.symbol_count = this->symbols_.size();
+  hdr.names_size = this->names_.size();
+  append_cache_record(buf, hdr);
+
+  for (Comp_unit_list::const_iterator p = this->comp_units_.begin();
+       p != this->comp_units_.end();
+       ++p)
+    {
+      Gdb_index_cache_comp_unit rec;
+      rec.cu_offset = p->first;
+      rec.cu_length = p->second;
+      append_cache_record(buf, rec);
+    }
+
+  for (Type_unit_list::const_iterator p = this->type_units_.begin();
+       p != this->type_units_.end();
+       ++p)
+    {
+      Gdb_index_cache_type_unit rec;
+      rec.tu_offset = p->tu_offset;
+      rec.type_offset = p->type_offset;
+      rec.type_signature = p->type_signature;
+      append_cache_record(buf, rec);
+    }
+
+  for (Range_list::const_iterator p = this->ranges_.begin();
+       p != this->ranges_.end();
+       ++p)
+    {
+      Gdb_index_cache_range rec;
+      rec.cu_index = p->cu_index;
+      rec.shndx = p->shndx;
+      rec.start = p->start;
+      rec.end = p->end;
+      append_cache_record(buf, rec);
+    }
+
+  for (Symbol_list::const_iterator p = this->symbols_.begin();
+       p != this->symbols_.end();
+       ++p)
+    {
+      Gdb_index_cache_symbol rec;
+      memset(&rec, 0, sizeof rec);
+      rec.name_offset = p->name_offset;
+      rec.hashval = p->hashval;
+      rec.cu_index = p->cu_index;
+      rec.flags = p->flags;
+      append_cache_record(buf, rec);
+    }
+
+  buf->append(this->names_);
+}
+
+// Scan the sections recorded by defer_section, then free the copy of
+// the symbol table.  If --link-cache is used, we first look for the
+// results of an earlier scan of the same sections, and store the
+// results of this scan for later links.
+
+void
+Gdb_index_scan::scan_deferred_sections()
+{
+  Link_cache* link_cache = parameters->link_cache();
+  Link_cache_key key(gdb_index_cache_kind);
+  bool use_cache = (link_cache != NULL
+		    && !this->deferred_sections_.empty()
+		    && this->link_cache_key(&key));
+
+  bool scanned = false;
+  if (use_cache)
+    {
+      Link_cache_entry* entry = link_cache->find(gdb_index_cache_kind, key);
+      if (entry != NULL)
+	{
+	  scanned = this->read_cache_entry(entry->data(), entry->size());
+	  delete entry;
+	  if (!scanned)
+	    {
+	      this->comp_units_.clear();
+	      this->type_units_.clear();
+	      this->ranges_.clear();
+	      this->symbols_.clear();
+	      this->names_.clear();
+	    }
+	}
+    }
+
+  if (!scanned)
+    {
+      // Don't cache the results if the scan reports a problem, as
+      // reading them back would lose the message.
+      const Errors* errors = parameters->errors();
+      int messages = errors->error_count() + errors->warning_count();
+
+      for (std::vector<Deferred_section>::const_iterator p =
+	     this->deferred_sections_.begin();
+	   p != this->deferred_sections_.end();
+	   ++p)
+	this->scan_section(p->is_type_unit, p->shndx, p->reloc_shndx,
+			   p->reloc_type);
+
+      if (use_cache
+	  && messages == errors->error_count() + errors->warning_count())
+	{
+	  std::string buf;
+	  this->write_cache_entry(&buf);
+	  link_cache->store(gdb_index_cache_kind, key, buf.data(),
+			    buf.size());
+	}
+    }
+
+  std::vector<Deferred_section>().swap(this->deferred_sections_);
+
+  delete this->pubnames_table_;
+  this->pubnames_table_ = NULL;
+  delete this->pubtypes_table_;
+  this->pubtypes_table_ = NULL;
+  if (this->owns_symtab_)
+    {
+      delete[] this->symtab_;
+      this->symtab_ = NULL;
+      this->owns_symtab_ = false;
+    }
+}
+
+// Add a symbol.  We compute the hash code here, so that it is done
+// in parallel when running with threads.
+
+void
+Gdb_index_scan::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+{
+  unsigned int hash = mapped_index_string_hash(
+      reinterpret_cast<const unsigned char*>(sym_name));
+  this->symbols_.push_back(Symbol(this->names_.size(), hash, cu_index, flags));
+  this->names_.append(sym_name, strlen(sym_name) + 1);
+}
+
+// Add the statistics to the totals and clear the results.
+
+void
+Gdb_index_scan::clear_results()
+{
+  Gdb_index_scan::dwarf_cu_count += this->cu_count_;
+  Gdb_index_scan::dwarf_cu_nopubnames_count += this->cu_nopubnames_count_;
+  Gdb_index_scan::dwarf_tu_count += this->tu_count_;
+  Gdb_index_scan::dwarf_tu_nopubnames_count += this->tu_nopubnames_count_;
+  this->cu_count_ = 0;
+  this->cu_nopubnames_count_ = 0;
+  this->tu_count_ = 0;
+  this->tu_nopubnames_count_ = 0;
+
+  this->comp_units_.clear();
+  this->type_units_.clear();
+  this->ranges_.clear();
+  this->symbols_.clear();
+  this->names_.clear();
+}
+
+// Print usage statistics.
+void
+Gdb_index_scan::print_stats()
+{
+  if (parameters->options().stats())
+    {
+      fprintf(stderr, _("%s: DWARF CUs: %u\n"),
+	      program_name, Gdb_index_scan::dwarf_cu_count);
+      fprintf(stderr, _("%s: DWARF CUs without pubnames/pubtypes: %u\n"),
+	      program_name, Gdb_index_scan::dwarf_cu_nopubnames_count);
+      fprintf(stderr, _("%s: DWARF TUs: %u\n"),
+	      program_name, Gdb_index_scan::dwarf_tu_count);
+      fprintf(stderr, _("%s: DWARF TUs without pubnames/pubtypes: %u\n"),
+	      program_name, Gdb_index_scan::dwarf_tu_nopubnames_count);
+    }
+  record_stat("DWARF CUs", Gdb_index_scan::dwarf_cu_count);
+  record_stat("DWARF CUs without pubnames/pubtypes",
+	      Gdb_index_scan::dwarf_cu_nopubnames_count);
+  record_stat("DWARF TUs", Gdb_index_scan::dwarf_tu_count);
+  record_stat("DWARF TUs without pubnames/pubtypes",
+	      Gdb_index_scan::dwarf_tu_nopubnames_count);
+}
+
+// This task scans the .debug_info and .debug_types sections of one
+// input object.
+
+class Gdb_index_scan_task : public Task
+{
+ public:
+  Gdb_index_scan_task(Gdb_index_scan* scan, Task_token* scanned_blocker)
+    : scan_(scan), scanned_blocker_(scanned_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->scan_->object()->is_locked())
+      return this->scan_->object()->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    tl->add(this, this->scanned_blocker_);
+    Task_token* token = this->scan_->object()->token();
+    if (token != NULL)
+      tl->add(this, token);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->scan_->scan_deferred_sections();
+    this->scan_->object()->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_scan_task " + this->scan_->object()->name(); }
+
+ private:
+  Gdb_index_scan* scan_;
+  Task_token* scanned_blocker_;
+};
+
+// This task adds the results of the scans to the index, in input
+// order.  It runs after all the scans are done, and after
+// THIS_BLOCKER, which it takes over, is released.
+
+class Gdb_index_add_scans_task : public Task
+{
+ public:
+  Gdb_index_add_scans_task(Gdb_index* gdb_index, Task_token* this_blocker,
+			   Task_token* scanned_blocker,
+			   Task_token* next_blocker)
+    : gdb_index_(gdb_index), this_blocker_(this_blocker),
+      scanned_blocker_(scanned_blocker), next_blocker_(next_blocker)
+  { }
+
+  ~Gdb_index_add_scans_task()
+  {
+    delete this->this_blocker_;
+    delete this->scanned_blocker_;
+  }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    if (this->scanned_blocker_->is_blocked())
+      return this->scanned_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->gdb_index_->add_deferred_scans(); }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_add_scans_task"; }
+
+ private:
+  Gdb_index* gdb_index_;
+  Task_token* this_blocker_;
+  Task_token* scanned_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Class Gdb_index.
+
+// Construct the .gdb_index section.
+
+Gdb_index::Gdb_index(Output_section* gdb_index_section)
+  : Output_section_data(4),
+    gdb_index_section_(gdb_index_section),
+    comp_units_(),
+    type_units_(),
+    ranges_(),
+    cu_vector_list_(),
+    cu_vector_offsets_(NULL),
+    stringpool_(),
+    tu_offset_(0),
+    addr_offset_(0),
+    symtab_offset_(0),
+    cu_pool_offset_(0),
+    stringpool_offset_(0),
+    scans_()
+{
+  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+}
+
+Gdb_index::~Gdb_index()
+{
+  // Free the memory used by the symbol table.
+  delete this->gdb_symtab_;
+  // Free the memory used by the CU vectors.
+  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+    delete this->cu_vector_list_[i];
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    delete this->scans_[i];
+}
+
+// Scan a .debug_info or .debug_types input section.  All the sections
+// of an object are passed in a row.  When running with threads or
+// with --link-cache, we only record the section, and queue_scan_tasks
+// will scan it later.
+
 void
 Gdb_index::scan_debug_info(bool is_type_unit,
 			   Relobj* object,
@@ -1111,22 +1859,139 @@ Gdb_index::scan_debug_info(bool is_type_unit,
 			   unsigned int reloc_shndx,
 			   unsigned int reloc_type)
 {
-  Gdb_index_info_reader dwinfo(is_type_unit, object,
-			       symbols, symbols_size,
-			       shndx, reloc_shndx,
-			       reloc_type, this);
-  if (object != this->pubnames_object_)
-    map_pubnames_and_types_to_dies(&dwinfo, object, symbols, symbols_size);
-  dwinfo.parse();
+  const bool defer = ((parameters->options().threads()
+		       || parameters->link_cache() != NULL)
+		      && !parameters->incremental());
+
+  if (this->scans_.empty() || this->scans_.back()->object() != object)
+    {
+      if (!defer)
+	{
+	  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+	    delete this->scans_[i];
+	  this->scans_.clear();
+	}
+      this->scans_.push_back(new Gdb_index_scan(object, symbols, symbols_size,
+						defer));
+    }
+
+  Gdb_index_scan* scan = this->scans_.back();
+  if (defer)
+    scan->defer_section(is_type_unit, shndx, reloc_shndx, reloc_type);
+  else
+    {
+      scan->scan_section(is_type_unit, shndx, reloc_shndx, reloc_type);
+      this->add_scan(scan);
+    }
+}
+
+// Queue the tasks to scan the recorded sections.
+
+Task_token*
+Gdb_index::queue_scan_tasks(Workqueue* workqueue, Task_token* this_blocker)
+{
+  if (this->scans_.empty()
+      || (!parameters->options().threads()
+	  && parameters->link_cache() == NULL)
+      || parameters->incremental())
+    return this_blocker;
+
+  Task_token* scanned_blocker = new Task_token(true);
+  Task_token* next_blocker = new Task_token(true);
+  scanned_blocker->add_blockers(this->scans_.size());
+  next_blocker->add_blocker();
+
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    workqueue->queue(new Gdb_index_scan_task(this->scans_[i],
+					     scanned_blocker));
+
+  workqueue->queue(new Gdb_index_add_scans_task(this, this_blocker,
+						scanned_blocker,
+						next_blocker));
+
+  return next_blocker;
+}
+
+// Add the results of the deferred scans to the index, in input order.
+
+void
+Gdb_index::add_deferred_scans()
+{
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    {
+      this->add_scan(this->scans_[i]);
+      delete this->scans_[i];
+    }
+  this->scans_.clear();
+}
+
+// Add the results of SCAN to the index.  The CU and TU indexes of
+// SCAN are relative to the object, so we renumber them.
+
+void
+Gdb_index::add_scan(Gdb_index_scan* scan)
+{
+  const int cu_base = this->comp_units_.size();
+  const int tu_base = this->type_units_.size();
+
+  const Gdb_index_scan::Comp_unit_list& comp_units = scan->comp_units();
+  for (Gdb_index_scan::Comp_unit_list::const_iterator p = comp_units.begin();
+       p != comp_units.end();
+       ++p)
+    this->comp_units_.push_back(Comp_unit(p->first, p->second));
+
+  const Gdb_index_scan::Type_unit_list& type_units = scan->type_units();
+  for (Gdb_index_scan::Type_unit_list::const_iterator p = type_units.begin();
+       p != type_units.end();
+       ++p)
+    this->type_units_.push_back(Type_unit(p->tu_offset, p->type_offset,
+					  p->type_signature));
+
+  // The ranges of each unit are in a row.  Drop the ranges in
+  // sections which are not included in the link.
+  Relobj* object = scan->object();
+  const Gdb_index_scan::Range_list& ranges = scan->ranges();
+  Dwarf_range_list* unit_ranges = NULL;
+  int unit_index = 0;
+  for (Gdb_index_scan::Range_list::const_iterator p = ranges.begin();
+       p != ranges.end();
+       ++p)
+    {
+      if (p->shndx != 0 && !object->is_section_included(p->shndx))
+	continue;
+      if (unit_ranges == NULL || p->cu_index != unit_index)
+	{
+	  unit_index = p->cu_index;
+	  int cu_index = (unit_index >= 0
+			  ? cu_base + unit_index
+			  : unit_index - tu_base);
+	  unit_ranges = new Dwarf_range_list();
+	  this->ranges_.push_back(Per_cu_range_list(object, cu_index,
+						    unit_ranges));
+	}
+      unit_ranges->add(p->shndx, p->start, p->end);
+    }
+
+  const Gdb_index_scan::Symbol_list& symbols = scan->symbols();
+  for (Gdb_index_scan::Symbol_list::const_iterator p = symbols.begin();
+       p != symbols.end();
+       ++p)
+    {
+      int cu_index = p->cu_index;
+      cu_index = cu_index >= 0 ? cu_base + cu_index : cu_index - tu_base;
+      this->add_symbol(cu_index, scan->symbol_name(*p), p->hashval,
+		       p->flags);
+    }
+
+  scan->clear_results();
 }
 
 // Add a symbol.
 
 void
-Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+Gdb_index::add_symbol(int cu_index, const char* sym_name, unsigned int hash,
+		      uint8_t flags)
 {
-  unsigned int hash = mapped_index_string_hash(
-      reinterpret_cast<const unsigned char*>(sym_name));
   Gdb_symbol* sym = new Gdb_symbol();
   this->stringpool_.add(sym_name, true, &sym->name_key);
   sym->hashval = hash;
@@ -1156,27 +2021,6 @@ Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
     cu_vec->push_back(std::make_pair(cu_index, flags));
 }
 
-// Return TRUE if we have already processed the pubnames associated
-// with the statement list at the given OFFSET.
-
-bool
-Gdb_index::pubnames_read(const Relobj* object, off_t offset)
-{
-  bool ret = (this->pubnames_object_ == object
-	      && this->stmt_list_offset_ == offset);
-  return ret;
-}
-
-// Record that we have processed the pubnames associated with the
-// statement list for OBJECT at the given OFFSET.
-
-void
-Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
-{
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = offset;
-}
-
 // Set the size of the .gdb_index section.
 
 void
@@ -1353,7 +2197,7 @@ void
 Gdb_index::print_stats()
 {
   if (parameters->options().gdb_index())
-    Gdb_index_info_reader::print_stats();
+    Gdb_index_scan::print_stats();
 }
 
 } // End namespace gold.
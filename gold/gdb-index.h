@@ -43,7 +43,10 @@ class Dwarf_range_list;
 template <typename T>
 class Gdb_hashtab;
 class Gdb_index_info_reader;
+class Gdb_index_scan;
 class Dwarf_pubnames_table;
+class Workqueue;
+class Task_token;
 
 // This class manages the .gdb_index section, which is a fast
 // lookup table for DWARF information used by the gdb debugger.
@@ -56,7 +59,9 @@ class Gdb_index : public Output_section_data
 
   ~Gdb_index();
 
-  // Scan a .debug_info or .debug_types input section.
+  // Scan a .debug_info or .debug_types input section.  When running
+  // with threads, this only records the section, and the scan is done
+  // later by the tasks queued by queue_scan_tasks.
   void scan_debug_info(bool is_type_unit,
 		       Relobj* object,
 		       const unsigned char* symbols,
@@ -65,64 +70,17 @@ class Gdb_index : public Output_section_data
 		       unsigned int reloc_shndx,
 		       unsigned int reloc_type);
 
-  // Add a compilation unit.
-  int
-  add_comp_unit(off_t cu_offset, off_t cu_length)
-  {
-    this->comp_units_.push_back(Comp_unit(cu_offset, cu_length));
-    return this->comp_units_.size() - 1;
-  }
-
-  // Add a type unit.
-  int
-  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
-  {
-    this->type_units_.push_back(Type_unit(tu_offset, type_offset, signature));
-    return this->type_units_.size() - 1;
-  }
+  // Queue a task for each input object whose sections were recorded
+  // by scan_debug_info, followed by a task which adds the results to
+  // the index in input order after THIS_BLOCKER is released.  Return
+  // the blocker to use for the layout task, which will be
+  // THIS_BLOCKER itself if there is nothing to do.
+  Task_token*
+  queue_scan_tasks(Workqueue*, Task_token* this_blocker);
 
-  // Add an address range.
-  void
-  add_address_range_list(Relobj* object, unsigned int cu_index,
-			 Dwarf_range_list* ranges)
-  {
-    this->ranges_.push_back(Per_cu_range_list(object, cu_index, ranges));
-  }
-
-  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
-  // the high-byte of the cu_index field.
-  void
-  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
-
-  // Return the offset into the pubnames table for the cu at the given
-  // offset.
-  off_t
-  find_pubname_offset(off_t cu_offset);
-
-  // Return the offset into the pubtypes table for the cu at the
-  // given offset.
-  off_t
-  find_pubtype_offset(off_t cu_offset);
-
-  // Return TRUE if we have already processed the pubnames and types
-  // set for OBJECT of the CUs and TUS associated with the statement
-  // list at OFFSET.
-  bool
-  pubnames_read(const Relobj* object, off_t offset);
-
-  // Record that we have already read the pubnames associated with
-  // OBJECT and OFFSET.
+  // Add the results of the deferred scans to the index.
   void
-  set_pubnames_read(const Relobj* object, off_t offset);
-
-  // Return a pointer to the given table.
-  Dwarf_pubnames_table*
-  pubnames_table()
-  { return pubnames_table_; }
-
-  Dwarf_pubnames_table*
-  pubtypes_table()
-  { return pubtypes_table_; }
+  add_deferred_scans();
 
   // Print usage statistics.
   static void
@@ -148,21 +106,6 @@ class Gdb_index : public Output_section_data
   do_print_to_mapfile(Mapfile* mapfile) const
   { mapfile->print_output_data(this, _("** gdb_index")); }
 
-  // Create a map from dies to pubnames.
-  Dwarf_pubnames_table*
-  map_pubtable_to_dies(unsigned int attr,
-                       Gdb_index_info_reader* dwinfo,
-                       Relobj* object,
-                       const unsigned char* symbols,
-                       off_t symbols_size);
-
-  // Wrapper for map_pubtable_to_dies
-  void
-  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                 Relobj* object,
-                                 const unsigned char* symbols,
-                                 off_t symbols_size);
-
  private:
   // An entry in the compilation unit list.
   struct Comp_unit
@@ -216,20 +159,17 @@ class Gdb_index : public Output_section_data
 
   typedef std::vector<std::pair<int, uint8_t> > Cu_vector;
 
-  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
-  Pubname_offset_map cu_pubname_map_;
-  Pubname_offset_map cu_pubtype_map_;
-
-  // Scan the given pubtable and build a map of the various dies it
-  // refers to, so we can process the entries when we encounter the
-  // die.
+  // Add the compilation units, type units, address ranges and
+  // symbols found by SCAN to the index, and clear them from SCAN.
   void
-  map_pubtable_to_dies(Dwarf_pubnames_table* table,
-                       Pubname_offset_map* map);
+  add_scan(Gdb_index_scan* scan);
 
-  // Tables to store the pubnames section of the current object.
-  Dwarf_pubnames_table* pubnames_table_;
-  Dwarf_pubnames_table* pubtypes_table_;
+  // Add a symbol with hash code HASH.  FLAGS are the gdb_index
+  // version 7 flags to be stored in the high-byte of the cu_index
+  // field.
+  void
+  add_symbol(int cu_index, const char* sym_name, unsigned int hash,
+	     uint8_t flags);
 
   // The .gdb_index section.
   Output_section* gdb_index_section_;
@@ -253,10 +193,9 @@ class Gdb_index : public Output_section_data
   off_t symtab_offset_;
   off_t cu_pool_offset_;
   off_t stringpool_offset_;
-  // Object, stmt list offset of the CUs and TUs associated with the
-  // last read pubnames and pubtypes sections.
-  const Relobj* pubnames_object_;
-  off_t stmt_list_offset_;
+  // The scans of the input objects, in input order.  When not running
+  // with threads, only the scan of the current object is kept.
+  std::vector<Gdb_index_scan*> scans_;
 };
 
 } // End namespace gold.
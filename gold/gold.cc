@@ -59,6 +59,16 @@ process_incremental_input(Incremental_binary*, unsigned int, Input_objects*,
 			  Symbol_table*, Layout*, Dirsearch*, Mapfile*,
 			  Task_token*, Task_token*);
 
+static void
+queue_middle_icf_tasks(const General_options&, const Task*,
+		       const Input_objects*, Symbol_table*, Layout*,
+		       Workqueue*, Mapfile*);
+
+static void
+queue_middle_tasks_after_icf(const General_options&, const Task*,
+			     const Input_objects*, Symbol_table*, Layout*,
+			     Workqueue*, Mapfile*);
+
 void
 gold_exit(Exit_status status)
 {
@@ -134,6 +144,77 @@ Middle_runner::run(Workqueue* workqueue, const Task* task)
 		     this->layout_, workqueue, this->mapfile_);
 }
 
+// This class arranges to finish garbage collection after the
+// reachable sections have been marked in parallel, and then to run
+// the rest of the functions done in the middle of the link.
+
+class Gc_closure_runner : public Task_function_runner
+{
+ public:
+  Gc_closure_runner(const General_options& options,
+		    const Input_objects* input_objects,
+		    Symbol_table* symtab,
+		    Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Gc_closure_runner::run(Workqueue* workqueue, const Task* task)
+{
+  this->symtab_->gc()->finish_transitive_closure();
+  queue_middle_icf_tasks(this->options_, task, this->input_objects_,
+			 this->symtab_, this->layout_, workqueue,
+			 this->mapfile_);
+}
+
+// This class arranges to finish identical code folding after the
+// candidate sections have been hashed, and then to run the rest of
+// the functions done in the middle of the link.
+
+class Icf_runner : public Task_function_runner
+{
+ public:
+  Icf_runner(const General_options& options,
+	     const Input_objects* input_objects,
+	     Symbol_table* symtab,
+	     Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Icf_runner::run(Workqueue* workqueue, const Task* task)
+{
+  this->symtab_->icf()->find_identical_sections(this->input_objects_,
+						this->symtab_);
+  queue_middle_tasks_after_icf(this->options_, task, this->input_objects_,
+			       this->symtab_, this->layout_, workqueue,
+			       this->mapfile_);
+}
+
 // This class arranges the tasks to process the relocs for garbage collection.
 
 class Gc_runner : public Task_function_runner
@@ -453,7 +534,7 @@ queue_middle_gc_tasks(const General_options& options,
       Task_token* next_blocker = new Task_token(true);
       next_blocker->add_blocker();
       workqueue->queue(new Read_relocs(symtab, layout, *p, this_blocker,
-				       next_blocker));
+				       next_blocker, NULL));
       this_blocker = next_blocker;
     }
 
@@ -522,17 +603,95 @@ queue_middle_tasks(const General_options& options,
       symtab->gc_mark_undef_symbols(layout);
       gold_assert(symtab->gc() != NULL);
       // Do a transitive closure on all references to determine the worklist.
+      // When running with threads, this is done in parallel.
+      if (options.threads())
+	{
+	  // Queue one marking task per worker thread; the tasks pull
+	  // sections from a shared pool.  By default the workqueue has
+	  // a thread per input file, so also limit the tasks to the
+	  // number of processors.
+	  int thread_count = workqueue->thread_count();
+	  if (options.thread_count_middle() > 0)
+	    thread_count = std::min(thread_count,
+				    options.thread_count_middle());
+#ifdef _SC_NPROCESSORS_ONLN
+	  else
+	    {
+	      long processors = ::sysconf(_SC_NPROCESSORS_ONLN);
+	      if (processors > 0 && processors < thread_count)
+		thread_count = processors;
+	    }
+#endif
+	  Task_token* gc_blocker =
+	    symtab->gc()->queue_transitive_closure_tasks(workqueue,
+							 thread_count);
+	  workqueue->queue(new Task_function(new Gc_closure_runner(options,
+								   input_objects,
+								   symtab,
+								   layout,
+								   mapfile),
+					     gc_blocker,
+					     "Task_function Gc_closure_runner"));
+	  return;
+	}
       symtab->gc()->do_transitive_closure();
     }
 
+  queue_middle_icf_tasks(options, task, input_objects, symtab, layout,
+			 workqueue, mapfile);
+}
+
+// Queue up the tasks for identical code folding, if it was chosen, and
+// then the rest of the middle set of tasks.  This runs after garbage
+// collection.
+
+static void
+queue_middle_icf_tasks(const General_options& options,
+		       const Task* task,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout,
+		       Workqueue* workqueue,
+		       Mapfile* mapfile)
+{
   // If identical code folding (--icf) is chosen it makes sense to do it
   // only after garbage collection (--gc-sections) as we do not want to
-  // be folding sections that will be garbage.
+  // be folding sections that will be garbage.  When running with
+  // threads, the candidate sections are hashed in parallel first.
   if (parameters->options().icf_enabled())
     {
+      if (options.threads())
+	{
+	  Task_token* icf_blocker =
+	    symtab->icf()->queue_hash_tasks(input_objects, symtab, workqueue);
+	  workqueue->queue(new Task_function(new Icf_runner(options,
+							    input_objects,
+							    symtab,
+							    layout,
+							    mapfile),
+					     icf_blocker,
+					     "Task_function Icf_runner"));
+	  return;
+	}
       symtab->icf()->find_identical_sections(input_objects, symtab);
     }
 
+  queue_middle_tasks_after_icf(options, task, input_objects, symtab, layout,
+			       workqueue, mapfile);
+}
+
+// Queue up the rest of the middle set of tasks, once identical code
+// folding, if any, is done.
+
+static void
+queue_middle_tasks_after_icf(const General_options& options,
+			     const Task* task,
+			     const Input_objects* input_objects,
+			     Symbol_table* symtab,
+			     Layout* layout,
+			     Workqueue* workqueue,
+			     Mapfile* mapfile)
+{
   // Call Object::layout for the second time to determine the
   // output_sections for all referenced input sections.  When
   // --gc-sections or --icf is turned on, or when certain input
@@ -563,10 +722,17 @@ queue_middle_tasks(const General_options& options,
   // Finalize the .eh_frame section.
   layout->finalize_eh_frame_section();
 
+  // Compute the section order from the call graph.  This must wait
+  // until all the input sections have been laid out.
+  if (parameters->options().call_graph_ordering_file())
+    layout->order_sections_by_call_graph(task, input_objects, symtab);
+
   /* If plugins have specified a section order, re-arrange input sections
      according to a specified section order.  If --section-ordering-file is
-     also specified, do not do anything here.  */
-  if (parameters->options().has_plugins()
+     also specified, do not do anything here.  The order computed from
+     --call-graph-ordering-file is applied the same way.  */
+  if ((parameters->options().has_plugins()
+       || parameters->options().call_graph_ordering_file())
       && layout->is_section_ordering_specified()
       && !parameters->options().section_ordering_file ())
     {
@@ -705,15 +871,31 @@ queue_middle_tasks(const General_options& options,
 
   Task_token* this_blocker = NULL;
 
+  // When running with threads, we prescan the relocations of all the
+  // objects in parallel, keeping only the ones which may need a GOT
+  // or PLT entry or a dynamic relocation.  The prescan reads the
+  // symbol table, so all the Prescan_relocs tasks must finish before
+  // anything changes it.
+  Task_token* prescan_blocker = NULL;
+  if (Prescan_relocs::is_enabled(layout))
+    {
+      prescan_blocker = new Task_token(true);
+      for (int i = 0; i < input_objects->number_of_relobjs(); ++i)
+	prescan_blocker->add_blocker();
+      this_blocker = prescan_blocker;
+    }
+
   // Allocate common symbols.  We use a blocker to run this before the
   // Scan_relocs tasks, because it writes to the symbol table just as
   // they do.
   if (parameters->options().define_common())
     {
-      this_blocker = new Task_token(true);
-      this_blocker->add_blocker();
+      Task_token* commons_blocker = new Task_token(true);
+      commons_blocker->add_blocker();
       workqueue->queue(new Allocate_commons_task(symtab, layout, mapfile,
-						 this_blocker));
+						 this_blocker,
+						 commons_blocker));
+      this_blocker = commons_blocker;
     }
 
   // If doing garbage collection, the relocations have already been read.
@@ -725,6 +907,10 @@ queue_middle_tasks(const General_options& options,
 	   p != input_objects->relobj_end();
 	   ++p)
 	{
+	  if (prescan_blocker != NULL)
+	    workqueue->queue(new Prescan_relocs(symtab, *p,
+						(*p)->get_relocs_data(),
+						prescan_blocker));
 	  Task_token* next_blocker = new Task_token(true);
 	  next_blocker->add_blocker();
 	  workqueue->queue(new Scan_relocs(symtab, layout, *p,
@@ -753,7 +939,7 @@ queue_middle_tasks(const General_options& options,
 	  Task_token* next_blocker = new Task_token(true);
 	  next_blocker->add_blocker();
 	  workqueue->queue(new Read_relocs(symtab, layout, *p, this_blocker,
-					   next_blocker));
+					   next_blocker, prescan_blocker));
 	  this_blocker = next_blocker;
 	}
     }
@@ -777,6 +963,15 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
+  // When running with threads, finish merging strings and build the
+  // .gdb_index section in parallel with scanning the relocations.
+  // The .gdb_index scans are also deferred to here with --link-cache.
+  if (parameters->options().threads())
+    this_blocker = layout->queue_merged_strings_tasks(workqueue,
+						      thread_count,
+						      this_blocker);
+  this_blocker = layout->queue_gdb_index_tasks(workqueue, this_blocker);
+
   // When all those tasks are complete, we can start laying out the
   // output file.
   workqueue->queue(new Task_function(new Layout_task_runner(options,
@@ -836,6 +1031,38 @@ queue_final_tasks(const General_options& options,
   if (!any_postprocessing_sections)
     final_blocker->add_blocker();
 
+  // Sort and write out the dynamic relocations and the .eh_frame_hdr
+  // table in parallel if they are large.  The .eh_frame_hdr tasks are
+  // queued by Write_after_input_sections_task, and block the same
+  // token that it does.
+  unsigned int eh_frame_hdr_tasks = 0;
+  if (options.threads() && !parameters->incremental())
+    {
+      layout->queue_dynamic_reloc_tasks(workqueue, of, thread_count,
+					final_blocker);
+      eh_frame_hdr_tasks = layout->set_parallel_eh_frame_hdr(thread_count);
+      if (!any_postprocessing_sections)
+	final_blocker->add_blockers(eh_frame_hdr_tasks);
+    }
+
+  // With --build-id=fast, hash most of the output file as soon as the
+  // input sections have been written.  If there are postprocessing
+  // sections the file size may still change, so it is all hashed at
+  // the end.
+  Build_id_chunks* build_id_chunks = NULL;
+  if (strcmp(options.build_id(), "fast") == 0
+      && input_sections_blocker != NULL
+      && !parameters->incremental()
+      && layout->output_file_size() > 0)
+    {
+      build_id_chunks =
+	new Build_id_chunks(layout->output_file_size(),
+			    options.build_id_chunk_size_for_treehash());
+      layout->queue_early_build_id_tasks(workqueue, of, build_id_chunks,
+					 input_sections_blocker,
+					 final_blocker);
+    }
+
   // Queue a task to write out the symbol table.
   workqueue->queue(new Write_symbols_task(layout,
 					  symtab,
@@ -878,23 +1105,36 @@ queue_final_tasks(const General_options& options,
     {
       Task_token* new_final_blocker = new Task_token(true);
       new_final_blocker->add_blocker();
-      Task* t = new Write_after_input_sections_task(layout, of,
-						    final_blocker,
-						    new_final_blocker);
+      new_final_blocker->add_blockers(eh_frame_hdr_tasks);
+      Task* t;
+      if (options.threads()
+	  && strcmp(options.compress_debug_sections(), "none") != 0)
+	{
+	  // Compress the debug sections in parallel before writing
+	  // them out.
+	  Task_function_runner* runner =
+	    new Compress_sections_task_runner(layout, of, new_final_blocker);
+	  t = new Task_function(runner, final_blocker,
+				"Task_function Compress_sections_task_runner");
+	}
+      else
+	t = new Write_after_input_sections_task(layout, of,
+						final_blocker,
+						new_final_blocker);
       workqueue->queue(t);
       final_blocker = new_final_blocker;
     }
 
   // Create tasks for tree-style build ID computation, if necessary.
-  if (strcmp(options.build_id(), "tree") == 0)
+  if (strcmp(options.build_id(), "tree") == 0
+      || strcmp(options.build_id(), "fast") == 0)
     {
       // Queue a task to compute the build id.  This will be blocked by
       // FINAL_BLOCKER, and will in turn schedule the task to close
       // the output file.
-      workqueue->queue(new Task_function(new Build_id_task_runner(&options,
-								  layout,
-								  of),
-					 final_blocker,
+      Task_function_runner* runner =
+	new Build_id_task_runner(&options, layout, of, build_id_chunks);
+      workqueue->queue(new Task_function(runner, final_blocker,
 					 "Task_function Build_id_task_runner"));
     }
   else
@@ -1015,6 +1015,9 @@ Target_i386::rel_dyn_section(Layout* layout)
       layout->add_output_section_data(".rel.dyn", elfcpp::SHT_REL,
 				      elfcpp::SHF_ALLOC, this->rel_dyn_,
 				      ORDER_DYNAMIC_RELOCS, false);
+      if (parameters->options().pack_relative_relocs())
+	this->rel_dyn_->set_pack_relative_relocs(
+	    layout, elfcpp::R_386_RELATIVE);
     }
   return this->rel_dyn_;
 }
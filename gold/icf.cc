@@ -167,6 +167,7 @@
 #include "demangle.h"
 #include "elfcpp.h"
 #include "int_encoding.h"
+#include "workqueue.h"
 
 #include <limits>
 
@@ -177,51 +178,41 @@ namespace gold
 // sections has unique contents.  Such unique sections or groups can be
 // declared final and need not be processed any further.
 // Parameters :
-// ID_SECTION : Vector mapping a section index to a Section_id pair.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
+// SECTION_HASHES : The hashes of each section.
+// FIRST_ITERATION : true if this is being called before the first
+//                   iteration of icf, in which case the checksum of the
+//                   section contents is used.  Otherwise the checksum
+//                   of the section's text and relocs to sections that
+//                   cannot be folded is used.
 
 static void
-preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
-                               std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+preprocess_for_unique_sections(
+    std::vector<bool>* is_secn_or_group_unique,
+    const std::vector<Icf::Section_hash>& section_hashes,
+    bool first_iteration)
 {
   Unordered_map<uint32_t, unsigned int> uniq_map;
   std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
     uniq_map_insert;
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < section_hashes.size(); i++)
     {
       if ((*is_secn_or_group_unique)[i])
         continue;
 
       uint32_t cksum;
-      Section_id secn = id_section[i];
-      section_size_type plen;
-      if (section_contents == NULL)
-        {
-          // Lock the object so we can read from it.  This is only called
-          // single-threaded from queue_middle_tasks, so it is OK to lock.
-          // Unfortunately we have no way to pass in a Task token.
-          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-          Task_lock_obj<Object> tl(dummy_task, secn.first);
-          const unsigned char* contents;
-          contents = secn.first->section_contents(secn.second,
-                                                  &plen,
-                                                  false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
-        }
+      if (first_iteration)
+	{
+	  gold_assert(section_hashes[i].has_contents_crc);
+	  cksum = section_hashes[i].contents_crc;
+	}
       else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
+	{
+	  gold_assert(section_hashes[i].is_hashed);
+	  cksum = section_hashes[i].fixed_crc;
+	}
       uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
       if (uniq_map_insert.second)
         {
@@ -274,78 +265,257 @@ get_rel_addend(const unsigned char* reloc_addend_ptr,
     }
 }
 
-// This returns the buffer containing the section's contents, both
-// text and relocs.  Relocs are differentiated as those pointing to
-// sections that could be folded and those that cannot.  Only relocs
-// pointing to sections that could be folded are recomputed on
-// subsequent invocations of this function.
+// Write V in lower case hexadecimal, without leading zeroes, to P.
+// Return a pointer past the last digit written.
+
+static inline char*
+write_hex(char* p, unsigned long long v)
+{
+  char digits[2 * sizeof(unsigned long long)];
+  unsigned int n = 0;
+  do
+    {
+      digits[n++] = "0123456789abcdef"[v & 0xf];
+      v >>= 4;
+    }
+  while (v != 0);
+  while (n > 0)
+    *p++ = digits[--n];
+  return p;
+}
+
+// Format the symbol value, the addend and the offset of a reloc into
+// ADDEND_STR, which must have room for ADDEND_STR_SIZE characters, as
+// "%llx %llx %llx" would.  Return the length of the string.  This is
+// called for every reloc in every candidate section, so we avoid the
+// cost of snprintf.
+
+static const size_t addend_str_size = 50;
+
+static size_t
+format_addend(char* addend_str, long long symval, long long addend,
+	      unsigned long long offset)
+{
+  char buf[3 * 2 * sizeof(unsigned long long) + 2];
+  char* p = write_hex(buf, symval);
+  *p++ = ' ';
+  p = write_hex(p, addend);
+  *p++ = ' ';
+  p = write_hex(p, offset);
+  // Truncate like snprintf would.
+  size_t len = std::min<size_t>(p - buf, addend_str_size - 1);
+  memcpy(addend_str, buf, len);
+  return len;
+}
+
+// Return the index of the section that a reloc refers to if that
+// section might be folded, or -1U if it cannot be.
+// Parameters  :
+// RELOC_SECN  : The section the reloc refers to.
+// GSYM        : The global symbol the reloc refers to, or NULL.
+
+static unsigned int
+tracked_section_id(Symbol_table* symtab, const Section_id& reloc_secn,
+		   const Symbol* gsym)
+{
+  bool is_sym_preemptible = (gsym != NULL
+			     && !gsym->is_from_dynobj()
+			     && !gsym->is_undefined()
+			     && gsym->is_preemptible());
+  if (is_sym_preemptible)
+    return -1U;
+  Icf::Uniq_secn_id_map& section_id_map =
+    symtab->icf()->section_to_int_map();
+  Icf::Uniq_secn_id_map::const_iterator section_id_map_it =
+    section_id_map.find(reloc_secn);
+  if (section_id_map_it == section_id_map.end())
+    return -1U;
+  return section_id_map_it->second;
+}
+
+// Look through function descriptors for the relocs of a section,
+// changing them to refer to the code entry.  This must be done before
+// any section is hashed.
+// Parameters  :
+// SECN               : Section whose relocs are processed.  The relocs
+//                      of its extra identity regions are processed too.
+// START_OFFSET       : Only consider the part of the section at and after
+//                      this offset.
+// END_OFFSET         : Only consider the part of the section before this
+//                      offset.
+
+static void
+find_function_locations(const Section_id& secn,
+			Symbol_table* symtab,
+			section_offset_type start_offset = 0,
+			section_offset_type end_offset =
+			  std::numeric_limits<section_offset_type>::max())
+{
+  Icf::Reloc_info_list& reloc_info_list =
+    symtab->icf()->reloc_info_list();
+
+  Icf::Reloc_info_list::iterator it_reloc_info_list =
+    reloc_info_list.find(secn);
+
+  if (it_reloc_info_list != reloc_info_list.end())
+    {
+      Icf::Sections_reachable_info &v =
+        (it_reloc_info_list->second).section_info;
+      Icf::Addend_info &a = (it_reloc_info_list->second).addend_info;
+      const Icf::Offset_info &o = (it_reloc_info_list->second).offset_info;
+      Icf::Sections_reachable_info::iterator it_v = v.begin();
+      Icf::Addend_info::iterator it_a = a.begin();
+      Icf::Offset_info::const_iterator it_o = o.begin();
+
+      for (; it_v != v.end(); ++it_v, ++it_a, ++it_o)
+        {
+	  if (static_cast<section_offset_type>(*it_o) < start_offset
+	      || static_cast<section_offset_type>(*it_o) >= end_offset
+	      || it_v->first == NULL)
+	    continue;
+
+	  Symbol_location loc;
+	  loc.object = it_v->first;
+	  loc.shndx = it_v->second;
+	  loc.offset = convert_types<off_t, long long>(it_a->first
+						       + it_a->second);
+	  // Look through function descriptors
+	  parameters->target().function_location(&loc);
+	  if (loc.shndx != it_v->second)
+	    {
+	      it_v->second = loc.shndx;
+	      // Modify symvalue/addend to the code entry.
+	      it_a->first = loc.offset;
+	      it_a->second = 0;
+	    }
+	}
+    }
+
+  std::pair<Icf::Extra_identity_list::const_iterator,
+	    Icf::Extra_identity_list::const_iterator>
+    extra_range = symtab->icf()->extra_identity_list().equal_range(secn);
+  for (Icf::Extra_identity_list::const_iterator it_ext = extra_range.first;
+       it_ext != extra_range.second; ++it_ext)
+    find_function_locations(it_ext->second.section, symtab,
+			    it_ext->second.offset,
+			    it_ext->second.offset + it_ext->second.length);
+}
+
+// The destination of the fixed part of a section's identity.  This is
+// normally the section's hashes.  When two sections have the same
+// digest, the identities are written out in full instead, so that
+// they can be compared byte for byte before the sections are folded.
+
+class Section_identity
+{
+ public:
+  Section_identity(Icf::Section_hash* hash)
+    : hash_(hash), buffer_(NULL)
+  { }
+
+  Section_identity(std::string* buffer)
+    : hash_(NULL), buffer_(buffer)
+  { }
+
+  // Add LEN bytes at P.
+  void
+  add(const void* p, size_t len)
+  {
+    if (this->buffer_ != NULL)
+      this->buffer_->append(static_cast<const char*>(p), len);
+    else
+      {
+	md5_process_bytes(p, len, &this->hash_->fixed_md5);
+	this->hash_->fixed_crc =
+	  xcrc32(static_cast<const unsigned char*>(p), len,
+		 this->hash_->fixed_crc);
+      }
+  }
+
+  void
+  add(const char* s)
+  { this->add(s, strlen(s)); }
+
+  void
+  add(const std::string& s)
+  { this->add(s.data(), s.length()); }
+
+  // Count a reloc to a section that might be folded.
+  void
+  add_tracked_reloc()
+  {
+    if (this->hash_ != NULL)
+      this->hash_->num_tracked_relocs++;
+  }
+
+ private:
+  Icf::Section_hash* hash_;
+  std::string* buffer_;
+};
+
+// This hashes the part of a section's identity that does not change
+// from iteration to iteration: its text and its relocs.  Relocs are
+// differentiated as those pointing to sections that could be folded
+// and those that cannot.  Only relocs pointing to sections that could
+// be folded are recomputed on every iteration, by get_icf_relocs;
+// here only a marker and their addend is hashed.  The section
+// contents are hashed in place, without copying them.
+// Returns false if LOCKED_OBJECT is not NULL and the hash depends on
+// the contents of a different object, which the caller has not locked.
 // Parameters  :
-// FIRST_ITERATION    : true if it is the first invocation.
-// FIXED_CACHE        : String that stores the portion of the result that
-//                      does not change from iteration to iteration;
-//                      written if first_iteration is true, read if it's false.
-// SECN               : Section for which contents are desired.
+// SECN               : Section for which contents are hashed.
 // SELF_SECN          : Relocations that target this section will be
 //                      considered "relocations to self" so that recursive
 //                      functions can be folded. Should normally be the
 //                      same as `secn` except when processing extra identity
 //                      regions.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
-// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
+// LOCKED_OBJECT      : The only object that may be read, or NULL.
+// IDENTITY           : Where the fixed part of the identity is added.
 // START_OFFSET       : Only consider the part of the section at and after
 //                      this offset.
 // END_OFFSET         : Only consider the part of the section before this
 //                      offset.
 
-static std::string
-get_section_contents(bool first_iteration,
-		     std::string* fixed_cache,
-                     const Section_id& secn,
-		     const Section_id& self_secn,
-                     unsigned int* num_tracked_relocs,
-                     Symbol_table* symtab,
-                     const std::vector<unsigned int>& kept_section_id,
-		     section_offset_type start_offset = 0,
-		     section_offset_type end_offset =
-		       std::numeric_limits<section_offset_type>::max())
+static bool
+hash_fixed_contents(const Section_id& secn,
+		    const Section_id& self_secn,
+		    Symbol_table* symtab,
+		    const Relobj* locked_object,
+		    Section_identity* identity,
+		    section_offset_type start_offset = 0,
+		    section_offset_type end_offset =
+		      std::numeric_limits<section_offset_type>::max())
 {
-  section_size_type plen;
-  const unsigned char* contents = NULL;
-  if (first_iteration)
-    contents = secn.first->section_contents(secn.second, &plen, false);
+  if (locked_object != NULL && secn.first != locked_object)
+    return false;
 
-  // The buffer to hold all the contents including relocs.  A checksum
-  // is then computed on this buffer.
-  std::string buffer;
-  std::string icf_reloc_buffer;
+  section_size_type plen;
+  const unsigned char* contents =
+    secn.first->section_contents(secn.second, &plen, false);
 
-  Icf::Reloc_info_list& reloc_info_list = 
+  Icf::Reloc_info_list& reloc_info_list =
     symtab->icf()->reloc_info_list();
 
-  Icf::Reloc_info_list::iterator it_reloc_info_list =
+  Icf::Reloc_info_list::const_iterator it_reloc_info_list =
     reloc_info_list.find(secn);
 
-  buffer.clear();
-  icf_reloc_buffer.clear();
-
-  // Process relocs and put them into the buffer.
+  // Process relocs and hash them.
 
   if (it_reloc_info_list != reloc_info_list.end())
     {
-      Icf::Sections_reachable_info &v =
+      const Icf::Sections_reachable_info &v =
         (it_reloc_info_list->second).section_info;
       // Stores the information of the symbol pointed to by the reloc.
       const Icf::Symbol_info &s = (it_reloc_info_list->second).symbol_info;
       // Stores the addend and the symbol value.
-      Icf::Addend_info &a = (it_reloc_info_list->second).addend_info;
+      const Icf::Addend_info &a = (it_reloc_info_list->second).addend_info;
       // Stores the offset of the reloc.
       const Icf::Offset_info &o = (it_reloc_info_list->second).offset_info;
       const Icf::Reloc_addend_size_info &reloc_addend_size_info =
         (it_reloc_info_list->second).reloc_addend_size_info;
-      Icf::Sections_reachable_info::iterator it_v = v.begin();
+      Icf::Sections_reachable_info::const_iterator it_v = v.begin();
       Icf::Symbol_info::const_iterator it_s = s.begin();
-      Icf::Addend_info::iterator it_a = a.begin();
+      Icf::Addend_info::const_iterator it_a = a.begin();
       Icf::Offset_info::const_iterator it_o = o.begin();
       Icf::Reloc_addend_size_info::const_iterator it_addend_size =
         reloc_addend_size_info.begin();
@@ -367,52 +537,26 @@ get_section_contents(bool first_iteration,
 	      gsym = NULL;
 	    }
 
-	  if (first_iteration
-	      && it_v->first != NULL)
-	    {
-	      Symbol_location loc;
-	      loc.object = it_v->first;
-	      loc.shndx = it_v->second;
-	      loc.offset = convert_types<off_t, long long>(it_a->first
-							   + it_a->second);
-	      // Look through function descriptors
-	      parameters->target().function_location(&loc);
-	      if (loc.shndx != it_v->second)
-		{
-		  it_v->second = loc.shndx;
-		  // Modify symvalue/addend to the code entry.
-		  it_a->first = loc.offset;
-		  it_a->second = 0;
-		}
-	    }
-
           // ADDEND_STR stores the symbol value and addend and offset,
           // each at most 16 hex digits long.  it_a points to a pair
           // where first is the symbol value and second is the
           // addend.
-          char addend_str[50];
-
-	  // It would be nice if we could use format macros in inttypes.h
-	  // here but there are not in ISO/IEC C++ 1998.
-          snprintf(addend_str, sizeof(addend_str), "%llx %llx %llx",
-                   static_cast<long long>((*it_a).first),
-		   static_cast<long long>((*it_a).second),
-		   static_cast<unsigned long long>(*it_o - start_offset));
+          char addend_str[addend_str_size];
+	  size_t addend_len =
+	    format_addend(addend_str, (*it_a).first, (*it_a).second,
+			  *it_o - start_offset);
 
 	  // If the symbol pointed to by the reloc is not in an ordinary
 	  // section or if the symbol type is not FROM_OBJECT, then the
 	  // object is NULL.
 	  if (it_v->first == NULL)
             {
-	      if (first_iteration)
-                {
-		  // If the symbol name is available, use it.
-                  if (gsym != NULL)
-                      buffer.append(gsym->name());
-                  // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
-		}
+	      // If the symbol name is available, use it.
+	      if (gsym != NULL)
+		identity->add(gsym->name());
+	      // Append the addend.
+	      identity->add(addend_str, addend_len);
+	      identity->add("@", 1);
 	      continue;
 	    }
 
@@ -423,191 +567,157 @@ get_section_contents(bool first_iteration,
           if (reloc_secn.first == self_secn.first
               && reloc_secn.second == self_secn.second)
             {
-              if (first_iteration)
-                {
-                  buffer.append("R");
-                  buffer.append(addend_str);
-                  buffer.append("@");
-                }
+	      identity->add("R", 1);
+	      identity->add(addend_str, addend_len);
+	      identity->add("@", 1);
               continue;
             }
-          Icf::Uniq_secn_id_map& section_id_map =
-            symtab->icf()->section_to_int_map();
-          Icf::Uniq_secn_id_map::iterator section_id_map_it =
-            section_id_map.find(reloc_secn);
-          bool is_sym_preemptible = (gsym != NULL
-				     && !gsym->is_from_dynobj()
-				     && !gsym->is_undefined()
-				     && gsym->is_preemptible());
-          if (!is_sym_preemptible
-              && section_id_map_it != section_id_map.end())
+          if (tracked_section_id(symtab, reloc_secn, gsym) != -1U)
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
-
-              char kept_section_str[10];
-              unsigned int secn_id = section_id_map_it->second;
-              snprintf(kept_section_str, sizeof(kept_section_str), "%u",
-                       kept_section_id[secn_id]);
-              if (first_iteration)
-                {
-                  buffer.append("ICF_R");
-                  buffer.append(addend_str);
-                }
-              icf_reloc_buffer.append(kept_section_str);
-              // Append the addend.
-              icf_reloc_buffer.append(addend_str);
-              icf_reloc_buffer.append("@");
+	      identity->add_tracked_reloc();
+	      identity->add("ICF_R", 5);
+	      identity->add(addend_str, addend_len);
+	      continue;
             }
-          else
-            {
-              // This is a reloc to a section that cannot be folded.
-              // Process it only in the first iteration.
-              if (!first_iteration)
-                continue;
-
-              uint64_t secn_flags = (it_v->first)->section_flags(it_v->second);
-              // This reloc points to a merge section.  Hash the
-              // contents of this section.
-              if ((secn_flags & elfcpp::SHF_MERGE) != 0
-		  && parameters->target().can_icf_inline_merge_sections())
-                {
-                  uint64_t entsize =
-                    (it_v->first)->section_entsize(it_v->second);
-		  long long offset = it_a->first;
-
-		  // Handle SHT_RELA and SHT_REL addends. Only one of these
-		  // addends exists. When pointing to a merge section, the
-		  // addend only matters if it's relative to a section
-		  // symbol. In order to unambiguously identify the target
-		  // of the relocation, the compiler (and assembler) must use
-		  // a local non-section symbol unless Symbol+Addend does in
-		  // fact point directly to the target. (In other words,
-		  // a bias for a pc-relative reference or a non-zero based
-		  // access forces the use of a local symbol, and the addend
-		  // is used only to provide that bias.)
-		  uint64_t reloc_addend_value = 0;
-		  if (is_section_symbol)
+
+	  // This is a reloc to a section that cannot be folded.
+	  uint64_t secn_flags = (it_v->first)->section_flags(it_v->second);
+	  // This reloc points to a merge section.  Hash the
+	  // contents of this section.
+	  if ((secn_flags & elfcpp::SHF_MERGE) != 0
+	      && parameters->target().can_icf_inline_merge_sections())
+	    {
+	      if (locked_object != NULL && it_v->first != locked_object)
+		return false;
+
+	      uint64_t entsize =
+		(it_v->first)->section_entsize(it_v->second);
+	      long long offset = it_a->first;
+
+	      // Handle SHT_RELA and SHT_REL addends. Only one of these
+	      // addends exists. When pointing to a merge section, the
+	      // addend only matters if it's relative to a section
+	      // symbol. In order to unambiguously identify the target
+	      // of the relocation, the compiler (and assembler) must use
+	      // a local non-section symbol unless Symbol+Addend does in
+	      // fact point directly to the target. (In other words,
+	      // a bias for a pc-relative reference or a non-zero based
+	      // access forces the use of a local symbol, and the addend
+	      // is used only to provide that bias.)
+	      uint64_t reloc_addend_value = 0;
+	      if (is_section_symbol)
+		{
+		  // Get the SHT_RELA addend.  For RELA relocations,
+		  // we have the addend from the relocation.
+		  reloc_addend_value = it_a->second;
+
+		  // Handle SHT_REL addends.
+		  // For REL relocations, we need to fetch the addend
+		  // from the section contents.
+		  const unsigned char* reloc_addend_ptr =
+		    contents + static_cast<unsigned long long>(*it_o);
+
+		  // Update the addend value with the SHT_REL addend if
+		  // available.
+		  get_rel_addend(reloc_addend_ptr, *it_addend_size,
+				 &reloc_addend_value);
+
+		  // Ignore the addend when it is a negative value.
+		  // See the comments in Merged_symbol_value::value
+		  // in object.h.
+		  if (reloc_addend_value < 0xffffff00)
+		    offset = offset + reloc_addend_value;
+		}
+
+	      section_size_type secn_len;
+
+	      const unsigned char* str_contents =
+	      (it_v->first)->section_contents(it_v->second,
+					      &secn_len,
+					      false) + offset;
+	      gold_assert (offset < (long long) secn_len);
+
+	      if ((secn_flags & elfcpp::SHF_STRINGS) != 0)
+		{
+		  // String merge section.
+		  const char* str_char =
+		    reinterpret_cast<const char*>(str_contents);
+		  switch(entsize)
 		    {
-		      // Get the SHT_RELA addend.  For RELA relocations,
-		      // we have the addend from the relocation.
-		      reloc_addend_value = it_a->second;
-
-		      // Handle SHT_REL addends.
-		      // For REL relocations, we need to fetch the addend
-		      // from the section contents.
-		      const unsigned char* reloc_addend_ptr =
-			contents + static_cast<unsigned long long>(*it_o);
-
-		      // Update the addend value with the SHT_REL addend if
-		      // available.
-		      get_rel_addend(reloc_addend_ptr, *it_addend_size,
-				     &reloc_addend_value);
-
-		      // Ignore the addend when it is a negative value.
-		      // See the comments in Merged_symbol_value::value
-		      // in object.h.
-		      if (reloc_addend_value < 0xffffff00)
-			offset = offset + reloc_addend_value;
+		    case 1:
+		      {
+			identity->add(str_char);
+			break;
+		      }
+		    case 2:
+		      {
+			const uint16_t* ptr_16 =
+			  reinterpret_cast<const uint16_t*>(str_char);
+			unsigned int strlen_16 = 0;
+			// Find the NULL character.
+			while(*(ptr_16 + strlen_16) != 0)
+			    strlen_16++;
+			identity->add(str_char, strlen_16 * 2);
+		      }
+		      break;
+		    case 4:
+		      {
+			const uint32_t* ptr_32 =
+			  reinterpret_cast<const uint32_t*>(str_char);
+			unsigned int strlen_32 = 0;
+			// Find the NULL character.
+			while(*(ptr_32 + strlen_32) != 0)
+			    strlen_32++;
+			identity->add(str_char, strlen_32 * 4);
+		      }
+		      break;
+		    default:
+		      gold_unreachable();
 		    }
-
-                  section_size_type secn_len;
-
-                  const unsigned char* str_contents =
-                  (it_v->first)->section_contents(it_v->second,
-                                                  &secn_len,
-                                                  false) + offset;
-		  gold_assert (offset < (long long) secn_len);
-
-                  if ((secn_flags & elfcpp::SHF_STRINGS) != 0)
-                    {
-                      // String merge section.
-                      const char* str_char =
-                        reinterpret_cast<const char*>(str_contents);
-                      switch(entsize)
-                        {
-                        case 1:
-                          {
-                            buffer.append(str_char);
-                            break;
-                          }
-                        case 2:
-                          {
-                            const uint16_t* ptr_16 =
-                              reinterpret_cast<const uint16_t*>(str_char);
-                            unsigned int strlen_16 = 0;
-                            // Find the NULL character.
-                            while(*(ptr_16 + strlen_16) != 0)
-                                strlen_16++;
-                            buffer.append(str_char, strlen_16 * 2);
-                          }
-                          break;
-                        case 4:
-                          {
-                            const uint32_t* ptr_32 =
-                              reinterpret_cast<const uint32_t*>(str_char);
-                            unsigned int strlen_32 = 0;
-                            // Find the NULL character.
-                            while(*(ptr_32 + strlen_32) != 0)
-                                strlen_32++;
-                            buffer.append(str_char, strlen_32 * 4);
-                          }
-                          break;
-                        default:
-                          gold_unreachable();
-                        }
-                    }
-                  else
-                    {
-                      // Use the entsize to determine the length to copy.
-		      uint64_t bufsize = entsize;
-		      // If entsize is too big, copy all the remaining bytes.
-		      if ((offset + entsize) > secn_len)
-			bufsize = secn_len - offset;
-                      buffer.append(reinterpret_cast<const
-                                                     char*>(str_contents),
-                                    bufsize);
-                    }
-		  buffer.append("@");
-                }
-              else if (gsym != NULL)
-                {
-                  // If symbol name is available use that.
-                  buffer.append(gsym->name());
-                  // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
-                }
-              else
-                {
-                  // Symbol name is not available, like for a local symbol,
-                  // use object and section id.
-                  buffer.append(it_v->first->name());
-                  char secn_id[10];
-                  snprintf(secn_id, sizeof(secn_id), "%u",it_v->second);
-                  buffer.append(secn_id);
-                  // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
-                }
-            }
+		}
+	      else
+		{
+		  // Use the entsize to determine the length to hash.
+		  uint64_t bufsize = entsize;
+		  // If entsize is too big, hash all the remaining bytes.
+		  if ((offset + entsize) > secn_len)
+		    bufsize = secn_len - offset;
+		  identity->add(str_contents, bufsize);
+		}
+	      identity->add("@", 1);
+	    }
+	  else if (gsym != NULL)
+	    {
+	      // If symbol name is available use that.
+	      identity->add(gsym->name());
+	      // Append the addend.
+	      identity->add(addend_str, addend_len);
+	      identity->add("@", 1);
+	    }
+	  else
+	    {
+	      // Symbol name is not available, like for a local symbol,
+	      // use object and section id.
+	      identity->add(it_v->first->name());
+	      char secn_id[10];
+	      snprintf(secn_id, sizeof(secn_id), "%u",it_v->second);
+	      identity->add(secn_id);
+	      // Append the addend.
+	      identity->add(addend_str, addend_len);
+	      identity->add("@", 1);
+	    }
         }
     }
 
-  if (first_iteration)
-    {
-      buffer.append("Contents = ");
+  identity->add("Contents = ");
 
-      const unsigned char* slice_end =
-	contents + std::min<section_offset_type>(plen, end_offset);
+  const unsigned char* slice_end =
+    contents + std::min<section_offset_type>(plen, end_offset);
 
-      if (contents + start_offset < slice_end)
-	{
-	  buffer.append(reinterpret_cast<const char*>(contents + start_offset),
-			slice_end - (contents + start_offset));
-	}
-    }
+  if (contents + start_offset < slice_end)
+    identity->add(contents + start_offset,
+		  slice_end - (contents + start_offset));
 
   // Add any extra identity regions.
   std::pair<Icf::Extra_identity_list::const_iterator,
@@ -616,182 +726,294 @@ get_section_contents(bool first_iteration,
   for (Icf::Extra_identity_list::const_iterator it_ext = extra_range.first;
        it_ext != extra_range.second; ++it_ext)
     {
-      std::string external_fixed;
-      std::string external_all =
-	get_section_contents(first_iteration, &external_fixed,
-			     it_ext->second.section, self_secn,
-			     num_tracked_relocs, symtab,
-			     kept_section_id, it_ext->second.offset,
-			     it_ext->second.offset + it_ext->second.length);
-      buffer.append(external_fixed);
-      icf_reloc_buffer.append(external_all, external_fixed.length(),
-			      std::string::npos);
+      if (!hash_fixed_contents(it_ext->second.section, self_secn, symtab,
+			       locked_object, identity, it_ext->second.offset,
+			       (it_ext->second.offset
+				+ it_ext->second.length)))
+	return false;
     }
 
-  if (first_iteration)
-    {
-      // Store the section contents that don't change to avoid recomputing
-      // during the next call to this function.
-      *fixed_cache = buffer;
-    }
-  else
+  return true;
+}
+
+// Compute the hashes of a candidate section that do not change from
+// iteration to iteration.  Returns false, leaving HASH untouched, if
+// LOCKED_OBJECT is not NULL and the section refers to the contents of
+// another object.  Such sections are hashed later, single-threaded.
+
+static bool
+hash_section(const Section_id& secn, Symbol_table* symtab,
+	     const Relobj* locked_object, Icf::Section_hash* hash)
+{
+  Icf::Section_hash h;
+  Section_identity identity(&h);
+  if (!hash_fixed_contents(secn, secn, symtab, locked_object, &identity))
+    return false;
+  h.contents_crc = hash->contents_crc;
+  h.has_contents_crc = hash->has_contents_crc;
+  h.is_hashed = true;
+  *hash = h;
+  return true;
+}
+
+// This appends the part of a section's identity that changes from
+// iteration to iteration to BUFFER: the relocs pointing to sections
+// that could be folded, which are identified by the section they are
+// currently folded into.
+// Parameters  :
+// SECN               : Section for which relocs are appended.
+// SELF_SECN          : As for hash_fixed_contents.
+// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
+// BUFFER             : String to append to.
+// START_OFFSET       : Only consider the part of the section at and after
+//                      this offset.
+// END_OFFSET         : Only consider the part of the section before this
+//                      offset.
+
+static void
+get_icf_relocs(const Section_id& secn,
+	       const Section_id& self_secn,
+	       Symbol_table* symtab,
+	       const std::vector<unsigned int>& kept_section_id,
+	       std::string* buffer,
+	       section_offset_type start_offset = 0,
+	       section_offset_type end_offset =
+		 std::numeric_limits<section_offset_type>::max())
+{
+  Icf::Reloc_info_list& reloc_info_list =
+    symtab->icf()->reloc_info_list();
+
+  Icf::Reloc_info_list::const_iterator it_reloc_info_list =
+    reloc_info_list.find(secn);
+
+  if (it_reloc_info_list != reloc_info_list.end())
     {
-      gold_assert(buffer.empty());
+      const Icf::Sections_reachable_info &v =
+        (it_reloc_info_list->second).section_info;
+      const Icf::Symbol_info &s = (it_reloc_info_list->second).symbol_info;
+      const Icf::Addend_info &a = (it_reloc_info_list->second).addend_info;
+      const Icf::Offset_info &o = (it_reloc_info_list->second).offset_info;
+      Icf::Sections_reachable_info::const_iterator it_v = v.begin();
+      Icf::Symbol_info::const_iterator it_s = s.begin();
+      Icf::Addend_info::const_iterator it_a = a.begin();
+      Icf::Offset_info::const_iterator it_o = o.begin();
+
+      for (; it_v != v.end(); ++it_v, ++it_s, ++it_a, ++it_o)
+        {
+	  if (static_cast<section_offset_type>(*it_o) < start_offset
+	      || static_cast<section_offset_type>(*it_o) >= end_offset
+	      || it_v->first == NULL)
+	    continue;
+
+	  Symbol* gsym = *it_s;
+	  if (gsym == reinterpret_cast<Symbol*>(-1))
+	    gsym = NULL;
 
-      // Reuse the contents computed in the previous iteration.
-      buffer.append(*fixed_cache);
+          Section_id reloc_secn(it_v->first, it_v->second);
+          if (reloc_secn.first == self_secn.first
+              && reloc_secn.second == self_secn.second)
+	    continue;
+
+	  unsigned int secn_id = tracked_section_id(symtab, reloc_secn, gsym);
+	  if (secn_id == -1U)
+	    continue;
+
+	  char kept_section_str[10];
+	  snprintf(kept_section_str, sizeof(kept_section_str), "%u",
+		   kept_section_id[secn_id]);
+	  char addend_str[addend_str_size];
+	  size_t addend_len =
+	    format_addend(addend_str, (*it_a).first, (*it_a).second,
+			  *it_o - start_offset);
+	  buffer->append(kept_section_str);
+	  // Append the addend.
+	  buffer->append(addend_str, addend_len);
+	  buffer->append("@");
+	}
     }
 
-  buffer.append(icf_reloc_buffer);
-  return buffer;
+  // Add any extra identity regions.
+  std::pair<Icf::Extra_identity_list::const_iterator,
+	    Icf::Extra_identity_list::const_iterator>
+    extra_range = symtab->icf()->extra_identity_list().equal_range(secn);
+  for (Icf::Extra_identity_list::const_iterator it_ext = extra_range.first;
+       it_ext != extra_range.second; ++it_ext)
+    get_icf_relocs(it_ext->second.section, self_secn, symtab,
+		   kept_section_id, buffer, it_ext->second.offset,
+		   it_ext->second.offset + it_ext->second.length);
 }
 
-// This function computes a checksum on each section to detect and form
-// groups of identical sections.  The first iteration does this for all 
+// Write the fixed part of the identity of SECN to BUFFER: the bytes
+// whose MD5 state is saved in its Section_hash.  This is used to
+// confirm that two sections with the same digest really are identical.
+
+static void
+get_fixed_identity(const Section_id& secn, Symbol_table* symtab,
+		   std::string* buffer)
+{
+  // Lock the object so we can read from it.  This is only called
+  // single-threaded from queue_middle_tasks, so it is OK to lock.
+  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+  Task_lock_obj<Object> tl(dummy_task, secn.first);
+
+  Section_identity identity(buffer);
+  bool ok = hash_fixed_contents(secn, secn, symtab, NULL, &identity);
+  gold_assert(ok);
+}
+
+// The MD5 digest of a section's identity: its fixed part followed by
+// its relocs to sections that could be folded.
+
+struct Section_digest
+{
+  unsigned char md5[16];
+
+  bool
+  operator==(const Section_digest& d) const
+  { return memcmp(this->md5, d.md5, sizeof(this->md5)) == 0; }
+};
+
+struct Section_digest_hash
+{
+  size_t
+  operator()(const Section_digest& d) const
+  {
+    size_t h;
+    memcpy(&h, d.md5, sizeof(h));
+    return h;
+  }
+};
+
+// This function computes a digest on each section to detect and form
+// groups of identical sections.  The first iteration does this for all
 // sections.
 // Further iterations do this only for the kept sections from each group to
 // determine if larger groups of identical sections could be formed.  The
 // first section in each group is the kept section for that group.
 //
-// CRC32 is the checksumming algorithm and can have collisions.  That is,
-// two sections with different contents can have the same checksum. Hence,
-// a multimap is used to maintain more than one group of checksum
-// identical sections.  A section is added to a group only after its
-// contents are explicitly compared with the kept section of the group.
+// The digest is the MD5 of the section's text and relocs.  Only the
+// relocs to sections that might be folded change from one iteration to
+// the next, so the MD5 state after the rest has been hashed is saved
+// and only those relocs are hashed in each iteration.
+//
+// Different sections can have the same digest, so a multimap is used
+// to maintain more than one group of sections with the same digest.
+// A section is added to a group only after its identity is compared
+// byte for byte with that of the kept section of the group.  The
+// identities are built for each comparison and freed right after it,
+// so that at most two of them are held at a time.
 //
 // Parameters  :
 // ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
 // ID_SECTION         : Vector mapping a section to an unique integer.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
+// SECTION_HASHES     : The hashes of each section that do not change from
+//                      iteration to iteration.  Those not yet computed
+//                      are computed in the first iteration.
 
 static bool
 match_sections(unsigned int iteration_num,
                Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
                std::vector<unsigned int>* kept_section_id,
                const std::vector<Section_id>& id_section,
 	       const std::vector<uint64_t>& section_addraligns,
                std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+               std::vector<Icf::Section_hash>* section_hashes)
 {
-  Unordered_multimap<uint32_t, unsigned int> section_cksum;
-  std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
-            Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
+  typedef Unordered_multimap<Section_digest, unsigned int,
+			     Section_digest_hash> Section_digests;
+  Section_digests section_digests;
+  // The relocs to sections that might be folded of each section, as
+  // hashed in this iteration.
+  std::vector<std::string> icf_relocs(id_section.size());
   bool converged = true;
 
-  if (iteration_num == 1)
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   NULL);
-  else
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   section_contents);
-
-  std::vector<std::string> full_section_contents;
+  preprocess_for_unique_sections(is_secn_or_group_unique, *section_hashes,
+				 iteration_num == 1);
 
   for (unsigned int i = 0; i < id_section.size(); i++)
     {
-      full_section_contents.push_back("");
       if ((*is_secn_or_group_unique)[i])
         continue;
 
       Section_id secn = id_section[i];
+      Icf::Section_hash* hash = &(*section_hashes)[i];
 
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from queue_middle_tasks, so it is OK to lock.
-      // Unfortunately we have no way to pass in a Task token.
-      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-      Task_lock_obj<Object> tl(dummy_task, secn.first);
+      if (iteration_num != 1 && (*kept_section_id)[i] != i)
+	{
+	  // This section is already folded into something.
+	  continue;
+	}
 
-      std::string this_secn_contents;
-      uint32_t cksum;
-      std::string* this_secn_cache = &((*section_contents)[i]);
-      if (iteration_num == 1)
-        {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, this_secn_cache,
-						    secn, secn, &num_relocs,
-						    symtab, (*kept_section_id));
-          (*num_tracked_relocs)[i] = num_relocs;
-        }
-      else
-        {
-          if ((*kept_section_id)[i] != i)
-            {
-              // This section is already folded into something.
-              continue;
-            }
-          this_secn_contents = get_section_contents(false, this_secn_cache,
-						    secn, secn, NULL,
-						    symtab, (*kept_section_id));
-        }
+      if (!hash->is_hashed)
+	{
+	  gold_assert(iteration_num == 1);
+
+	  // Lock the object so we can read from it.  This is only called
+	  // single-threaded from queue_middle_tasks, so it is OK to lock.
+	  // Unfortunately we have no way to pass in a Task token.
+	  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+	  Task_lock_obj<Object> tl(dummy_task, secn.first);
+	  bool ok = hash_section(secn, symtab, NULL, hash);
+	  gold_assert(ok);
+	}
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
-      size_t count = section_cksum.count(cksum);
+      get_icf_relocs(secn, secn, symtab, *kept_section_id, &icf_relocs[i]);
 
-      if (count == 0)
-        {
-          // Start a group with this cksum.
-          section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
-        }
+      md5_ctx ctx = hash->fixed_md5;
+      md5_process_bytes(icf_relocs[i].data(), icf_relocs[i].length(), &ctx);
+      Section_digest digest;
+      md5_finish_ctx(&ctx, digest.md5);
+
+      std::pair<Section_digests::iterator, Section_digests::iterator>
+	key_range = section_digests.equal_range(digest);
+      Section_digests::iterator it = key_range.first;
+      if (it != key_range.second)
+	{
+	  std::string this_fixed;
+	  for (; it != key_range.second; ++it)
+	    {
+	      unsigned int kept = it->second;
+	      if (icf_relocs[kept] != icf_relocs[i])
+		continue;
+	      if (this_fixed.empty())
+		get_fixed_identity(secn, symtab, &this_fixed);
+	      std::string kept_fixed;
+	      get_fixed_identity(id_section[kept], symtab, &kept_fixed);
+	      if (kept_fixed == this_fixed)
+		break;
+	    }
+	}
+
+      if (it == key_range.second)
+	section_digests.insert(std::make_pair(digest, i));
       else
-        {
-          key_range = section_cksum.equal_range(cksum);
-          Unordered_multimap<uint32_t, unsigned int>::iterator it;
-          // Search all the groups with this cksum for a match.
-          for (it = key_range.first; it != key_range.second; ++it)
-            {
-              unsigned int kept_section = it->second;
-              if (full_section_contents[kept_section].length()
-                  != this_secn_contents.length())
-                  continue;
-              if (memcmp(full_section_contents[kept_section].c_str(),
-                         this_secn_contents.c_str(),
-                         this_secn_contents.length()) != 0)
-                  continue;
-
-	      // Check section alignment here.
-	      // The section with the larger alignment requirement
-	      // should be kept.  We assume alignment can only be 
-	      // zero or positive integral powers of two.
-	      uint64_t align_i = section_addraligns[i];
-	      uint64_t align_kept = section_addraligns[kept_section];
-	      if (align_i <= align_kept)
-		{
-		  (*kept_section_id)[i] = kept_section;
-		}
-	      else
-		{
-		  (*kept_section_id)[kept_section] = i;
-		  it->second = i;
-		  full_section_contents[kept_section].swap(
-		      full_section_contents[i]);
-		}
+	{
+	  unsigned int kept_section = it->second;
+
+	  // Check section alignment here.
+	  // The section with the larger alignment requirement
+	  // should be kept.  We assume alignment can only be
+	  // zero or positive integral powers of two.
+	  uint64_t align_i = section_addraligns[i];
+	  uint64_t align_kept = section_addraligns[kept_section];
+	  if (align_i <= align_kept)
+	    {
+	      (*kept_section_id)[i] = kept_section;
+	    }
+	  else
+	    {
+	      (*kept_section_id)[kept_section] = i;
+	      it->second = i;
+	    }
 
-              converged = false;
-              break;
-            }
-          if (it == key_range.second)
-            {
-              // Create a new group for this cksum.
-              section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
-            }
-        }
+	  converged = false;
+	}
       // If there are no relocs to foldable sections do not process
       // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
+      if (iteration_num == 1 && hash->num_tracked_relocs == 0)
         (*is_secn_or_group_unique)[i] = true;
     }
 
@@ -943,22 +1165,17 @@ Icf::add_ehframe_links(Relobj* object, unsigned int ehframe_shndx,
   return true;
 }
 
-// This is the main ICF function called in gold.cc.  This does the
-// initialization and calls match_sections repeatedly (thrice by default)
-// which computes the crc checksums and detects identical functions.
+// Decide which sections are possible candidates for folding, and
+// prepare their relocs for hashing.
 
 void
-Icf::find_identical_sections(const Input_objects* input_objects,
-                             Symbol_table* symtab)
+Icf::find_candidate_sections(const Input_objects* input_objects,
+			     Symbol_table* symtab)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
-  std::vector<uint64_t> section_addraligns;
-  std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
 
-  // Decide which sections are possible candidates first.
+  gold_assert(!this->candidates_ready_);
 
   for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
        p != input_objects->relobj_end();
@@ -999,10 +1216,7 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
-	  section_addraligns.push_back((*p)->section_addralign(i));
-          is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
+	  this->section_addraligns_.push_back((*p)->section_addralign(i));
           section_num++;
         }
 
@@ -1032,6 +1246,149 @@ Icf::find_identical_sections(const Input_objects* input_objects,
 	}
     }
 
+  this->section_hashes_.resize(section_num);
+
+  // Look through function descriptors before hashing anything, since
+  // the hashing may run in parallel.
+  for (unsigned int i = 0; i < section_num; ++i)
+    find_function_locations(this->id_section_[i], symtab);
+
+  this->candidates_ready_ = true;
+}
+
+// This task hashes the candidate sections of a single object.
+
+class Icf_hash_task : public Task
+{
+ public:
+  Icf_hash_task(Symbol_table* symtab, Relobj* object, unsigned int first,
+		unsigned int last, Task_token* final_blocker)
+    : symtab_(symtab), object_(object), first_(first), last_(last),
+      final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  {
+    this->symtab_->icf()->hash_sections(this->symtab_, this->object_,
+					this->first_, this->last_);
+    this->object_->release();
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  // Lock the object, and unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  {
+    tl->add(this, this->object_->token());
+    tl->add(this, this->final_blocker_);
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_hash_task " + this->object_->name(); }
+
+ private:
+  Symbol_table* symtab_;
+  Relobj* object_;
+  const unsigned int first_;
+  const unsigned int last_;
+  Task_token* const final_blocker_;
+};
+
+// Find the candidate sections and queue a task to hash the candidate
+// sections of each object.
+
+Task_token*
+Icf::queue_hash_tasks(const Input_objects* input_objects,
+		      Symbol_table* symtab, Workqueue* workqueue)
+{
+  this->find_candidate_sections(input_objects, symtab);
+
+  Task_token* blocker = new Task_token(true);
+  unsigned int first = 0;
+  while (first < this->id_section_.size())
+    {
+      Relobj* object = this->id_section_[first].first;
+      unsigned int last = first + 1;
+      while (last < this->id_section_.size()
+	     && this->id_section_[last].first == object)
+	++last;
+      blocker->add_blocker();
+      workqueue->queue(new Icf_hash_task(symtab, object, first, last,
+					 blocker));
+      first = last;
+    }
+  return blocker;
+}
+
+// Hash the candidate sections FIRST through LAST - 1 of OBJECT.  This
+// runs in an Icf_hash_task, so it may only read from OBJECT.  Sections
+// which need the contents of other objects are left to be hashed by
+// find_identical_sections.
+
+void
+Icf::hash_sections(Symbol_table* symtab, Relobj* object, unsigned int first,
+		   unsigned int last)
+{
+  for (unsigned int i = first; i < last; ++i)
+    {
+      const Section_id& secn = this->id_section_[i];
+      gold_assert(secn.first == object);
+      Section_hash* hash = &this->section_hashes_[i];
+
+      section_size_type plen;
+      const unsigned char* contents =
+	object->section_contents(secn.second, &plen, false);
+      hash->contents_crc = xcrc32(contents, plen, 0xffffffff);
+      hash->has_contents_crc = true;
+
+      hash_section(secn, symtab, object, hash);
+    }
+}
+
+// This is the main ICF function called in gold.cc.  This does the
+// initialization and calls match_sections repeatedly (thrice by default)
+// which computes the digests and detects identical functions.  If
+// queue_hash_tasks has been called, most sections have already been
+// hashed.
+
+void
+Icf::find_identical_sections(const Input_objects* input_objects,
+                             Symbol_table* symtab)
+{
+  if (!this->candidates_ready_)
+    this->find_candidate_sections(input_objects, symtab);
+
+  std::vector<bool> is_secn_or_group_unique(this->id_section_.size(), false);
+
+  for (unsigned int i = 0; i < this->id_section_.size(); ++i)
+    {
+      Section_hash* hash = &this->section_hashes_[i];
+      if (hash->has_contents_crc)
+	continue;
+
+      Section_id secn = this->id_section_[i];
+
+      // Lock the object so we can read from it.  This is only called
+      // single-threaded from queue_middle_tasks, so it is OK to lock.
+      // Unfortunately we have no way to pass in a Task token.
+      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+      Task_lock_obj<Object> tl(dummy_task, secn.first);
+      section_size_type plen;
+      const unsigned char* contents =
+	secn.first->section_contents(secn.second, &plen, false);
+      hash->contents_crc = xcrc32(contents, plen, 0xffffffff);
+      hash->has_contents_crc = true;
+    }
+
   unsigned int num_iterations = 0;
 
   // Default number of iterations to run ICF is 3.
@@ -1045,11 +1402,15 @@ Icf::find_identical_sections(const Input_objects* input_objects,
     {
       num_iterations++;
       converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
-                                 this->id_section_, section_addraligns,
-                                 &is_secn_or_group_unique, &section_contents);
+                                 &this->kept_section_id_,
+                                 this->id_section_, this->section_addraligns_,
+                                 &is_secn_or_group_unique,
+				 &this->section_hashes_);
     }
 
+  // The hashes are not needed any more.
+  std::vector<Section_hash>().swap(this->section_hashes_);
+
   if (parameters->options().print_icf_sections())
     {
       if (converged)
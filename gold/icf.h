@@ -25,6 +25,8 @@
 
 #include <vector>
 
+#include "md5.h"
+
 #include "elfcpp.h"
 #include "symtab.h"
 #include "object.h"
@@ -35,6 +37,8 @@ namespace gold
 class Object;
 class Input_objects;
 class Symbol_table;
+class Workqueue;
+class Task_token;
 
 class Icf
 {
@@ -77,10 +81,40 @@ class Icf
 
   typedef std::multimap<Section_id, Extra_identity_info> Extra_identity_list;
 
+  // The hashes of a candidate section that are computed once, before
+  // the first iteration.  The fixed part of a section's identity is
+  // its contents together with its relocations to sections that
+  // cannot be folded; it does not change from iteration to iteration.
+  struct Section_hash
+  {
+    Section_hash()
+      : contents_crc(0), fixed_crc(0xffffffff), fixed_md5(),
+	num_tracked_relocs(0), has_contents_crc(false), is_hashed(false)
+    { md5_init_ctx(&this->fixed_md5); }
+
+    // CRC32 of the section contents.
+    uint32_t contents_crc;
+    // CRC32 of the fixed part.
+    uint32_t fixed_crc;
+    // MD5 state after hashing the fixed part.  Each iteration
+    // finishes a copy of this with the relocations to sections that
+    // might be folded.
+    md5_ctx fixed_md5;
+    // The number of relocations to sections that might be folded.
+    unsigned int num_tracked_relocs;
+    // Whether CONTENTS_CRC has been computed.
+    bool has_contents_crc;
+    // Whether FIXED_CRC, FIXED_MD5 and NUM_TRACKED_RELOCS have been
+    // computed.
+    bool is_hashed;
+  };
+
   Icf()
   : id_section_(), section_id_(), kept_section_id_(),
     fptr_section_id_(),
     icf_ready_(false),
+    candidates_ready_(false),
+    section_addraligns_(), section_hashes_(),
     reloc_info_list_()
   { }
 
@@ -95,6 +129,20 @@ class Icf
   find_identical_sections(const Input_objects* input_objects,
                           Symbol_table* symtab);
 
+  // Decides which sections are candidates for folding and queues
+  // tasks which hash them in parallel, one task per object.  Returns
+  // a blocker which is released when all the sections have been
+  // hashed; find_identical_sections should run after that.
+  Task_token*
+  queue_hash_tasks(const Input_objects* input_objects, Symbol_table* symtab,
+		   Workqueue* workqueue);
+
+  // Hashes the candidate sections FIRST through LAST - 1, all of
+  // which are in OBJECT.  OBJECT must be locked by the caller.
+  void
+  hash_sections(Symbol_table* symtab, Relobj* object, unsigned int first,
+		unsigned int last);
+
   // This is set when ICF has been run and the groups of
   // identical sections have been formed.
   void
@@ -167,6 +215,10 @@ class Icf
   add_ehframe_links(Relobj* object, unsigned int ehframe_shndx,
 		    Reloc_info& ehframe_relocs);
 
+  void
+  find_candidate_sections(const Input_objects* input_objects,
+			  Symbol_table* symtab);
+
   // Maps integers to sections.
   std::vector<Section_id> id_section_;
   // Does the reverse.
@@ -181,6 +233,12 @@ class Icf
   Secn_fptr_taken_set fptr_section_id_;
   // Flag to indicate if ICF has been run.
   bool icf_ready_;
+  // Flag to indicate if the candidate sections have been found.
+  bool candidates_ready_;
+  // The alignment of each candidate section.
+  std::vector<uint64_t> section_addraligns_;
+  // The hashes of each candidate section.
+  std::vector<Section_hash> section_hashes_;
   // This list is populated by gc_process_relocs in gc.h.
   Reloc_info_list reloc_info_list_;
   // Regions of other sections that should be considered part of
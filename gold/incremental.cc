@@ -2548,7 +2548,8 @@ template<int size, bool big_endian>
 void
 Sized_relobj_incr<size, big_endian>::do_relocate(const Symbol_table*,
 						 const Layout* layout,
-						 Output_file* of)
+						 Output_file* of,
+						 Workqueue*)
 {
   if (this->incr_reloc_count_ == 0)
     return;
@@ -2016,7 +2016,8 @@ class Sized_relobj_incr : public Sized_relobj<size, big_endian>
 
   // Relocate the input sections and write out the local symbols.
   void
-  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of);
+  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of,
+	      Workqueue*);
 
   // Set the offset of a section.
   void
@@ -50,12 +50,16 @@
 #include "ehframe.h"
 #include "gdb-index.h"
 #include "compressed_output.h"
+#include "merge.h"
 #include "reduced_debug_output.h"
 #include "object.h"
 #include "reloc.h"
 #include "descriptors.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "call-graph.h"
+#include "fast-hash.h"
+#include "stats.h"
 #include "layout.h"
 
 namespace gold
@@ -225,32 +229,49 @@ Free_list::dump()
 void
 Free_list::print_stats()
 {
-  fprintf(stderr, _("%s: total free lists: %u\n"),
-	  program_name, Free_list::num_lists);
-  fprintf(stderr, _("%s: total free list nodes: %u\n"),
-	  program_name, Free_list::num_nodes);
-  fprintf(stderr, _("%s: calls to Free_list::remove: %u\n"),
-	  program_name, Free_list::num_removes);
-  fprintf(stderr, _("%s: nodes visited: %u\n"),
-	  program_name, Free_list::num_remove_visits);
-  fprintf(stderr, _("%s: calls to Free_list::allocate: %u\n"),
-	  program_name, Free_list::num_allocates);
-  fprintf(stderr, _("%s: nodes visited: %u\n"),
-	  program_name, Free_list::num_allocate_visits);
-}
-
-// A Hash_task computes the MD5 checksum of an array of char.
+  if (parameters->options().stats())
+    {
+      fprintf(stderr, _("%s: total free lists: %u\n"),
+	      program_name, Free_list::num_lists);
+      fprintf(stderr, _("%s: total free list nodes: %u\n"),
+	      program_name, Free_list::num_nodes);
+      fprintf(stderr, _("%s: calls to Free_list::remove: %u\n"),
+	      program_name, Free_list::num_removes);
+      fprintf(stderr, _("%s: nodes visited: %u\n"),
+	      program_name, Free_list::num_remove_visits);
+      fprintf(stderr, _("%s: calls to Free_list::allocate: %u\n"),
+	      program_name, Free_list::num_allocates);
+      fprintf(stderr, _("%s: nodes visited: %u\n"),
+	      program_name, Free_list::num_allocate_visits);
+    }
+  record_stat("total free lists", Free_list::num_lists);
+  record_stat("total free list nodes", Free_list::num_nodes);
+  record_stat("calls to Free_list::remove", Free_list::num_removes);
+  record_stat("Free_list::remove nodes visited",
+	      Free_list::num_remove_visits);
+  record_stat("calls to Free_list::allocate", Free_list::num_allocates);
+  record_stat("Free_list::allocate nodes visited",
+	      Free_list::num_allocate_visits);
+}
+
+// A Hash_task computes the checksum of a range of the output file,
+// using HASH, which is md5_buffer or fast_hash_buffer.  If
+// THIS_BLOCKER is not NULL, it waits until that range is complete.
 
 class Hash_task : public Task
 {
  public:
+  typedef void* (*Hash_function)(const char*, size_t, void*);
+
   Hash_task(Output_file* of,
 	    size_t offset,
 	    size_t size,
 	    unsigned char* dst,
-	    Task_token* final_blocker)
+	    Task_token* final_blocker,
+	    Hash_function hash = md5_buffer,
+	    Task_token* this_blocker = NULL)
     : of_(of), offset_(offset), size_(size), dst_(dst),
-      final_blocker_(final_blocker)
+      final_blocker_(final_blocker), hash_(hash), this_blocker_(this_blocker)
   { }
 
   void
@@ -258,13 +279,17 @@ class Hash_task : public Task
   {
     const unsigned char* iv =
 	this->of_->get_input_view(this->offset_, this->size_);
-    md5_buffer(reinterpret_cast<const char*>(iv), this->size_, this->dst_);
+    this->hash_(reinterpret_cast<const char*>(iv), this->size_, this->dst_);
     this->of_->free_input_view(this->offset_, this->size_, iv);
   }
 
   Task_token*
   is_runnable()
-  { return NULL; }
+  {
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
 
   // Unblock FINAL_BLOCKER_ when done.
   void
@@ -281,6 +306,8 @@ class Hash_task : public Task
   const size_t size_;
   unsigned char* const dst_;
   Task_token* const final_blocker_;
+  const Hash_function hash_;
+  Task_token* const this_blocker_;
 };
 
 // Layout::Relaxation_debug_check methods.
@@ -447,10 +474,14 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     eh_frame_data_(NULL),
     added_eh_frame_data_(false),
     eh_frame_hdr_section_(NULL),
+    eh_frame_hdr_data_(NULL),
+    dynamic_reloc_section_(NULL),
     gdb_index_data_(NULL),
     build_id_note_(NULL),
     debug_abbrev_(NULL),
     debug_info_(NULL),
+    compressed_sections_(),
+    relr_sections_(),
     group_signatures_(),
     output_file_size_(-1),
     have_added_input_section_(false),
@@ -473,6 +504,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     section_segment_map_(),
     input_section_position_(),
     input_section_glob_(),
+    call_graph_(NULL),
     incremental_base_(NULL),
     free_list_(),
     gnu_properties_()
@@ -1521,6 +1553,103 @@ Layout::finalize_eh_frame_section()
     }
 }
 
+// Queue the tasks which finish merging the strings of SHF_MERGE and
+// SHF_STRINGS sections.  The strings of each section are hashed in
+// parallel, and then split into shards by hash code, so that each
+// shard can be deduplicated in parallel.
+
+Task_token*
+Layout::queue_merged_strings_tasks(Workqueue* workqueue, int thread_count,
+				   Task_token* this_blocker)
+{
+  // Scanning all the hash codes of a section is cheap compared to
+  // looking up strings, but each shard does it, so don't use too many
+  // shards.
+  const size_t max_shard_count = 32;
+  // Don't bother splitting up small sections.
+  const size_t strings_per_shard = 4096;
+
+  std::vector<Output_merge_base*>* sections =
+    new std::vector<Output_merge_base*>;
+  std::vector<size_t> hash_task_counts;
+  std::vector<size_t> shard_counts;
+  int shard_total = 0;
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    {
+      const Output_section::Input_section_list& input_sections =
+	(*p)->input_sections();
+      for (Output_section::Input_section_list::const_iterator q =
+	     input_sections.begin();
+	   q != input_sections.end();
+	   ++q)
+	{
+	  if (!q->is_merge_section())
+	    continue;
+	  Output_merge_base* pomb = q->output_merge_base();
+	  size_t input_count = pomb->pending_input_count();
+	  if (input_count == 0)
+	    continue;
+	  size_t string_count = pomb->pending_string_count();
+	  size_t hash_task_count =
+	    std::min(input_count, static_cast<size_t>(thread_count));
+	  size_t shard_count =
+	    std::min(std::min(1 + string_count / strings_per_shard,
+			      max_shard_count),
+		     static_cast<size_t>(thread_count));
+	  sections->push_back(pomb);
+	  hash_task_counts.push_back(hash_task_count);
+	  shard_counts.push_back(shard_count);
+	  shard_total += shard_count;
+	}
+    }
+
+  if (sections->empty())
+    {
+      delete sections;
+      return this_blocker;
+    }
+
+  Task_token* hashed_blocker = new Task_token(true);
+  Task_token* found_blocker = new Task_token(true);
+  Task_token* next_blocker = new Task_token(true);
+  for (size_t i = 0; i < sections->size(); ++i)
+    hashed_blocker->add_blockers(hash_task_counts[i]);
+  found_blocker->add_blockers(shard_total);
+  next_blocker->add_blocker();
+
+  for (size_t i = 0; i < sections->size(); ++i)
+    {
+      Output_merge_base* pomb = (*sections)[i];
+      size_t input_count = pomb->pending_input_count();
+      size_t task_count = hash_task_counts[i];
+      for (size_t j = 0; j < task_count; ++j)
+	{
+	  size_t begin = input_count * j / task_count;
+	  size_t end = input_count * (j + 1) / task_count;
+	  workqueue->queue(new Hash_merged_strings_task(pomb, begin, end,
+							hashed_blocker));
+	}
+    }
+
+  for (size_t i = 0; i < sections->size(); ++i)
+    {
+      unsigned int shard_count = shard_counts[i];
+      for (unsigned int j = 0; j < shard_count; ++j)
+	workqueue->queue(new Find_merged_duplicates_task((*sections)[i], j,
+							 shard_count,
+							 hashed_blocker,
+							 found_blocker));
+    }
+
+  workqueue->queue(new Add_merged_strings_task(sections, this_blocker,
+					       hashed_blocker, found_blocker,
+					       next_blocker));
+
+  return next_blocker;
+}
+
 // Create and return the magic .eh_frame section.  Create
 // .eh_frame_hdr also if appropriate.  OBJECT is the object with the
 // input .eh_frame section; it may be NULL.
@@ -1573,6 +1702,7 @@ Layout::make_eh_frame_section(const Relobj* object)
 		}
 
 	      this->eh_frame_data_->set_eh_frame_hdr(hdr_posd);
+	      this->eh_frame_hdr_data_ = hdr_posd;
 	    }
 	}
     }
@@ -1653,6 +1783,16 @@ Layout::add_to_gdb_index(bool is_type_unit,
 					 reloc_type);
 }
 
+// Queue the tasks to scan the sections recorded by add_to_gdb_index.
+
+Task_token*
+Layout::queue_gdb_index_tasks(Workqueue* workqueue, Task_token* this_blocker)
+{
+  if (this->gdb_index_data_ == NULL)
+    return this_blocker;
+  return this->gdb_index_data_->queue_scan_tasks(workqueue, this_blocker);
+}
+
 // Add POSD to an output section using NAME, TYPE, and FLAGS.  Return
 // the output section.
 
@@ -1697,8 +1837,13 @@ Layout::make_output_section(const char* name, elfcpp::Elf_Word type,
   if ((flags & elfcpp::SHF_ALLOC) == 0
       && strcmp(parameters->options().compress_debug_sections(), "none") != 0
       && is_compressible_debug_section(name))
-    os = new Output_compressed_section(&parameters->options(), name, type,
-				       flags);
+    {
+      Output_compressed_section* ocs =
+	new Output_compressed_section(&parameters->options(), name, type,
+				      flags);
+      this->compressed_sections_.push_back(ocs);
+      os = ocs;
+    }
   else if ((flags & elfcpp::SHF_ALLOC) == 0
 	   && parameters->options().strip_debug_non_line()
 	   && strcmp(".debug_abbrev", name) == 0)
@@ -2693,6 +2838,55 @@ Layout::reset_relax_output()
   this->relax_output_list_.clear();
 }
 
+// Add the SHT_RELR section RELR.  The dynamic linker finds it through
+// the DT_RELR and DT_RELRSZ tags, so its placement is not required;
+// we put it with the dynamic relocs to keep them together.
+
+void
+Layout::add_relr_section(Output_data_relr_generic* relr)
+{
+  gold_assert(!parameters->options().relocatable());
+  this->add_output_section_data(".relr.dyn", elfcpp::SHT_RELR,
+				elfcpp::SHF_ALLOC, relr,
+				ORDER_DYNAMIC_RELOCS, false);
+  this->relr_sections_.push_back(relr);
+}
+
+// Move the relocs in the SHT_RELR sections back to the dynamic reloc
+// sections, which will then not use DT_RELR.  The SHT_RELR sections
+// are left empty.
+
+void
+Layout::unpack_relr_sections()
+{
+  for (std::vector<Output_data_relr_generic*>::const_iterator p =
+	 this->relr_sections_.begin();
+       p != this->relr_sections_.end();
+       ++p)
+    (*p)->unpack();
+  this->relr_sections_.clear();
+}
+
+// Encode the SHT_RELR sections now that the sections have addresses.
+// Return true if any of them needs more space, or moved relocs back
+// into a dynamic reloc section, in which case we must lay out the
+// sections again.
+
+bool
+Layout::encode_relr_sections()
+{
+  bool relayout = false;
+  for (std::vector<Output_data_relr_generic*>::const_iterator p =
+	 this->relr_sections_.begin();
+       p != this->relr_sections_.end();
+       ++p)
+    {
+      if ((*p)->encode())
+	relayout = true;
+    }
+  return relayout;
+}
+
 // Prepare for relaxation.
 
 void
@@ -2945,6 +3139,42 @@ Layout::read_layout_from_file()
     }
 }
 
+// Read the call graph from the file specified with option
+// --call-graph-ordering-file.  We need to keep track of the input
+// sections from the start, so this is treated as specifying a section
+// order.
+
+void
+Layout::read_call_graph_from_file()
+{
+  gold_assert(this->call_graph_ == NULL);
+  this->call_graph_ = new Call_graph();
+  this->call_graph_->read(parameters->options().call_graph_ordering_file());
+  this->set_section_ordering_specified();
+}
+
+// Compute the order of the input sections from the call graph.  This
+// is called after all the input sections have been laid out and all
+// the symbols have been resolved.
+
+void
+Layout::order_sections_by_call_graph(const Task* task,
+				     const Input_objects* input_objects,
+				     const Symbol_table* symtab)
+{
+  gold_assert(this->call_graph_ != NULL);
+
+  if (!this->section_order_map_.empty())
+    {
+      gold_warning(_("ignoring --call-graph-ordering-file because "
+		     "a plugin specified the section order"));
+      return;
+    }
+
+  this->call_graph_->compute_order(task, input_objects, symtab, this,
+				   &this->section_order_map_);
+}
+
 // Finalize the layout.  When this is called, we have created all the
 // output sections and all the output segments which are based on
 // input sections.  We have several things to do, and we have to do
@@ -2984,6 +3214,19 @@ Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
   unsigned int local_dynamic_count = 0;
   unsigned int forced_local_dynamic_count = 0;
 
+  // A program using DT_RELR must refer to the GLIBC_ABI_DT_RELR
+  // version; see create_dynamic_symtab.  If no needed shared library
+  // defines it, the program could not be loaded, so put the relocs
+  // back in the dynamic reloc sections before the target adds the
+  // dynamic tags.
+  if (!this->relr_sections_.empty()
+      && Versions::version_need_dynobj(symtab, "GLIBC_ABI_DT_RELR") == NULL)
+    {
+      gold_warning(_("ignoring -z pack-relative-relocs because no "
+		     "needed shared library defines GLIBC_ABI_DT_RELR"));
+      this->unpack_relr_sections();
+    }
+
   target->finalize_sections(this, input_objects, symtab);
 
   this->count_local_symbols(task, input_objects);
@@ -3064,8 +3307,10 @@ Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
   unsigned int shndx;
   int pass = 0;
 
-  // Take a snapshot of the section layout as needed.
-  if (target->may_relax())
+  // Take a snapshot of the section layout as needed.  The SHT_RELR
+  // sections can only be encoded once the addresses are known, and
+  // may then need more space, so they use the same mechanism.
+  if (target->may_relax() || !this->relr_sections_.empty())
     this->prepare_for_relaxation();
 
   // Run the relaxation loop to lay out sections.
@@ -3076,8 +3321,9 @@ Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
 				       &shndx);
       pass++;
     }
-  while (target->may_relax()
-	 && target->relax(pass, input_objects, symtab, this, task));
+  while ((target->may_relax()
+	  && target->relax(pass, input_objects, symtab, this, task))
+	 || this->encode_relr_sections());
 
   // If there is a load segment that contains the file and program headers,
   // provide a symbol __ehdr_start pointing there.
@@ -3422,6 +3668,8 @@ Layout::create_build_id()
     descsz = 128 / 8;
   else if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
     descsz = 160 / 8;
+  else if (strcmp(style, "fast") == 0)
+    descsz = fast_hash_size;
   else if (strcmp(style, "uuid") == 0)
     {
 #ifndef __MINGW32__
@@ -3926,9 +4174,21 @@ Layout::set_segment_offsets(const Target* target, Output_segment* load_seg,
 	  uint64_t abi_pagesize = target->abi_pagesize();
 	  uint64_t common_pagesize = target->common_pagesize();
 
+	  // With --huge-page-size, start each read-only or executable
+	  // segment on a huge page boundary, with a file offset that is
+	  // congruent to the address modulo the huge page size, so that
+	  // the loader (or the kernel's THP support for file mappings)
+	  // can back the segment with huge pages.
+	  uint64_t huge_pagesize = 0;
+	  if (parameters->options().huge_page_size() > abi_pagesize
+	      && !parameters->options().nmagic()
+	      && !parameters->options().omagic()
+	      && ((*p)->flags() & elfcpp::PF_W) == 0)
+	    huge_pagesize = parameters->options().huge_page_size();
+
 	  if (!parameters->options().nmagic()
 	      && !parameters->options().omagic())
-	    (*p)->set_minimum_p_align(abi_pagesize);
+	    (*p)->set_minimum_p_align(std::max(abi_pagesize, huge_pagesize));
 
 	  if (!are_addresses_set)
 	    {
@@ -3938,7 +4198,8 @@ Layout::set_segment_offsets(const Target* target, Output_segment* load_seg,
 	      // put them on different pages in memory. We will revisit this
 	      // decision once we know the size of the segment.
 
-	      uint64_t max_align = (*p)->maximum_alignment();
+	      uint64_t max_align = std::max((*p)->maximum_alignment(),
+					    huge_pagesize);
 	      if (max_align > abi_pagesize)
 		addr = align_address(addr, max_align);
 	      aligned_addr = addr;
@@ -3961,7 +4222,8 @@ Layout::set_segment_offsets(const Target* target, Output_segment* load_seg,
 		  // But this is not the first segment!  To make its
 		  // address congruent with its offset, that address better
 		  // be aligned to the ABI-mandated page size.
-		  addr = align_address(addr, abi_pagesize);
+		  addr = align_address(addr, std::max(abi_pagesize,
+						      huge_pagesize));
 		  aligned_addr = addr;
 		}
 	      else
@@ -3979,7 +4241,8 @@ Layout::set_segment_offsets(const Target* target, Output_segment* load_seg,
 	      // Here we are also taking care of the case when
 	      // the maximum segment alignment is larger than the page size.
 	      off = align_file_offset(off, addr,
-				      std::max(abi_pagesize,
+				      std::max(std::max(abi_pagesize,
+							huge_pagesize),
 					       (*p)->maximum_alignment()));
 	    }
 	  else
@@ -4634,6 +4897,16 @@ Layout::create_dynamic_symtab(const Input_objects* input_objects,
   unsigned int local_symcount = index;
   unsigned int forced_local_count = 0;
 
+  // The GNU dynamic linker refuses to load a program with DT_RELR
+  // unless it refers to the GLIBC_ABI_DT_RELR version, which is how
+  // an older dynamic linker that does not support DT_RELR is made to
+  // fail cleanly.  No symbol has that version, so add it by hand.
+  // Layout::finalize has made sure that a needed shared library
+  // defines it.
+  if (!this->relr_sections_.empty())
+    pversions->record_version_need(symtab, &this->dynpool_,
+				   "GLIBC_ABI_DT_RELR");
+
   index = symtab->set_dynsym_indexes(index, &forced_local_count,
 				     pdynamic_symbols, &this->dynpool_,
 				     pversions);
@@ -5052,7 +5325,7 @@ Layout::create_interp(const Target* target)
 void
 Layout::add_target_dynamic_tags(bool use_rel, const Output_data* plt_got,
 				const Output_data* plt_rel,
-				const Output_data_reloc_generic* dyn_rel,
+				Output_data_reloc_generic* dyn_rel,
 				bool add_debug, bool dynrel_includes_plt)
 {
   Output_data_dynamic* odyn = this->dynamic_data_;
@@ -5126,6 +5399,22 @@ Layout::add_target_dynamic_tags(bool use_rel, const Output_data* plt_got,
 	}
     }
 
+  // Remember a sorted dynamic relocation section, so that
+  // queue_dynamic_reloc_tasks can sort it in parallel.
+  if (dyn_rel != NULL
+      && dyn_rel->output_section() != NULL
+      && dyn_rel->sort_relocs())
+    this->dynamic_reloc_section_ = dyn_rel;
+
+  if (dyn_rel != NULL && dyn_rel->relr_section() != NULL)
+    {
+      const Output_data* relr = dyn_rel->relr_section();
+      odyn->add_section_address(elfcpp::DT_RELR, relr->output_section());
+      odyn->add_section_size(elfcpp::DT_RELRSZ, relr->output_section());
+      odyn->add_constant(elfcpp::DT_RELRENT,
+			 parameters->target().get_size() / 8);
+    }
+
   if (add_debug && !parameters->options().shared())
     {
       // The value of the DT_DEBUG tag is filled in by the dynamic
@@ -5850,9 +6139,54 @@ Layout::write_sections_after_input_sections(Output_file* of)
   this->section_headers_->write(of);
 }
 
-// If a tree-style build ID was requested, the parallel part of that computation
-// is already done, and the final hash-of-hashes is computed here.  For other
-// types of build IDs, all the work is done here.
+// Queue tasks to compress the compressed debug sections.
+
+void
+Layout::queue_compression_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  for (std::vector<Output_compressed_section*>::const_iterator p =
+	 this->compressed_sections_.begin();
+       p != this->compressed_sections_.end();
+       ++p)
+    (*p)->queue_compression_tasks(workqueue, blocker);
+}
+
+// Queue tasks to sort and write out the dynamic relocations.
+
+void
+Layout::queue_dynamic_reloc_tasks(Workqueue* workqueue, Output_file* of,
+				  int thread_count, Task_token* final_blocker)
+{
+  if (this->dynamic_reloc_section_ != NULL)
+    this->dynamic_reloc_section_->queue_write_tasks(workqueue, of,
+						    thread_count,
+						    final_blocker);
+}
+
+// Arrange to sort and write out the .eh_frame_hdr table in parallel.
+
+unsigned int
+Layout::set_parallel_eh_frame_hdr(int thread_count)
+{
+  if (this->eh_frame_hdr_data_ == NULL)
+    return 0;
+  return this->eh_frame_hdr_data_->set_parallel_write(thread_count);
+}
+
+// Queue the tasks to sort and write out the .eh_frame_hdr table.
+
+void
+Layout::queue_eh_frame_hdr_tasks(Workqueue* workqueue, Output_file* of,
+				 Task_token* final_blocker)
+{
+  if (this->eh_frame_hdr_data_ != NULL)
+    this->eh_frame_hdr_data_->queue_write_tasks(workqueue, of,
+						final_blocker);
+}
+
+// If a tree-style or fast build ID was requested, the parallel part of that
+// computation is already done, and the final hash-of-hashes is computed here.
+// For other types of build IDs, all the work is done here.
 
 void
 Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
@@ -5884,9 +6218,14 @@ Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
   else
     {
       // Non-overlapping substrings of the output file have been hashed.
-      // Compute SHA-1 hash of the hashes.
-      sha1_buffer(reinterpret_cast<const char*>(array_of_hashes),
-		  size_of_hashes, ov);
+      // Compute the hash of the hashes, using SHA-1 for a tree-style
+      // build ID.
+      if (strcmp(parameters->options().build_id(), "fast") == 0)
+	fast_hash_buffer(reinterpret_cast<const char*>(array_of_hashes),
+			 size_of_hashes, ov);
+      else
+	sha1_buffer(reinterpret_cast<const char*>(array_of_hashes),
+		    size_of_hashes, ov);
       delete[] array_of_hashes;
     }
 
@@ -5895,6 +6234,96 @@ Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
 			ov);
 }
 
+// Queue tasks to hash the chunks of the output file for --build-id=fast
+// which are complete once the Relocate_tasks and the Write_sections_task
+// are done, that is, once INPUT_SECTIONS_BLOCKER is unblocked.  That is
+// most of the file, so hashing it overlaps with writing the symbol
+// tables and the other late sections, and little remains to be hashed
+// by Build_id_task_runner.  This must be called before any task that
+// unblocks FINAL_BLOCKER is queued.
+
+void
+Layout::queue_early_build_id_tasks(Workqueue* workqueue, Output_file* of,
+				   Build_id_chunks* chunks,
+				   Task_token* input_sections_blocker,
+				   Task_token* final_blocker) const
+{
+  gold_assert(!this->any_postprocessing_sections_);
+
+  // Collect the ranges of the file that are written by other tasks
+  // which may still be running: the file and segment headers, the
+  // section headers, the symbol tables, the sections written after the
+  // input sections, and those written in parallel.
+  typedef std::vector<std::pair<off_t, off_t> > Ranges;
+  Ranges late;
+  for (Data_list::const_iterator p = this->special_output_list_.begin();
+       p != this->special_output_list_.end();
+       ++p)
+    late.push_back(std::make_pair((*p)->offset(),
+				  (*p)->offset() + (*p)->data_size()));
+  for (Data_list::const_iterator p = this->relax_output_list_.begin();
+       p != this->relax_output_list_.end();
+       ++p)
+    late.push_back(std::make_pair((*p)->offset(),
+				  (*p)->offset() + (*p)->data_size()));
+  if (this->section_headers_ != NULL)
+    late.push_back(std::make_pair(this->section_headers_->offset(),
+				  (this->section_headers_->offset()
+				   + this->section_headers_->data_size())));
+
+  const Output_section* dynamic_reloc_os =
+    (this->dynamic_reloc_section_ != NULL
+     ? this->dynamic_reloc_section_->output_section()
+     : NULL);
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    {
+      if ((*p)->type() == elfcpp::SHT_NOBITS || !(*p)->is_offset_valid())
+	continue;
+      if ((*p)->after_input_sections()
+	  || *p == this->symtab_section_
+	  || *p == this->dynsym_section_
+	  || *p == this->eh_frame_hdr_section_
+	  || *p == dynamic_reloc_os)
+	late.push_back(std::make_pair((*p)->offset(),
+				      (*p)->offset() + (*p)->data_size()));
+    }
+  std::sort(late.begin(), late.end());
+
+  // Queue a task for every chunk which does not overlap any of those
+  // ranges.
+  Ranges::const_iterator pl = late.begin();
+  unsigned char* dst = chunks->hashes;
+  for (size_t i = 0; i < chunks->count; ++i, dst += fast_hash_size)
+    {
+      off_t start = i * chunks->chunk_size;
+      off_t end = std::min(i * chunks->chunk_size + chunks->chunk_size,
+			   chunks->file_size);
+      while (pl != late.end() && pl->second <= start)
+	++pl;
+      bool overlaps = false;
+      for (Ranges::const_iterator q = pl;
+	   q != late.end() && q->first < end;
+	   ++q)
+	{
+	  if (q->second > start && q->second > q->first)
+	    {
+	      overlaps = true;
+	      break;
+	    }
+	}
+      if (overlaps)
+	continue;
+
+      final_blocker->add_blocker();
+      chunks->queued[i] = true;
+      workqueue->queue(new Hash_task(of, start, end - start, dst,
+				     final_blocker, fast_hash_buffer,
+				     input_sections_blocker));
+    }
+}
+
 // Write out a binary file.  This is called after the link is
 // complete.  IN is the temporary output file we used to generate the
 // ELF code.  We simply walk through the segments, read them from
@@ -6081,14 +6510,48 @@ Write_after_input_sections_task::locks(Task_locker* tl)
 // Run the task.
 
 void
-Write_after_input_sections_task::run(Workqueue*)
+Write_after_input_sections_task::run(Workqueue* workqueue)
 {
   this->layout_->write_sections_after_input_sections(this->of_);
+  this->layout_->queue_eh_frame_hdr_tasks(workqueue, this->of_,
+					  this->final_blocker_);
+}
+
+// Compress_sections_task_runner methods.
+
+// Queue the compression tasks, and then the task which writes out
+// the compressed sections once they are done.
+
+void
+Compress_sections_task_runner::run(Workqueue* workqueue, const Task*)
+{
+  Task_token* compressed_blocker = new Task_token(true);
+  this->layout_->queue_compression_tasks(workqueue, compressed_blocker);
+  workqueue->queue(new Write_after_input_sections_task(this->layout_,
+							this->of_,
+							compressed_blocker,
+							this->final_blocker_));
+}
+
+// Build_id_chunks methods.
+
+Build_id_chunks::Build_id_chunks(size_t file_size_arg, size_t chunk_size_arg)
+  : file_size(file_size_arg), chunk_size(chunk_size_arg), count(1),
+    hashes(NULL), queued()
+{
+  if (this->chunk_size == 0 || this->chunk_size >= this->file_size)
+    this->chunk_size = std::max(this->file_size, static_cast<size_t>(1));
+  else
+    this->count = (this->file_size - 1) / this->chunk_size + 1;
+  this->hashes = new unsigned char[this->count * fast_hash_size];
+  this->queued.resize(this->count, false);
 }
 
 // Build IDs can be computed as a "flat" sha1 or md5 of a string of bytes,
 // or as a "tree" where each chunk of the string is hashed and then those
 // hashes are put into a (much smaller) string which is hashed with sha1.
+// A "fast" build ID is a tree of non-cryptographic hashes, in which
+// some chunks may have been hashed already.
 // We compute a checksum over the entire file because that is simplest.
 
 void
@@ -6102,7 +6565,35 @@ Build_id_task_runner::run(Workqueue* workqueue, const Task*)
   unsigned char* array_of_hashes = NULL;
   size_t size_of_hashes = 0;
 
-  if (strcmp(this->options_->build_id(), "tree") == 0
+  if (strcmp(this->options_->build_id(), "fast") == 0)
+    {
+      Build_id_chunks* chunks = this->chunks_;
+      if (chunks == NULL)
+	{
+	  const size_t chunk_size =
+	    this->options_->build_id_chunk_size_for_treehash();
+	  chunks = new Build_id_chunks(filesize, chunk_size);
+	}
+      gold_assert(chunks->file_size == filesize);
+      unsigned char* dst = chunks->hashes;
+      for (size_t i = 0; i < chunks->count; ++i, dst += fast_hash_size)
+	{
+	  if (chunks->queued[i])
+	    continue;
+	  size_t src_offset = i * chunks->chunk_size;
+	  size_t size = std::min(chunks->chunk_size, filesize - src_offset);
+	  post_hash_tasks_blocker->add_blocker();
+	  workqueue->queue(new Hash_task(of, src_offset, size, dst,
+					 post_hash_tasks_blocker,
+					 fast_hash_buffer));
+	}
+      // The hashes are deleted by Layout::write_build_id.
+      array_of_hashes = chunks->hashes;
+      size_of_hashes = chunks->count * fast_hash_size;
+      chunks->hashes = NULL;
+      delete chunks;
+    }
+  else if (strcmp(this->options_->build_id(), "tree") == 0
       && this->options_->build_id_chunk_size_for_treehash() > 0
       && filesize > 0
       && (filesize >= this->options_->build_id_min_file_size_for_treehash()))
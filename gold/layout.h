@@ -53,14 +53,19 @@ class Output_file_header;
 class Output_segment;
 class Output_data;
 class Output_data_reloc_generic;
+class Output_data_relr_generic;
 class Output_data_dynamic;
 class Output_symtab_xindex;
 class Output_reduced_debug_abbrev_section;
 class Output_reduced_debug_info_section;
+class Output_compressed_section;
 class Eh_frame;
+class Eh_frame_hdr;
+class Call_graph;
 class Gdb_index;
 class Target;
 struct Timespec;
+struct Build_id_chunks;
 
 // Return TRUE if SECNAME is the name of a compressed debug section.
 extern bool
@@ -607,6 +612,18 @@ class Layout
   void
   read_layout_from_file();
 
+  // Read the call graph from the file specified with linker option
+  // --call-graph-ordering-file.
+  void
+  read_call_graph_from_file();
+
+  // Use the call graph read by read_call_graph_from_file to compute
+  // the order of the input sections, and record it in the section
+  // order map.
+  void
+  order_sections_by_call_graph(const Task*, const Input_objects*,
+			       const Symbol_table*);
+
   // Layout an input reloc section when doing a relocatable link.  The
   // section is RELOC_SHNDX in OBJECT, with data in SHDR.
   // DATA_SECTION is the reloc section to which it refers.  RR is the
@@ -658,6 +675,15 @@ class Layout
   void
   finalize_eh_frame_section();
 
+  // Queue tasks to hash and deduplicate, using up to THREAD_COUNT
+  // threads, the pending strings of the merged string sections.  The
+  // strings are added to the Stringpools after THIS_BLOCKER is
+  // released.  This returns the blocker for the layout task, which
+  // will be THIS_BLOCKER itself if there is nothing to do.
+  Task_token*
+  queue_merged_strings_tasks(Workqueue*, int thread_count,
+			     Task_token* this_blocker);
+
   // Add .eh_frame information for a PLT.  The FDE must start with a
   // 4-byte PC-relative reference to the start of the PLT, followed by
   // a 4-byte size of PLT.
@@ -685,6 +711,13 @@ class Layout
 		   unsigned int reloc_shndx,
 		   unsigned int reloc_type);
 
+  // Queue tasks to scan, in parallel, the .debug_info and .debug_types
+  // sections recorded by add_to_gdb_index.  This returns the blocker
+  // for the layout task, which will be THIS_BLOCKER itself if there
+  // is nothing to do.
+  Task_token*
+  queue_gdb_index_tasks(Workqueue*, Task_token* this_blocker);
+
   // Handle a GNU stack note.  This is called once per input object
   // file.  SEEN_GNU_STACK is true if the object file has a
   // .note.GNU-stack section.  GNU_STACK_FLAGS is the section flags
@@ -894,6 +927,33 @@ class Layout
   void
   write_sections_after_input_sections(Output_file* of);
 
+  // Queue tasks to compress the contents of the compressed debug
+  // sections in parallel, before they are written out by
+  // write_sections_after_input_sections.  BLOCKER is released as
+  // each task completes.
+  void
+  queue_compression_tasks(Workqueue*, Task_token* blocker);
+
+  // Queue tasks to sort and write out the dynamic relocations in
+  // parallel, using up to THREAD_COUNT tasks.  This adds a blocker
+  // to FINAL_BLOCKER for each task.
+  void
+  queue_dynamic_reloc_tasks(Workqueue*, Output_file*, int thread_count,
+			    Task_token* final_blocker);
+
+  // Arrange to sort and write out the .eh_frame_hdr table in
+  // parallel, using up to THREAD_COUNT tasks.  This returns the
+  // number of tasks which queue_eh_frame_hdr_tasks will queue; the
+  // caller must add that many blockers to the token it passes.
+  unsigned int
+  set_parallel_eh_frame_hdr(int thread_count);
+
+  // Queue the tasks arranged by set_parallel_eh_frame_hdr.  This is
+  // called after write_sections_after_input_sections.
+  void
+  queue_eh_frame_hdr_tasks(Workqueue*, Output_file*,
+			   Task_token* final_blocker);
+
   // Return an output section named NAME, or NULL if there is none.
   Output_section*
   find_output_section(const char* name) const;
@@ -938,7 +998,7 @@ class Layout
   void
   add_target_dynamic_tags(bool use_rel, const Output_data* plt_got,
 			  const Output_data* plt_rel,
-			  const Output_data_reloc_generic* dyn_rel,
+			  Output_data_reloc_generic* dyn_rel,
 			  bool add_debug, bool dynrel_includes_plt);
 
   // Add a target-specific dynamic tag with constant value.
@@ -949,6 +1009,15 @@ class Layout
   void
   write_build_id(Output_file*, unsigned char*, size_t) const;
 
+  // Queue tasks to hash the chunks of the output file for
+  // --build-id=fast which are complete once the input sections have
+  // been written.  The tasks wait for INPUT_SECTIONS_BLOCKER and
+  // unblock FINAL_BLOCKER.
+  void
+  queue_early_build_id_tasks(Workqueue*, Output_file*, Build_id_chunks*,
+			     Task_token* input_sections_blocker,
+			     Task_token* final_blocker) const;
+
   // Rewrite output file in binary format.
   void
   write_binary(Output_file* in) const;
@@ -1033,6 +1102,10 @@ class Layout
   void
   reset_relax_output();
 
+  // Add the SHT_RELR section RELR, for -z pack-relative-relocs.
+  void
+  add_relr_section(Output_data_relr_generic* relr);
+
  private:
   Layout(const Layout&);
   Layout& operator=(const Layout&);
@@ -1294,6 +1367,16 @@ class Layout
 		       Output_segment*, Output_segment_headers*,
 		       Output_file_header*, unsigned int*);
 
+  // Move the relocs in the SHT_RELR sections back to the dynamic
+  // reloc sections.
+  void
+  unpack_relr_sections();
+
+  // Encode the SHT_RELR sections after laying out the sections.
+  // Return true if the sections must be laid out again.
+  bool
+  encode_relr_sections();
+
   // A mapping used for kept comdats/.gnu.linkonce group signatures.
   typedef Unordered_map<std::string, Kept_section> Signatures;
 
@@ -1438,6 +1521,10 @@ class Layout
   bool added_eh_frame_data_;
   // The exception frame header output section if there is one.
   Output_section* eh_frame_hdr_section_;
+  // The data for eh_frame_hdr_section_.
+  Eh_frame_hdr* eh_frame_hdr_data_;
+  // The sorted dynamic relocation section, if there is one.
+  Output_data_reloc_generic* dynamic_reloc_section_;
   // The data for the .gdb_index section.
   Gdb_index* gdb_index_data_;
   // The space for the build ID checksum if there is one.
@@ -1446,6 +1533,10 @@ class Layout
   Output_reduced_debug_abbrev_section* debug_abbrev_;
   // The output section containing the dwarf debug info tree
   Output_reduced_debug_info_section* debug_info_;
+  // The output sections whose contents are compressed.
+  std::vector<Output_compressed_section*> compressed_sections_;
+  // The SHT_RELR sections, for -z pack-relative-relocs.
+  std::vector<Output_data_relr_generic*> relr_sections_;
   // A list of group sections and their signatures.
   Group_signatures group_signatures_;
   // The size of the output file.
@@ -1500,6 +1591,8 @@ class Layout
   Unordered_map<std::string, unsigned int> input_section_position_;
   // Vector of glob only patterns in the section_ordering file.
   std::vector<std::string> input_section_glob_;
+  // The call graph read from the --call-graph-ordering-file.
+  Call_graph* call_graph_;
   // For incremental links, the base file to be modified.
   Incremental_binary* incremental_base_;
   // For incremental links, a list of free space within the file.
@@ -1660,18 +1753,65 @@ class Write_after_input_sections_task : public Task
   Task_token* final_blocker_;
 };
 
+// This task function handles compressing the debug sections, when
+// running with multiple threads.  It queues a task for each chunk of
+// each compressed section, followed by a
+// Write_after_input_sections_task which waits for them.
+
+class Compress_sections_task_runner : public Task_function_runner
+{
+ public:
+  Compress_sections_task_runner(Layout* layout, Output_file* of,
+				Task_token* final_blocker)
+    : layout_(layout), of_(of), final_blocker_(final_blocker)
+  { }
+
+  // Run the operation.
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  Layout* layout_;
+  Output_file* of_;
+  Task_token* final_blocker_;
+};
+
+// The chunks of the output file which are hashed separately for
+// --build-id=fast.  The build ID is the hash of the chunk hashes.
+
+struct Build_id_chunks
+{
+  Build_id_chunks(size_t file_size, size_t chunk_size);
+
+  ~Build_id_chunks()
+  { delete[] this->hashes; }
+
+  // The size of the output file.
+  size_t file_size;
+  // The size of each chunk but the last.
+  size_t chunk_size;
+  // The number of chunks.
+  size_t count;
+  // The hashes of the chunks, in order.
+  unsigned char* hashes;
+  // Whether a task to hash each chunk has been queued.
+  std::vector<bool> queued;
+};
+
 // This task function handles computation of the build id.
-// When using --build-id=tree, it schedules the tasks that
-// compute the hashes for each chunk of the file. This task
+// When using --build-id=tree or --build-id=fast, it schedules the
+// tasks that compute the hashes for each chunk of the file. This task
 // cannot run until we have finalized the size of the output
 // file, after the completion of Write_after_input_sections_task.
+// With --build-id=fast, CHUNKS records any chunks that were hashed
+// before that.
 
 class Build_id_task_runner : public Task_function_runner
 {
  public:
   Build_id_task_runner(const General_options* options, const Layout* layout,
-		       Output_file* of)
-    : options_(options), layout_(layout), of_(of)
+		       Output_file* of, Build_id_chunks* chunks)
+    : options_(options), layout_(layout), of_(of), chunks_(chunks)
   { }
 
   // Run the operation.
@@ -1682,6 +1822,7 @@ class Build_id_task_runner : public Task_function_runner
   const General_options* options_;
   const Layout* layout_;
   Output_file* of_;
+  Build_id_chunks* chunks_;
 };
 
 // This task function handles closing the file.
@@ -0,0 +1,299 @@
+// link-cache.cc -- on-disk cache of per-object .gdb_index scans
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#include "elfcpp.h"
+#include "descriptors.h"
+#include "gold-threads.h"
+#include "object.h"
+#include "stats.h"
+#include "link-cache.h"
+
+namespace gold
+{
+
+// Class Link_cache_key.
+
+Link_cache_key::Link_cache_key(const char* kind)
+  : finished_(false)
+{
+  md5_init_ctx(&this->ctx_);
+  this->add_string(get_version_string());
+  this->add_string(kind);
+}
+
+// Add the section headers and the unallocated section contents of
+// OBJECT.
+
+void
+Link_cache_key::add_unallocated_sections(Relobj* object)
+{
+  this->add_uint64(object->elfsize());
+  this->add_uint64(object->is_big_endian());
+  unsigned int shnum = object->shnum();
+  this->add_uint64(shnum);
+  for (unsigned int i = 1; i < shnum; ++i)
+    {
+      this->add_string(object->section_name(i).c_str());
+      unsigned int sh_type = object->section_type(i);
+      uint64_t sh_flags = object->section_flags(i);
+      this->add_uint64(sh_type);
+      this->add_uint64(sh_flags);
+      this->add_uint64(object->section_size(i));
+      this->add_uint64(object->section_link(i));
+      this->add_uint64(object->section_info(i));
+      if ((sh_flags & elfcpp::SHF_ALLOC) == 0
+	  && sh_type != elfcpp::SHT_NOBITS)
+	{
+	  section_size_type len;
+	  const unsigned char* contents =
+	    object->section_contents(i, &len, false);
+	  this->add(contents, len);
+	}
+    }
+}
+
+// Finish the digest.
+
+void
+Link_cache_key::finish()
+{
+  gold_assert(!this->finished_);
+  md5_finish_ctx(&this->ctx_, this->digest_);
+  this->finished_ = true;
+}
+
+// Return the digest in hex.
+
+std::string
+Link_cache_key::hex() const
+{
+  static const char digits[] = "0123456789abcdef";
+  gold_assert(this->finished_);
+  std::string ret;
+  for (size_t i = 0; i < sizeof this->digest_; ++i)
+    {
+      ret.push_back(digits[this->digest_[i] >> 4]);
+      ret.push_back(digits[this->digest_[i] & 0xf]);
+    }
+  return ret;
+}
+
+// Class Link_cache_entry.
+
+Link_cache_entry::~Link_cache_entry()
+{
+#ifdef HAVE_MMAP
+  if (this->size_ > 0)
+    ::munmap(const_cast<unsigned char*>(this->data_), this->size_);
+#else
+  delete[] this->data_;
+#endif
+}
+
+// Class Link_cache.
+
+Link_cache::Link_cache()
+  : dirname_(), lock_(new Lock()), hits_(0), misses_(0), stores_(0),
+    bytes_read_(0), bytes_written_(0), temp_count_(0)
+{
+}
+
+Link_cache::~Link_cache()
+{
+  delete this->lock_;
+}
+
+// Open the cache.
+
+bool
+Link_cache::open(const char* dirname)
+{
+  struct stat st;
+  if (::stat(dirname, &st) != 0)
+    {
+#if defined (_WIN32) && !defined (__CYGWIN32__)
+      int ret = ::mkdir(dirname);
+#else
+      int ret = ::mkdir(dirname, 0777);
+#endif
+      if (ret != 0 && errno != EEXIST)
+	{
+	  gold_warning(_("cannot create link cache directory %s: %s"),
+		       dirname, strerror(errno));
+	  return false;
+	}
+    }
+  else if (!S_ISDIR(st.st_mode))
+    {
+      gold_warning(_("link cache %s is not a directory"), dirname);
+      return false;
+    }
+
+  this->dirname_ = dirname;
+  return true;
+}
+
+// Return the name of the file for an entry.
+
+std::string
+Link_cache::filename(const char* kind, const Link_cache_key& key) const
+{
+  std::string ret(this->dirname_);
+  ret.push_back('/');
+  ret.append(key.hex());
+  ret.push_back('.');
+  ret.append(kind);
+  return ret;
+}
+
+// Find an entry.
+
+Link_cache_entry*
+Link_cache::find(const char* kind, const Link_cache_key& key)
+{
+  std::string name(this->filename(kind, key));
+  Link_cache_entry* entry = NULL;
+  int o = open_descriptor(-1, name.c_str(), O_RDONLY);
+  if (o >= 0)
+    {
+      struct stat st;
+      if (::fstat(o, &st) == 0 && st.st_size > 0)
+	{
+	  size_t size = st.st_size;
+#ifdef HAVE_MMAP
+	  void* p = ::mmap(NULL, size, PROT_READ, MAP_PRIVATE, o, 0);
+	  if (p != MAP_FAILED)
+	    entry = new Link_cache_entry(static_cast<unsigned char*>(p), size);
+#else
+	  unsigned char* p = new unsigned char[size];
+	  if (::read(o, p, size) == static_cast<ssize_t>(size))
+	    entry = new Link_cache_entry(p, size);
+	  else
+	    delete[] p;
+#endif
+	}
+      release_descriptor(o, true);
+    }
+
+  Hold_lock hl(*this->lock_);
+  if (entry == NULL)
+    ++this->misses_;
+  else
+    {
+      ++this->hits_;
+      this->bytes_read_ += entry->size();
+    }
+  return entry;
+}
+
+// Store an entry.  We write it to a temporary file in the cache
+// directory, and rename it into place, so that nobody ever sees a
+// partial entry.
+
+void
+Link_cache::store(const char* kind, const Link_cache_key& key,
+		  const void* data, size_t len)
+{
+  std::string name(this->filename(kind, key));
+
+  unsigned int count;
+  {
+    Hold_lock hl(*this->lock_);
+    count = this->temp_count_++;
+  }
+  char suffix[40];
+  snprintf(suffix, sizeof suffix, ".tmp%ld.%u",
+	   static_cast<long>(getpid()), count);
+  std::string tmpname(name + suffix);
+
+  int o = open_descriptor(-1, tmpname.c_str(), O_WRONLY | O_CREAT | O_EXCL,
+			  0666);
+  if (o < 0)
+    return;
+
+  const char* p = static_cast<const char*>(data);
+  size_t left = len;
+  while (left > 0)
+    {
+      ssize_t bytes = ::write(o, p, left);
+      if (bytes <= 0)
+	{
+	  if (bytes < 0 && errno == EINTR)
+	    continue;
+	  break;
+	}
+      p += bytes;
+      left -= bytes;
+    }
+  release_descriptor(o, true);
+
+  if (left != 0 || ::rename(tmpname.c_str(), name.c_str()) != 0)
+    {
+      ::unlink(tmpname.c_str());
+      return;
+    }
+
+  Hold_lock hl(*this->lock_);
+  ++this->stores_;
+  this->bytes_written_ += len;
+}
+
+// Print statistics.
+
+void
+Link_cache::print_stats() const
+{
+  if (parameters->options().stats())
+    {
+      fprintf(stderr, _("%s: link cache hits: %u\n"),
+	      program_name, this->hits_);
+      fprintf(stderr, _("%s: link cache misses: %u\n"),
+	      program_name, this->misses_);
+      fprintf(stderr, _("%s: link cache bytes read: %llu\n"),
+	      program_name,
+	      static_cast<unsigned long long>(this->bytes_read_));
+      fprintf(stderr, _("%s: link cache entries stored: %u\n"),
+	      program_name, this->stores_);
+      fprintf(stderr, _("%s: link cache bytes stored: %llu\n"),
+	      program_name,
+	      static_cast<unsigned long long>(this->bytes_written_));
+    }
+  record_stat("link cache hits", this->hits_);
+  record_stat("link cache misses", this->misses_);
+  record_stat("link cache bytes read", this->bytes_read_);
+  record_stat("link cache entries stored", this->stores_);
+  record_stat("link cache bytes stored", this->bytes_written_);
+}
+
+} // End namespace gold.
@@ -0,0 +1,187 @@
+// link-cache.h -- on-disk cache of per-object .gdb_index scans  -*- C++ -*-
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_LINK_CACHE_H
+#define GOLD_LINK_CACHE_H
+
+#include <string>
+
+#include "md5.h"
+
+namespace gold
+{
+
+class Lock;
+class Relobj;
+
+// The key of an entry in the link cache.  This is an MD5 digest of
+// everything the cached work depends upon.  The digest always covers
+// the gold version, so that a new linker never uses entries written
+// by an old one.
+
+class Link_cache_key
+{
+ public:
+  // KIND names the kind of work which is cached, and is part of the
+  // digest.
+  Link_cache_key(const char* kind);
+
+  // Add LEN bytes at DATA to the digest.
+  void
+  add(const void* data, size_t len)
+  {
+    gold_assert(!this->finished_);
+    md5_process_bytes(data, len, &this->ctx_);
+  }
+
+  // Add a null terminated string to the digest.
+  void
+  add_string(const char* s)
+  { this->add(s, strlen(s) + 1); }
+
+  // Add an integer to the digest.
+  void
+  add_uint64(uint64_t val)
+  { this->add(&val, sizeof val); }
+
+  // Add the section headers of OBJECT to the digest, and the
+  // contents of every section which does not have the SHF_ALLOC flag.
+  // This covers the symbol table, the debugging information and the
+  // relocations which apply to it.  The caller must hold the lock on
+  // OBJECT.
+  void
+  add_unallocated_sections(Relobj* object);
+
+  // Finish the digest.  Nothing may be added after this.
+  void
+  finish();
+
+  // Return the digest as a string of hex digits.
+  std::string
+  hex() const;
+
+ private:
+  // The MD5 context.
+  md5_ctx ctx_;
+  // The digest, once it is finished.
+  unsigned char digest_[16];
+  // Whether finish has been called.
+  bool finished_;
+};
+
+// An entry read from the link cache.  The contents are mapped from
+// the cache file, and stay valid until this object is deleted.
+
+class Link_cache_entry
+{
+ public:
+  Link_cache_entry(const unsigned char* data, size_t size)
+    : data_(data), size_(size)
+  { }
+
+  ~Link_cache_entry();
+
+  // The contents of the entry.
+  const unsigned char*
+  data() const
+  { return this->data_; }
+
+  // The size of the entry.
+  size_t
+  size() const
+  { return this->size_; }
+
+ private:
+  Link_cache_entry(const Link_cache_entry&);
+  Link_cache_entry& operator=(const Link_cache_entry&);
+
+  const unsigned char* data_;
+  size_t size_;
+};
+
+// The link cache, enabled by --link-cache.  This is a directory of
+// files, each named for the kind and key of the work it holds.  The
+// files are written under a temporary name and renamed into place,
+// so several links may safely share a cache.  The cache is only an
+// optimization: if it can not be read or written, the work is simply
+// done again.  The methods may be called from any thread.
+
+// Only the --gdb-index scans of the debugging information are cached.
+// Symbol tables, merge maps and relocation scans are still done on
+// every link.
+
+class Link_cache
+{
+ public:
+  Link_cache();
+
+  ~Link_cache();
+
+  // Open the cache in DIRNAME, creating the directory if needed.
+  // Returns false, after issuing a warning, if it can not be used.
+  bool
+  open(const char* dirname);
+
+  // Return the entry of kind KIND with key KEY, or NULL if there is
+  // none.  The caller must delete the entry.
+  Link_cache_entry*
+  find(const char* kind, const Link_cache_key& key);
+
+  // Store LEN bytes at DATA as the entry of kind KIND with key KEY.
+  void
+  store(const char* kind, const Link_cache_key& key, const void* data,
+	size_t len);
+
+  // Print statistics about the cache to stderr.
+  void
+  print_stats() const;
+
+ private:
+  Link_cache(const Link_cache&);
+  Link_cache& operator=(const Link_cache&);
+
+  // Return the name of the file holding the entry of kind KIND with
+  // key KEY.
+  std::string
+  filename(const char* kind, const Link_cache_key& key) const;
+
+  // The cache directory.
+  std::string dirname_;
+  // Lock for the statistics, and for the counter used to make
+  // temporary file names.
+  Lock* lock_;
+  // Number of entries found.
+  unsigned int hits_;
+  // Number of entries not found.
+  unsigned int misses_;
+  // Number of entries stored.
+  unsigned int stores_;
+  // Number of bytes in the entries found.
+  uint64_t bytes_read_;
+  // Number of bytes in the entries stored.
+  uint64_t bytes_written_;
+  // Counter used to make temporary file names.
+  unsigned int temp_count_;
+};
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_LINK_CACHE_H)
@@ -29,6 +29,10 @@
 #include <malloc.h>
 #endif
 
+#ifdef HAVE_GETRUSAGE
+#include <sys/resource.h>
+#endif
+
 #include "libiberty.h"
 
 #include "script.h"
@@ -48,6 +52,9 @@
 #include "icf.h"
 #include "incremental.h"
 #include "gdb-index.h"
+#include "link-cache.h"
+#include "task-trace.h"
+#include "stats.h"
 #include "timer.h"
 
 using namespace gold;
@@ -165,7 +172,7 @@ main(int argc, char** argv)
   command_line.process(argc - 1, const_cast<const char**>(argv + 1));
 
   Timer timer;
-  if (command_line.options().stats())
+  if (command_line.options().collect_stats())
     {
       timer.start();
       set_parameters_timer(&timer);
@@ -190,6 +197,48 @@ main(int argc, char** argv)
 	}
     }
 
+  // If the user asked for a link cache, open it.
+  Link_cache* link_cache = NULL;
+  if (command_line.options().user_set_link_cache())
+    {
+      link_cache = new Link_cache();
+      if (!link_cache->open(command_line.options().link_cache()))
+	{
+	  delete link_cache;
+	  link_cache = NULL;
+	}
+      else
+	set_parameters_link_cache(link_cache);
+    }
+
+  // If the user asked for a task trace, open it.
+  Task_trace* task_trace = NULL;
+  if (command_line.options().user_set_trace_tasks())
+    {
+      task_trace = new Task_trace();
+      if (!task_trace->open(command_line.options().trace_tasks()))
+	{
+	  delete task_trace;
+	  task_trace = NULL;
+	}
+      else
+	set_parameters_task_trace(task_trace);
+    }
+
+  // If the user asked for statistics in JSON format, open the file.
+  Stats_json* stats_json = NULL;
+  if (command_line.options().user_set_stats_json())
+    {
+      stats_json = new Stats_json();
+      if (!stats_json->open(command_line.options().stats_json()))
+	{
+	  delete stats_json;
+	  stats_json = NULL;
+	}
+      else
+	set_parameters_stats_json(stats_json);
+    }
+
   // The GNU linker ignores version scripts when generating
   // relocatable output.  If we are not compatible, then we break the
   // Linux kernel build, which uses a linker script with -r which must
@@ -235,6 +284,9 @@ main(int argc, char** argv)
   if (parameters->options().section_ordering_file())
     layout.read_layout_from_file();
 
+  if (parameters->options().call_graph_ordering_file())
+    layout.read_call_graph_from_file();
+
   // Load plugin libraries.
   if (command_line.options().has_plugins())
     command_line.options().plugins()->load_plugins(&layout);
@@ -251,61 +303,90 @@ main(int argc, char** argv)
   // Run the main task processing loop.
   workqueue.process(0);
 
+  if (task_trace != NULL)
+    task_trace->close();
+
   if (command_line.options().print_output_format())
     print_output_format();
 
-  if (command_line.options().stats())
+  if (command_line.options().collect_stats())
     {
       timer.stamp(2);
+      const bool print = command_line.options().stats();
       Timer::TimeStats elapsed = timer.get_pass_time(0);
-      fprintf(stderr,
-             _("%s: initial tasks run time: " \
-               "(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
-              program_name,
-              elapsed.user / 1000, (elapsed.user % 1000) * 1000,
-              elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
-              elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
+      if (print)
+	fprintf(stderr,
+		_("%s: initial tasks run time: " \
+		  "(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
+		program_name,
+		elapsed.user / 1000, (elapsed.user % 1000) * 1000,
+		elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
+		elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
+      record_run_time("initial tasks", elapsed);
       elapsed = timer.get_pass_time(1);
-      fprintf(stderr,
-             _("%s: middle tasks run time: " \
-               "(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
-              program_name,
-              elapsed.user / 1000, (elapsed.user % 1000) * 1000,
-              elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
-              elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
+      if (print)
+	fprintf(stderr,
+		_("%s: middle tasks run time: " \
+		  "(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
+		program_name,
+		elapsed.user / 1000, (elapsed.user % 1000) * 1000,
+		elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
+		elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
+      record_run_time("middle tasks", elapsed);
       elapsed = timer.get_pass_time(2);
-      fprintf(stderr,
-             _("%s: final tasks run time: " \
-               "(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
-              program_name,
-              elapsed.user / 1000, (elapsed.user % 1000) * 1000,
-              elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
-              elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
+      if (print)
+	fprintf(stderr,
+		_("%s: final tasks run time: " \
+		  "(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
+		program_name,
+		elapsed.user / 1000, (elapsed.user % 1000) * 1000,
+		elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
+		elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
+      record_run_time("final tasks", elapsed);
       elapsed = timer.get_elapsed_time();
-      fprintf(stderr,
-             _("%s: total run time: " \
-               "(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
-              program_name,
-              elapsed.user / 1000, (elapsed.user % 1000) * 1000,
-              elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
-              elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
-
+      if (print)
+	fprintf(stderr,
+		_("%s: total run time: " \
+		  "(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
+		program_name,
+		elapsed.user / 1000, (elapsed.user % 1000) * 1000,
+		elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
+		elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
+      record_run_time("total", elapsed);
+
+      // The peak resident set size is only recorded for --stats-json,
+      // so that the --stats output is unchanged.
+#ifdef HAVE_GETRUSAGE
+      struct rusage usage;
+      if (getrusage(RUSAGE_SELF, &usage) == 0)
+	record_stat("peak resident set size in KiB", usage.ru_maxrss);
+#endif
 #ifdef HAVE_MALLINFO
       struct mallinfo m = mallinfo();
-      fprintf(stderr, _("%s: total space allocated by malloc: %lld bytes\n"),
-	      program_name, static_cast<long long>(m.arena));
+      if (print)
+	fprintf(stderr, _("%s: total space allocated by malloc: %lld bytes\n"),
+		program_name, static_cast<long long>(m.arena));
+      record_stat("total space allocated by malloc", m.arena);
 #endif
       File_read::print_stats();
       Archive::print_stats();
       Lib_group::print_stats();
-      fprintf(stderr, _("%s: output file size: %lld bytes\n"),
-	      program_name, static_cast<long long>(layout.output_file_size()));
+      if (print)
+	fprintf(stderr, _("%s: output file size: %lld bytes\n"),
+		program_name,
+		static_cast<long long>(layout.output_file_size()));
+      record_stat("output file size", layout.output_file_size());
       symtab.print_stats();
       layout.print_stats();
       Gdb_index::print_stats();
+      if (link_cache != NULL)
+	link_cache->print_stats();
       Free_list::print_stats();
     }
 
+  if (stats_json != NULL)
+    stats_json->close();
+
   // Issue defined symbol report.
   if (command_line.options().user_set_print_symbol_counts())
     input_objects.print_symbol_counts(&symtab);
@@ -23,10 +23,12 @@
 #include "gold.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
 
 #include "merge.h"
 #include "compressed_output.h"
+#include "stats.h"
 
 namespace gold
 {
@@ -170,6 +172,25 @@ Object_merge_map::get_output_offset(unsigned int shndx,
   return true;
 }
 
+// Sort the mappings for every input section.
+
+void
+Object_merge_map::sort_input_merge_maps()
+{
+  for (Section_merge_maps::iterator p = this->section_merge_maps_.begin();
+       p != this->section_merge_maps_.end();
+       ++p)
+    {
+      Input_merge_map* map = p->second;
+      if (!map->sorted)
+	{
+	  std::sort(map->entries.begin(), map->entries.end(),
+		    Input_merge_compare());
+	  map->sorted = true;
+	}
+    }
+}
+
 // Return whether this is the merge map for section SHNDX.
 
 const Output_section_data*
@@ -417,16 +438,22 @@ Output_merge_data::do_write_to_buffer(unsigned char* buffer)
   memcpy(buffer, this->p_, this->len_);
 }
 
-// Print merge stats to stderr.
+// Print merge stats to stderr for --stats, and record them for
+// --stats-json.
 
 void
 Output_merge_data::do_print_merge_stats(const char* section_name)
 {
-  fprintf(stderr,
-	  _("%s: %s merged constants size: %lu; input: %zu; output: %zu\n"),
-	  program_name, section_name,
-	  static_cast<unsigned long>(this->entsize()),
-	  this->input_count_, this->hashtable_.size());
+  if (parameters->options().stats())
+    fprintf(stderr,
+	    _("%s: %s merged constants size: %lu; input: %zu; output: %zu\n"),
+	    program_name, section_name,
+	    static_cast<unsigned long>(this->entsize()),
+	    this->input_count_, this->hashtable_.size());
+  std::string prefix(std::string(section_name) + " merged constants");
+  record_stat(prefix + " size", this->entsize());
+  record_stat(prefix + " input", this->input_count_);
+  record_stat(prefix + " output", this->hashtable_.size());
 }
 
 // Class Output_merge_string.
@@ -475,6 +502,40 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   this->merged_strings_lists_.push_back(merged_strings_list);
   Merged_strings& merged_strings = merged_strings_list->merged_strings;
 
+  // When running with threads, we keep the section contents and add
+  // the strings to the Stringpool later; see Hash_merged_strings_task.
+  // Contents which come straight from the file are kept in a lasting
+  // view rather than copied.  Decompressed contents are only cached
+  // by the object until it is laid out, so we keep our own buffer.
+  const bool defer = parameters->options().threads();
+  if (defer)
+    {
+      if (is_new)
+	{
+	  merged_strings_list->buffer = pdata;
+	  merged_strings_list->contents = p;
+	  is_new = false;
+	}
+      else if (!object->section_is_compressed(shndx, NULL))
+	{
+	  section_size_type view_len;
+	  File_view* view = object->section_contents_lasting_view(shndx,
+								  &view_len);
+	  gold_assert(view_len == sec_len);
+	  merged_strings_list->view = view;
+	  merged_strings_list->contents =
+	    reinterpret_cast<const Char_type*>(view->data());
+	}
+      else
+	{
+	  unsigned char* copy = new unsigned char[sec_len];
+	  memcpy(copy, pdata, sec_len);
+	  merged_strings_list->buffer = copy;
+	  merged_strings_list->contents =
+	    reinterpret_cast<const Char_type*>(copy);
+	}
+    }
+
   // Count the number of non-null strings in the section and size the list.
   size_t count = 0;
   const Char_type* pt = p;
@@ -509,8 +570,11 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 	      != init_align_modulo))
 	  has_misaligned_strings = true;
 
-      Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
+      Stringpool::Key key = 0;
+      if (!defer)
+	this->stringpool_.add_with_length(p, len, true, &key);
+      else
+	++this->pending_count_;
 
       merged_strings.push_back(Merged_string(i, key));
       p += len + 1;
@@ -540,6 +604,131 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   return true;
 }
 
+// Compute the hash codes of the pending strings in the input sections
+// BEGIN up to END.  This is called by Hash_merged_strings_task, so
+// several of these may run at the same time for different ranges.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::do_hash_pending_strings(size_t begin,
+							size_t end)
+{
+  gold_assert(end <= this->merged_strings_lists_.size());
+  for (size_t j = begin; j < end; ++j)
+    {
+      Merged_strings_list* l = this->merged_strings_lists_[j];
+      if (l->contents == NULL)
+	continue;
+      size_t count = l->merged_strings.size() - 1;
+      l->hash_codes.resize(count);
+      l->first_strings.resize(count);
+      for (size_t i = 0; i < count; ++i)
+	{
+	  size_t len;
+	  const Char_type* s = pending_string(l, i, &len);
+	  l->hash_codes[i] = string_hash<Char_type>(s, len);
+	}
+    }
+}
+
+// For each pending string whose hash code is SHARD modulo SHARD_COUNT,
+// record the first string, in input order, with the same contents.
+// This is called by Find_merged_duplicates_task.  The shards are
+// disjoint, so the tasks for different shards may run at the same
+// time.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::do_find_pending_duplicates(
+    unsigned int shard,
+    unsigned int shard_count)
+{
+  Pending_string_set pending_set;
+  for (typename Merged_strings_lists::const_iterator l =
+	 this->merged_strings_lists_.begin();
+       l != this->merged_strings_lists_.end();
+       ++l)
+    {
+      if ((*l)->contents == NULL || (*l)->hash_codes.empty())
+	continue;
+      size_t count = (*l)->hash_codes.size();
+      for (size_t i = 0; i < count; ++i)
+	{
+	  size_t hash_code = (*l)->hash_codes[i];
+	  if (hash_code % shard_count != shard)
+	    continue;
+	  size_t len;
+	  const Char_type* s = pending_string(*l, i, &len);
+	  const Merged_string* ms = &(*l)->merged_strings[i];
+	  std::pair<typename Pending_string_set::iterator, bool> ins =
+	    pending_set.insert(std::make_pair(Pending_string(s, len,
+							     hash_code),
+					      ms));
+	  (*l)->first_strings[i] = ins.first->second;
+	}
+    }
+}
+
+// Add the pending strings to the Stringpool.  We add the strings in
+// input order, so the keys and offsets are the same as if each string
+// had been added when its input section was seen.  Strings whose
+// first occurrence is known just reuse its key.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::do_add_pending_strings()
+{
+  if (this->pending_count_ == 0)
+    return;
+
+  for (typename Merged_strings_lists::const_iterator l =
+	 this->merged_strings_lists_.begin();
+       l != this->merged_strings_lists_.end();
+       ++l)
+    {
+      if ((*l)->contents == NULL)
+	continue;
+      Merged_strings& merged_strings((*l)->merged_strings);
+      const bool have_hashes = !(*l)->hash_codes.empty();
+      size_t count = merged_strings.size() - 1;
+      for (size_t i = 0; i < count; ++i)
+	{
+	  Merged_string* ms = &merged_strings[i];
+	  if (have_hashes
+	      && (*l)->first_strings[i] != NULL
+	      && (*l)->first_strings[i] != ms)
+	    {
+	      ms->stringpool_key = (*l)->first_strings[i]->stringpool_key;
+	      gold_assert(ms->stringpool_key != 0);
+	      continue;
+	    }
+
+	  size_t len;
+	  const Char_type* s = pending_string(*l, i, &len);
+	  if (have_hashes)
+	    this->stringpool_.add_with_length_and_hash(s, len,
+						       (*l)->hash_codes[i],
+						       true,
+						       &ms->stringpool_key);
+	  else
+	    this->stringpool_.add_with_length(s, len, true,
+					      &ms->stringpool_key);
+	}
+
+      // Free the memory we no longer need.  The view can only be
+      // released while the object is locked, which we can not do
+      // here as other tasks may be running; finalize_merged_data
+      // releases it.
+      delete[] (*l)->buffer;
+      (*l)->buffer = NULL;
+      (*l)->contents = NULL;
+      std::vector<size_t>().swap((*l)->hash_codes);
+      std::vector<const Merged_string*>().swap((*l)->first_strings);
+    }
+
+  this->pending_count_ = 0;
+}
+
 // Finalize the mappings from the input sections to the output
 // section, and return the final data size.
 
@@ -547,6 +736,9 @@ template<typename Char_type>
 section_size_type
 Output_merge_string<Char_type>::finalize_merged_data()
 {
+  // Normally Add_merged_strings_task has already done this.
+  this->do_add_pending_strings();
+
   this->stringpool_.set_string_offsets();
 
   for (typename Merged_strings_lists::const_iterator l =
@@ -575,6 +767,16 @@ Output_merge_string<Char_type>::finalize_merged_data()
 	    last_output_offset =
 	        this->stringpool_.get_offset_from_key(p->stringpool_key);
 	}
+
+      // All the merge tasks have finished, and we are running
+      // single-threaded, so we can lock the object to release the
+      // view.
+      if ((*l)->view != NULL)
+	{
+	  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+	  Task_lock_obj<Object> tl(dummy_task, object);
+	  delete (*l)->view;
+	}
       delete *l;
     }
 
@@ -644,7 +846,8 @@ Output_merge_string<uint32_t>::string_name()
   return "32-bit strings";
 }
 
-// Print merge stats to stderr.
+// Print merge stats to stderr for --stats, and record them for
+// --stats-json.
 
 template<typename Char_type>
 void
@@ -652,13 +855,52 @@ Output_merge_string<Char_type>::do_print_merge_stats(const char* section_name)
 {
   char buf[200];
   snprintf(buf, sizeof buf, "%s merged %s", section_name, this->string_name());
-  fprintf(stderr, _("%s: %s input bytes: %zu\n"),
-	  program_name, buf, this->input_size_);
-  fprintf(stderr, _("%s: %s input strings: %zu\n"),
-	  program_name, buf, this->input_count_);
+  if (parameters->options().stats())
+    {
+      fprintf(stderr, _("%s: %s input bytes: %zu\n"),
+	      program_name, buf, this->input_size_);
+      fprintf(stderr, _("%s: %s input strings: %zu\n"),
+	      program_name, buf, this->input_count_);
+    }
+  record_stat(std::string(buf) + " input bytes", this->input_size_);
+  record_stat(std::string(buf) + " input strings", this->input_count_);
   this->stringpool_.print_stats(buf);
 }
 
+// Class Add_merged_strings_task.
+
+Add_merged_strings_task::~Add_merged_strings_task()
+{
+  delete this->sections_;
+  delete this->this_blocker_;
+  delete this->hashed_blocker_;
+  delete this->found_blocker_;
+}
+
+// Wait for the previous tasks and for the duplicates to be found.
+
+Task_token*
+Add_merged_strings_task::is_runnable()
+{
+  if (this->this_blocker_->is_blocked())
+    return this->this_blocker_;
+  if (this->found_blocker_->is_blocked())
+    return this->found_blocker_;
+  return NULL;
+}
+
+// Add the strings to the Stringpools.
+
+void
+Add_merged_strings_task::run(Workqueue*)
+{
+  for (std::vector<Output_merge_base*>::const_iterator p =
+	 this->sections_->begin();
+       p != this->sections_->end();
+       ++p)
+    (*p)->add_pending_strings();
+}
+
 // Instantiate the templates we need.
 
 template
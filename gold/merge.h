@@ -33,6 +33,8 @@
 namespace gold
 {
 
+class File_view;
+
 // For each object with merge sections, we store an Object_merge_map.
 // This is used to map locations in input sections to a merged output
 // section.  The output section itself is not recorded here--it can be
@@ -69,6 +71,12 @@ class Object_merge_map
 		    section_offset_type offset,
 		    section_offset_type* output_offset);
 
+  // Sort the mappings for every input section.  After this,
+  // get_output_offset does not change this object, so it may be
+  // called from several threads at once.
+  void
+  sort_input_merge_maps();
+
   const Output_section_data*
   find_merge_section(unsigned int shndx) const;
 
@@ -235,6 +243,44 @@ class Output_merge_base : public Output_section_data
     gold_assert(this->keeps_input_sections_);
     return this->input_sections_.end();
   }
+
+  // When running with threads, an Output_merge_string does not add
+  // strings to its Stringpool as it sees the input sections.  The
+  // strings are instead hashed and deduplicated by tasks, and then
+  // added to the Stringpool in input order, so that the output is
+  // the same as when the strings are added one at a time.  Adding
+  // the strings to the Stringpool, which also assigns their output
+  // offsets, is still done by a single task, since the keys and
+  // offsets depend on the input order.  These functions do nothing
+  // for other merge sections.
+
+  // Return the number of input sections which may have pending
+  // strings.
+  size_t
+  pending_input_count() const
+  { return this->do_pending_input_count(); }
+
+  // Return the number of pending strings.
+  size_t
+  pending_string_count() const
+  { return this->do_pending_string_count(); }
+
+  // Compute the hash codes of the pending strings in the input
+  // sections BEGIN up to END.
+  void
+  hash_pending_strings(size_t begin, size_t end)
+  { this->do_hash_pending_strings(begin, end); }
+
+  // For each pending string whose hash code is SHARD modulo
+  // SHARD_COUNT, find the first string with the same contents.
+  void
+  find_pending_duplicates(unsigned int shard, unsigned int shard_count)
+  { this->do_find_pending_duplicates(shard, shard_count); }
+
+  // Add the pending strings to the Stringpool.
+  void
+  add_pending_strings()
+  { this->do_add_pending_strings(); }
  
  protected:
   // Return the output offset for an input offset.
@@ -253,6 +299,27 @@ class Output_merge_base : public Output_section_data
   do_set_keeps_input_sections()
   { this->keeps_input_sections_ = true; }
 
+  // These may be overridden by the child class.
+  virtual size_t
+  do_pending_input_count() const
+  { return 0; }
+
+  virtual size_t
+  do_pending_string_count() const
+  { return 0; }
+
+  virtual void
+  do_hash_pending_strings(size_t, size_t)
+  { }
+
+  virtual void
+  do_find_pending_duplicates(unsigned int, unsigned int)
+  { }
+
+  virtual void
+  do_add_pending_strings()
+  { }
+
   // Record the merged input section for script processing.
   void
   record_input_section(Relobj* relobj, unsigned int shndx);
@@ -402,7 +469,8 @@ class Output_merge_string : public Output_merge_base
  public:
   Output_merge_string(uint64_t addralign)
     : Output_merge_base(sizeof(Char_type), addralign), stringpool_(addralign),
-      merged_strings_lists_(), input_count_(0), input_size_(0)
+      merged_strings_lists_(), input_count_(0), input_size_(0),
+      pending_count_(0)
   {
     this->stringpool_.set_no_zero_null();
   }
@@ -461,6 +529,33 @@ class Output_merge_string : public Output_merge_base
     Output_merge_base::do_set_keeps_input_sections();
   }
 
+  // Return the number of input sections which may have pending
+  // strings.
+  size_t
+  do_pending_input_count() const
+  {
+    return (this->pending_count_ == 0
+	    ? 0
+	    : this->merged_strings_lists_.size());
+  }
+
+  // Return the number of pending strings.
+  size_t
+  do_pending_string_count() const
+  { return this->pending_count_; }
+
+  // Hash the pending strings.
+  void
+  do_hash_pending_strings(size_t begin, size_t end);
+
+  // Find the first occurrence of the pending strings in one shard.
+  void
+  do_find_pending_duplicates(unsigned int shard, unsigned int shard_count);
+
+  // Add the pending strings to the Stringpool.
+  void
+  do_add_pending_strings();
+
  private:
   // The name of the string type, for stats.
   const char*
@@ -490,14 +585,76 @@ class Output_merge_string : public Output_merge_base
     unsigned int shndx;
     // The list of merged strings.
     Merged_strings merged_strings;
+    // If the strings have not yet been added to the Stringpool, the
+    // section contents.  The offsets in MERGED_STRINGS are offsets
+    // into this.
+    const Char_type* contents;
+    // The view of the input file which holds CONTENTS, if any.  This
+    // is released by finalize_merged_data.
+    File_view* view;
+    // The decompressed section contents, if we own them.
+    const unsigned char* buffer;
+    // The hash codes of the pending strings, once computed.
+    std::vector<size_t> hash_codes;
+    // For each pending string, the first string in any input section
+    // with the same contents, once computed.
+    std::vector<const Merged_string*> first_strings;
 
     Merged_strings_list(Relobj* objecta, unsigned int shndxa)
-      : object(objecta), shndx(shndxa), merged_strings()
+      : object(objecta), shndx(shndxa), merged_strings(), contents(NULL),
+	view(NULL), buffer(NULL), hash_codes(), first_strings()
     { }
   };
 
   typedef std::vector<Merged_strings_list*> Merged_strings_lists;
 
+  // The key used to find duplicate pending strings.
+  struct Pending_string
+  {
+    const Char_type* string;
+    // Length is in characters, not bytes.
+    size_t length;
+    size_t hash_code;
+
+    Pending_string(const Char_type* s, size_t len, size_t hash)
+      : string(s), length(len), hash_code(hash)
+    { }
+  };
+
+  struct Pending_string_hash
+  {
+    size_t
+    operator()(const Pending_string& ps) const
+    { return ps.hash_code; }
+  };
+
+  struct Pending_string_eq
+  {
+    bool
+    operator()(const Pending_string& ps1, const Pending_string& ps2) const
+    {
+      return (ps1.hash_code == ps2.hash_code
+	      && ps1.length == ps2.length
+	      && memcmp(ps1.string, ps2.string,
+			ps1.length * sizeof(Char_type)) == 0);
+    }
+  };
+
+  typedef Unordered_map<Pending_string, const Merged_string*,
+			Pending_string_hash, Pending_string_eq>
+    Pending_string_set;
+
+  // Return the pending string at index I in the list L, and set
+  // *PLENGTH to its length in characters.
+  static const Char_type*
+  pending_string(const Merged_strings_list* l, size_t i, size_t* plength)
+  {
+    const Merged_strings& ms(l->merged_strings);
+    section_offset_type offset = ms[i].offset;
+    *plength = (ms[i + 1].offset - offset) / sizeof(Char_type) - 1;
+    return l->contents + offset / sizeof(Char_type);
+  }
+
   // As we see the strings, we add them to a Stringpool.
   Stringpool_template<Char_type> stringpool_;
   // Map from a location in an input object to an entry in the
@@ -507,6 +664,135 @@ class Output_merge_string : public Output_merge_base
   size_t input_count_;
   // The total size of input sections.
   size_t input_size_;
+  // The number of strings which have not yet been added to the
+  // Stringpool.
+  size_t pending_count_;
+};
+
+// This task computes the hash codes of the pending strings in some of
+// the input sections of a merged string section.
+
+class Hash_merged_strings_task : public Task
+{
+ public:
+  Hash_merged_strings_task(Output_merge_base* pomb, size_t begin, size_t end,
+			   Task_token* hashed_blocker)
+    : pomb_(pomb), begin_(begin), end_(end), hashed_blocker_(hashed_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->hashed_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->pomb_->hash_pending_strings(this->begin_, this->end_); }
+
+  std::string
+  get_name() const
+  { return "Hash_merged_strings_task"; }
+
+ private:
+  Output_merge_base* pomb_;
+  size_t begin_;
+  size_t end_;
+  Task_token* hashed_blocker_;
+};
+
+// This task finds the first occurrence of the pending strings in one
+// shard of a merged string section.  It runs after all the hash codes
+// have been computed.
+
+class Find_merged_duplicates_task : public Task
+{
+ public:
+  Find_merged_duplicates_task(Output_merge_base* pomb, unsigned int shard,
+			      unsigned int shard_count,
+			      Task_token* hashed_blocker,
+			      Task_token* found_blocker)
+    : pomb_(pomb), shard_(shard), shard_count_(shard_count),
+      hashed_blocker_(hashed_blocker), found_blocker_(found_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->hashed_blocker_->is_blocked())
+      return this->hashed_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->found_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->pomb_->find_pending_duplicates(this->shard_, this->shard_count_); }
+
+  std::string
+  get_name() const
+  { return "Find_merged_duplicates_task"; }
+
+ private:
+  Output_merge_base* pomb_;
+  unsigned int shard_;
+  unsigned int shard_count_;
+  Task_token* hashed_blocker_;
+  Task_token* found_blocker_;
+};
+
+// This task adds the deduplicated strings to the Stringpools of the
+// merged string sections, in input order.  It runs after all the
+// duplicates have been found, and after THIS_BLOCKER, which it takes
+// over, is released.  It deletes all the blockers it is given except
+// NEXT_BLOCKER.
+
+class Add_merged_strings_task : public Task
+{
+ public:
+  Add_merged_strings_task(std::vector<Output_merge_base*>* sections,
+			  Task_token* this_blocker,
+			  Task_token* hashed_blocker,
+			  Task_token* found_blocker,
+			  Task_token* next_blocker)
+    : sections_(sections), this_blocker_(this_blocker),
+      hashed_blocker_(hashed_blocker), found_blocker_(found_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Add_merged_strings_task();
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Add_merged_strings_task"; }
+
+ private:
+  std::vector<Output_merge_base*>* sections_;
+  Task_token* this_blocker_;
+  Task_token* hashed_blocker_;
+  Task_token* found_blocker_;
+  Task_token* next_blocker_;
 };
 
 } // End namespace gold.
@@ -2454,6 +2454,16 @@ class Mips_output_data_reloc : public Output_data_reloc<sh_type, dynamic,
         big_endian> Writer;
     this->template do_write_generic<Writer>(of);
   }
+
+  // Write out a bucket of sorted relocs, when writing them out in
+  // parallel.
+  void
+  do_write_bucket(Output_file* of, unsigned int i)
+  {
+    typedef Mips_output_reloc_writer<sh_type, dynamic, size,
+        big_endian> Writer;
+    this->template write_bucket_generic<Writer>(of, i);
+  }
 };
 
 
@@ -306,6 +306,13 @@ Relobj::find_merge_section(unsigned int shndx) const {
   return object_merge_map->find_merge_section(shndx);
 }
 
+void
+Relobj::sort_merge_maps()
+{
+  if (this->object_merge_map_ != NULL)
+    this->object_merge_map_->sort_input_merge_maps();
+}
+
 // To copy the symbols data read from the file to a local data structure.
 // This function is called from do_layout only while doing garbage
 // collection.
@@ -479,7 +486,8 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
     is_deferred_layout_(false),
     deferred_layout_(),
     deferred_layout_relocs_(),
-    output_views_(NULL)
+    output_views_(NULL),
+    relocate_workqueue_(NULL)
 {
   this->e_type_ = ehdr.get_e_type();
 }
@@ -822,6 +830,66 @@ Sized_relobj_file<size, big_endian>::do_find_special_sections(
 			    "debug_types", 12) != NULL)));
 }
 
+// With --prefetch-inputs, ask the system to start reading the symbol
+// table, its string table and the relocations for allocated sections,
+// all at once.  We read the symbols right away, but asking for all the
+// ranges together lets the system read them in parallel rather than
+// one page fault at a time.  The relocations are read much later, when
+// we scan and apply relocations, so by then they should be in the page
+// cache.  This is called by the Read_symbols task, or by the
+// Add_archive_symbols task for an archive member, right after the
+// section headers have been read.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::prefetch_sections(
+    const unsigned char* pshdrs)
+{
+  const unsigned int shnum = this->shnum();
+  File_read::Prefetch_ranges ranges;
+
+  if (this->symtab_shndx_ != 0)
+    {
+      typename This::Shdr symtabshdr(pshdrs
+				     + this->symtab_shndx_ * This::shdr_size);
+      ranges.push_back(std::make_pair(symtabshdr.get_sh_offset(),
+				      convert_to_section_size_type(
+					  symtabshdr.get_sh_size())));
+      unsigned int strtab_shndx =
+	this->adjust_shndx(symtabshdr.get_sh_link());
+      if (strtab_shndx > 0 && strtab_shndx < shnum)
+	{
+	  typename This::Shdr strtabshdr(pshdrs
+					 + strtab_shndx * This::shdr_size);
+	  ranges.push_back(std::make_pair(strtabshdr.get_sh_offset(),
+					  convert_to_section_size_type(
+					      strtabshdr.get_sh_size())));
+	}
+    }
+
+  const unsigned char* p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      const unsigned int sh_type = shdr.get_sh_type();
+      if (sh_type != elfcpp::SHT_REL && sh_type != elfcpp::SHT_RELA)
+	continue;
+      unsigned int target_shndx = this->adjust_shndx(shdr.get_sh_info());
+      if (target_shndx == 0 || target_shndx >= shnum)
+	continue;
+      typename This::Shdr target_shdr(pshdrs + target_shndx * This::shdr_size);
+      if ((target_shdr.get_sh_flags() & elfcpp::SHF_ALLOC) == 0)
+	continue;
+
+      if (shdr.get_sh_size() > 0)
+	ranges.push_back(std::make_pair(shdr.get_sh_offset(),
+					convert_to_section_size_type(
+					    shdr.get_sh_size())));
+    }
+
+  this->input_file()->file().prefetch(this->offset(), &ranges);
+}
+
 // Read the sections and symbols from an object file.
 
 template<int size, bool big_endian>
@@ -844,6 +912,9 @@ Sized_relobj_file<size, big_endian>::base_read_symbols(Read_symbols_data* sd)
 
   this->find_symtab(pshdrs);
 
+  if (parameters->options().prefetch_inputs())
+    this->prefetch_sections(pshdrs);
+
   bool need_local_symbols = this->do_find_special_sections(sd);
 
   sd->symbols = NULL;
@@ -919,6 +990,30 @@ Sized_relobj_file<size, big_endian>::base_read_symbols(Read_symbols_data* sd)
   sd->symbol_names = fvstrtab;
   sd->symbol_names_size =
     convert_to_section_size_type(strtabshdr.get_sh_size());
+
+  // When running with threads, hash the names of the global symbols
+  // now.  Read_symbols tasks run in parallel, while Add_symbols tasks
+  // must run one at a time in input file order.
+  if (parameters->options().threads())
+    {
+      const unsigned char* psyms = (fvsymtab->data()
+				    + sd->external_symbols_offset);
+      const size_t symcount = extsize / sym_size;
+      const char* names = reinterpret_cast<const char*>(fvstrtab->data());
+      sd->symbol_name_hashes.resize(symcount);
+      for (size_t i = 0; i < symcount; ++i, psyms += sym_size)
+	{
+	  elfcpp::Sym<size, big_endian> sym(psyms);
+	  unsigned int st_name = sym.get_st_name();
+	  if (st_name >= sd->symbol_names_size)
+	    continue;
+	  const char* name = names + st_name;
+	  const char* ver = strchr(name, '@');
+	  size_t len = ver != NULL ? ver - name : strlen(name);
+	  sd->symbol_name_hashes[i].length = len;
+	  sd->symbol_name_hashes[i].hash_code = string_hash<char>(name, len);
+	}
+    }
 }
 
 // Return the section index of symbol SYM.  Set *VALUE to its value in
@@ -2104,10 +2199,18 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
 
   const char* sym_names =
     reinterpret_cast<const char*>(sd->symbol_names->data());
+  const Symbol_name_hash* name_hashes = NULL;
+  if (!sd->symbol_name_hashes.empty())
+    {
+      gold_assert(sd->symbol_name_hashes.size() == symcount);
+      name_hashes = &sd->symbol_name_hashes[0];
+    }
+
   symtab->add_from_relobj(this,
 			  sd->symbols->data() + sd->external_symbols_offset,
 			  symcount, this->local_symbol_count_,
 			  sym_names, sd->symbol_names_size,
+			  name_hashes,
 			  &this->symbols_,
 			  &this->defined_count_);
 
@@ -2624,6 +2727,54 @@ Sized_relobj_file<size, big_endian>::do_finalize_local_symbols(
   return index;
 }
 
+// Add to *FOUND the local function symbols whose names are in NAMES.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::do_find_local_functions(
+    const Unordered_set<std::string>& names,
+    Relobj::Local_functions* found)
+{
+  if (this->symtab_shndx_ == 0)
+    return;
+
+  section_size_type symbols_size;
+  const unsigned char* symbols = this->section_contents(this->symtab_shndx_,
+							&symbols_size,
+							false);
+
+  unsigned int symbol_names_shndx =
+    this->adjust_shndx(this->section_link(this->symtab_shndx_));
+  section_size_type names_size;
+  const unsigned char* symbol_names_u =
+    this->section_contents(symbol_names_shndx, &names_size, false);
+  const char* symbol_names = reinterpret_cast<const char*>(symbol_names_u);
+
+  const int sym_size = This::sym_size;
+  size_t count = symbols_size / sym_size;
+  if (count > this->local_symbol_count_)
+    count = this->local_symbol_count_;
+
+  const unsigned char* p = symbols + sym_size;
+  for (size_t i = 1; i < count; ++i, p += sym_size)
+    {
+      elfcpp::Sym<size, big_endian> sym(p);
+      if (sym.get_st_type() != elfcpp::STT_FUNC
+	  || sym.get_st_name() >= names_size)
+	continue;
+
+      bool is_ordinary;
+      unsigned int shndx = this->adjust_sym_shndx(i, sym.get_st_shndx(),
+						  &is_ordinary);
+      if (!is_ordinary || shndx == elfcpp::SHN_UNDEF)
+	continue;
+
+      std::string name(symbol_names + sym.get_st_name());
+      if (names.find(name) != names.end())
+	found->push_back(std::make_pair(name, shndx));
+    }
+}
+
 // Set the output dynamic symbol table indexes for the local variables.
 
 template<int size, bool big_endian>
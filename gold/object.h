@@ -49,11 +49,28 @@ class Pluginobj;
 class Dynobj;
 class Object_merge_map;
 class Relocatable_relocs;
+class Workqueue;
 struct Symbols_data;
 
 template<typename Stringpool_char>
 class Stringpool_template;
 
+// The length and hash code of the name of a global symbol, as
+// computed by gold::string_hash.  The length and hash do not include
+// any version suffix introduced by '@'.
+
+struct Symbol_name_hash
+{
+  Symbol_name_hash()
+    : length(0), hash_code(0)
+  { }
+
+  // Length of the name in bytes.
+  size_t length;
+  // Hash code of the name.
+  size_t hash_code;
+};
+
 // Data to pass from read_symbols() to add_symbols().
 
 struct Read_symbols_data
@@ -96,6 +113,13 @@ struct Read_symbols_data
   File_view* verneed;
   section_size_type verneed_size;
   unsigned int verneed_info;
+
+  // The lengths and hash codes of the names of the external symbols.
+  // When running with threads, these are computed by the Read_symbols
+  // task, which runs in parallel, so that Add_symbols, which runs in
+  // input file order, does not have to hash every name.  Otherwise
+  // this is empty.
+  std::vector<Symbol_name_hash> symbol_name_hashes;
 };
 
 // Information used to print error messages.
@@ -113,11 +137,14 @@ struct Symbol_location_info
 struct Section_relocs
 {
   Section_relocs()
-    : contents(NULL)
+    : contents(NULL), deferred_relocs(NULL), deferred_reloc_count(0)
   { }
 
   ~Section_relocs()
-  { delete this->contents; }
+  {
+    delete this->contents;
+    delete this->deferred_relocs;
+  }
 
   // Index of reloc section.
   unsigned int reloc_shndx;
@@ -135,6 +162,11 @@ struct Section_relocs
   bool needs_special_offset_handling;
   // Whether the data section is allocated (has the SHF_ALLOC flag set).
   bool is_data_section_allocated;
+  // If the relocs were prescanned, the relocs which scan_relocs still
+  // needs to see, copied from CONTENTS.  Otherwise NULL.
+  std::vector<unsigned char>* deferred_relocs;
+  // Number of reloc entries in DEFERRED_RELOCS.
+  size_t deferred_reloc_count;
 };
 
 // Relocations in an object file.  This is read in read_relocs and
@@ -554,6 +586,12 @@ class Object
   const unsigned char*
   section_contents(unsigned int shndx, section_size_type* plen, bool cache);
 
+  // Return a lasting view of the contents of a section.  Set *PLEN to
+  // the size.  The view must be deleted while the object is locked.
+  File_view*
+  section_contents_lasting_view(unsigned int shndx, section_size_type* plen)
+  { return this->do_section_contents_lasting_view(shndx, plen); }
+
   // Adjust a symbol's section index as needed.  SYMNDX is the index
   // of the symbol and SHNDX is the symbol's section from
   // get_st_shndx.  This returns the section index.  It sets
@@ -914,6 +952,12 @@ class Object
   do_section_contents(unsigned int shndx, section_size_type* plen,
 		      bool cache) = 0;
 
+  // Return a lasting view of the contents of a section--implemented
+  // by child class.
+  virtual File_view*
+  do_section_contents_lasting_view(unsigned int, section_size_type*)
+  { gold_unreachable(); }
+
   // Get the size of a section--implemented by child class.
   virtual uint64_t
   do_section_size(unsigned int shndx) = 0;
@@ -1155,6 +1199,12 @@ class Relobj : public Object
   gc_process_relocs(Symbol_table* symtab, Layout* layout, Read_relocs_data* rd)
   { return this->do_gc_process_relocs(symtab, layout, rd); }
 
+  // Prescan the relocs in parallel with other objects, before
+  // scan_relocs, dropping those which don't need to be scanned.
+  void
+  prescan_relocs(Symbol_table* symtab, Read_relocs_data* rd)
+  { return this->do_prescan_relocs(symtab, rd); }
+
   // Scan the relocs and adjust the symbol table.
   void
   scan_relocs(Symbol_table* symtab, Layout* layout, Read_relocs_data* rd)
@@ -1255,6 +1305,19 @@ class Relobj : public Object
   set_local_dynsym_indexes(unsigned int index)
   { return this->do_set_local_dynsym_indexes(index); }
 
+  // The local function symbols found by find_local_functions: the
+  // name and the index of the defining section.
+  typedef std::vector<std::pair<std::string, unsigned int> > Local_functions;
+
+  // Add to *FOUND each local function symbol whose name is in NAMES
+  // and which is defined in an ordinary section.  This reads the
+  // symbol table, so the object must be locked.  It is only used for
+  // --call-graph-ordering-file.
+  void
+  find_local_functions(const Unordered_set<std::string>& names,
+		       Local_functions* found)
+  { this->do_find_local_functions(names, found); }
+
   // Set the offset where local dynamic symbol information will be stored.
   unsigned int
   set_local_dynsym_offset(off_t off)
@@ -1280,9 +1343,12 @@ class Relobj : public Object
   { return this->dyn_reloc_count_; }
 
   // Relocate the input sections and write out the local symbols.
+  // WORKQUEUE may be used to relocate parts of the object in
+  // parallel; it is NULL if that should not be done.
   void
-  relocate(const Symbol_table* symtab, const Layout* layout, Output_file* of)
-  { return this->do_relocate(symtab, layout, of); }
+  relocate(const Symbol_table* symtab, const Layout* layout, Output_file* of,
+	   Workqueue* workqueue)
+  { return this->do_relocate(symtab, layout, of, workqueue); }
 
   // Return whether an input section is being included in the link.
   bool
@@ -1338,6 +1404,11 @@ class Relobj : public Object
   const Output_section_data*
   find_merge_section(unsigned int shndx) const;
 
+  // Sort the merge mappings, so that merge_output_offset may be
+  // called from several threads at once.
+  void
+  sort_merge_maps();
+
   // Record the relocatable reloc info for an input reloc section.
   void
   set_relocatable_relocs(unsigned int reloc_shndx, Relocatable_relocs* rr)
@@ -1394,6 +1465,12 @@ class Relobj : public Object
   virtual void
   do_gc_process_relocs(Symbol_table*, Layout*, Read_relocs_data*) = 0;
 
+  // Prescan the relocs--may be implemented by child class.  By
+  // default scan_relocs sees all the relocs.
+  virtual void
+  do_prescan_relocs(Symbol_table*, Read_relocs_data*)
+  { }
+
   // Scan the relocs--implemented by child class.
   virtual void
   do_scan_relocs(Symbol_table*, Layout*, Read_relocs_data*) = 0;
@@ -1453,6 +1530,12 @@ class Relobj : public Object
   virtual unsigned int
   do_set_local_dynsym_indexes(unsigned int) = 0;
 
+  // Find local function symbols--may be implemented by child class.
+  virtual void
+  do_find_local_functions(const Unordered_set<std::string>&,
+			  Local_functions*)
+  { }
+
   // Set the offset where local dynamic symbol information will be stored.
   virtual unsigned int
   do_set_local_dynsym_offset(off_t) = 0;
@@ -1460,7 +1543,8 @@ class Relobj : public Object
   // Relocate the input sections and write out the local
   // symbols--implemented by child class.
   virtual void
-  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of) = 0;
+  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of,
+	      Workqueue*) = 0;
 
   // Set the offset of a section--implemented by child class.
   virtual void
@@ -2422,6 +2506,10 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   void
   do_gc_process_relocs(Symbol_table*, Layout*, Read_relocs_data*);
 
+  // Prescan the relocs, keeping those which need to be scanned.
+  void
+  do_prescan_relocs(Symbol_table*, Read_relocs_data*);
+
   // Scan the relocs and adjust the symbol table.
   void
   do_scan_relocs(Symbol_table*, Layout*, Read_relocs_data*);
@@ -2435,6 +2523,11 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   unsigned int
   do_finalize_local_symbols(unsigned int, off_t, Symbol_table*);
 
+  // Find local function symbols.
+  void
+  do_find_local_functions(const Unordered_set<std::string>&,
+			  Relobj::Local_functions*);
+
   // Set the offset where local dynamic symbol information will be stored.
   unsigned int
   do_set_local_dynsym_indexes(unsigned int);
@@ -2445,7 +2538,8 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
 
   // Relocate the input sections and write out the local symbols.
   void
-  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of);
+  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of,
+	      Workqueue*);
 
   // Get the size of a section.
   uint64_t
@@ -2472,6 +2566,16 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
     return this->get_view(loc.file_offset, *plen, true, cache);
   }
 
+  // Return a lasting view of the contents of a section.
+  File_view*
+  do_section_contents_lasting_view(unsigned int shndx,
+				   section_size_type* plen)
+  {
+    Object::Location loc(this->elf_file_.section_contents(shndx));
+    *plen = convert_to_section_size_type(loc.data_size);
+    return this->get_lasting_view(loc.file_offset, *plen, true, false);
+  }
+
   // Return section flags.
   uint64_t
   do_section_flags(unsigned int shndx);
@@ -2584,6 +2688,17 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
 			 Views* pviews, unsigned int start_shndx,
 			 unsigned int end_shndx);
 
+  // Relocate the sections in pieces which run in parallel, if this
+  // object has enough relocations to make that worthwhile.  Return
+  // false if the sections were not relocated.
+  bool
+  relocate_section_pieces(const Symbol_table* symtab, const Layout* layout,
+			  const unsigned char* pshdrs, Output_file* of,
+			  Views* pviews);
+
+  // The pieces of the sections, used by relocate_section_pieces.
+  class Relocate_section_pieces;
+
   // Adjust this local symbol value.  Return false if the symbol
   // should be discarded from the output file.
   virtual bool
@@ -2630,6 +2745,11 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   void
   find_symtab(const unsigned char* pshdrs);
 
+  // Prefetch the symbol table and the relocation sections, given the
+  // section headers.
+  void
+  prefetch_sections(const unsigned char* pshdrs);
+
   // Return whether SHDR has the right flags for a GNU style exception
   // frame section.
   bool
@@ -2882,6 +3002,9 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   std::vector<Deferred_layout> deferred_layout_relocs_;
   // Pointer to the list of output views; valid only during do_relocate().
   const Views* output_views_;
+  // The workqueue to use for parallel relocation; valid only during
+  // do_relocate().
+  Workqueue* relocate_workqueue_;
 };
 
 // A class to manage the list of all objects.
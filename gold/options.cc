@@ -1311,6 +1311,15 @@ General_options::finalize()
 	gold_fatal(_("-f/--auxiliary may not be used without -shared"));
     }
 
+  if (this->call_graph_ordering_file() != NULL)
+    {
+      if (this->section_ordering_file() != NULL)
+	gold_fatal(_("--call-graph-ordering-file and --section-ordering-file "
+		     "are incompatible"));
+      if (this->relocatable())
+	gold_fatal(_("--call-graph-ordering-file and -r are incompatible"));
+    }
+
   // TODO: implement support for -retain-symbols-file with -r, if needed.
   if (this->relocatable() && this->retain_symbols_file())
     gold_fatal(_("-retain-symbols-file does not yet work with -r"));
@@ -1329,6 +1338,31 @@ General_options::finalize()
 		 "[0.0, 1.0)"),
 	       this->hash_bucket_empty_fraction());
 
+  if (this->huge_page_size() != 0
+      && (this->huge_page_size() & (this->huge_page_size() - 1)) != 0)
+    gold_fatal(_("--huge-page-size value %#llx is not a power of two"),
+	       static_cast<unsigned long long>(this->huge_page_size()));
+
+  if (strcmp(this->compress_debug_sections(), "zstd") == 0)
+    {
+#ifndef HAVE_ZSTD
+      gold_fatal(_("--compress-debug-sections=zstd: gold was built without "
+		   "zstd support"));
+#endif
+      if (this->user_set_compress_debug_sections_level()
+	  && (this->compress_debug_sections_level() < 1
+	      || this->compress_debug_sections_level() > 22))
+	gold_fatal(_("--compress-debug-sections-level value %d out of range "
+		     "[1, 22]"),
+		   this->compress_debug_sections_level());
+    }
+  else if (this->user_set_compress_debug_sections_level()
+	   && (this->compress_debug_sections_level() < 0
+	       || this->compress_debug_sections_level() > 9))
+    gold_fatal(_("--compress-debug-sections-level value %d out of range "
+		 "[0, 9]"),
+	       this->compress_debug_sections_level());
+
   if (this->implicit_incremental_ && this->incremental_mode_ == INCREMENTAL_OFF)
     gold_fatal(_("Options --incremental-changed, --incremental-unchanged, "
 		 "--incremental-unknown require the use of --incremental"));
@@ -1360,6 +1394,12 @@ General_options::finalize()
 	  gold_warning(_("ignoring --icf for an incremental link"));
 	  this->set_icf_status(ICF_NONE);
 	}
+      if (this->pack_relative_relocs())
+	{
+	  gold_warning(_("ignoring -z pack-relative-relocs for an "
+			 "incremental link"));
+	  this->set_pack_relative_relocs(false);
+	}
       if (strcmp(this->compress_debug_sections(), "none") != 0)
 	{
 	  gold_warning(_("ignoring --compress-debug-sections for an "
@@ -755,14 +755,29 @@ class General_options
 
   // c
 
+  DEFINE_string(call_graph_ordering_file, options::TWO_DASHES, '\0', NULL,
+		N_("Layout functions to improve locality, using a call graph "
+		   "profile of CALLER CALLEE WEIGHT lines"),
+		N_("FILENAME"));
+
   DEFINE_bool(check_sections, options::TWO_DASHES, '\0', true,
 	      N_("Check segment addresses for overlaps"),
 	      N_("Do not check segment addresses for overlaps"));
 
   DEFINE_enum(compress_debug_sections, options::TWO_DASHES, '\0', "none",
 	      N_("Compress .debug_* sections in the output file"),
-	      ("[none,zlib,zlib-gnu,zlib-gabi]"),
-	      {"none", "zlib", "zlib-gnu", "zlib-gabi"});
+	      ("[none,zlib,zlib-gnu,zlib-gabi,zstd]"),
+	      {"none", "zlib", "zlib-gnu", "zlib-gabi", "zstd"});
+
+  DEFINE_uint64(compress_debug_sections_chunk_size, options::TWO_DASHES,
+		'\0', 1 << 20,
+		N_("Compress debug sections in independent pieces of SIZE "
+		   "bytes, which may be compressed in parallel (0 means "
+		   "one piece per section)"), N_("SIZE"));
+
+  DEFINE_int(compress_debug_sections_level, options::TWO_DASHES, '\0', -1,
+	     N_("Compression level for compressed debug sections "
+		"(default 1, or 9 if optimizing)"), N_("LEVEL"));
 
   DEFINE_bool(copy_dt_needed_entries, options::TWO_DASHES, '\0', false,
 	      N_("Not supported"),
@@ -829,6 +844,12 @@ class General_options
 	      N_("Create exception frame header"),
 	      N_("Do not create exception frame header"));
 
+  DEFINE_bool(early_writeback, options::TWO_DASHES, '\0', false,
+	      N_("Start writing the mapped output file to disk while "
+		 "linking"),
+	      N_("Leave writing the output file to disk until it is "
+		 "closed (default)"));
+
   // Alphabetized under 'e' because the option is spelled --enable-new-dtags.
   DEFINE_enable(new_dtags, options::EXACTLY_TWO_DASHES, '\0', true,
 		N_("Enable use of DT_RUNPATH"),
@@ -933,6 +954,11 @@ class General_options
 	      N_("Dynamic hash style"), N_("[sysv,gnu,both]"),
 	      {"sysv", "gnu", "both"});
 
+  DEFINE_uint64(huge_page_size, options::TWO_DASHES, '\0', 0,
+		N_("Align read-only and executable segments to huge pages "
+		   "of SIZE bytes"),
+		N_("SIZE"));
+
   // i
 
   DEFINE_bool_alias(i, relocatable, options::EXACTLY_ONE_DASH, '\0',
@@ -1018,6 +1044,11 @@ class General_options
   DEFINE_dirlist(library_path, options::TWO_DASHES, 'L',
 		 N_("Add directory to search path"), N_("DIR"));
 
+  DEFINE_string(link_cache, options::TWO_DASHES, '\0', NULL,
+		N_("Cache the --gdb-index scans of input files in DIR "
+		   "for later links"),
+		N_("DIR"));
+
   DEFINE_bool(long_plt, options::TWO_DASHES, '\0', false,
 	      N_("(ARM only) Generate long PLT entries"),
 	      N_("(ARM only) Do not generate long PLT entries"));
@@ -1137,6 +1168,10 @@ class General_options
 	      N_("Use posix_fallocate to reserve space in the output file"),
 	      N_("Use fallocate or ftruncate to reserve space"));
 
+  DEFINE_bool(prefetch_inputs, options::TWO_DASHES, '\0', false,
+	      N_("Read ahead the symbols and relocations of input files"),
+	      N_("Read input files only when needed"));
+
   DEFINE_bool(preread_archive_symbols, options::TWO_DASHES, '\0', false,
 	      N_("Preread archive symbols when multi-threaded"), NULL);
 
@@ -1177,6 +1212,12 @@ class General_options
 	      N_("Relax branches on certain targets"),
 	      N_("Do not relax branches"));
 
+  DEFINE_uint64(relocate_split_size, options::TWO_DASHES, '\0',
+		4 * 1024 * 1024,
+		N_("With --threads, relocate objects with more than SIZE "
+		   "bytes of relocations in parallel pieces"),
+		N_("SIZE"));
+
   DEFINE_string(retain_symbols_file, options::TWO_DASHES, '\0', NULL,
 		N_("keep only symbols listed in this file"), N_("FILE"));
 
@@ -1266,6 +1307,9 @@ class General_options
 
   DEFINE_bool(stats, options::TWO_DASHES, '\0', false,
 	      N_("Print resource usage statistics"), NULL);
+  DEFINE_string(stats_json, options::TWO_DASHES, '\0', NULL,
+		N_("Write resource usage statistics to FILE in JSON format"),
+		N_("FILE"));
 
   DEFINE_string(sysroot, options::TWO_DASHES, '\0', "",
 		N_("Set target system root directory"), N_("DIR"));
@@ -1274,6 +1318,10 @@ class General_options
 
   DEFINE_bool(trace, options::TWO_DASHES, 't', false,
 	      N_("Print the name of each input file"), NULL);
+  DEFINE_string(trace_tasks, options::TWO_DASHES, '\0', NULL,
+		N_("Write a timeline of task execution to FILE in Chrome "
+		   "trace format"),
+		N_("FILE"));
 
   DEFINE_bool(target1_abs, options::TWO_DASHES, '\0', false,
 	      N_("(ARM only) Force R_ARM_TARGET1 type to R_ARM_ABS32"),
@@ -1495,6 +1543,9 @@ class General_options
   DEFINE_bool(origin, options::DASH_Z, '\0', false,
 	      N_("Mark DSO to indicate that needs immediate $ORIGIN "
 		 "processing at runtime"), NULL);
+  DEFINE_bool(pack_relative_relocs, options::DASH_Z, '\0', false,
+	      N_("Pack relative relocations into a DT_RELR section"),
+	      N_("Do not pack relative relocations (default)"));
   DEFINE_bool(relro, options::DASH_Z, '\0', DEFAULT_LD_Z_RELRO,
 	      N_("Where possible mark variables read-only after relocation"),
 	      N_("Don't mark variables read-only after relocation"));
@@ -1613,6 +1664,12 @@ class General_options
   icf_safe_folding() const
   { return this->icf_status_ == ICF_SAFE; }
 
+  // Whether to collect the statistics reported by --stats and
+  // --stats-json.
+  bool
+  collect_stats() const
+  { return this->stats() || this->user_set_stats_json(); }
+
   // The --demangle option takes an optional string, and there is also
   // a --no-demangle option.  This is the best way to decide whether
   // to demangle or not.
@@ -1264,6 +1264,17 @@ Output_data_reloc_base<sh_type, dynamic, size, big_endian>
     os->set_should_link_to_dynsym();
 }
 
+// Class Output_data_relr_generic.
+
+// Set the entry size of a SHT_RELR section, which is the size of a
+// word.
+
+void
+Output_data_relr_generic::do_adjust_output_section(Output_section* os)
+{
+  os->set_entsize(parameters->target().get_size() / 8);
+}
+
 // Standard relocation writer, which just calls Output_reloc::write().
 
 template<int sh_type, bool dynamic, int size, bool big_endian>
@@ -1288,6 +1299,41 @@ Output_data_reloc_base<sh_type, dynamic, size, big_endian>::do_write(
   this->do_write_generic<Writer>(of);
 }
 
+// Write out bucket I of the relocs sorted in parallel.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+void
+Output_data_reloc_base<sh_type, dynamic, size, big_endian>::do_write_bucket(
+    Output_file* of,
+    unsigned int i)
+{
+  typedef Output_reloc_writer<sh_type, dynamic, size, big_endian> Writer;
+  this->template write_bucket_generic<Writer>(of, i);
+}
+
+// Queue tasks to sort and write out the relocs in parallel.  This is
+// only worth doing for the large sorted dynamic reloc sections.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+void
+Output_data_reloc_base<sh_type, dynamic, size, big_endian>::
+do_queue_write_tasks(Workqueue* workqueue, Output_file* of, int thread_count,
+		     Task_token* final_blocker)
+{
+  if (!this->sort_relocs() || this->write_in_parallel_)
+    return;
+  unsigned int count = parallel_sort_chunk_count(this->relocs_.size(),
+						 thread_count);
+  if (count < 2)
+    return;
+
+  this->parallel_write_ = new Parallel_write(this, count);
+  this->write_in_parallel_ = true;
+  final_blocker->add_blockers(count);
+  queue_parallel_sort_tasks(workqueue, of, this->parallel_write_, count,
+			    this->output_section()->name(), final_blocker);
+}
+
 // Class Output_relocatable_relocs.
 
 template<int sh_type, int size, bool big_endian>
@@ -4986,7 +5032,9 @@ Output_file::Output_file(const char* name)
     base_(NULL),
     map_is_anonymous_(false),
     map_is_allocated_(false),
-    is_temporary_(false)
+    is_temporary_(false),
+    early_writeback_(false),
+    unflushed_bytes_(0)
 {
 }
 
@@ -5246,6 +5294,12 @@ Output_file::map_no_anonymous(bool writable)
 
   this->map_is_anonymous_ = false;
   this->base_ = static_cast<unsigned char*>(base);
+
+#ifdef HAVE_SYNC_FILE_RANGE
+  this->early_writeback_ = (writable
+			    && parameters->options().early_writeback());
+#endif
+
   return true;
 }
 
@@ -5289,6 +5343,31 @@ Output_file::unmap()
   this->base_ = NULL;
 }
 
+// Note that LEN more bytes have been written to the mapped file.  Once
+// we have accumulated writeback_chunk_size bytes, ask the kernel to
+// start writing out the dirty pages, so that the I/O overlaps with the
+// rest of the link rather than all happening when the file is closed.
+// This is called by many threads at once.  Only the thread which
+// resets the count starts the writeback.
+
+void
+Output_file::note_written(size_t len)
+{
+  size_t unflushed = __sync_add_and_fetch(&this->unflushed_bytes_, len);
+  if (unflushed < writeback_chunk_size)
+    return;
+  if (!__sync_bool_compare_and_swap(&this->unflushed_bytes_, unflushed, 0))
+    return;
+
+#ifdef HAVE_SYNC_FILE_RANGE
+  // This only starts the writeback; it does not wait for it.  Pages
+  // which are written again later are simply written again.  Errors
+  // are ignored, as this is only an optimization, and any real I/O
+  // problem will be reported by close.
+  ::sync_file_range(this->o_, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+}
+
 // Close the output file.
 
 void
@@ -31,6 +31,7 @@
 #include "mapfile.h"
 #include "layout.h"
 #include "reloc-types.h"
+#include "parallel-sort.h"
 
 namespace gold
 {
@@ -100,7 +101,11 @@ class Output_file
   // Write data to the output file.
   void
   write(off_t offset, const void* data, size_t len)
-  { memcpy(this->base_ + offset, data, len); }
+  {
+    memcpy(this->base_ + offset, data, len);
+    if (this->early_writeback_)
+      this->note_written(len);
+  }
 
   // Get a buffer to use to write to the file, given the offset into
   // the file and the size.
@@ -115,8 +120,11 @@ class Output_file
   // VIEW must have been returned by get_output_view.  Write the
   // buffer to the file, passing in the offset and the size.
   void
-  write_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_output_view(off_t, size_t size, unsigned char*)
+  {
+    if (this->early_writeback_)
+      this->note_written(size);
+  }
 
   // Get a read/write buffer.  This is used when we want to write part
   // of the file, read it in, and write it again.
@@ -126,8 +134,11 @@ class Output_file
 
   // Write a read/write buffer back to the file.
   void
-  write_input_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_input_output_view(off_t, size_t size, unsigned char*)
+  {
+    if (this->early_writeback_)
+      this->note_written(size);
+  }
 
   // Get a read buffer.  This is used when we just want to read part
   // of the file back it in.
@@ -158,6 +169,15 @@ class Output_file
   void
   unmap();
 
+  // Record that LEN bytes of the mapped file have been written, and
+  // start writeback once enough of them have accumulated.
+  void
+  note_written(size_t len);
+
+  // With --early-writeback, the number of bytes written to the mapped
+  // file before we ask the kernel to start writing dirty pages.
+  static const size_t writeback_chunk_size = 32 * 1024 * 1024;
+
   // File name.
   const char* name_;
   // File descriptor.
@@ -172,6 +192,10 @@ class Output_file
   bool map_is_allocated_;
   // True if this is a temporary file which should not be output.
   bool is_temporary_;
+  // True if we start writeback of the mapped file as it is written.
+  bool early_writeback_;
+  // Bytes written since writeback was last started.
+  size_t unflushed_bytes_;
 };
 
 // An abtract class for data which has to go into the output file.
@@ -1283,6 +1307,11 @@ class Output_reloc<elfcpp::SHT_REL, dynamic, size, big_endian>
   Address
   get_address() const;
 
+  // Return whether the addend should be the PLT offset.
+  bool
+  use_plt_offset() const
+  { return this->use_plt_offset_; }
+
  private:
   // Record that we need a dynamic symbol index.
   void
@@ -1457,6 +1486,11 @@ class Output_reloc<elfcpp::SHT_RELA, dynamic, size, big_endian>
     : rel_(type, arg, relobj, shndx, address), addend_(addend)
   { }
 
+  // Return the reloc type.
+  unsigned int
+  type() const
+  { return this->rel_.type(); }
+
   // Return whether this is a RELATIVE relocation.
   bool
   is_relative() const
@@ -1474,6 +1508,16 @@ class Output_reloc<elfcpp::SHT_RELA, dynamic, size, big_endian>
   get_relobj() const
   { return this->rel_.get_relobj(); }
 
+  // Return the output address.
+  Address
+  get_address() const
+  { return this->rel_.get_address(); }
+
+  // Return whether the addend should be the PLT offset.
+  bool
+  use_plt_offset() const
+  { return this->rel_.use_plt_offset(); }
+
   // Write the reloc entry to an output view.
   void
   write(unsigned char* pov) const;
@@ -1500,6 +1544,47 @@ class Output_reloc<elfcpp::SHT_RELA, dynamic, size, big_endian>
   Addend addend_;
 };
 
+// Output_data_relr_generic is a non-template base class for
+// Output_data_relr, which holds a SHT_RELR section for
+// -z pack-relative-relocs.  This gives Layout a way to encode the
+// section once the section addresses are known.
+
+class Output_data_relr_generic : public Output_section_data
+{
+ public:
+  Output_data_relr_generic(int size)
+    : Output_section_data(Output_data::default_alignment_for_size(size))
+  { }
+
+  // Encode the relocations using the current section addresses.
+  // Return true if the sections must be laid out again, because the
+  // encoding does not fit in the space we have reserved for it, or
+  // because some relocations had to be moved back to the dynamic
+  // reloc section.
+  bool
+  encode()
+  { return this->do_encode(); }
+
+  // Move the relocations back to the dynamic reloc section, which
+  // will then no longer use this section.
+  void
+  unpack()
+  { this->do_unpack(); }
+
+ protected:
+  // Implemented by the child class.
+  virtual bool
+  do_encode() = 0;
+
+  // Implemented by the child class.
+  virtual void
+  do_unpack() = 0;
+
+  // Set the entry size.
+  void
+  do_adjust_output_section(Output_section* os);
+};
+
 // Output_data_reloc_generic is a non-template base class for
 // Output_data_reloc_base.  This gives the generic code a way to hold
 // a pointer to a reloc section.
@@ -1509,7 +1594,8 @@ class Output_data_reloc_generic : public Output_section_data_build
  public:
   Output_data_reloc_generic(int size, bool sort_relocs)
     : Output_section_data_build(Output_data::default_alignment_for_size(size)),
-      relative_reloc_count_(0), sort_relocs_(sort_relocs)
+      relative_reloc_count_(0), sort_relocs_(sort_relocs), relr_layout_(NULL),
+      relr_type_(0), relr_(NULL)
   { }
 
   // Return the number of relative relocs in this section.
@@ -1522,6 +1608,31 @@ class Output_data_reloc_generic : public Output_section_data_build
   sort_relocs() const
   { return this->sort_relocs_; }
 
+  // Put the RELATIVE relocs of type RELATIVE_TYPE into a SHT_RELR
+  // section, which is created in LAYOUT when the first one is added.
+  // This is used for -z pack-relative-relocs.
+  void
+  set_pack_relative_relocs(Layout* layout, unsigned int relative_type)
+  {
+    this->relr_layout_ = layout;
+    this->relr_type_ = relative_type;
+  }
+
+  // Return the SHT_RELR section, or NULL if there is none.
+  const Output_data_relr_generic*
+  relr_section() const
+  { return this->relr_; }
+
+  // Queue tasks to sort and write out the relocs in parallel, using
+  // up to THREAD_COUNT tasks.  This does nothing unless the relocs
+  // are sorted and there are enough of them to be worth it.  Each
+  // task which writes out relocs unblocks FINAL_BLOCKER, which must
+  // not yet be visible to any other task.
+  void
+  queue_write_tasks(Workqueue* workqueue, Output_file* of, int thread_count,
+		    Task_token* final_blocker)
+  { this->do_queue_write_tasks(workqueue, of, thread_count, final_blocker); }
+
   // Add a reloc of type TYPE against the global symbol GSYM.  The
   // relocation applies to the data at offset ADDRESS within OD.
   virtual void
@@ -1572,11 +1683,57 @@ class Output_data_reloc_generic : public Output_section_data_build
 			     uint64_t addend) = 0;
 
  protected:
+  // Queue tasks to write out the relocs; see queue_write_tasks.
+  virtual void
+  do_queue_write_tasks(Workqueue*, Output_file*, int thread_count,
+		       Task_token* final_blocker) = 0;
+
   // Note that we've added another relative reloc.
   void
   bump_relative_reloc_count()
   { ++this->relative_reloc_count_; }
 
+  // Return whether a reloc of type TYPE should go into the SHT_RELR
+  // section.  IS_RELATIVE and USE_PLT_OFFSET are from the reloc.
+  bool
+  should_pack(unsigned int type, bool is_relative, bool use_plt_offset) const
+  {
+    return (this->relr_layout_ != NULL
+	    && is_relative
+	    && type == this->relr_type_
+	    && !use_plt_offset);
+  }
+
+  // Return whether we have created the SHT_RELR section.
+  bool
+  have_relr_section() const
+  { return this->relr_ != NULL; }
+
+  // Add the SHT_RELR section RELR to the layout.
+  void
+  add_relr_section(Output_data_relr_generic* relr)
+  {
+    gold_assert(this->relr_ == NULL);
+    this->relr_ = relr;
+    this->relr_layout_->add_relr_section(relr);
+  }
+
+  // Return the SHT_RELR section, which must have been created.
+  Output_data_relr_generic*
+  relr()
+  {
+    gold_assert(this->relr_ != NULL);
+    return this->relr_;
+  }
+
+  // Stop using the SHT_RELR section.
+  void
+  clear_relr_section()
+  {
+    this->relr_layout_ = NULL;
+    this->relr_ = NULL;
+  }
+
  private:
   // The number of relative relocs added to this section.  This is to
   // support DT_RELCOUNT.
@@ -1584,8 +1741,18 @@ class Output_data_reloc_generic : public Output_section_data_build
   // Whether to sort the relocations when writing them out, to make
   // the dynamic linker more efficient.
   bool sort_relocs_;
+  // The layout in which to create the SHT_RELR section, or NULL if we
+  // are not packing relative relocs.
+  Layout* relr_layout_;
+  // The type of the RELATIVE relocs which we pack.
+  unsigned int relr_type_;
+  // The SHT_RELR section, once it has been created.
+  Output_data_relr_generic* relr_;
 };
 
+template<int sh_type, bool dynamic, int size, bool big_endian>
+class Output_data_relr;
+
 // Output_data_reloc is used to manage a section containing relocs.
 // SH_TYPE is either elfcpp::SHT_REL or elfcpp::SHT_RELA.  DYNAMIC
 // indicates whether this is a dynamic relocation or a normal
@@ -1604,7 +1771,8 @@ class Output_data_reloc_base : public Output_data_reloc_generic
 
   // Construct the section.
   Output_data_reloc_base(bool sort_relocs)
-    : Output_data_reloc_generic(size, sort_relocs)
+    : Output_data_reloc_generic(size, sort_relocs), relocs_(),
+      parallel_write_(NULL), write_in_parallel_(false)
   { }
 
  protected:
@@ -1612,21 +1780,39 @@ class Output_data_reloc_base : public Output_data_reloc_generic
   void
   do_write(Output_file*);
 
+  // Queue tasks to sort and write out the relocs in parallel.
+  void
+  do_queue_write_tasks(Workqueue*, Output_file*, int thread_count,
+		       Task_token* final_blocker);
+
+  // Write out bucket I of the sorted relocs, when writing them out
+  // in parallel.  This must write the relocs the same way as
+  // do_write.
+  virtual void
+  do_write_bucket(Output_file* of, unsigned int i);
+
   // Generic implementation of do_write, allowing a customized
   // class for writing the output relocation (e.g., for MIPS-64).
   template<class Output_reloc_writer>
   void
   do_write_generic(Output_file* of)
   {
+    // If the relocs are being written out in parallel, the tasks do
+    // everything.
+    if (this->write_in_parallel_)
+      return;
+
     const off_t off = this->offset();
     const off_t oview_size = this->data_size();
     unsigned char* const oview = of->get_output_view(off, oview_size);
 
+    // We use a stable sort, so that relocs which compare equal come
+    // out in the same order as when we sort them in parallel.
     if (this->sort_relocs())
       {
 	gold_assert(dynamic);
-	std::sort(this->relocs_.begin(), this->relocs_.end(),
-		  Sort_relocs_comparison());
+	std::stable_sort(this->relocs_.begin(), this->relocs_.end(),
+			 Sort_relocs_comparison());
       }
 
     unsigned char* pov = oview;
@@ -1646,6 +1832,27 @@ class Output_data_reloc_base : public Output_data_reloc_generic
     this->relocs_.clear();
   }
 
+  // Generic implementation of do_write_bucket, with a customized
+  // class for writing the output relocation as for do_write_generic.
+  template<class Output_reloc_writer>
+  void
+  write_bucket_generic(Output_file* of, unsigned int i)
+  {
+    const Parallel_sort<Output_reloc_type, Sort_relocs_comparison>&
+      sort(this->parallel_write_->sort());
+    const off_t off = this->offset() + sort.bucket_start(i) * reloc_size;
+    const off_t oview_size = sort.bucket_size(i) * reloc_size;
+    if (oview_size == 0)
+      return;
+    unsigned char* const oview = of->get_output_view(off, oview_size);
+
+    Write_relocs<Output_reloc_writer> write(oview);
+    sort.merge_bucket(i, write);
+    gold_assert(write.pov - oview == oview_size);
+
+    of->write_output_view(off, oview_size, oview);
+  }
+
   // Set the entry size and the link.
   void
   do_adjust_output_section(Output_section* os);
@@ -1664,6 +1871,18 @@ class Output_data_reloc_base : public Output_data_reloc_generic
   void
   add(Output_data* od, const Output_reloc_type& reloc)
   {
+    if (this->should_pack(reloc.type(), reloc.is_relative(),
+			  reloc.use_plt_offset()))
+      {
+	typedef Output_data_relr<sh_type, dynamic, size, big_endian> Relr;
+	if (!this->have_relr_section())
+	  this->add_relr_section(new Relr(this));
+	static_cast<Relr*>(this->relr())->add(reloc);
+	if (dynamic)
+	  od->add_dynamic_reloc();
+	return;
+      }
+
     this->relocs_.push_back(reloc);
     this->set_current_data_size(this->relocs_.size() * reloc_size);
     if (dynamic)
@@ -1686,8 +1905,242 @@ class Output_data_reloc_base : public Output_data_reloc_generic
     { return r1.sort_before(r2); }
   };
 
+  // This is used to sort and write out the relocs in parallel.  It
+  // is deleted after the last bucket is written, and then frees the
+  // relocs as do_write_generic does.
+  class Parallel_write : public Parallel_sort_table
+  {
+   public:
+    Parallel_write(Output_data_reloc_base* relocs, unsigned int count)
+      : relocs_(relocs),
+	sort_(&relocs->relocs_, Sort_relocs_comparison(), count)
+    { }
+
+    ~Parallel_write()
+    {
+      this->relocs_->parallel_write_ = NULL;
+      Relocs().swap(this->relocs_->relocs_);
+    }
+
+    const Parallel_sort<Output_reloc_type, Sort_relocs_comparison>&
+    sort() const
+    { return this->sort_; }
+
+    void
+    sort_chunk(unsigned int i)
+    { this->sort_.sort_chunk(i); }
+
+    void
+    split_into_buckets()
+    { this->sort_.split_into_buckets(); }
+
+    void
+    write_bucket(Output_file* of, unsigned int i)
+    { this->relocs_->do_write_bucket(of, i); }
+
+   private:
+    Output_data_reloc_base* relocs_;
+    Parallel_sort<Output_reloc_type, Sort_relocs_comparison> sort_;
+  };
+
+  // This is passed to Parallel_sort::merge_bucket to write out the
+  // merged relocs.
+  template<class Output_reloc_writer>
+  struct Write_relocs
+  {
+    Write_relocs(unsigned char* a_pov)
+      : pov(a_pov)
+    { }
+
+    void
+    operator()(typename Relocs::const_iterator p)
+    {
+      Output_reloc_writer::write(p, this->pov);
+      this->pov += reloc_size;
+    }
+
+    unsigned char* pov;
+  };
+
+  friend class Output_data_relr<sh_type, dynamic, size, big_endian>;
+
+  // Add a relocation entry which the SHT_RELR section could not
+  // represent after all.  This is called after the section has been
+  // laid out, before it is laid out again.
+  void
+  add_unpacked(const Output_reloc_type& reloc)
+  {
+    this->reset_data_size();
+    this->relocs_.push_back(reloc);
+    this->set_current_data_size(this->relocs_.size() * reloc_size);
+    this->bump_relative_reloc_count();
+  }
+
   // The relocations in this section.
   Relocs relocs_;
+  // Used while the relocs are sorted and written out in parallel.
+  Parallel_write* parallel_write_;
+  // Whether the relocs are written out in parallel, in which case
+  // do_write does nothing.
+  bool write_in_parallel_;
+};
+
+// Output_data_relr holds the RELATIVE relocs of an
+// Output_data_reloc_base in the compact SHT_RELR format.  Each entry
+// is a word.  An even entry is the address of a word to relocate.  An
+// odd entry is a bitmap covering the next 8 * wordsize - 1 words:
+// bit N set means that word N - 1 is to be relocated.  The first
+// bitmap after an address starts at the following word, and each
+// further bitmap starts where the previous one ends.  The addend is
+// the value stored at the address, so this only works for relocs
+// which are applied statically.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+class Output_data_relr : public Output_data_relr_generic
+{
+ public:
+  typedef Output_data_reloc_base<sh_type, dynamic, size, big_endian>
+    Reloc_section;
+  typedef typename Reloc_section::Output_reloc_type Output_reloc_type;
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+
+  Output_data_relr(Reloc_section* rel)
+    : Output_data_relr_generic(size), rel_(rel), relocs_(), entries_(),
+      reserved_(0)
+  { }
+
+  // Add a reloc.
+  void
+  add(const Output_reloc_type& reloc)
+  { this->relocs_.push_back(reloc); }
+
+ protected:
+  // The size is the number of entries we have made room for.  We
+  // never shrink the section, so that laying out the sections again
+  // always converges.
+  void
+  set_final_data_size()
+  { this->set_data_size(this->reserved_ * (size / 8)); }
+
+  bool
+  do_encode()
+  {
+    const Address wordsize = size / 8;
+    const Address bitmap_words = size - 1;
+
+    // The encoding needs word aligned addresses.  A reloc in an input
+    // section which is not word aligned has to go back to the dynamic
+    // reloc section.
+    bool relayout = false;
+    std::vector<Address> addresses;
+    addresses.reserve(this->relocs_.size());
+    typename Relocs::iterator out = this->relocs_.begin();
+    for (typename Relocs::const_iterator p = this->relocs_.begin();
+	 p != this->relocs_.end();
+	 ++p)
+      {
+	Address address = p->get_address();
+	if (address % wordsize != 0)
+	  {
+	    this->rel_->add_unpacked(*p);
+	    relayout = true;
+	  }
+	else
+	  {
+	    addresses.push_back(address);
+	    *out = *p;
+	    ++out;
+	  }
+      }
+    this->relocs_.erase(out, this->relocs_.end());
+
+    std::sort(addresses.begin(), addresses.end());
+
+    this->entries_.clear();
+    typename std::vector<Address>::const_iterator p = addresses.begin();
+    while (p != addresses.end())
+      {
+	this->entries_.push_back(*p);
+	Address base = *p + wordsize;
+	++p;
+	while (p != addresses.end())
+	  {
+	    Address bitmap = 0;
+	    while (p != addresses.end()
+		   && *p >= base
+		   && *p - base < bitmap_words * wordsize)
+	      {
+		bitmap |= static_cast<Address>(1) << ((*p - base) / wordsize);
+		++p;
+	      }
+	    if (bitmap == 0)
+	      break;
+	    this->entries_.push_back((bitmap << 1) | 1);
+	    base += bitmap_words * wordsize;
+	  }
+      }
+
+    if (this->entries_.size() > this->reserved_)
+      {
+	this->reserved_ = this->entries_.size();
+	relayout = true;
+      }
+    return relayout;
+  }
+
+  void
+  do_unpack()
+  {
+    for (typename Relocs::const_iterator p = this->relocs_.begin();
+	 p != this->relocs_.end();
+	 ++p)
+      this->rel_->add_unpacked(*p);
+    this->relocs_.clear();
+    this->entries_.clear();
+    this->reserved_ = 0;
+    this->rel_->clear_relr_section();
+  }
+
+  // Write out the entries.  If the encoding is shorter than the space
+  // we reserved, we pad it with empty bitmaps.
+  void
+  do_write(Output_file* of)
+  {
+    const off_t off = this->offset();
+    const off_t oview_size = this->data_size();
+    unsigned char* const oview = of->get_output_view(off, oview_size);
+
+    unsigned char* pov = oview;
+    for (size_t i = 0; i < this->reserved_; ++i)
+      {
+	Address entry = (i < this->entries_.size() ? this->entries_[i] : 1);
+	elfcpp::Swap<size, big_endian>::writeval(pov, entry);
+	pov += size / 8;
+      }
+    gold_assert(pov - oview == oview_size);
+
+    of->write_output_view(off, oview_size, oview);
+
+    this->relocs_.clear();
+    this->entries_.clear();
+  }
+
+  // Write to a map file.
+  void
+  do_print_to_mapfile(Mapfile* mapfile) const
+  { mapfile->print_output_data(this, _("** packed relative relocs")); }
+
+ private:
+  typedef std::vector<Output_reloc_type> Relocs;
+
+  // The dynamic reloc section for the relocs we can not pack.
+  Reloc_section* rel_;
+  // The relocs.
+  Relocs relocs_;
+  // The encoded entries.
+  std::vector<Address> entries_;
+  // The number of entries we have made room for.
+  size_t reserved_;
 };
 
 // The class which callers actually create.
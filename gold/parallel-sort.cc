@@ -0,0 +1,157 @@
+// parallel-sort.cc -- sort a table using several tasks
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include "workqueue.h"
+#include "parallel-sort.h"
+
+namespace gold
+{
+
+// This task sorts one chunk of a table.
+
+class Sort_chunk_task : public Task
+{
+ public:
+  Sort_chunk_task(Parallel_sort_table* table, unsigned int chunk,
+		  const char* name, Task_token* sorted_blocker)
+    : table_(table), chunk_(chunk), name_(name),
+      sorted_blocker_(sorted_blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock SORTED_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->sorted_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->table_->sort_chunk(this->chunk_); }
+
+  std::string
+  get_name() const
+  { return "Sort_chunk_task " + std::string(this->name_); }
+
+ private:
+  Parallel_sort_table* table_;
+  unsigned int chunk_;
+  const char* name_;
+  Task_token* sorted_blocker_;
+};
+
+// This task merges and writes out one bucket of a table.
+
+class Write_bucket_task : public Task
+{
+ public:
+  Write_bucket_task(Parallel_sort_table* table, Output_file* of,
+		    unsigned int bucket, const char* name,
+		    Task_token* final_blocker)
+    : table_(table), of_(of), bucket_(bucket), name_(name),
+      final_blocker_(final_blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  void
+  run(Workqueue*)
+  {
+    this->table_->write_bucket(this->of_, this->bucket_);
+    if (this->table_->bucket_written())
+      delete this->table_;
+  }
+
+  std::string
+  get_name() const
+  { return "Write_bucket_task " + std::string(this->name_); }
+
+ private:
+  Parallel_sort_table* table_;
+  Output_file* of_;
+  unsigned int bucket_;
+  const char* name_;
+  Task_token* final_blocker_;
+};
+
+// This runs once all the chunks are sorted.  It splits the table into
+// buckets, and queues a task to write out each one.
+
+class Split_buckets_task_runner : public Task_function_runner
+{
+ public:
+  Split_buckets_task_runner(Parallel_sort_table* table, Output_file* of,
+			    unsigned int count, const char* name,
+			    Task_token* final_blocker)
+    : table_(table), of_(of), count_(count), name_(name),
+      final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue* workqueue, const Task*)
+  {
+    this->table_->split_into_buckets();
+    for (unsigned int i = 0; i < this->count_; ++i)
+      workqueue->queue(new Write_bucket_task(this->table_, this->of_, i,
+					     this->name_,
+					     this->final_blocker_));
+  }
+
+ private:
+  Parallel_sort_table* table_;
+  Output_file* of_;
+  unsigned int count_;
+  const char* name_;
+  Task_token* final_blocker_;
+};
+
+// Queue the tasks to sort and write out TABLE.
+
+void
+queue_parallel_sort_tasks(Workqueue* workqueue, Output_file* of,
+			  Parallel_sort_table* table, unsigned int count,
+			  const char* name, Task_token* final_blocker)
+{
+  table->set_unwritten_buckets(count);
+  Task_token* sorted_blocker = new Task_token(true);
+  sorted_blocker->add_blockers(count);
+  for (unsigned int i = 0; i < count; ++i)
+    workqueue->queue(new Sort_chunk_task(table, i, name, sorted_blocker));
+  workqueue->queue(new Task_function(new Split_buckets_task_runner(table, of,
+								   count,
+								   name,
+								   final_blocker),
+				     sorted_blocker,
+				     "Task_function Split_buckets_task_runner"));
+}
+
+} // End namespace gold.
@@ -0,0 +1,354 @@
+// parallel-sort.h -- sort a table using several tasks  -*- C++ -*-
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_PARALLEL_SORT_H
+#define GOLD_PARALLEL_SORT_H
+
+#include <algorithm>
+#include <vector>
+
+namespace gold
+{
+
+class Output_file;
+class Task_token;
+class Workqueue;
+
+// Parallel_sort sorts a vector in pieces which may be handled by
+// different tasks.  The vector is split into chunks, and each chunk
+// is sorted with std::stable_sort.  The sorted chunks are then split
+// into the same number of buckets, using splitters sampled from the
+// chunks, and the parts of the chunks which fall into each bucket are
+// merged.  The merge of a bucket is passed to a function rather than
+// stored, so that it can be written directly to the output file.
+
+// The result is always the same as std::stable_sort of the whole
+// vector, whatever the number of chunks.  This is what lets us
+// produce the same output file with and without threads.
+
+template<typename Type, typename Compare>
+class Parallel_sort
+{
+ public:
+  // Sort ELEMENTS in COUNT chunks.
+  Parallel_sort(std::vector<Type>* elements, Compare compare,
+		unsigned int count)
+    : elements_(elements), compare_(compare), count_(count), chunks_(),
+      bounds_()
+  {
+    gold_assert(count > 0);
+    size_t total = elements->size();
+    this->chunks_.reserve(count + 1);
+    for (unsigned int i = 0; i <= count; ++i)
+      this->chunks_.push_back(total / count * i
+			      + std::min<size_t>(total % count, i));
+  }
+
+  // The number of chunks, which is also the number of buckets.
+  unsigned int
+  count() const
+  { return this->count_; }
+
+  // Return the index of the first element of chunk I.  Chunk COUNT
+  // starts at the end of the vector.
+  size_t
+  chunk_start(unsigned int i) const
+  { return this->chunks_[i]; }
+
+  // Sort chunk I.
+  void
+  sort_chunk(unsigned int i)
+  {
+    std::stable_sort(this->elements_->begin() + this->chunks_[i],
+		     this->elements_->begin() + this->chunks_[i + 1],
+		     this->compare_);
+  }
+
+  // Split the sorted chunks into buckets.  This may only be called
+  // after all the chunks have been sorted.
+  void
+  split_into_buckets();
+
+  // Return the index in the sorted vector of the first element of
+  // bucket I.
+  size_t
+  bucket_start(unsigned int i) const
+  {
+    size_t start = 0;
+    for (unsigned int j = 0; j < this->count_; ++j)
+      start += this->bound(i, j) - this->chunks_[j];
+    return start;
+  }
+
+  // Return the number of elements in bucket I.
+  size_t
+  bucket_size(unsigned int i) const
+  {
+    size_t size = 0;
+    for (unsigned int j = 0; j < this->count_; ++j)
+      size += this->bound(i + 1, j) - this->bound(i, j);
+    return size;
+  }
+
+  // Merge bucket I, passing each element in sorted order to WRITE,
+  // which is called with a std::vector<Type>::const_iterator.
+  template<typename Write>
+  void
+  merge_bucket(unsigned int i, Write& write) const;
+
+ private:
+  // The first element of bucket I in chunk J.  Bucket COUNT_ is the
+  // end of the chunks.
+  size_t
+  bound(unsigned int i, unsigned int j) const
+  { return this->bounds_[i * this->count_ + j]; }
+
+  // An entry in the heap used to merge a bucket: the next element of
+  // one chunk, and the end of the part of the chunk in the bucket.
+  struct Merge_entry
+  {
+    size_t next;
+    size_t end;
+    unsigned int chunk;
+  };
+
+  // Compare Merge_entry objects to put the smallest element at the
+  // top of a heap.  Equal elements are taken from the first chunk,
+  // which keeps the merge stable.
+  class Merge_compare
+  {
+   public:
+    Merge_compare(const std::vector<Type>* elements, const Compare* compare)
+      : elements_(elements), compare_(compare)
+    { }
+
+    bool
+    operator()(const Merge_entry& e1, const Merge_entry& e2) const
+    {
+      const Type& t1((*this->elements_)[e1.next]);
+      const Type& t2((*this->elements_)[e2.next]);
+      if ((*this->compare_)(t2, t1))
+	return true;
+      if ((*this->compare_)(t1, t2))
+	return false;
+      return e1.chunk > e2.chunk;
+    }
+
+   private:
+    const std::vector<Type>* elements_;
+    const Compare* compare_;
+  };
+
+  // Compare elements given by index.
+  class Index_compare
+  {
+   public:
+    Index_compare(const std::vector<Type>* elements, const Compare* compare)
+      : elements_(elements), compare_(compare)
+    { }
+
+    bool
+    operator()(size_t i1, size_t i2) const
+    { return (*this->compare_)((*this->elements_)[i1],
+			       (*this->elements_)[i2]); }
+
+   private:
+    const std::vector<Type>* elements_;
+    const Compare* compare_;
+  };
+
+  // The elements to sort.
+  std::vector<Type>* elements_;
+  // The comparison function.
+  Compare compare_;
+  // The number of chunks and buckets.
+  unsigned int count_;
+  // The index of the start of each chunk, followed by the size of
+  // the vector.
+  std::vector<size_t> chunks_;
+  // The index of the start of each bucket in each chunk, as used by
+  // bound.
+  std::vector<size_t> bounds_;
+};
+
+// Split the sorted chunks into buckets.  We take some samples from
+// each chunk, and pick evenly spaced splitters from the sorted
+// samples.  The splitters only affect how the work is balanced
+// between the buckets, not the result: all the elements which compare
+// equal to each other wind up in the same bucket.
+
+template<typename Type, typename Compare>
+void
+Parallel_sort<Type, Compare>::split_into_buckets()
+{
+  const unsigned int count = this->count_;
+  const std::vector<Type>& elements(*this->elements_);
+
+  // Sample each chunk COUNT times.
+  std::vector<size_t> samples;
+  samples.reserve(count * count);
+  for (unsigned int j = 0; j < count; ++j)
+    {
+      size_t start = this->chunks_[j];
+      size_t len = this->chunks_[j + 1] - start;
+      if (len == 0)
+	continue;
+      for (unsigned int k = 0; k < count; ++k)
+	samples.push_back(start + len * k / count);
+    }
+  std::sort(samples.begin(), samples.end(),
+	    Index_compare(this->elements_, &this->compare_));
+
+  this->bounds_.resize((count + 1) * count);
+  for (unsigned int i = 0; i <= count; ++i)
+    {
+      for (unsigned int j = 0; j < count; ++j)
+	{
+	  size_t b;
+	  if (i == 0)
+	    b = this->chunks_[j];
+	  else if (i == count || samples.empty())
+	    b = this->chunks_[j + 1];
+	  else
+	    {
+	      const Type& splitter(elements[samples[samples.size() * i
+						    / count]]);
+	      b = (std::lower_bound(elements.begin() + this->chunks_[j],
+				    elements.begin() + this->chunks_[j + 1],
+				    splitter, this->compare_)
+		   - elements.begin());
+	    }
+	  this->bounds_[i * count + j] = b;
+	}
+    }
+}
+
+// Merge bucket I.
+
+template<typename Type, typename Compare>
+template<typename Write>
+void
+Parallel_sort<Type, Compare>::merge_bucket(unsigned int i,
+					   Write& write) const
+{
+  const std::vector<Type>& elements(*this->elements_);
+  Merge_compare merge_compare(this->elements_, &this->compare_);
+
+  std::vector<Merge_entry> heap;
+  heap.reserve(this->count_);
+  for (unsigned int j = 0; j < this->count_; ++j)
+    {
+      Merge_entry e;
+      e.next = this->bound(i, j);
+      e.end = this->bound(i + 1, j);
+      e.chunk = j;
+      if (e.next < e.end)
+	heap.push_back(e);
+    }
+  std::make_heap(heap.begin(), heap.end(), merge_compare);
+
+  while (!heap.empty())
+    {
+      std::pop_heap(heap.begin(), heap.end(), merge_compare);
+      Merge_entry& e(heap.back());
+      write(elements.begin() + e.next);
+      ++e.next;
+      if (e.next < e.end)
+	std::push_heap(heap.begin(), heap.end(), merge_compare);
+      else
+	heap.pop_back();
+    }
+}
+
+// Return the number of chunks to use to sort COUNT elements with up
+// to THREAD_COUNT threads.  This returns 1 if the table is too small
+// to be worth splitting.
+
+inline unsigned int
+parallel_sort_chunk_count(size_t count, int thread_count)
+{
+  // Each chunk should hold enough elements to amortize the cost of a
+  // task and of the merge.
+  const size_t min_chunk_size = 16384;
+  size_t chunks = count / min_chunk_size;
+  if (thread_count < 1)
+    thread_count = 1;
+  if (chunks > static_cast<size_t>(thread_count))
+    chunks = thread_count;
+  return chunks < 1 ? 1 : chunks;
+}
+
+// The interface used by the tasks which sort and write out a table
+// with Parallel_sort.
+
+class Parallel_sort_table
+{
+ public:
+  Parallel_sort_table()
+    : unwritten_buckets_(0)
+  { }
+
+  virtual
+  ~Parallel_sort_table()
+  { }
+
+  // Sort chunk I.
+  virtual void
+  sort_chunk(unsigned int i) = 0;
+
+  // Split the sorted chunks into buckets.
+  virtual void
+  split_into_buckets() = 0;
+
+  // Merge bucket I and write it to OF.
+  virtual void
+  write_bucket(Output_file* of, unsigned int i) = 0;
+
+  // Set the number of buckets which remain to be written.
+  void
+  set_unwritten_buckets(unsigned int count)
+  { this->unwritten_buckets_ = count; }
+
+  // Record that a bucket has been written.  Return true if it was the
+  // last one, in which case the caller should delete the table.
+  bool
+  bucket_written()
+  { return __sync_sub_and_fetch(&this->unwritten_buckets_, 1) == 0; }
+
+ private:
+  // The number of buckets which have not yet been written.
+  unsigned int unwritten_buckets_;
+};
+
+// Queue tasks to sort TABLE in COUNT chunks and write it out to OF.
+// The COUNT tasks which write out the buckets each unblock
+// FINAL_BLOCKER once; the caller must have added those blockers.
+// TABLE should be allocated using new, and is deleted by the last of
+// those tasks.  NAME is used for the names of the tasks.
+
+extern void
+queue_parallel_sort_tasks(Workqueue*, Output_file* of,
+			  Parallel_sort_table* table, unsigned int count,
+			  const char* name, Task_token* final_blocker);
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_PARALLEL_SORT_H)
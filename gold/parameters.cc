@@ -64,7 +64,8 @@ Set_parameters_target_once set_parameters_target_once(&static_parameters);
 // Class Parameters.
 
 Parameters::Parameters()
-   : errors_(NULL), timer_(NULL), options_(NULL), target_(NULL),
+   : errors_(NULL), timer_(NULL), link_cache_(NULL), task_trace_(NULL),
+     stats_json_(NULL), options_(NULL), target_(NULL),
      doing_static_link_valid_(false), doing_static_link_(false),
      debug_(0), incremental_mode_(General_options::INCREMENTAL_OFF),
      set_parameters_target_once_(&set_parameters_target_once)
@@ -85,6 +86,27 @@ Parameters::set_timer(Timer* timer)
   this->timer_ = timer;
 }
 
+void
+Parameters::set_link_cache(Link_cache* link_cache)
+{
+  gold_assert(this->link_cache_ == NULL);
+  this->link_cache_ = link_cache;
+}
+
+void
+Parameters::set_task_trace(Task_trace* task_trace)
+{
+  gold_assert(this->task_trace_ == NULL);
+  this->task_trace_ = task_trace;
+}
+
+void
+Parameters::set_stats_json(Stats_json* stats_json)
+{
+  gold_assert(this->stats_json_ == NULL);
+  this->stats_json_ = stats_json;
+}
+
 void
 Parameters::set_options(const General_options* options)
 {
@@ -290,6 +312,18 @@ void
 set_parameters_timer(Timer* timer)
 { static_parameters.set_timer(timer); }
 
+void
+set_parameters_link_cache(Link_cache* link_cache)
+{ static_parameters.set_link_cache(link_cache); }
+
+void
+set_parameters_task_trace(Task_trace* task_trace)
+{ static_parameters.set_task_trace(task_trace); }
+
+void
+set_parameters_stats_json(Stats_json* stats_json)
+{ static_parameters.set_stats_json(stats_json); }
+
 void
 set_parameters_options(const General_options* options)
 { static_parameters.set_options(options); }
@@ -29,6 +29,9 @@ namespace gold
 class General_options;
 class Errors;
 class Timer;
+class Link_cache;
+class Task_trace;
+class Stats_json;
 class Target;
 template<int size, bool big_endian>
 class Sized_target;
@@ -60,6 +63,15 @@ class Parameters
   void
   set_timer(Timer* timer);
 
+  void
+  set_link_cache(Link_cache* link_cache);
+
+  void
+  set_task_trace(Task_trace* task_trace);
+
+  void
+  set_stats_json(Stats_json* stats_json);
+
   void
   set_options(const General_options* options);
 
@@ -79,6 +91,21 @@ class Parameters
   timer() const
   { return this->timer_; }
 
+  // Return the link cache, or NULL if --link-cache was not used.
+  Link_cache*
+  link_cache() const
+  { return this->link_cache_; }
+
+  // Return the task trace, or NULL if --trace-tasks was not used.
+  Task_trace*
+  task_trace() const
+  { return this->task_trace_; }
+
+  // Return the JSON statistics, or NULL if --stats-json was not used.
+  Stats_json*
+  stats_json() const
+  { return this->stats_json_; }
+
   // Whether the options are valid.  This should not normally be
   // called, but it is needed by gold_exit.
   bool
@@ -190,6 +217,9 @@ class Parameters
 
   Errors* errors_;
   Timer* timer_;
+  Link_cache* link_cache_;
+  Task_trace* task_trace_;
+  Stats_json* stats_json_;
   const General_options* options_;
   Target* target_;
   bool doing_static_link_valid_;
@@ -211,6 +241,15 @@ set_parameters_errors(Errors* errors);
 extern void
 set_parameters_timer(Timer* timer);
 
+extern void
+set_parameters_link_cache(Link_cache* link_cache);
+
+extern void
+set_parameters_task_trace(Task_trace* task_trace);
+
+extern void
+set_parameters_stats_json(Stats_json* stats_json);
+
 extern void
 set_parameters_options(const General_options* options);
 
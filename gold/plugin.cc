@@ -178,6 +178,11 @@ register_new_input(ld_plugin_new_input_handler handler);
 static enum ld_plugin_status
 get_wrap_symbols(uint64_t *num_symbols, const char ***wrap_symbol_list);
 
+static int
+get_api_version(const char* plugin_identifier, const char* plugin_version,
+		int minimal_api_supported, int maximal_api_supported,
+		const char** linker_identifier, const char** linker_version);
+
 };
 
 #endif // ENABLE_PLUGINS
@@ -223,7 +228,7 @@ Plugin::load()
   sscanf(ver, "%d.%d", &major, &minor);
 
   // Allocate and populate a transfer vector.
-  const int tv_fixed_size = 31;
+  const int tv_fixed_size = 32;
 
   int tv_size = this->args_.size() + tv_fixed_size;
   ld_plugin_tv* tv = new ld_plugin_tv[tv_size];
@@ -365,6 +370,10 @@ Plugin::load()
   tv[i].tv_tag = LDPT_GET_WRAP_SYMBOLS;
   tv[i].tv_u.tv_get_wrap_symbols = get_wrap_symbols;
 
+  ++i;
+  tv[i].tv_tag = LDPT_GET_API_VERSION;
+  tv[i].tv_u.tv_get_api_version = get_api_version;
+
   ++i;
   tv[i].tv_tag = LDPT_NULL;
   tv[i].tv_u.tv_val = 0;
@@ -711,6 +720,7 @@ Plugin_manager::~Plugin_manager()
     delete *obj;
   this->objects_.clear();
   delete this->lock_;
+  delete this->claim_lock_;
   delete this->recorder_;
 }
 
@@ -731,42 +741,66 @@ Plugin_manager::load_plugins(Layout* layout)
        this->current_ != this->plugins_.end();
        ++this->current_)
     (*this->current_)->load();
+
+  // We can only offer several files at once if every plugin allows it.
+  this->concurrent_claim_file_ = true;
+  for (Plugin_list::const_iterator p = this->plugins_.begin();
+       p != this->plugins_.end();
+       ++p)
+    if (!(*p)->concurrent_claim_file())
+      this->concurrent_claim_file_ = false;
 }
 
 // Call the plugin claim-file handlers in turn to see if any claim the file.
+// If every plugin allows it, this may be called by several Read_symbols
+// tasks at once.
 
 Pluginobj*
 Plugin_manager::claim_file(Input_file* input_file, off_t offset,
                            off_t filesize, Object* elf_object)
 {
   bool lock_initialized = this->initialize_lock_.initialize();
-
   gold_assert(lock_initialized);
-  Hold_lock hl(*this->lock_);
+  lock_initialized = this->initialize_claim_lock_.initialize();
+  gold_assert(lock_initialized);
 
-  unsigned int handle = this->objects_.size();
-  this->input_file_ = input_file;
-  this->plugin_input_file_.name = input_file->filename().c_str();
-  this->plugin_input_file_.fd = input_file->file().descriptor();
-  this->plugin_input_file_.offset = offset;
-  this->plugin_input_file_.filesize = filesize;
-  this->plugin_input_file_.handle = reinterpret_cast<void*>(handle);
-  if (elf_object != NULL)
+  // Unless the plugins allow it, offer one file at a time.  The
+  // new_input handlers are always called one at a time.
+  Lock* claim_lock = NULL;
+  if (!this->concurrent_claim_file_ || this->in_replacement_phase_)
+    claim_lock = this->claim_lock_;
+  Hold_optional_lock hcl(claim_lock);
+
+  Pending_claim claim;
+  claim.input_file = input_file;
+
+  unsigned int handle;
+  {
+    Hold_lock hl(*this->lock_);
+    handle = this->objects_.size();
     this->objects_.push_back(elf_object);
-  this->in_claim_file_handler_ = true;
+    this->pending_claims_[handle] = &claim;
+  }
 
-  for (this->current_ = this->plugins_.begin();
-       this->current_ != this->plugins_.end();
-       ++this->current_)
+  claim.plugin_input_file.name = input_file->filename().c_str();
+  claim.plugin_input_file.fd = input_file->file().descriptor();
+  claim.plugin_input_file.offset = offset;
+  claim.plugin_input_file.filesize = filesize;
+  claim.plugin_input_file.handle = reinterpret_cast<void*>(handle);
+
+  for (Plugin_list::iterator p = this->plugins_.begin();
+       p != this->plugins_.end();
+       ++p)
     {
       // If we aren't yet in replacement phase, allow plugins to claim input
       // files, otherwise notify the plugin of the new input file, if needed.
       if (!this->in_replacement_phase_)
         {
-          if ((*this->current_)->claim_file(&this->plugin_input_file_))
+          if ((*p)->claim_file(&claim.plugin_input_file))
             {
+	      Hold_lock hl(*this->lock_);
+
               this->any_claimed_ = true;
-              this->in_claim_file_handler_ = false;
 
 	      if (this->recorder_ != NULL)
 		{
@@ -775,26 +809,30 @@ Plugin_manager::claim_file(Input_file* input_file, off_t offset,
 						: elf_object->name());
 		  this->recorder_->claimed_file(objname,
 						offset, filesize,
-						(*this->current_)->filename());
+						(*p)->filename());
 		}
 
-              if (this->objects_.size() > handle
-                  && this->objects_[handle]->pluginobj() != NULL)
-                return this->objects_[handle]->pluginobj();
-
               // If the plugin claimed the file but did not call the
               // add_symbols callback, we need to create the Pluginobj now.
-              Pluginobj* obj = this->make_plugin_object(handle);
+	      Pluginobj* obj = NULL;
+	      if (this->objects_[handle] != NULL)
+		obj = this->objects_[handle]->pluginobj();
+	      if (obj == NULL)
+		obj = this->do_make_plugin_object(handle);
+
+	      this->pending_claims_.erase(handle);
               return obj;
             }
         }
       else
         {
-          (*this->current_)->new_input(&this->plugin_input_file_);
+          (*p)->new_input(&claim.plugin_input_file);
         }
     }
 
-  this->in_claim_file_handler_ = false;
+  Hold_lock hl(*this->lock_);
+
+  this->pending_claims_.erase(handle);
 
   if (this->recorder_ != NULL)
     this->recorder_->unclaimed_file(input_file->filename(), offset, filesize);
@@ -802,6 +840,20 @@ Plugin_manager::claim_file(Input_file* input_file, off_t offset,
   return NULL;
 }
 
+// Return the pending claim for HANDLE.
+
+Plugin_manager::Pending_claim*
+Plugin_manager::pending_claim(unsigned int handle)
+{
+  if (this->lock_ == NULL)
+    return NULL;
+  Hold_lock hl(*this->lock_);
+  Pending_claim_map::const_iterator p = this->pending_claims_.find(handle);
+  if (p == this->pending_claims_.end())
+    return NULL;
+  return p->second;
+}
+
 // Save an archive.  This is used so that a plugin can add a file
 // which refers to a symbol which was not previously referenced.  In
 // that case we want to pretend that the symbol was referenced before,
@@ -1040,30 +1092,39 @@ Plugin_manager::cleanup()
 Pluginobj*
 Plugin_manager::make_plugin_object(unsigned int handle)
 {
-  // Make sure we aren't asked to make an object for the same handle twice.
-  if (this->objects_.size() != handle
-      && this->objects_[handle]->pluginobj() != NULL)
-    return NULL;
+  Hold_lock hl(*this->lock_);
+  return this->do_make_plugin_object(handle);
+}
 
-  const std::string* filename = &this->input_file_->filename();
+// Make a new Pluginobj object for a file which is being claimed.  The
+// lock must be held.
 
-  // If the elf object for this file was pushed into the objects_ vector,
-  // use its filename, then delete it to make room for the Pluginobj as
-  // this file is claimed.
-  if (this->objects_.size() != handle)
-    {
-      filename = &this->objects_.back()->name();
-      this->objects_.pop_back();
-    }
+Pluginobj*
+Plugin_manager::do_make_plugin_object(unsigned int handle)
+{
+  Pending_claim_map::const_iterator p = this->pending_claims_.find(handle);
+  if (p == this->pending_claims_.end())
+    return NULL;
+  const Pending_claim* claim = p->second;
 
-  Pluginobj* obj = make_sized_plugin_object(*filename,
-					    this->input_file_,
-                                            this->plugin_input_file_.offset,
-                                            this->plugin_input_file_.filesize);
+  // Make sure we aren't asked to make an object for the same handle twice.
+  Object* elf_object = this->objects_[handle];
+  if (elf_object != NULL && elf_object->pluginobj() != NULL)
+    return NULL;
 
+  // If there is an elf object for this file, use its filename.  The
+  // Pluginobj replaces it in the objects_ vector as this file is
+  // claimed.
+  const std::string& filename = (elf_object != NULL
+				 ? elf_object->name()
+				 : claim->input_file->filename());
 
+  Pluginobj* obj = make_sized_plugin_object(filename,
+					    claim->input_file,
+					    claim->plugin_input_file.offset,
+					    claim->plugin_input_file.filesize);
 
-  this->objects_.push_back(obj);
+  this->objects_[handle] = obj;
   return obj;
 }
 
@@ -1127,13 +1188,14 @@ Plugin_manager::get_view(unsigned int handle, const void **viewp)
   off_t offset;
   size_t filesize;
   Input_file *input_file;
-  if (this->in_claim_file_handler_)
+  const Pending_claim* claim = this->pending_claim(handle);
+  if (claim != NULL)
     {
       // We are being called from the claim_file hook.
-      const struct ld_plugin_input_file &f = this->plugin_input_file_;
+      const struct ld_plugin_input_file &f = claim->plugin_input_file;
       offset = f.offset;
       filesize = f.filesize;
-      input_file = this->input_file_;
+      input_file = claim->input_file;
     }
   else
     {
@@ -1980,7 +2042,7 @@ get_input_section_count(const void* handle, unsigned int* count)
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(handle))
     return LDPS_ERR;
 
   Object* obj = parameters->options().plugins()->get_elf_object(handle);
@@ -2002,7 +2064,7 @@ get_input_section_type(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(section.handle))
     return LDPS_ERR;
 
   Object* obj
@@ -2025,7 +2087,7 @@ get_input_section_name(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(section.handle))
     return LDPS_ERR;
 
   Object* obj
@@ -2054,7 +2116,7 @@ get_input_section_contents(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(section.handle))
     return LDPS_ERR;
 
   Object* obj
@@ -2083,7 +2145,7 @@ get_input_section_alignment(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(section.handle))
     return LDPS_ERR;
 
   Object* obj
@@ -2106,7 +2168,7 @@ get_input_section_size(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(section.handle))
     return LDPS_ERR;
 
   Object* obj
@@ -2188,6 +2250,24 @@ allow_section_ordering()
   return LDPS_OK;
 }
 
+// Negotiate the API version with the plugin.  We support LAPI_V0 and
+// LAPI_V1, at which the claim_file handler may be called concurrently.
+
+static int
+get_api_version(const char*, const char*, int, int maximal_api_supported,
+		const char** linker_identifier, const char** linker_version)
+{
+  gold_assert(parameters->options().has_plugins());
+  *linker_identifier = "GNU gold";
+  *linker_version = get_version_string();
+
+  int version = (maximal_api_supported < LAPI_V1
+		 ? static_cast<int>(LAPI_V0)
+		 : static_cast<int>(LAPI_V1));
+  parameters->options().plugins()->set_api_version(version);
+  return version;
+}
+
 // Let the linker know that a subset of sections could be mapped
 // to a unique segment.
 
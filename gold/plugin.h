@@ -62,7 +62,8 @@ class Plugin
       all_symbols_read_handler_(NULL),
       cleanup_handler_(NULL),
       new_input_handler_(NULL),
-      cleanup_done_(false)
+      cleanup_done_(false),
+      concurrent_claim_file_(false)
   { }
 
   ~Plugin()
@@ -108,6 +109,20 @@ class Plugin
   set_new_input_handler(ld_plugin_new_input_handler handler)
   { this->new_input_handler_ = handler; }
 
+  // Record that the claim-file handler may be called concurrently.
+  void
+  set_concurrent_claim_file()
+  { this->concurrent_claim_file_ = true; }
+
+  // Return whether we may call the claim-file handler concurrently.
+  // This is true if the plugin has no claim-file handler.
+  bool
+  concurrent_claim_file() const
+  {
+    return (this->concurrent_claim_file_
+	    || this->claim_file_handler_ == NULL);
+  }
+
   // Add an argument
   void
   add_option(const char* arg)
@@ -136,6 +151,9 @@ class Plugin
   ld_plugin_new_input_handler new_input_handler_;
   // TRUE if the cleanup handlers have been called.
   bool cleanup_done_;
+  // TRUE if the plugin allows concurrent calls to its claim-file
+  // handler.
+  bool concurrent_claim_file_;
 };
 
 // A manager class for plugins.
@@ -144,14 +162,15 @@ class Plugin_manager
 {
  public:
   Plugin_manager(const General_options& options)
-    : plugins_(), objects_(), deferred_layout_objects_(), input_file_(NULL),
-      plugin_input_file_(), rescannable_(), undefined_symbols_(),
+    : plugins_(), objects_(), deferred_layout_objects_(), pending_claims_(),
+      rescannable_(), undefined_symbols_(),
       any_claimed_(false), in_replacement_phase_(false), any_added_(false),
-      in_claim_file_handler_(false),
+      concurrent_claim_file_(false),
       options_(options), workqueue_(NULL), task_(NULL), input_objects_(NULL),
       symtab_(NULL), layout_(NULL), dirpath_(NULL), mapfile_(NULL),
       this_blocker_(NULL), extra_search_path_(), lock_(NULL),
-      initialize_lock_(&lock_), defsym_defines_set_(),
+      initialize_lock_(&lock_), claim_lock_(NULL),
+      initialize_claim_lock_(&claim_lock_), defsym_defines_set_(),
       recorder_(NULL)
   { this->current_ = plugins_.end(); }
 
@@ -191,10 +210,14 @@ class Plugin_manager
   Object*
   get_elf_object(const void* handle);
 
-  // True if the claim_file handler of the plugins is being called.
+  // True if the claim_file handler of the plugins is being called for
+  // the file with HANDLE.
   bool
-  in_claim_file_handler()
-  { return in_claim_file_handler_; }
+  in_claim_file_handler(const void* handle)
+  {
+    return this->pending_claim(
+	static_cast<unsigned int>(reinterpret_cast<intptr_t>(handle))) != NULL;
+  }
 
   // Let the plugin manager save an archive for later rescanning.
   // This takes ownership of the Archive pointer.
@@ -258,6 +281,16 @@ class Plugin_manager
     (*this->current_)->set_cleanup_handler(handler);
   }
 
+  // Record the API version negotiated with the plugin being loaded.
+  // At LAPI_V1 its claim-file handler may be called concurrently.
+  void
+  set_api_version(int version)
+  {
+    gold_assert(this->current_ != plugins_.end());
+    if (version >= LAPI_V1)
+      (*this->current_)->set_concurrent_claim_file();
+  }
+
   // Make a new Pluginobj object.  This is called when the plugin calls
   // the add_symbols API.
   Pluginobj*
@@ -267,6 +300,7 @@ class Plugin_manager
   Object*
   object(unsigned int handle) const
   {
+    Hold_optional_lock hl(this->lock_);
     if (handle >= this->objects_.size())
       return NULL;
     return this->objects_[handle];
@@ -359,10 +393,28 @@ class Plugin_manager
   typedef std::vector<Rescannable> Rescannable_list;
   typedef std::vector<Symbol*> Undefined_symbol_list;
 
+  // A file which is being offered to the claim-file handlers.
+  struct Pending_claim
+  {
+    Input_file* input_file;
+    struct ld_plugin_input_file plugin_input_file;
+  };
+
+  typedef Unordered_map<unsigned int, Pending_claim*> Pending_claim_map;
+
   // Rescan archives for undefined symbols.
   void
   rescan(Task*);
 
+  // Return the pending claim for HANDLE, or NULL if the claim-file
+  // handlers are not being called for it.
+  Pending_claim*
+  pending_claim(unsigned int handle);
+
+  // Make a new Pluginobj object with the lock held.
+  Pluginobj*
+  do_make_plugin_object(unsigned int handle);
+
   // See whether the rescannable at index I defines SYM.
   bool
   rescannable_defines(size_t i, Symbol* sym);
@@ -373,15 +425,17 @@ class Plugin_manager
   Plugin_list::iterator current_;
 
   // The list of plugin objects.  The index of an item in this list
-  // serves as the "handle" that we pass to the plugins.
+  // serves as the "handle" that we pass to the plugins.  While a file
+  // is offered to the plugins, its entry is the ELF object for the
+  // file, or NULL.
   Object_list objects_;
 
   // The list of regular objects whose layout has been deferred.
   Deferred_layout_list deferred_layout_objects_;
 
-  // The file currently up for claim by the plugins.
-  Input_file* input_file_;
-  struct ld_plugin_input_file plugin_input_file_;
+  // The files currently up for claim by the plugins, indexed by
+  // handle.
+  Pending_claim_map pending_claims_;
 
   // A list of archives and input groups being saved for possible
   // later rescanning.
@@ -401,8 +455,9 @@ class Plugin_manager
   // Whether any input files or libraries were added by a plugin.
   bool any_added_;
 
-  // Set to true when the claim_file handler of a plugin is called.
-  bool in_claim_file_handler_;
+  // Set to true if every plugin allows concurrent calls to its
+  // claim_file handler.
+  bool concurrent_claim_file_;
 
   const General_options& options_;
   Workqueue* workqueue_;
@@ -417,8 +472,14 @@ class Plugin_manager
   // An extra directory to search for the libraries passed by
   // add_input_library.
   std::string extra_search_path_;
+  // Protects objects_, pending_claims_ and recorder_ while files are
+  // being claimed.
   Lock* lock_;
   Initialize_lock initialize_lock_;
+  // Held while calling the claim-file handlers, unless they may be
+  // called concurrently.
+  Lock* claim_lock_;
+  Initialize_lock initialize_claim_lock_;
 
   // Keep track of all symbols defined by defsym.
   typedef Unordered_set<std::string> Defsym_defines_set;
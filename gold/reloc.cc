@@ -85,6 +85,9 @@ Read_relocs::run(Workqueue* workqueue)
     }
   else
     {
+      if (this->prescan_blocker_ != NULL)
+	workqueue->queue_next(new Prescan_relocs(this->symtab_, this->object_,
+						 rd, this->prescan_blocker_));
       workqueue->queue_next(new Scan_relocs(this->symtab_, this->layout_,
 					    this->object_, rd,
                                             this->this_blocker_,
@@ -145,6 +148,56 @@ Gc_process_relocs::get_name() const
   return "Gc_process_relocs " + this->object_->name();
 }
 
+// Prescan_relocs methods.
+
+// We prescan the relocations when running with threads.  We don't
+// when the relocations are also needed for -r, --emit-relocs or an
+// incremental link, since those scan every relocation anyhow.
+
+bool
+Prescan_relocs::is_enabled(const Layout* layout)
+{
+  return (parameters->options().threads()
+	  && parameters->target().can_prescan_relocs()
+	  && !parameters->options().relocatable()
+	  && !parameters->options().emit_relocs()
+	  && layout->incremental_inputs() == NULL);
+}
+
+// These tasks only look at the relocations which have already been
+// read, and at the symbol table, which nothing changes while they
+// run.  They don't touch the file, so they don't lock it.
+
+Task_token*
+Prescan_relocs::is_runnable()
+{
+  return NULL;
+}
+
+// Release the blocker when done.
+
+void
+Prescan_relocs::locks(Task_locker* tl)
+{
+  tl->add(this, this->blocker_);
+}
+
+// Prescan the relocs.
+
+void
+Prescan_relocs::run(Workqueue*)
+{
+  this->object_->prescan_relocs(this->symtab_, this->rd_);
+}
+
+// Return a debugging name for the task.
+
+std::string
+Prescan_relocs::get_name() const
+{
+  return "Prescan_relocs " + this->object_->name();
+}
+
 // Scan_relocs methods.
 
 Scan_relocs::~Scan_relocs()
@@ -234,9 +287,12 @@ Relocate_task::locks(Task_locker* tl)
 // Run the task.
 
 void
-Relocate_task::run(Workqueue*)
+Relocate_task::run(Workqueue* workqueue)
 {
-  this->object_->relocate(this->symtab_, this->layout_, this->of_);
+  this->object_->relocate(this->symtab_, this->layout_, this->of_,
+			  (parameters->options().threads()
+			   ? workqueue
+			   : NULL));
 
   // This is normally the last thing we will do with an object, so
   // uncache all views.
@@ -253,6 +309,81 @@ Relocate_task::get_name() const
   return "Relocate_task " + this->object_->name();
 }
 
+// Relocate_pieces methods.
+
+// Relocate pieces until there are none left to start.
+
+void
+Relocate_pieces::run()
+{
+  while (true)
+    {
+      unsigned int piece;
+      {
+	Hold_lock hl(this->lock_);
+	if (this->next_ >= this->count_)
+	  return;
+	piece = this->next_;
+	++this->next_;
+      }
+
+      this->do_relocate_piece(piece);
+
+      Hold_lock hl(this->lock_);
+      ++this->done_;
+      if (this->done_ == this->count_)
+	this->condvar_.broadcast();
+    }
+}
+
+// Wait until all the pieces have been relocated.
+
+void
+Relocate_pieces::wait()
+{
+  Hold_lock hl(this->lock_);
+  while (this->done_ < this->count_)
+    this->condvar_.wait();
+}
+
+// Add a reference.
+
+void
+Relocate_pieces::add_ref()
+{
+  Hold_lock hl(this->lock_);
+  ++this->refs_;
+}
+
+// Drop a reference.  A Relocate_pieces_task may not run until after
+// the Relocate_task is finished, so whoever drops the last reference
+// deletes this.
+
+void
+Relocate_pieces::release()
+{
+  bool last;
+  {
+    Hold_lock hl(this->lock_);
+    gold_assert(this->refs_ > 0);
+    --this->refs_;
+    last = this->refs_ == 0;
+  }
+  if (last)
+    delete this;
+}
+
+// Relocate_pieces_task methods.
+
+// Relocate pieces, if there are any left.
+
+void
+Relocate_pieces_task::run(Workqueue*)
+{
+  this->pieces_->run();
+  this->pieces_->release();
+}
+
 // Read the relocs and local symbols from the object file and store
 // the information in RD.
 
@@ -418,6 +549,53 @@ Sized_relobj_file<size, big_endian>::do_gc_process_relocs(Symbol_table* symtab,
 }
 
 
+// Prescan the relocs, so that do_scan_relocs only sees those which
+// may require GOT/PLT/COPY relocations.  This runs in parallel with
+// the other objects.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::do_prescan_relocs(Symbol_table* symtab,
+						       Read_relocs_data* rd)
+{
+  Sized_target<size, big_endian>* target =
+    parameters->sized_target<size, big_endian>();
+
+  const unsigned char* local_symbols;
+  if (rd->local_symbols == NULL)
+    local_symbols = NULL;
+  else
+    local_symbols = rd->local_symbols->data();
+
+  for (Read_relocs_data::Relocs_list::iterator p = rd->relocs.begin();
+       p != rd->relocs.end();
+       ++p)
+    {
+      // Sections which need special offset handling are left to
+      // do_scan_relocs, since mapping the offsets is not read-only.
+      if (p->output_section == NULL
+	  || !p->is_data_section_allocated
+	  || p->needs_special_offset_handling)
+	continue;
+
+      std::vector<unsigned char>* deferred = new std::vector<unsigned char>;
+      if (!target->prescan_relocs(symtab, this, p->sh_type,
+				  p->contents->data(), p->reloc_count,
+				  this->local_symbol_count_, local_symbols,
+				  deferred))
+	{
+	  delete deferred;
+	  continue;
+	}
+
+      const int reloc_size = (p->sh_type == elfcpp::SHT_RELA
+			      ? elfcpp::Elf_sizes<size>::rela_size
+			      : elfcpp::Elf_sizes<size>::rel_size);
+      p->deferred_relocs = deferred;
+      p->deferred_reloc_count = deferred->size() / reloc_size;
+    }
+}
+
 // Scan the relocs and adjust the symbol table.  This looks for
 // relocations which require GOT/PLT/COPY relocations.
 
@@ -458,7 +636,19 @@ Sized_relobj_file<size, big_endian>::do_scan_relocs(Symbol_table* symtab,
 	  // As noted above, when not generating an object file, we
 	  // only scan allocated sections.  We may see a non-allocated
 	  // section here if we are emitting relocs.
-	  if (p->is_data_section_allocated)
+	  if (p->deferred_relocs != NULL)
+	    {
+	      // do_prescan_relocs has dropped the relocs which don't
+	      // need to be scanned.
+	      if (p->deferred_reloc_count > 0)
+		target->scan_relocs(symtab, layout, this, p->data_shndx,
+				    p->sh_type, &(*p->deferred_relocs)[0],
+				    p->deferred_reloc_count,
+				    p->output_section, false,
+				    this->local_symbol_count_,
+				    local_symbols);
+	    }
+	  else if (p->is_data_section_allocated)
 	    target->scan_relocs(symtab, layout, this, p->data_shndx,
 				p->sh_type, p->contents->data(),
 				p->reloc_count, p->output_section,
@@ -488,6 +678,8 @@ Sized_relobj_file<size, big_endian>::do_scan_relocs(Symbol_table* symtab,
 
       delete p->contents;
       p->contents = NULL;
+      delete p->deferred_relocs;
+      p->deferred_relocs = NULL;
     }
 
   // For incremental links, finalize the allocation of relocations.
@@ -586,7 +778,8 @@ template<int size, bool big_endian>
 void
 Sized_relobj_file<size, big_endian>::do_relocate(const Symbol_table* symtab,
 						 const Layout* layout,
-						 Output_file* of)
+						 Output_file* of,
+						 Workqueue* workqueue)
 {
   unsigned int shnum = this->shnum();
 
@@ -628,7 +821,9 @@ Sized_relobj_file<size, big_endian>::do_relocate(const Symbol_table* symtab,
 
   // Apply relocations.
 
+  this->relocate_workqueue_ = workqueue;
   this->relocate_sections(symtab, layout, pshdrs, of, &views);
+  this->relocate_workqueue_ = NULL;
 
   // After we've done the relocations, we release the hash tables,
   // since we no longer need them.
@@ -871,10 +1066,148 @@ Sized_relobj_file<size, big_endian>::do_relocate_sections(
     Output_file* of,
     Views* pviews)
 {
+  if (this->relocate_workqueue_ != NULL
+      && this->relocate_section_pieces(symtab, layout, pshdrs, of, pviews))
+    return;
   this->relocate_section_range(symtab, layout, pshdrs, of, pviews,
 			       1, this->shnum() - 1);
 }
 
+// The pieces of an object whose sections are being relocated in
+// parallel.  Each piece is a range of section indexes, which is
+// passed to relocate_section_range.
+
+template<int size, bool big_endian>
+class Sized_relobj_file<size, big_endian>::Relocate_section_pieces
+  : public Relocate_pieces
+{
+ public:
+  typedef std::vector<std::pair<unsigned int, unsigned int> > Ranges;
+
+  Relocate_section_pieces(Sized_relobj_file<size, big_endian>* object,
+			  const Symbol_table* symtab, const Layout* layout,
+			  const unsigned char* pshdrs, Output_file* of,
+			  Views* pviews, const Ranges& ranges)
+    : Relocate_pieces(ranges.size()), object_(object), symtab_(symtab),
+      layout_(layout), pshdrs_(pshdrs), of_(of), pviews_(pviews),
+      ranges_(ranges)
+  { }
+
+ protected:
+  void
+  do_relocate_piece(unsigned int piece)
+  {
+    this->object_->relocate_section_range(this->symtab_, this->layout_,
+					  this->pshdrs_, this->of_,
+					  this->pviews_,
+					  this->ranges_[piece].first,
+					  this->ranges_[piece].second);
+  }
+
+ private:
+  Sized_relobj_file<size, big_endian>* object_;
+  const Symbol_table* symtab_;
+  const Layout* layout_;
+  const unsigned char* pshdrs_;
+  Output_file* of_;
+  Views* pviews_;
+  Ranges ranges_;
+};
+
+// Relocate the sections in pieces, using the Workqueue to run them
+// in parallel.  This is only done for an object with more than
+// --relocate-split-size bytes of relocations.  Each piece has about
+// that many bytes of relocations.  Return false if we did not split
+// the object, in which case nothing has been relocated.
+
+template<int size, bool big_endian>
+bool
+Sized_relobj_file<size, big_endian>::relocate_section_pieces(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    const unsigned char* pshdrs,
+    Output_file* of,
+    Views* pviews)
+{
+  // Leave the unusual cases to relocate_section_range.
+  if (parameters->options().relocatable()
+      || parameters->options().emit_relocs()
+      || parameters->incremental()
+      || this->uses_split_stack())
+    return false;
+
+  uint64_t split_size = parameters->options().relocate_split_size();
+  if (split_size == 0)
+    return false;
+
+  unsigned int shnum = this->shnum();
+
+  // Two pieces must never write to the same output view, so we don't
+  // split an object with more than one reloc section for a section.
+  std::vector<bool> has_relocs(shnum, false);
+  typename Relocate_section_pieces::Ranges ranges;
+  unsigned int start_shndx = 1;
+  uint64_t piece_size = 0;
+  const unsigned char* p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+
+      unsigned int sh_type = shdr.get_sh_type();
+      if (sh_type != elfcpp::SHT_REL && sh_type != elfcpp::SHT_RELA)
+	continue;
+
+      // relocate_section_range will report a bad index.
+      unsigned int index = this->adjust_shndx(shdr.get_sh_info());
+      if (index >= shnum)
+	continue;
+      if (has_relocs[index])
+	return false;
+      has_relocs[index] = true;
+
+      piece_size += shdr.get_sh_size();
+      if (piece_size > split_size)
+	{
+	  ranges.push_back(std::make_pair(start_shndx, i));
+	  start_shndx = i + 1;
+	  piece_size = 0;
+	}
+    }
+  if (piece_size > 0)
+    ranges.push_back(std::make_pair(start_shndx, shnum - 1));
+
+  if (ranges.size() < 2)
+    return false;
+
+  // The pieces look up offsets in the merge maps, which must not
+  // change while they run.  They may also read the input file, for
+  // instance to report an error, so give the file a lock.
+  this->sort_merge_maps();
+  Lock read_lock;
+  File_read& file(this->input_file()->file());
+  file.set_read_lock(&read_lock);
+
+  Relocate_section_pieces* pieces =
+    new Relocate_section_pieces(this, symtab, layout, pshdrs, of, pviews,
+				ranges);
+  for (size_t i = 1; i < ranges.size(); ++i)
+    {
+      pieces->add_ref();
+      this->relocate_workqueue_->queue_soon(
+	  new Relocate_pieces_task(pieces, this->name()));
+    }
+
+  // Relocate pieces here too.  Once none are left to start, we only
+  // have to wait for the ones running on other threads.
+  pieces->run();
+  pieces->wait();
+  pieces->release();
+
+  file.set_read_lock(NULL);
+
+  return true;
+}
+
 // Relocate section data for the range of sections START_SHNDX through
 // END_SHNDX.
 
@@ -1666,6 +1999,34 @@ Sized_relobj_file<64, true>::do_gc_process_relocs(Symbol_table* symtab,
 						  Read_relocs_data* rd);
 #endif
 
+#ifdef HAVE_TARGET_32_LITTLE
+template
+void
+Sized_relobj_file<32, false>::do_prescan_relocs(Symbol_table* symtab,
+						Read_relocs_data* rd);
+#endif
+
+#ifdef HAVE_TARGET_32_BIG
+template
+void
+Sized_relobj_file<32, true>::do_prescan_relocs(Symbol_table* symtab,
+					       Read_relocs_data* rd);
+#endif
+
+#ifdef HAVE_TARGET_64_LITTLE
+template
+void
+Sized_relobj_file<64, false>::do_prescan_relocs(Symbol_table* symtab,
+						Read_relocs_data* rd);
+#endif
+
+#ifdef HAVE_TARGET_64_BIG
+template
+void
+Sized_relobj_file<64, true>::do_prescan_relocs(Symbol_table* symtab,
+					       Read_relocs_data* rd);
+#endif
+
 #ifdef HAVE_TARGET_32_LITTLE
 template
 void
@@ -1703,7 +2064,8 @@ template
 void
 Sized_relobj_file<32, false>::do_relocate(const Symbol_table* symtab,
 					  const Layout* layout,
-					  Output_file* of);
+					  Output_file* of,
+					  Workqueue* workqueue);
 #endif
 
 #ifdef HAVE_TARGET_32_BIG
@@ -1711,7 +2073,8 @@ template
 void
 Sized_relobj_file<32, true>::do_relocate(const Symbol_table* symtab,
 					 const Layout* layout,
-					 Output_file* of);
+					 Output_file* of,
+					 Workqueue* workqueue);
 #endif
 
 #ifdef HAVE_TARGET_64_LITTLE
@@ -1719,7 +2082,8 @@ template
 void
 Sized_relobj_file<64, false>::do_relocate(const Symbol_table* symtab,
 					  const Layout* layout,
-					  Output_file* of);
+					  Output_file* of,
+					  Workqueue* workqueue);
 #endif
 
 #ifdef HAVE_TARGET_64_BIG
@@ -1727,7 +2091,8 @@ template
 void
 Sized_relobj_file<64, true>::do_relocate(const Symbol_table* symtab,
 					 const Layout* layout,
-					 Output_file* of);
+					 Output_file* of,
+					 Workqueue* workqueue);
 #endif
 
 #ifdef HAVE_TARGET_32_LITTLE
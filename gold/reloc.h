@@ -64,11 +64,14 @@ class Read_relocs : public Task
  public:
   //   THIS_BLOCKER and NEXT_BLOCKER are passed along to a Scan_relocs
   // or Gc_process_relocs task, so that they run in a deterministic
-  // order.
+  // order.  If PRESCAN_BLOCKER is not NULL, we also start a
+  // Prescan_relocs task which unblocks it.
   Read_relocs(Symbol_table* symtab, Layout* layout, Relobj* object,
-	      Task_token* this_blocker, Task_token* next_blocker)
+	      Task_token* this_blocker, Task_token* next_blocker,
+	      Task_token* prescan_blocker)
     : symtab_(symtab), layout_(layout), object_(object),
-      this_blocker_(this_blocker), next_blocker_(next_blocker)
+      this_blocker_(this_blocker), next_blocker_(next_blocker),
+      prescan_blocker_(prescan_blocker)
   { }
 
   // The standard Task methods.
@@ -91,6 +94,7 @@ class Read_relocs : public Task
   Relobj* object_;
   Task_token* this_blocker_;
   Task_token* next_blocker_;
+  Task_token* prescan_blocker_;
 };
 
 // Process the relocs to figure out which sections are garbage.
@@ -134,6 +138,45 @@ class Gc_process_relocs : public Task
   Task_token* next_blocker_;
 };
 
+// Prescan the relocations for an object, keeping only those which
+// may require GOT/PLT/COPY relocations, so that the Scan_relocs tasks,
+// which must run one at a time, have less to do.  These tasks run in
+// parallel, and must all finish before any Scan_relocs task runs.
+
+class Prescan_relocs : public Task
+{
+ public:
+  // BLOCKER is unblocked when this task finishes.
+  Prescan_relocs(Symbol_table* symtab, Relobj* object, Read_relocs_data* rd,
+		 Task_token* blocker)
+    : symtab_(symtab), object_(object), rd_(rd), blocker_(blocker)
+  { }
+
+  // Return whether we should prescan the relocations.
+  static bool
+  is_enabled(const Layout*);
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const;
+
+ private:
+  Symbol_table* symtab_;
+  Relobj* object_;
+  Read_relocs_data* rd_;
+  Task_token* blocker_;
+};
+
 // Scan the relocations for an object to see if they require any
 // GOT/PLT/COPY relocations.
 
@@ -214,6 +257,99 @@ class Relocate_task : public Task
   Task_token* final_blocker_;
 };
 
+// When using threads, the relocation sections of an object with a
+// lot of relocations are divided into pieces.  The Relocate_task
+// relocates pieces itself, and queues Relocate_pieces_tasks which
+// relocate pieces on other threads.  The Relocate_task waits for all
+// the pieces before it finishes, so the object stays locked while
+// they run.  This is the base class, which hands out the pieces; a
+// child class relocates them.
+
+class Relocate_pieces
+{
+ public:
+  Relocate_pieces(unsigned int count)
+    : lock_(), condvar_(this->lock_), count_(count), next_(0), done_(0),
+      refs_(1)
+  { }
+
+  virtual
+  ~Relocate_pieces()
+  { }
+
+  // Relocate pieces until there are none left to start.
+  void
+  run();
+
+  // Wait until all the pieces have been relocated.
+  void
+  wait();
+
+  // Add a reference.  The creator holds the first reference, and
+  // each Relocate_pieces_task holds one.
+  void
+  add_ref();
+
+  // Drop a reference, deleting this when there are none left.
+  void
+  release();
+
+ protected:
+  // Relocate piece PIECE--implemented by child class.
+  virtual void
+  do_relocate_piece(unsigned int piece) = 0;
+
+ private:
+  Relocate_pieces(const Relocate_pieces&);
+  Relocate_pieces& operator=(const Relocate_pieces&);
+
+  // Lock which controls access to the counts below.
+  Lock lock_;
+  // Signalled when the last piece is done.
+  Condvar condvar_;
+  // The number of pieces.
+  unsigned int count_;
+  // The next piece to start.
+  unsigned int next_;
+  // The number of pieces which have been relocated.
+  unsigned int done_;
+  // The number of references.
+  unsigned int refs_;
+};
+
+// A task which helps a Relocate_task by relocating pieces of its
+// object.  It does not lock anything itself.
+
+class Relocate_pieces_task : public Task
+{
+ public:
+  Relocate_pieces_task(Relocate_pieces* pieces, const std::string& name)
+    : pieces_(pieces), name_(name)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Relocate_pieces_task " + this->name_; }
+
+ private:
+  Relocate_pieces* pieces_;
+  // The name of the object, for debugging.
+  std::string name_;
+};
+
 // During a relocatable link, this class records how relocations
 // should be handled for a single input reloc section.  An instance of
 // this class is created while scanning relocs, and it is used while
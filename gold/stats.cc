@@ -0,0 +1,182 @@
+// stats.cc -- report link statistics
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "parameters.h"
+#include "stats.h"
+
+namespace gold
+{
+
+// Write NAME to FILE as a JSON string.
+
+static void
+write_json_string(FILE* file, const std::string& name)
+{
+  putc('"', file);
+  for (std::string::const_iterator p = name.begin(); p != name.end(); ++p)
+    {
+      unsigned char c = *p;
+      if (c == '"' || c == '\\')
+	{
+	  putc('\\', file);
+	  putc(c, file);
+	}
+      else if (c < 0x20)
+	fprintf(file, "\\u%04x", c);
+      else
+	putc(c, file);
+    }
+  putc('"', file);
+}
+
+// Class Stats_json.
+
+Stats_json::Stats_json()
+  : file_(NULL), phases_(), counters_(), counter_index_()
+{
+}
+
+Stats_json::~Stats_json()
+{
+  if (this->file_ != NULL)
+    ::fclose(this->file_);
+}
+
+// Open the statistics file.
+
+bool
+Stats_json::open(const char* filename)
+{
+  this->file_ = ::fopen(filename, "w");
+  if (this->file_ == NULL)
+    {
+      gold_error(_("cannot open statistics file %s: %s"), filename,
+		 strerror(errno));
+      return false;
+    }
+  return true;
+}
+
+// Record the run time of a phase.
+
+void
+Stats_json::add_phase(const char* name, const Timer::TimeStats& elapsed)
+{
+  this->phases_.push_back(std::make_pair(std::string(name), elapsed));
+}
+
+// Record a counter.
+
+void
+Stats_json::add_counter(const std::string& name, unsigned long long value)
+{
+  std::pair<std::map<std::string, size_t>::iterator, bool> ins =
+    this->counter_index_.insert(std::make_pair(name,
+					       this->counters_.size()));
+  if (ins.second)
+    this->counters_.push_back(std::make_pair(name,
+					     std::vector<unsigned long long>()));
+  this->counters_[ins.first->second].second.push_back(value);
+}
+
+// Write out the statistics.  The format is
+//   {"version":1,
+//    "phases":{NAME:{"user_ms":N,"sys_ms":N,"wall_ms":N},...},
+//    "counters":{NAME:[N,...],...}}
+// Every counter is written as an array of the values recorded for it,
+// so that its type does not depend on the input files.
+
+void
+Stats_json::close()
+{
+  if (this->file_ == NULL)
+    return;
+
+  FILE* file = this->file_;
+  fputs("{\"version\":1,\n\"phases\":{", file);
+  for (Phases::const_iterator p = this->phases_.begin();
+       p != this->phases_.end();
+       ++p)
+    {
+      if (p != this->phases_.begin())
+	putc(',', file);
+      fputs("\n ", file);
+      write_json_string(file, p->first);
+      fprintf(file, ":{\"user_ms\":%ld,\"sys_ms\":%ld,\"wall_ms\":%ld}",
+	      p->second.user, p->second.sys, p->second.wall);
+    }
+  fputs("},\n\"counters\":{", file);
+  for (Counters::const_iterator p = this->counters_.begin();
+       p != this->counters_.end();
+       ++p)
+    {
+      if (p != this->counters_.begin())
+	putc(',', file);
+      fputs("\n ", file);
+      write_json_string(file, p->first);
+      putc(':', file);
+      const std::vector<unsigned long long>& values(p->second);
+      for (size_t i = 0; i < values.size(); ++i)
+	fprintf(file, "%c%llu", i == 0 ? '[' : ',', values[i]);
+      putc(']', file);
+    }
+  fputs("}}\n", file);
+
+  if (::fclose(file) != 0)
+    gold_error(_("cannot close statistics file: %s"), strerror(errno));
+  this->file_ = NULL;
+}
+
+// Record a statistic.
+
+void
+record_stat(const char* name, unsigned long long value)
+{
+  Stats_json* stats_json = parameters->stats_json();
+  if (stats_json != NULL)
+    stats_json->add_counter(name, value);
+}
+
+void
+record_stat(const std::string& name, unsigned long long value)
+{
+  Stats_json* stats_json = parameters->stats_json();
+  if (stats_json != NULL)
+    stats_json->add_counter(name, value);
+}
+
+// Record the run time of a phase.
+
+void
+record_run_time(const char* name, const Timer::TimeStats& elapsed)
+{
+  Stats_json* stats_json = parameters->stats_json();
+  if (stats_json != NULL)
+    stats_json->add_phase(name, elapsed);
+}
+
+} // End namespace gold.
@@ -0,0 +1,106 @@
+// stats.h -- report link statistics  -*- C++ -*-
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_STATS_H
+#define GOLD_STATS_H
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "timer.h"
+
+namespace gold
+{
+
+// Stats_json collects the statistics which --stats prints, and writes
+// them to a file as a single JSON object for --stats-json.  This is
+// meant to be read by scripts which track linker performance over
+// time, so the names are fixed and never translated.
+
+// Statistics are only reported after all tasks have run, so there is
+// no locking.
+
+class Stats_json
+{
+ public:
+  Stats_json();
+
+  ~Stats_json();
+
+  // Open FILENAME for the statistics.  Return false if it can not be
+  // opened, after issuing an error.
+  bool
+  open(const char* filename);
+
+  // Record the run time of the phase of the link called NAME.
+  void
+  add_phase(const char* name, const Timer::TimeStats& elapsed);
+
+  // Record the counter NAME.  If a counter with the same name was
+  // already recorded, as happens when several merged sections have
+  // the same name, all the values are kept, in order.
+  void
+  add_counter(const std::string& name, unsigned long long value);
+
+  // Write out the statistics and close the file.
+  void
+  close();
+
+ private:
+  Stats_json(const Stats_json&);
+  Stats_json& operator=(const Stats_json&);
+
+  typedef std::vector<std::pair<std::string, Timer::TimeStats> > Phases;
+  typedef std::vector<std::pair<std::string,
+				std::vector<unsigned long long> > > Counters;
+
+  // The statistics file.
+  FILE* file_;
+  // The phases, in the order they were recorded.
+  Phases phases_;
+  // The counters, in the order they were first recorded.
+  Counters counters_;
+  // Map from a counter name to its index in counters_.
+  std::map<std::string, size_t> counter_index_;
+};
+
+// Record the statistic NAME with VALUE for --stats-json.  This does
+// nothing if --stats-json was not used.  The print_stats functions
+// print the --stats text themselves.
+
+extern void
+record_stat(const char* name, unsigned long long value);
+
+extern void
+record_stat(const std::string& name, unsigned long long value);
+
+// Record the run time of the phase of the link called NAME for
+// --stats-json.
+
+extern void
+record_run_time(const char* name, const Timer::TimeStats& elapsed);
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_STATS_H)
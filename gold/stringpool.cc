@@ -28,6 +28,7 @@
 
 #include "output.h"
 #include "parameters.h"
+#include "stats.h"
 #include "stringpool.h"
 
 namespace gold
@@ -35,9 +36,9 @@ namespace gold
 
 template<typename Stringpool_char>
 Stringpool_template<Stringpool_char>::Stringpool_template(uint64_t addralign)
-  : string_set_(), key_to_offset_(), strings_(), strtab_size_(0),
-    zero_null_(true), optimize_(false), offset_(sizeof(Stringpool_char)),
-    addralign_(addralign)
+  : entries_(), table_(), key_to_offset_(), strings_(), buffer_size_(1024),
+    strtab_size_(0), zero_null_(true), optimize_(false),
+    offset_(sizeof(Stringpool_char)), addralign_(addralign)
 {
   if (parameters->options_valid()
       && parameters->options().optimize() >= 2
@@ -55,7 +56,8 @@ Stringpool_template<Stringpool_char>::clear()
     delete[] reinterpret_cast<char*>(*p);
   this->strings_.clear();
   this->key_to_offset_.clear();
-  this->string_set_.clear();
+  this->entries_.clear();
+  Hash_table().swap(this->table_);
 }
 
 template<typename Stringpool_char>
@@ -65,32 +67,83 @@ Stringpool_template<Stringpool_char>::~Stringpool_template()
 }
 
 // Resize the internal hashtable with the expectation we'll get n new
-// elements.  Note that the hashtable constructor takes a "number of
-// buckets you'd like," rather than "number of elements you'd like,"
-// but that's the best we can do.
+// elements.
 
 template<typename Stringpool_char>
 void
 Stringpool_template<Stringpool_char>::reserve(unsigned int n)
 {
   this->key_to_offset_.reserve(n);
+  this->entries_.reserve(this->entries_.size() + n);
+  this->resize_table(this->entries_.size() + n);
+}
+
+// Resize the hash table so that it is no more than half full with
+// COUNT strings.  The table never shrinks.  We add the strings back
+// in key order, which walks through the entries in memory order, and
+// since they are all different we don't have to compare them.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::resize_table(size_t count)
+{
+  size_t size = 64;
+  while (size < count * 2)
+    size *= 2;
+  if (size <= this->table_.size())
+    return;
+
+  Hash_slot empty = { 0, 0 };
+  Hash_table new_table(size, empty);
+  const size_t mask = size - 1;
+  const size_t entry_count = this->entries_.size();
+  for (size_t i = 0; i < entry_count; ++i)
+    {
+      size_t hash_code = this->entries_[i].hash_code;
+      size_t j = hash_code & mask;
+      while (new_table[j].key != 0)
+	j = (j + 1) & mask;
+      new_table[j].tag = hash_tag(hash_code);
+      new_table[j].key = i + 1;
+    }
+  this->table_.swap(new_table);
+}
+
+// Look up a string in the hash table.
 
-#if defined(HAVE_UNORDERED_MAP)
-  this->string_set_.rehash(this->string_set_.size() + n);
-  return;
-#elif defined(HAVE_TR1_UNORDERED_MAP)
-  // rehash() implementation is broken in gcc 4.0.3's stl
-  //this->string_set_.rehash(this->string_set_.size() + n);
-  //return;
-#elif defined(HAVE_EXT_HASH_MAP)
-  this->string_set_.resize(this->string_set_.size() + n);
-  return;
-#endif
-
-  // This is the generic "reserve" code, if no #ifdef above triggers.
-  String_set_type new_string_set(this->string_set_.size() + n);
-  new_string_set.insert(this->string_set_.begin(), this->string_set_.end());
-  this->string_set_.swap(new_string_set);
+template<typename Stringpool_char>
+typename Stringpool_template<Stringpool_char>::Key
+Stringpool_template<Stringpool_char>::find_slot(const Stringpool_char* s,
+						size_t length,
+						size_t hash_code,
+						size_t* pslot) const
+{
+  gold_assert(!this->table_.empty());
+  const size_t mask = this->table_.size() - 1;
+  const uint32_t tag = hash_tag(hash_code);
+  size_t i = hash_code & mask;
+  while (true)
+    {
+      const Hash_slot& slot(this->table_[i]);
+      if (slot.key == 0)
+	break;
+      if (slot.tag == tag)
+	{
+	  const String_entry& entry(this->entries_[slot.key - 1]);
+	  if (entry.hash_code == hash_code
+	      && entry.length == length
+	      && (entry.string == s
+		  || memcmp(entry.string, s,
+			    length * sizeof(Stringpool_char)) == 0))
+	    {
+	      *pslot = i;
+	      return slot.key;
+	    }
+	}
+      i = (i + 1) & mask;
+    }
+  *pslot = i;
+  return 0;
 }
 
 // Compare two strings of arbitrary character type for equality.
@@ -115,21 +168,6 @@ Stringpool_template<char>::string_equal(const char* s1, const char* s2)
   return strcmp(s1, s2) == 0;
 }
 
-// Equality comparison function for the hash table.
-
-template<typename Stringpool_char>
-inline bool
-Stringpool_template<Stringpool_char>::Stringpool_eq::operator()(
-    const Hashkey& h1,
-    const Hashkey& h2) const
-{
-  return (h1.hash_code == h2.hash_code
-	  && h1.length == h2.length
-	  && (h1.string == h2.string
-	      || memcmp(h1.string, h2.string,
-			h1.length * sizeof(Stringpool_char)) == 0));
-}
-
 // Hash function.  The length is in characters, not bytes.
 
 template<typename Stringpool_char>
@@ -153,17 +191,16 @@ Stringpool_template<Stringpool_char>::add_string(const Stringpool_char* s,
   // We are in trouble if we've already computed the string offsets.
   gold_assert(this->strtab_size_ == 0);
 
-  // The size we allocate for a new Stringdata.
-  const size_t buffer_size = 1000;
-  // The amount we multiply the Stringdata index when calculating the
-  // key.
-  const size_t key_mult = 1024;
-  gold_assert(key_mult >= buffer_size);
+  // The largest Stringdata buffer we allocate.  Many string pools
+  // only hold a few strings, so the first buffer is small, and each
+  // new buffer is twice as large as the last one up to this limit.
+  const size_t max_buffer_size = 256 * 1024;
 
   // Convert len to the number of bytes we need to allocate, including
   // the null character.
   len = (len + 1) * sizeof(Stringpool_char);
 
+  const size_t buffer_size = this->buffer_size_;
   size_t alc;
   bool front = true;
   if (len > buffer_size)
@@ -199,7 +236,11 @@ Stringpool_template<Stringpool_char>::add_string(const Stringpool_char* s,
   psd->len = len;
 
   if (front)
-    this->strings_.push_front(psd);
+    {
+      this->strings_.push_front(psd);
+      if (buffer_size < max_buffer_size)
+	this->buffer_size_ = buffer_size * 2;
+    }
   else
     this->strings_.push_back(psd);
 
@@ -242,66 +283,55 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 						      bool copy,
 						      Key* pkey)
 {
-  typedef std::pair<typename String_set_type::iterator, bool> Insert_type;
-
-  // We add 1 so that 0 is always invalid.
-  const Key k = this->key_to_offset_.size() + 1;
-
-  if (!copy)
-    {
-      // When we don't need to copy the string, we can call insert
-      // directly.
-
-      std::pair<Hashkey, Hashval> element(Hashkey(s, length), k);
-
-      Insert_type ins = this->string_set_.insert(element);
-
-      typename String_set_type::const_iterator p = ins.first;
+  return this->add_with_length_and_hash(s, length, string_hash(s, length),
+					copy, pkey);
+}
 
-      if (ins.second)
-	{
-	  // We just added the string.  The key value has now been
-	  // used.
-	  this->new_key_offset(length);
-	}
-      else
-	{
-	  gold_assert(k != p->second);
-	}
+// Add a string whose hash code has already been computed.
 
-      if (pkey != NULL)
-	*pkey = p->second;
-      return p->first.string;
-    }
-
-  // When we have to copy the string, we look it up twice in the hash
-  // table.  The problem is that we can't insert S before we
-  // canonicalize it by copying it into the canonical list. The hash
-  // code will only be computed once.
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_with_length_and_hash(
+    const Stringpool_char* s,
+    size_t length,
+    size_t hash_code,
+    bool copy,
+    Key* pkey)
+{
+  // Make sure there is room in the table for one more string.
+  if ((this->entries_.size() + 1) * 2 > this->table_.size())
+    this->resize_table(this->entries_.size() + 1);
 
-  Hashkey hk(s, length);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p != this->string_set_.end())
+  size_t slot;
+  Key k = this->find_slot(s, length, hash_code, &slot);
+  if (k != 0)
     {
       if (pkey != NULL)
-	*pkey = p->second;
-      return p->first.string;
+	*pkey = k;
+      return this->entries_[k - 1].string;
     }
 
-  this->new_key_offset(length);
+  // We add 1 so that 0 is always invalid.
+  k = this->key_to_offset_.size() + 1;
+  gold_assert(k == this->entries_.size() + 1
+	      && k == static_cast<uint32_t>(k));
 
-  hk.string = this->add_string(s, length);
-  // The contents of the string stay the same, so we don't need to
-  // adjust hk.hash_code or hk.length.
+  if (copy)
+    s = this->add_string(s, length);
+  this->new_key_offset(length);
 
-  std::pair<Hashkey, Hashval> element(hk, k);
+  String_entry entry;
+  entry.string = s;
+  entry.length = length;
+  entry.hash_code = hash_code;
+  this->entries_.push_back(entry);
 
-  Insert_type ins = this->string_set_.insert(element);
-  gold_assert(ins.second);
+  this->table_[slot].tag = hash_tag(hash_code);
+  this->table_[slot].key = k;
 
   if (pkey != NULL)
     *pkey = k;
-  return hk.string;
+  return s;
 }
 
 template<typename Stringpool_char>
@@ -309,15 +339,19 @@ const Stringpool_char*
 Stringpool_template<Stringpool_char>::find(const Stringpool_char* s,
 					   Key* pkey) const
 {
-  Hashkey hk(s);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p == this->string_set_.end())
+  if (this->table_.empty())
+    return NULL;
+
+  size_t length = string_length(s);
+  size_t slot;
+  Key k = this->find_slot(s, length, string_hash(s, length), &slot);
+  if (k == 0)
     return NULL;
 
   if (pkey != NULL)
-    *pkey = p->second;
+    *pkey = k;
 
-  return p->first.string;
+  return this->entries_[k - 1].string;
 }
 
 // Comparison routine used when sorting into an ELF strtab.  We want
@@ -337,12 +371,10 @@ Stringpool_template<Stringpool_char>::Stringpool_sort_comparison::operator()(
   const Stringpool_sort_info& sort_info1,
   const Stringpool_sort_info& sort_info2) const
 {
-  const Hashkey& h1(sort_info1->first);
-  const Hashkey& h2(sort_info2->first);
-  const Stringpool_char* s1 = h1.string;
-  const Stringpool_char* s2 = h2.string;
-  const size_t len1 = h1.length;
-  const size_t len2 = h2.length;
+  const Stringpool_char* s1 = sort_info1.string;
+  const Stringpool_char* s2 = sort_info2.string;
+  const size_t len1 = sort_info1.length;
+  const size_t len2 = sort_info2.length;
   const size_t minlen = len1 < len2 ? len1 : len2;
   const Stringpool_char* p1 = s1 + len1 - 1;
   const Stringpool_char* p2 = s2 + len2 - 1;
@@ -398,15 +430,19 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
     }
   else
     {
-      size_t count = this->string_set_.size();
+      size_t count = this->entries_.size();
 
       std::vector<Stringpool_sort_info> v;
       v.reserve(count);
 
-      for (typename String_set_type::iterator p = this->string_set_.begin();
-           p != this->string_set_.end();
-           ++p)
-        v.push_back(Stringpool_sort_info(p));
+      for (size_t i = 0; i < count; ++i)
+	{
+	  Stringpool_sort_info info;
+	  info.string = this->entries_[i].string;
+	  info.length = this->entries_[i].length;
+	  info.key = i + 1;
+	  v.push_back(info);
+	}
 
       std::sort(v.begin(), v.end(), Stringpool_sort_comparison());
 
@@ -417,24 +453,21 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
            last = curr++)
         {
 	  section_offset_type this_offset;
-          if (this->zero_null_ && (*curr)->first.string[0] == 0)
+          if (this->zero_null_ && curr->string[0] == 0)
             this_offset = 0;
           else if (last != v.end()
-                   && ((((*curr)->first.length - (*last)->first.length)
+                   && (((curr->length - last->length)
 			% this->addralign_) == 0)
-                   && is_suffix((*curr)->first.string,
-				(*curr)->first.length,
-                                (*last)->first.string,
-				(*last)->first.length))
+                   && is_suffix(curr->string, curr->length,
+                                last->string, last->length))
             this_offset = (last_offset
-			   + (((*last)->first.length - (*curr)->first.length)
-			      * charsize));
+			   + ((last->length - curr->length) * charsize));
           else
             {
               this_offset = align_address(offset, this->addralign_);
-              offset = this_offset + ((*curr)->first.length + 1) * charsize;
+              offset = this_offset + (curr->length + 1) * charsize;
             }
-	  this->key_to_offset_[(*curr)->second - 1] = this_offset;
+	  this->key_to_offset_[curr->key - 1] = this_offset;
 	  last_offset = this_offset;
         }
     }
@@ -460,10 +493,13 @@ Stringpool_template<Stringpool_char>::get_offset_with_length(
     size_t length) const
 {
   gold_assert(this->strtab_size_ != 0);
-  Hashkey hk(s, length);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p != this->string_set_.end())
-    return this->key_to_offset_[p->second - 1];
+  if (!this->table_.empty())
+    {
+      size_t slot;
+      Key k = this->find_slot(s, length, string_hash(s, length), &slot);
+      if (k != 0)
+	return this->key_to_offset_[k - 1];
+    }
   gold_unreachable();
 }
 
@@ -479,15 +515,15 @@ Stringpool_template<Stringpool_char>::write_to_buffer(
   gold_assert(bufsize >= this->strtab_size_);
   if (this->zero_null_)
     buffer[0] = '\0';
-  for (typename String_set_type::const_iterator p = this->string_set_.begin();
-       p != this->string_set_.end();
-       ++p)
+  const size_t count = this->entries_.size();
+  for (size_t i = 0; i < count; ++i)
     {
-      const int len = (p->first.length + 1) * sizeof(Stringpool_char);
-      const section_offset_type offset = this->key_to_offset_[p->second - 1];
+      const String_entry& entry(this->entries_[i]);
+      const int len = (entry.length + 1) * sizeof(Stringpool_char);
+      const section_offset_type offset = this->key_to_offset_[i];
       gold_assert(static_cast<section_size_type>(offset) + len
 		  <= this->strtab_size_);
-      memcpy(buffer + offset, p->first.string, len);
+      memcpy(buffer + offset, entry.string, len);
     }
 }
 
@@ -503,22 +539,38 @@ Stringpool_template<Stringpool_char>::write(Output_file* of, off_t offset)
   of->write_output_view(offset, this->strtab_size_, view);
 }
 
-// Print statistical information to stderr.  This is used for --stats.
+// Print statistical information to stderr for --stats, and record it
+// for --stats-json.
 
 template<typename Stringpool_char>
 void
 Stringpool_template<Stringpool_char>::print_stats(const char* name) const
 {
-#if defined(HAVE_UNORDERED_MAP) || defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
-  fprintf(stderr, _("%s: %s entries: %zu; buckets: %zu\n"),
-	  program_name, name, this->string_set_.size(),
-	  this->string_set_.bucket_count());
-#else
-  fprintf(stderr, _("%s: %s entries: %zu\n"),
-	  program_name, name, this->table_.size());
-#endif
-  fprintf(stderr, _("%s: %s Stringdata structures: %zu\n"),
-	  program_name, name, this->strings_.size());
+  size_t memory = (this->entries_.capacity() * sizeof(String_entry)
+		   + this->table_.size() * sizeof(Hash_slot)
+		   + (this->key_to_offset_.capacity()
+		      * sizeof(section_offset_type)));
+  for (typename Stringdata_list::const_iterator p = this->strings_.begin();
+       p != this->strings_.end();
+       ++p)
+    memory += sizeof(Stringdata) + (*p)->alc;
+
+  if (parameters->options().stats())
+    {
+      fprintf(stderr, _("%s: %s entries: %zu; buckets: %zu\n"),
+	      program_name, name, this->entries_.size(),
+	      this->table_.size());
+      fprintf(stderr, _("%s: %s Stringdata structures: %zu\n"),
+	      program_name, name, this->strings_.size());
+      fprintf(stderr, _("%s: %s memory: %zu\n"),
+	      program_name, name, memory);
+    }
+
+  std::string prefix(name);
+  record_stat(prefix + " entries", this->entries_.size());
+  record_stat(prefix + " buckets", this->table_.size());
+  record_stat(prefix + " Stringdata structures", this->strings_.size());
+  record_stat(prefix + " memory", memory);
 }
 
 // Instantiate the templates we need.
@@ -130,6 +130,11 @@ class Chunked_vector
   size() const
   { return this->size_; }
 
+  // Get the number of elements for which space has been allocated.
+  size_t
+  capacity() const
+  { return this->chunks_.size() * chunk_size; }
+
   // Push a new element on the back of the vector.
   void
   push_back(const Element& element)
@@ -200,7 +205,7 @@ class Stringpool_template
   void
   set_no_zero_null()
   {
-    gold_assert(this->string_set_.empty()
+    gold_assert(this->entries_.size() == 0
 		&& this->offset_ == sizeof(Stringpool_char));
     this->zero_null_ = false;
     this->offset_ = 0;
@@ -229,6 +234,14 @@ class Stringpool_template
   const Stringpool_char*
   add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey);
 
+  // Add string S of length LEN characters to the pool, where
+  // HASH_CODE is the value that gold::string_hash returns for S.
+  // This permits callers to compute the hash code ahead of time,
+  // possibly in a different thread.
+  const Stringpool_char*
+  add_with_length_and_hash(const Stringpool_char* s, size_t len,
+			   size_t hash_code, bool copy, Key* pkey);
+
   // If the string S is present in the pool, return the canonical
   // string pointer.  Otherwise, return NULL.  If PKEY is not NULL,
   // set *PKEY to the key.
@@ -326,62 +339,60 @@ class Stringpool_template
   is_suffix(const Stringpool_char* s1, size_t len1,
             const Stringpool_char* s2, size_t len2);
 
-  // The hash table key includes the string, the length of the string,
-  // and the hash code for the string.  We put the hash code
-  // explicitly into the key so that we can do a find()/insert()
-  // sequence without having to recompute the hash.  Computing the
+  // An entry for a string in the pool.  The entries are indexed by
+  // the key minus one.  We keep the hash code so that we never have
+  // to compute it again when the hash table grows.  Computing the
   // hash code is a significant user of CPU time in the linker.
-  struct Hashkey
+  struct String_entry
   {
     const Stringpool_char* string;
     // Length is in characters, not bytes.
     size_t length;
     size_t hash_code;
-
-    // This goes in an STL container, so we need a default
-    // constructor.
-    Hashkey()
-      : string(NULL), length(0), hash_code(0)
-    { }
-
-    // Note that these constructors are relatively expensive, because
-    // they compute the hash code.
-    explicit Hashkey(const Stringpool_char* s)
-      : string(s), length(string_length(s)), hash_code(string_hash(s, length))
-    { }
-
-    Hashkey(const Stringpool_char* s, size_t len)
-      : string(s), length(len), hash_code(string_hash(s, len))
-    { }
   };
 
-  // Hash function.  This is trivial, since we have already computed
-  // the hash.
-  struct Stringpool_hash
-  {
-    size_t
-    operator()(const Hashkey& hk) const
-    { return hk.hash_code; }
-  };
+  typedef Chunked_vector<String_entry> String_entries;
 
-  // Equality comparison function for hash table.
-  struct Stringpool_eq
+  // The hash table maps strings to keys.  It is a power of two sized
+  // array using open addressing with linear probing, and is never
+  // more than half full.  Each slot holds the key, which is zero for
+  // an empty slot, and the high bits of the hash code, so that a
+  // probe only has to look at the String_entry when the tag matches.
+  struct Hash_slot
   {
-    bool
-    operator()(const Hashkey&, const Hashkey&) const;
+    uint32_t tag;
+    uint32_t key;
   };
 
-  // The hash table is a map from strings to Keys.
+  typedef std::vector<Hash_slot> Hash_table;
 
-  typedef Key Hashval;
+  // Return the tag stored in a Hash_slot for HASH_CODE.
+  static uint32_t
+  hash_tag(size_t hash_code)
+  { return static_cast<uint32_t>(hash_code >> (sizeof(size_t) * 8 - 32)); }
 
-  typedef Unordered_map<Hashkey, Hashval, Stringpool_hash,
-			Stringpool_eq> String_set_type;
+  // Look up the string S of LENGTH characters with hash code
+  // HASH_CODE.  Return its key, or 0 if it is not in the table.  Set
+  // *PSLOT to the index of the slot holding the string, or of the
+  // empty slot where it should be added.  The table must not be
+  // empty.
+  Key
+  find_slot(const Stringpool_char* s, size_t length, size_t hash_code,
+	    size_t* pslot) const;
 
-  // Comparison routine used when sorting into a string table.
+  // Resize the hash table to hold at least COUNT strings.
+  void
+  resize_table(size_t count);
 
-  typedef typename String_set_type::iterator Stringpool_sort_info;
+  // Information used when sorting into a string table.
+  struct Stringpool_sort_info
+  {
+    const Stringpool_char* string;
+    size_t length;
+    Key key;
+  };
 
+  // Comparison routine used when sorting into a string table.
   struct Stringpool_sort_comparison
   {
     bool
@@ -395,12 +406,16 @@ class Stringpool_template
   // List of Stringdata structures.
   typedef std::list<Stringdata*> Stringdata_list;
 
-  // Mapping from const char* to namepool entry.
-  String_set_type string_set_;
+  // The strings in the pool, indexed by key minus one.
+  String_entries entries_;
+  // Mapping from strings to keys.
+  Hash_table table_;
   // Mapping from Key to string table offset.
   Key_to_offset key_to_offset_;
   // List of buffers.
   Stringdata_list strings_;
+  // Size of the next Stringdata buffer we allocate.
+  size_t buffer_size_;
   // Size of string table.
   section_size_type strtab_size_;
   // Whether to reserve offset 0 to hold the null string.
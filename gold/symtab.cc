@@ -25,6 +25,7 @@
 #include <cstring>
 #include <stdint.h>
 #include <algorithm>
+#include <new>
 #include <set>
 #include <string>
 #include <utility>
@@ -41,6 +42,7 @@
 #include "script.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "stats.h"
 
 namespace gold
 {
@@ -59,8 +61,7 @@ Symbol::init_fields(const char* name, const char* version,
   this->version_ = version;
   this->symtab_index_ = 0;
   this->dynsym_index_ = 0;
-  this->got_offsets_.init();
-  this->plt_offset_ = -1U;
+  this->got_plt_ = NULL;
   this->type_ = type;
   this->binding_ = binding;
   this->visibility_ = visibility;
@@ -210,6 +211,39 @@ Symbol::allocate_base_common(Output_data* od)
   this->u2_.offset_is_from_end = false;
 }
 
+// Count the entries in a Got_offset_list.
+
+class Count_got_offsets : public Got_offset_list::Visitor
+{
+ public:
+  Count_got_offsets()
+    : count(0)
+  { }
+
+  void
+  visit(unsigned int, unsigned int)
+  { ++this->count; }
+
+  size_t count;
+};
+
+// Return the memory used for the GOT and PLT entries.  The first GOT
+// entry is in the Got_plt_offsets record, and each other one has its
+// own list node.
+
+size_t
+Symbol::got_plt_memory() const
+{
+  if (this->got_plt_ == NULL)
+    return 0;
+  Count_got_offsets counter;
+  this->got_plt_->got_offsets.for_all_got_offsets(&counter);
+  size_t memory = sizeof(Got_plt_offsets);
+  if (counter.count > 1)
+    memory += (counter.count - 1) * sizeof(Got_offset_list);
+  return memory;
+}
+
 // Initialize the fields in Sized_symbol for SYM in OBJECT.
 
 template<int size>
@@ -569,13 +603,51 @@ Symbol_table::Symbol_table(unsigned int count,
     forwarders_(), commons_(), tls_commons_(), small_commons_(),
     large_commons_(), forced_locals_(), warnings_(),
     version_script_(version_script), gc_(NULL), icf_(NULL),
-    target_symbols_()
+    target_symbols_(), symbol_blocks_(), symbol_block_free_(NULL),
+    symbol_block_left_(0), symbol_count_(0), strong_undefineds_()
 {
   namepool_.reserve(count);
 }
 
 Symbol_table::~Symbol_table()
 {
+  for (std::vector<unsigned char*>::iterator p = this->symbol_blocks_.begin();
+       p != this->symbol_blocks_.end();
+       ++p)
+    delete[] *p;
+}
+
+// Allocate LEN bytes from the symbol arena.  LEN is always the size
+// of a Sized_symbol, which is a multiple of the pointer size, so the
+// returned memory is suitably aligned.
+
+void*
+Symbol_table::allocate_symbol_memory(size_t len)
+{
+  gold_assert(len % sizeof(void*) == 0 && len <= symbol_block_size);
+  if (this->symbol_block_left_ < len)
+    {
+      unsigned char* block = new unsigned char[symbol_block_size];
+      this->symbol_blocks_.push_back(block);
+      this->symbol_block_free_ = block;
+      this->symbol_block_left_ = symbol_block_size;
+    }
+  void* ret = this->symbol_block_free_;
+  this->symbol_block_free_ += len;
+  this->symbol_block_left_ -= len;
+  ++this->symbol_count_;
+  return ret;
+}
+
+// Allocate a new symbol from the symbol arena.  These symbols live
+// as long as the symbol table, and must not be deleted.
+
+template<int size>
+Sized_symbol<size>*
+Symbol_table::allocate_symbol()
+{
+  void* p = this->allocate_symbol_memory(sizeof(Sized_symbol<size>));
+  return new(p) Sized_symbol<size>();
 }
 
 // The symbol table key equality function.  This is called with
@@ -991,6 +1063,7 @@ Symbol_table::add_from_object(Object* object,
 
   Sized_symbol<size>* ret = NULL;
   bool was_undefined_in_reg;
+  bool was_strong_undefined = false;
   bool was_common;
   if (!ins.second)
     {
@@ -999,6 +1072,8 @@ Symbol_table::add_from_object(Object* object,
       gold_assert(ret != NULL);
 
       was_undefined_in_reg = ret->is_undefined() && ret->in_reg();
+      was_strong_undefined = (ret->is_undefined()
+			      && ret->binding() != elfcpp::STB_WEAK);
       // Commons from plugins are just placeholders.
       was_common = ret->is_common() && ret->object()->pluginobj() == NULL;
 
@@ -1092,7 +1167,7 @@ Symbol_table::add_from_object(Object* object,
 	  Sized_target<size, big_endian>* target =
 	    parameters->sized_target<size, big_endian>();
 	  if (!target->has_make_symbol())
-	    ret = new Sized_symbol<size>();
+	    ret = this->allocate_symbol<size>();
 	  else
 	    {
 	      ret = target->make_symbol(name, sym.get_st_type(), object,
@@ -1140,6 +1215,14 @@ Symbol_table::add_from_object(Object* object,
 	parameters->options().plugins()->new_undefined_symbol(ret);
     }
 
+  // Record every time a name may start to refer to a strong undefined
+  // symbol, so that an archive can look for the members to include
+  // without scanning its whole symbol map again.
+  if (ret->is_undefined()
+      && ret->binding() != elfcpp::STB_WEAK
+      && (ins.second || is_default_version || !was_strong_undefined))
+    this->strong_undefineds_.push_back(ret);
+
   // Keep track of common symbols, to speed up common symbol
   // allocation.  Don't record commons from plugin objects;
   // we need to wait until we see the real symbol in the
@@ -1182,6 +1265,7 @@ Symbol_table::add_from_relobj(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_hash* name_hashes,
     typename Sized_relobj_file<size, big_endian>::Symbols* sympointers,
     size_t* defined)
 {
@@ -1243,7 +1327,15 @@ Symbol_table::add_from_relobj(
       // In an object file, an '@' in the name separates the symbol
       // name from the version name.  If there are two '@' characters,
       // this is the default version.
-      const char* ver = strchr(name, '@');
+      // If we have the length of the name, we already know where any
+      // version begins.
+      const char* ver;
+      if (name_hashes == NULL)
+	ver = strchr(name, '@');
+      else if (name[name_hashes[i].length] == '@')
+	ver = name + name_hashes[i].length;
+      else
+	ver = NULL;
       Stringpool::Key ver_key = 0;
       int namelen = 0;
       // IS_DEFAULT_VERSION: is the version default?
@@ -1276,7 +1368,10 @@ Symbol_table::add_from_relobj(
       // about a common symbol?
       else
 	{
-	  namelen = strlen(name);
+	  if (name_hashes != NULL)
+	    namelen = name_hashes[i].length;
+	  else
+	    namelen = strlen(name);
 	  if (!this->version_script_.empty()
 	      && st_shndx != elfcpp::SHN_UNDEF)
 	    {
@@ -1348,8 +1443,12 @@ Symbol_table::add_from_relobj(
         }
 
       Stringpool::Key name_key;
-      name = this->namepool_.add_with_length(name, namelen, true,
-					     &name_key);
+      if (name_hashes == NULL)
+	name = this->namepool_.add_with_length(name, namelen, true,
+					       &name_key);
+      else
+	name = this->namepool_.add_with_length_and_hash(
+	    name, namelen, name_hashes[i].hash_code, true, &name_key);
 
       Sized_symbol<size>* res;
       res = this->add_from_object(relobj, name, name_key, ver, ver_key,
@@ -2532,6 +2631,7 @@ Symbol_table::add_undefined_symbol_from_command_line(const char* name)
   sym->init_undefined(name, version, 0, elfcpp::STT_NOTYPE, elfcpp::STB_GLOBAL,
 		      elfcpp::STV_DEFAULT, 0);
   ++this->saw_undefined_;
+  this->strong_undefineds_.push_back(sym);
 }
 
 // Set the dynamic symbol indexes.  INDEX is the index of the first
@@ -3443,18 +3543,72 @@ Symbol_table::sized_write_section_symbol(const Output_section* os,
   of->write_output_view(offset, sym_size, pov);
 }
 
-// Print statistical information to stderr.  This is used for --stats.
+// Print statistical information to stderr for --stats, and record it
+// for --stats-json.
 
 void
 Symbol_table::print_stats() const
 {
+  size_t symbol_size = 0;
+  if (parameters->target_valid())
+    symbol_size = (parameters->target().get_size() == 32
+		   ? sizeof(Sized_symbol<32>)
+		   : sizeof(Sized_symbol<64>));
+  size_t memory = this->symbol_blocks_.size() * symbol_block_size;
+
+  // The hash table memory is an estimate, without the malloc
+  // overhead: each entry is a node holding the value, the hash code
+  // and a pointer to the next node, and each bucket is a pointer.
+  size_t table_memory = (this->table_.size()
+			 * (sizeof(Symbol_table_type::value_type)
+			    + sizeof(size_t) + sizeof(void*)));
+#if defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
+  table_memory += this->table_.bucket_count() * sizeof(void*);
+#endif
+
+  size_t got_plt_count = 0;
+  size_t got_plt_memory = 0;
+  for (Symbol_table_type::const_iterator p = this->table_.begin();
+       p != this->table_.end();
+       ++p)
+    {
+      size_t m = p->second->got_plt_memory();
+      if (m != 0)
+	{
+	  ++got_plt_count;
+	  got_plt_memory += m;
+	}
+    }
+
+  if (parameters->options().stats())
+    {
 #if defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
-  fprintf(stderr, _("%s: symbol table entries: %zu; buckets: %zu\n"),
-	  program_name, this->table_.size(), this->table_.bucket_count());
+      fprintf(stderr, _("%s: symbol table entries: %zu; buckets: %zu\n"),
+	      program_name, this->table_.size(), this->table_.bucket_count());
 #else
-  fprintf(stderr, _("%s: symbol table entries: %zu\n"),
-	  program_name, this->table_.size());
+      fprintf(stderr, _("%s: symbol table entries: %zu\n"),
+	      program_name, this->table_.size());
+#endif
+      fprintf(stderr, _("%s: symbol table hash memory: %zu\n"),
+	      program_name, table_memory);
+      fprintf(stderr, _("%s: symbol table symbols: %zu; symbol size: %zu; "
+			"memory: %zu\n"),
+	      program_name, this->symbol_count_, symbol_size, memory);
+      fprintf(stderr, _("%s: symbols with GOT or PLT entries: %zu; "
+			"memory: %zu\n"),
+	      program_name, got_plt_count, got_plt_memory);
+    }
+
+  record_stat("symbol table entries", this->table_.size());
+#if defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
+  record_stat("symbol table buckets", this->table_.bucket_count());
 #endif
+  record_stat("symbol table symbols", this->symbol_count_);
+  record_stat("symbol size", symbol_size);
+  record_stat("symbol table memory", memory);
+  record_stat("symbol table hash memory", table_memory);
+  record_stat("symbols with GOT or PLT entries", got_plt_count);
+  record_stat("symbol GOT and PLT memory", got_plt_memory);
   this->namepool_.print_stats("symbol table stringpool");
 }
 
@@ -3715,6 +3869,7 @@ Symbol_table::add_from_relobj<32, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_hash* name_hashes,
     Sized_relobj_file<32, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3729,6 +3884,7 @@ Symbol_table::add_from_relobj<32, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_hash* name_hashes,
     Sized_relobj_file<32, true>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3743,6 +3899,7 @@ Symbol_table::add_from_relobj<64, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_hash* name_hashes,
     Sized_relobj_file<64, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3757,6 +3914,7 @@ Symbol_table::add_from_relobj<64, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_hash* name_hashes,
     Sized_relobj_file<64, true>::Symbols* sympointers,
     size_t* defined);
 #endif
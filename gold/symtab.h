@@ -66,6 +66,12 @@ class Icf;
 // Size dependent fields can be found in the template class
 // Sized_symbol.  Targets may support their own derived classes.
 
+// The GOT and PLT entries, which most symbols do not have, are kept
+// in a separate record.  The name, version and object are still
+// pointers rather than 32-bit indices: a Stringpool can not map a key
+// back to its string without a table costing as much as the pointer,
+// and an object index would have to be looked up on every access.
+
 class Symbol
 {
  public:
@@ -429,13 +435,17 @@ class Symbol
   // For a TLS symbol, this GOT entry will hold its tp-relative offset.
   bool
   has_got_offset(unsigned int got_type) const
-  { return this->got_offsets_.get_offset(got_type) != -1U; }
+  {
+    return (this->got_plt_ != NULL
+	    && this->got_plt_->got_offsets.get_offset(got_type) != -1U);
+  }
 
   // Return the offset into the GOT section of this symbol.
   unsigned int
   got_offset(unsigned int got_type) const
   {
-    unsigned int got_offset = this->got_offsets_.get_offset(got_type);
+    gold_assert(this->got_plt_ != NULL);
+    unsigned int got_offset = this->got_plt_->got_offsets.get_offset(got_type);
     gold_assert(got_offset != -1U);
     return got_offset;
   }
@@ -443,24 +453,28 @@ class Symbol
   // Set the GOT offset of this symbol.
   void
   set_got_offset(unsigned int got_type, unsigned int got_offset)
-  { this->got_offsets_.set_offset(got_type, got_offset); }
+  { this->got_plt()->got_offsets.set_offset(got_type, got_offset); }
 
   // Return the GOT offset list.
   const Got_offset_list*
   got_offset_list() const
-  { return this->got_offsets_.get_list(); }
+  {
+    if (this->got_plt_ == NULL)
+      return NULL;
+    return this->got_plt_->got_offsets.get_list();
+  }
 
   // Return whether this symbol has an entry in the PLT section.
   bool
   has_plt_offset() const
-  { return this->plt_offset_ != -1U; }
+  { return this->got_plt_ != NULL && this->got_plt_->plt_offset != -1U; }
 
   // Return the offset into the PLT section of this symbol.
   unsigned int
   plt_offset() const
   {
     gold_assert(this->has_plt_offset());
-    return this->plt_offset_;
+    return this->got_plt_->plt_offset;
   }
 
   // Set the PLT offset of this symbol.
@@ -468,9 +482,14 @@ class Symbol
   set_plt_offset(unsigned int plt_offset)
   {
     gold_assert(plt_offset != -1U);
-    this->plt_offset_ = plt_offset;
+    this->got_plt()->plt_offset = plt_offset;
   }
 
+  // Return the memory used for the GOT and PLT entries of this
+  // symbol, for --stats.
+  size_t
+  got_plt_memory() const;
+
   // Return whether this dynamic symbol needs a special value in the
   // dynamic symbol table.
   bool
@@ -916,6 +935,9 @@ class Symbol
   Symbol()
   { memset(static_cast<void*>(this), 0, sizeof *this); }
 
+  ~Symbol()
+  { delete this->got_plt_; }
+
   // Initialize the general fields.
   void
   init_fields(const char* name, const char* version,
@@ -982,6 +1004,33 @@ class Symbol
   Symbol(const Symbol&);
   Symbol& operator=(const Symbol&);
 
+  // The GOT and PLT entries of a symbol.  Most symbols have neither,
+  // so this is kept out of the symbol and only allocated when the
+  // first entry is set.
+  struct Got_plt_offsets
+  {
+    Got_plt_offsets()
+      : plt_offset(-1U), got_offsets()
+    { }
+
+    // The offset from the start of the PLT section, or -1U if there
+    // is no PLT entry.
+    unsigned int plt_offset;
+    // The GOT section entries.  A symbol may have more than one GOT
+    // offset (e.g., when mixing modules compiled with two different
+    // TLS models), but will usually have at most one.
+    Got_offset_list got_offsets;
+  };
+
+  // Return the GOT and PLT entries, allocating them if necessary.
+  Got_plt_offsets*
+  got_plt()
+  {
+    if (this->got_plt_ == NULL)
+      this->got_plt_ = new Got_plt_offsets();
+    return this->got_plt_;
+  }
+
   // Symbol name (expected to point into a Stringpool).
   const char* name_;
   // Symbol version (expected to point into a Stringpool).  This may
@@ -1007,6 +1056,10 @@ class Symbol
     Output_segment* output_segment;
   } u1_;
 
+  // The GOT and PLT entries for this symbol, or NULL if it has
+  // neither.
+  Got_plt_offsets* got_plt_;
+
   union
   {
     // This is used if SOURCE_ == FROM_OBJECT.
@@ -1035,16 +1088,6 @@ class Symbol
   // non-zero value during Layout::finalize.
   unsigned int dynsym_index_;
 
-  // If this symbol has an entry in the PLT section, then this is the
-  // offset from the start of the PLT section.  This is -1U if there
-  // is no PLT entry.
-  unsigned int plt_offset_;
-
-  // The GOT section entries for this symbol.  A symbol may have more
-  // than one GOT offset (e.g., when mixing modules compiled with two
-  // different TLS models), but will usually have at most one.
-  Got_offset_list got_offsets_;
-
   // Symbol type (bits 0 to 3).
   elfcpp::STT type_ : 4;
   // Symbol binding (bits 4 to 7).
@@ -1464,15 +1507,18 @@ class Symbol_table
   // Add COUNT external symbols from the relocatable object RELOBJ to
   // the symbol table.  SYMS is the symbols, SYMNDX_OFFSET is the
   // offset in the symbol table of the first symbol, SYM_NAMES is
-  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.  This sets
-  // SYMPOINTERS to point to the symbols in the symbol table.  It sets
-  // *DEFINED to the number of defined symbols.
+  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.  If
+  // NAME_HASHES is not NULL, it holds the precomputed lengths and hash
+  // codes of the COUNT names.  This sets SYMPOINTERS to point to the
+  // symbols in the symbol table.  It sets *DEFINED to the number of
+  // defined symbols.
   template<int size, bool big_endian>
   void
   add_from_relobj(Sized_relobj_file<size, big_endian>* relobj,
 		  const unsigned char* syms, size_t count,
 		  size_t symndx_offset, const char* sym_names,
 		  size_t sym_name_size,
+		  const Symbol_name_hash* name_hashes,
 		  typename Sized_relobj_file<size, big_endian>::Symbols*,
 		  size_t* defined);
 
@@ -1580,6 +1626,19 @@ class Symbol_table
   saw_undefined() const
   { return this->saw_undefined_; }
 
+  // Return the number of times we have recorded a symbol which may
+  // newly satisfy an archive map entry: a strong undefined symbol
+  // which was just added or whose name or binding changed.  A symbol
+  // may be recorded more than once.
+  size_t
+  strong_undefined_count() const
+  { return this->strong_undefineds_.size(); }
+
+  // Return the Ith recorded strong undefined symbol.
+  Symbol*
+  strong_undefined(size_t i) const
+  { return this->strong_undefineds_[i]; }
+
   // Allocate the common symbols
   void
   allocate_commons(Layout*, Mapfile*);
@@ -1727,7 +1786,10 @@ class Symbol_table
   // The type of the list of common symbols.
   typedef std::vector<Symbol*> Commons_type;
 
-  // The type of the symbol hash table.
+  // The type of the symbol hash table.  The key is not made smaller
+  // than a pair of Stringpool keys: with the hash code cached in each
+  // node and malloc rounding, 32-bit keys do not make the nodes any
+  // smaller.
 
   typedef std::pair<Stringpool::Key, Stringpool::Key> Symbol_table_key;
 
@@ -1758,6 +1820,15 @@ class Symbol_table
   void
   make_forwarder(Symbol* from, Symbol* to);
 
+  // Allocate a new symbol from the symbol arena.
+  template<int size>
+  Sized_symbol<size>*
+  allocate_symbol();
+
+  // Allocate LEN bytes of memory from the symbol arena.
+  void*
+  allocate_symbol_memory(size_t len);
+
   // Add a symbol.
   template<int size, bool big_endian>
   Sized_symbol<size>*
@@ -1981,7 +2052,9 @@ class Symbol_table
   // The number of global dynamic symbols (including forced-local symbols),
   // or 0 if none.
   unsigned int dynamic_count_;
-  // The symbol hash table.
+  // The symbol hash table.  This is filled by one Add_symbols task at
+  // a time, in input order; only the name hashing is done in parallel,
+  // by the Read_symbols tasks.
   Symbol_table_type table_;
   // A pool of symbol names.  This is used for all global symbols.
   // Entries in the hash table point into this pool.
@@ -2025,6 +2098,21 @@ class Symbol_table
   Icf* icf_;
   // Target-specific symbols, if any.
   std::vector<Symbol*> target_symbols_;
+  // The size of each block in symbol_blocks_.
+  static const size_t symbol_block_size = 256 * 1024;
+  // Blocks of memory from which we allocate symbols.  Symbols are
+  // never freed individually, so allocating them from large blocks
+  // saves the malloc overhead for each one.
+  std::vector<unsigned char*> symbol_blocks_;
+  // The unused part of the last block in symbol_blocks_.
+  unsigned char* symbol_block_free_;
+  // The number of bytes left in the last block.
+  size_t symbol_block_left_;
+  // The number of symbols allocated from the blocks, for --stats.
+  size_t symbol_count_;
+  // Symbols which have become strong undefined symbols, in the order
+  // in which we saw them.  This is used by Archive::add_symbols.
+  std::vector<Symbol*> strong_undefineds_;
 };
 
 // We inline get_sized_symbol for efficiency.
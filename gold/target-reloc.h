@@ -113,6 +113,73 @@ scan_relocs(
     }
 }
 
+// This function implements the generic part of prescanning relocs.
+// It copies to *DEFERRED each reloc which the target's scan_relocs
+// needs to see.  The template parameter Scan must provide two static
+// functions: local_is_trivial() and global_is_trivial().  They return
+// true if Scan::local() or Scan::global() would do nothing for a
+// reloc.  They are called while other objects are being prescanned,
+// so they may only look at symbol table state which does not change
+// while relocs are scanned.
+
+template<int size, bool big_endian, typename Scan, typename Classify_reloc>
+inline void
+prescan_relocs(
+    Symbol_table* symtab,
+    Sized_relobj_file<size, big_endian>* object,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    size_t local_count,
+    const unsigned char* plocal_syms,
+    std::vector<unsigned char>* deferred)
+{
+  typedef typename Classify_reloc::Reltype Reltype;
+  const int reloc_size = Classify_reloc::reloc_size;
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+
+  for (size_t i = 0; i < reloc_count; ++i, prelocs += reloc_size)
+    {
+      Reltype reloc(prelocs);
+
+      unsigned int r_sym = Classify_reloc::get_r_sym(&reloc);
+      unsigned int r_type = Classify_reloc::get_r_type(&reloc);
+
+      bool is_trivial;
+      if (r_sym < local_count)
+	{
+	  gold_assert(plocal_syms != NULL);
+	  typename elfcpp::Sym<size, big_endian> lsym(plocal_syms
+						      + r_sym * sym_size);
+	  unsigned int shndx = lsym.get_st_shndx();
+	  // Finding the extended section index may read the file, so
+	  // leave that to scan_relocs.
+	  if (shndx == elfcpp::SHN_XINDEX)
+	    is_trivial = false;
+	  else
+	    {
+	      bool is_ordinary;
+	      shndx = object->adjust_sym_shndx(r_sym, shndx, &is_ordinary);
+	      bool is_discarded = (is_ordinary
+				   && shndx != elfcpp::SHN_UNDEF
+				   && !object->is_section_included(shndx)
+				   && !symtab->is_section_folded(object, shndx));
+	      is_trivial = Scan::local_is_trivial(r_type, lsym, is_discarded);
+	    }
+	}
+      else
+	{
+	  Symbol* gsym = object->global_symbol(r_sym);
+	  gold_assert(gsym != NULL);
+	  // Leave forwarders to scan_relocs, which resolves them.
+	  is_trivial = (!gsym->is_forwarder()
+			&& Scan::global_is_trivial(r_type, gsym));
+	}
+
+      if (!is_trivial)
+	deferred->insert(deferred->end(), prelocs, prelocs + reloc_size);
+    }
+}
+
 // Behavior for relocations to discarded comdat sections.
 
 enum Comdat_behavior
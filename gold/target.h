@@ -310,6 +310,11 @@ class Target
   can_check_for_function_pointers() const
   { return this->do_can_check_for_function_pointers(); }
 
+  // Return whether this target implements Sized_target::prescan_relocs.
+  bool
+  can_prescan_relocs() const
+  { return this->do_can_prescan_relocs(); }
+
   // Return whether a relocation to a merged section can be processed
   // to retrieve the contents.
   bool
@@ -663,6 +668,11 @@ class Target
   do_can_check_for_function_pointers() const
   { return false; }
 
+  // Virtual function which may be overridden by the child class.
+  virtual bool
+  do_can_prescan_relocs() const
+  { return false; }
+
   // Virtual function which may be overridden by the child class.  We
   // recognize some default sections for which we don't care whether
   // they have function pointers.
@@ -917,6 +927,26 @@ class Sized_target : public Target
 	      size_t local_symbol_count,
 	      const unsigned char* plocal_symbols) = 0;
 
+  // Prescan the relocs for a section.  This is called for all objects
+  // in parallel, with no locks held, before any scan_relocs call, so
+  // it must not change anything.  Copy to *DEFERRED each reloc which
+  // scan_relocs needs to see; the others must be relocs for which
+  // scan_relocs would do nothing, such as PC-relative relocs against
+  // locally defined symbols.  Return false if scan_relocs should see
+  // all the relocs.  The parameters are like scan_relocs.  This is
+  // only called if can_prescan_relocs returns true, and never for
+  // sections which need special offset handling.
+  virtual bool
+  prescan_relocs(Symbol_table*,
+		 Sized_relobj_file<size, big_endian>*,
+		 unsigned int /* sh_type */,
+		 const unsigned char* /* prelocs */,
+		 size_t /* reloc_count */,
+		 size_t /* local_symbol_count */,
+		 const unsigned char* /* plocal_symbols */,
+		 std::vector<unsigned char>* /* deferred */)
+  { gold_unreachable(); }
+
   // Relocate section data.  SH_TYPE is the type of the relocation
   // section, SHT_REL or SHT_RELA.  PRELOCS points to the relocation
   // information.  RELOC_COUNT is the number of relocs.
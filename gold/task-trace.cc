@@ -0,0 +1,339 @@
+// task-trace.cc -- record a timeline of task execution
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/time.h>
+
+#ifdef ENABLE_THREADS
+#include <pthread.h>
+#endif
+
+#include "workqueue.h"
+#include "task-trace.h"
+
+namespace gold
+{
+
+// A single event in the trace.
+
+struct Task_trace_event
+{
+  // The Chrome trace event phase: 'X' for a complete event, 'b' and
+  // 'e' for the beginning and end of an asynchronous event.
+  char phase;
+  // The event category.
+  const char* category;
+  // The time of the event, or the start time for a complete event.
+  uint64_t ts;
+  // The duration of a complete event.
+  uint64_t dur;
+  // The ID of an asynchronous event.
+  const void* id;
+  // The event name.
+  std::string name;
+};
+
+// The events recorded by a single thread.
+
+class Task_trace_buffer
+{
+ public:
+  Task_trace_buffer(int index)
+    : index_(index), thread_number_(-1), events_()
+  { }
+
+  // Add an event.
+  void
+  add(char phase, const char* category, uint64_t ts, uint64_t dur,
+      const void* id, const std::string& name)
+  {
+    this->events_.push_back(Task_trace_event());
+    Task_trace_event& e(this->events_.back());
+    e.phase = phase;
+    e.category = category;
+    e.ts = ts;
+    e.dur = dur;
+    e.id = id;
+    e.name = name;
+  }
+
+  // Note the workqueue thread number of this thread.
+  void
+  set_thread_number(int thread_number)
+  { this->thread_number_ = thread_number; }
+
+  // The thread ID to use in the trace.  We use the workqueue thread
+  // number, so that the trace matches --debug=task.  Threads which
+  // never ran a task get numbers which are not used by the workqueue.
+  int
+  tid() const
+  {
+    if (this->thread_number_ >= 0)
+      return this->thread_number_;
+    return 10000 + this->index_;
+  }
+
+  // Write out the events, each preceded by a comma and a newline if
+  // *PFIRST is false.
+  void
+  write(FILE*, uint64_t start, bool* pfirst) const;
+
+ private:
+  // The order in which this buffer was created.
+  int index_;
+  // The workqueue thread number, or -1 if not known.
+  int thread_number_;
+  // The events.
+  std::vector<Task_trace_event> events_;
+};
+
+// Write NAME to FILE as a JSON string.
+
+static void
+write_json_string(FILE* file, const std::string& name)
+{
+  putc('"', file);
+  for (std::string::const_iterator p = name.begin(); p != name.end(); ++p)
+    {
+      unsigned char c = *p;
+      if (c == '"' || c == '\\')
+	{
+	  putc('\\', file);
+	  putc(c, file);
+	}
+      else if (c < 0x20)
+	fprintf(file, "\\u%04x", c);
+      else
+	putc(c, file);
+    }
+  putc('"', file);
+}
+
+// Write out the events of a buffer.
+
+void
+Task_trace_buffer::write(FILE* file, uint64_t start, bool* pfirst) const
+{
+  int tid = this->tid();
+  for (std::vector<Task_trace_event>::const_iterator p =
+	 this->events_.begin();
+       p != this->events_.end();
+       ++p)
+    {
+      if (!*pfirst)
+	fputs(",\n", file);
+      *pfirst = false;
+
+      fputs("{\"name\":", file);
+      write_json_string(file, p->name);
+      fprintf(file, ",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,"
+	      "\"ts\":%llu",
+	      p->category, p->phase, tid,
+	      static_cast<unsigned long long>(p->ts - start));
+      if (p->phase == 'X')
+	fprintf(file, ",\"dur\":%llu",
+		static_cast<unsigned long long>(p->dur));
+      else
+	fprintf(file, ",\"id\":\"%p\"", p->id);
+      putc('}', file);
+    }
+
+  if (this->thread_number_ >= 0)
+    {
+      if (!*pfirst)
+	fputs(",\n", file);
+      *pfirst = false;
+      fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+	      "\"tid\":%d,\"args\":{\"name\":\"gold thread %d\"}}",
+	      tid, this->thread_number_);
+    }
+}
+
+// Class Task_trace.
+
+#ifdef ENABLE_THREADS
+
+// The key used to find the buffer of the current thread.  There is
+// only ever one Task_trace, so this does not need to be a member.
+
+static pthread_key_t task_trace_key;
+
+#else
+
+// Without threads there is only one buffer.
+
+static Task_trace_buffer* task_trace_single_buffer;
+
+#endif
+
+Task_trace::Task_trace()
+  : file_(NULL), start_(Task_trace::now()), lock_(), buffers_()
+{
+#ifdef ENABLE_THREADS
+  int err = pthread_key_create(&task_trace_key, NULL);
+  if (err != 0)
+    gold_fatal(_("pthread_key_create failed: %s"), strerror(err));
+#endif
+}
+
+Task_trace::~Task_trace()
+{
+  for (std::vector<Task_trace_buffer*>::iterator p = this->buffers_.begin();
+       p != this->buffers_.end();
+       ++p)
+    delete *p;
+}
+
+// Open the trace file.
+
+bool
+Task_trace::open(const char* filename)
+{
+  this->file_ = ::fopen(filename, "w");
+  if (this->file_ == NULL)
+    {
+      gold_error(_("cannot open task trace file %s: %s"), filename,
+		 strerror(errno));
+      return false;
+    }
+  return true;
+}
+
+// Return the current time in microseconds.
+
+uint64_t
+Task_trace::now()
+{
+  struct timeval tv;
+  ::gettimeofday(&tv, NULL);
+  return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+// Return the buffer for the current thread, creating it if this is
+// the first event the thread records.
+
+Task_trace_buffer*
+Task_trace::buffer()
+{
+#ifdef ENABLE_THREADS
+  void* p = pthread_getspecific(task_trace_key);
+  if (p != NULL)
+    return static_cast<Task_trace_buffer*>(p);
+#else
+  if (task_trace_single_buffer != NULL)
+    return task_trace_single_buffer;
+#endif
+
+  Task_trace_buffer* buffer;
+  {
+    Hold_lock hl(this->lock_);
+    buffer = new Task_trace_buffer(this->buffers_.size());
+    this->buffers_.push_back(buffer);
+  }
+
+#ifdef ENABLE_THREADS
+  int err = pthread_setspecific(task_trace_key, buffer);
+  if (err != 0)
+    gold_fatal(_("pthread_setspecific failed: %s"), strerror(err));
+#else
+  task_trace_single_buffer = buffer;
+#endif
+
+  return buffer;
+}
+
+// Note that TASK is about to run.
+
+uint64_t
+Task_trace::task_start(Task* task)
+{
+  // Compute the name now, as it may not be possible after the task
+  // has run.
+  task->name();
+  return Task_trace::now();
+}
+
+// Record that TASK ran.
+
+void
+Task_trace::task_end(int thread_number, Task* task, uint64_t start)
+{
+  uint64_t end = Task_trace::now();
+  Task_trace_buffer* buffer = this->buffer();
+  buffer->set_thread_number(thread_number);
+  buffer->add('X', "task", start, end - start, NULL, task->name());
+}
+
+// Record that TASK started waiting for a token.
+
+void
+Task_trace::wait_begin(Task* task, bool is_blocker)
+{
+  this->buffer()->add('b', is_blocker ? "blocker wait" : "lock wait",
+		      Task_trace::now(), 0, task, task->name());
+}
+
+// Record that TASK stopped waiting for a token.
+
+void
+Task_trace::wait_end(Task* task, bool is_blocker)
+{
+  this->buffer()->add('e', is_blocker ? "blocker wait" : "lock wait",
+		      Task_trace::now(), 0, task, task->name());
+}
+
+// Record a wait for a file lock.
+
+void
+Task_trace::file_lock_wait(const std::string& name, uint64_t start,
+			   uint64_t end)
+{
+  this->buffer()->add('X', "file lock wait", start, end - start, NULL, name);
+}
+
+// Write out the trace.  This is called after all tasks have run, so
+// no thread is adding events.
+
+void
+Task_trace::close()
+{
+  if (this->file_ == NULL)
+    return;
+
+  fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", this->file_);
+  bool first = true;
+  for (std::vector<Task_trace_buffer*>::const_iterator p =
+	 this->buffers_.begin();
+       p != this->buffers_.end();
+       ++p)
+    (*p)->write(this->file_, this->start_, &first);
+  fputs("\n]}\n", this->file_);
+
+  if (::fclose(this->file_) != 0)
+    gold_error(_("cannot close task trace file: %s"), strerror(errno));
+  this->file_ = NULL;
+}
+
+} // End namespace gold.
@@ -0,0 +1,111 @@
+// task-trace.h -- record a timeline of task execution  -*- C++ -*-
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_TASK_TRACE_H
+#define GOLD_TASK_TRACE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "gold-threads.h"
+
+namespace gold
+{
+
+class Task;
+class Task_trace_buffer;
+
+// Task_trace records when each Task runs, on which thread, and how
+// long Tasks wait for Task_tokens and for file locks.  This is used
+// for --trace-tasks.  The result is written in the Chrome trace event
+// JSON format, which can be loaded into chrome://tracing or Perfetto.
+
+// Each thread records events into its own buffer, so recording an
+// event does not take a lock.  The buffers are only combined when the
+// trace is written.
+
+class Task_trace
+{
+ public:
+  Task_trace();
+
+  ~Task_trace();
+
+  // Open FILENAME for the trace.  Return false if it can not be
+  // opened, after issuing an error.
+  bool
+  open(const char* filename);
+
+  // Return the current time in microseconds.
+  static uint64_t
+  now();
+
+  // Note that TASK is about to run.  Return the start time to pass
+  // to task_end.
+  uint64_t
+  task_start(Task* task);
+
+  // Record that TASK, which started at START, has finished running on
+  // thread THREAD_NUMBER.
+  void
+  task_end(int thread_number, Task* task, uint64_t start);
+
+  // Record that TASK started waiting for a Task_token.  IS_BLOCKER is
+  // true if the token is a blocker, false if it is a lock.
+  void
+  wait_begin(Task* task, bool is_blocker);
+
+  // Record that TASK stopped waiting for a Task_token.  IS_BLOCKER
+  // must be the same as for wait_begin.
+  void
+  wait_end(Task* task, bool is_blocker);
+
+  // Record that the current thread waited from START to END for the
+  // lock of the file NAME.
+  void
+  file_lock_wait(const std::string& name, uint64_t start, uint64_t end);
+
+  // Write out the trace and close the file.
+  void
+  close();
+
+ private:
+  Task_trace(const Task_trace&);
+  Task_trace& operator=(const Task_trace&);
+
+  // Return the buffer for the current thread.
+  Task_trace_buffer*
+  buffer();
+
+  // The trace file.
+  FILE* file_;
+  // The time at which the trace started.
+  uint64_t start_;
+  // Lock controlling access to buffers_.
+  Lock lock_;
+  // All the buffers, in the order the threads first recorded an event.
+  std::vector<Task_trace_buffer*> buffers_;
+};
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_TASK_TRACE_H)
@@ -0,0 +1,61 @@
+#!/bin/sh
+
+# archive_group_test.sh -- test archive member selection in groups.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# See archive_group_test_main.c.  Every member of the chain must have
+# been included, and the member defining w, which is only referenced
+# weakly, must not have been.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected symbol in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected symbol in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+for sym in a1 a2 a3 b1 b2; do
+    check archive_group_test.stdout " T $sym\$"
+done
+check archive_group_test.stdout " w w\$"
+check_missing archive_group_test.stdout "w_member_included"
+check_missing archive_group_test.stdout " T w\$"
+
+exit 0
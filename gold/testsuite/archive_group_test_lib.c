@@ -0,0 +1,57 @@
+/* archive_group_test_lib.c -- archive members for archive_group_test
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This file is compiled once for each archive member, with one of
+   the macros below defined.  See archive_group_test_main.c.  */
+
+#if defined (A1)
+
+extern int b1 (void);
+int a1 (void) { return b1 () + 1; }
+
+#elif defined (A2)
+
+extern int b2 (void);
+int a2 (void) { return b2 () + 1; }
+
+#elif defined (A3)
+
+int a3 (void) { return 1; }
+
+#elif defined (W)
+
+int w_member_included;
+int w (void) { return w_member_included; }
+
+#elif defined (B1)
+
+extern int a2 (void);
+int b1 (void) { return a2 () + 1; }
+
+#elif defined (B2)
+
+extern int a3 (void);
+extern int w (void) __attribute__ ((weak));
+int b2 (void) { return a3 () + 1 + (w ? w () : 0); }
+
+#else
+#error "no archive member selected"
+#endif
@@ -0,0 +1,44 @@
+/* archive_group_test_main.c -- test archive member selection in groups
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   The program is linked with --start-group libarchive_group_test_1.a
+   libarchive_group_test_2.a --end-group.  Each member of one archive
+   calls a member of the other, so that the members are only found by
+   passing over the group several times:
+
+     a1 (archive 1) -> b1 (archive 2) -> a2 (archive 1)
+       -> b2 (archive 2) -> a3 (archive 1)
+
+   Both this file and b2 have a weak reference to w, which is defined
+   in archive 1.  That member must not be included.  */
+
+extern int a1 (void);
+extern int w (void) __attribute__ ((weak));
+
+int
+main (void)
+{
+  if (a1 () != 5)
+    return 1;
+  if (w)
+    return 2;
+  return 0;
+}
@@ -0,0 +1,54 @@
+#!/bin/sh
+
+# build_id_fast_test.sh -- test --build-id=fast
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# build_id_fast_test_1 and build_id_fast_test_2 are the same link with
+# and without threads, so they must have the same 128-bit build ID.
+# build_id_fast_test_3 has compressed debug sections, so its chunks are
+# only hashed once the file is complete.
+
+get_build_id()
+{
+    id=`grep 'Build ID:' $1 | sed -e 's/.*Build ID: *//'`
+    if ! echo "$id" | grep -q '^[0-9a-f]\{32\}$'; then
+	echo "bad or missing 128-bit build ID in $1"
+	cat $1
+	exit 1
+    fi
+    echo $id
+}
+
+id1=`get_build_id build_id_fast_test_1.stdout` || { echo "$id1"; exit 1; }
+id2=`get_build_id build_id_fast_test_2.stdout` || { echo "$id2"; exit 1; }
+id3=`get_build_id build_id_fast_test_3.stdout` || { echo "$id3"; exit 1; }
+
+if test "$id1" != "$id2"; then
+    echo "build IDs differ with and without threads: $id1 $id2"
+    exit 1
+fi
+
+if test "$id1" = "$id3"; then
+    echo "build ID did not change with compressed debug sections: $id3"
+    exit 1
+fi
+
+exit 0
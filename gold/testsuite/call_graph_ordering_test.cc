@@ -0,0 +1,66 @@
+// call_graph_ordering_test.cc -- a test case for gold
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The goal of this program is to verify that --call-graph-ordering-file
+// places each function after its hottest caller, that it finds static
+// functions, and that it places the functions which are not in the
+// call graph last.  The functions are defined in the reverse of the
+// expected order.
+
+extern "C"
+{
+
+int func_e()
+{
+  return 5;
+}
+
+static int func_s()
+{
+  return 6;
+}
+
+int func_c()
+{
+  return func_s() + 1;
+}
+
+int func_d()
+{
+  return 2;
+}
+
+int func_a()
+{
+  return func_d() + 3;
+}
+
+int func_b()
+{
+  return func_a() + 4;
+}
+
+}
+
+int main()
+{
+  return func_b() + func_c() + func_e() == 0;
+}
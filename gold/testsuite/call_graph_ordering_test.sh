@@ -0,0 +1,72 @@
+#!/bin/sh
+
+# call_graph_ordering_test.sh -- test --call-graph-ordering-file
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The goal of this program is to verify that --call-graph-ordering-file
+# orders the functions of call_graph_ordering_test.cc by the call graph
+# in call_graph_ordering_test.prof, including the static function
+# func_s, and that func_e, which is not in the call graph, comes after
+# them.  The linker should warn about no_such_function.
+
+set -e
+
+check()
+{
+    awk "
+BEGIN { saw1 = 0; saw2 = 0; err = 0; }
+/ [Tt] $2\$/ { saw1 = 1; }
+/ [Tt] $3\$/ {
+     saw2 = 1;
+     if (!saw1)
+       {
+	  printf \"layout of $2 and $3 is not right\\n\";
+	  err = 1;
+	  exit 1;
+       }
+    }
+END {
+      if (!saw1 && !err)
+        {
+	  printf \"did not see $2\\n\";
+	  exit 1;
+	}
+      if (!saw2 && !err)
+	{
+	  printf \"did not see $3\\n\";
+	  exit 1;
+	}
+    }" $1
+}
+
+check call_graph_ordering_test.stdout "main" "func_b"
+check call_graph_ordering_test.stdout "func_b" "func_a"
+check call_graph_ordering_test.stdout "func_a" "func_d"
+check call_graph_ordering_test.stdout "func_d" "func_c"
+check call_graph_ordering_test.stdout "func_c" "func_s"
+check call_graph_ordering_test.stdout "func_s" "func_e"
+
+if ! grep -q "no function named no_such_function" call_graph_ordering_test.err
+then
+    echo "missing warning about no_such_function"
+    cat call_graph_ordering_test.err
+    exit 1
+fi
@@ -0,0 +1,70 @@
+#!/bin/sh
+
+# dwp_test_3.sh -- Test the dwp tool with multiple threads and --stats.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output:"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_num()
+{
+    n=$(grep -c "$2" "$1")
+    if test "$n" -ne "$3"
+    then
+	echo "Found $n occurrences (should find $3):"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+# Reading the input files on several threads must not change the output.
+if ! cmp -s dwp_test_1.dwp dwp_test_3.dwp
+then
+    echo "dwp_test_3.dwp differs from dwp_test_1.dwp"
+    exit 1
+fi
+
+STATS="dwp_test_3.err"
+
+check $STATS "input files: 4$"
+
+# With -v, dwp prints the name of each input file as it adds it.
+check_num $STATS "^dwp_test_main.dwo$" 1
+check_num $STATS "^dwp_test_1.dwo$" 1
+check_num $STATS "^dwp_test_1b.dwo$" 1
+check_num $STATS "^dwp_test_2.dwo$" 1
+check $STATS "compilation units: 4$"
+check $STATS "type units: 9$"
+check $STATS "duplicate type units: 6$"
+check $STATS "bytes deduplicated by type signature: [1-9]"
@@ -0,0 +1,77 @@
+#!/bin/sh
+
+# flagstest_compress_debug_sections_zstd.sh -- test
+# --compress-debug-sections=zstd.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The readelf and objdump built with gold can not decompress zstd
+# sections.  So we use them to check the section headers of a program
+# linked with --compress-debug-sections=zstd, and we check the
+# contents by linking a zstd compressed relocatable object again
+# without compression, and comparing the DWARF with that of a program
+# linked from the original object.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+# readelf -t prints the type of each compressed section.  Versions
+# which do not know about zstd print "[<unknown>: 0x2]".
+check flagstest_compress_debug_sections_zstd.stdout "COMPRESSED"
+check flagstest_compress_debug_sections_zstd.stdout "ZSTD\|<unknown>: 0x2"
+check_missing flagstest_compress_debug_sections_zstd.stdout "ZLIB"
+check_missing flagstest_compress_debug_sections_zstd.stdout "\.zdebug_"
+
+# objdump must still be able to read the section headers.
+check flagstest_compress_debug_sections_zstd.objdump "\.debug_info"
+
+if ! cmp -s flagstest_compress_debug_sections_zstd_rt.stdout \
+	flagstest_compress_debug_sections_none.stdout
+then
+    echo "DWARF differs after decompressing zstd sections:"
+    diff -u flagstest_compress_debug_sections_none.stdout \
+	flagstest_compress_debug_sections_zstd_rt.stdout
+    exit 1
+fi
+
+exit 0
@@ -40,3 +40,6 @@ check()
 check gc_comdat_test.stdout "foo()"
 check gc_comdat_test.stdout "bar()"
 check gc_comdat_test.stdout "int GetMax<int>(int, int)"
+check gc_comdat_test_threads.stdout "foo()"
+check gc_comdat_test_threads.stdout "bar()"
+check gc_comdat_test_threads.stdout "int GetMax<int>(int, int)"
@@ -0,0 +1,79 @@
+#!/bin/sh
+
+# huge_page_test.sh -- test --huge-page-size
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The goal of this program is to verify that --huge-page-size puts the
+# read-only and executable PT_LOAD segments at huge page aligned
+# addresses and file offsets, and that it does not change where the
+# sections named in the section ordering file are placed.  With
+# --call-graph-ordering-file the functions in the call graph, which are
+# the hot ones, must come first in .text, ahead of the startup code, so
+# that they start near the huge page aligned start of the segment.
+
+set -e
+
+huge=2097152
+
+check_before()
+{
+    awk "
+BEGIN { saw1 = 0; }
+/.*$2\$/ { saw1 = 1; }
+/.*$3\$/ {
+     if (!saw1)
+       {
+	  printf \"$2 is not laid out before $3\\n\";
+	  exit 1;
+       }
+     exit 0;
+    }" $1
+}
+
+nload=0
+for seg in `grep ' LOAD ' huge_page_test_readelf.stdout | grep -v 'RW' | awk '{ print $2 ":" $3 ":" $NF; }'`
+do
+    off=`echo $seg | cut -d: -f1`
+    addr=`echo $seg | cut -d: -f2`
+    align=`echo $seg | cut -d: -f3`
+    if test $(($off % $huge)) -ne 0 -o $(($addr % $huge)) -ne 0 \
+	 -o $(($align)) -ne $huge; then
+	echo "segment at offset $off address $addr align $align not huge page aligned"
+	cat huge_page_test_readelf.stdout
+	exit 1
+    fi
+    nload=$(($nload + 1))
+done
+
+if test $nload -lt 2; then
+    echo "expected separate read-only and executable segments"
+    cat huge_page_test_readelf.stdout
+    exit 1
+fi
+
+check_before huge_page_test.stdout " main" " _Z3bazv"
+
+check_before huge_page_cg_test.stdout " main" " _start"
+check_before huge_page_cg_test.stdout " func_d" " _start"
+check_before huge_page_cg_test.stdout " func_s" " _start"
+check_before huge_page_cg_test.stdout " func_s" " func_e"
+
+exit 0
@@ -46,3 +46,4 @@ END {
 }
 
 check icf_test.map "folded_func" "kept_func"
+check icf_test_threads.map "folded_func" "kept_func"
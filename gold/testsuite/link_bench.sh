@@ -0,0 +1,297 @@
+#!/bin/sh
+
+# link_bench.sh -- a synthetic benchmark of large links
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This is not a test; it is run by "make bench", not by "make check".
+# It generates a large synthetic x86_64 program and links it as a PIE
+# with several combinations of options, writing the --stats-json
+# output of each link to $BENCH_DIR/results.  A summary is printed at
+# the end, and is also written to $BENCH_DIR/results/summary.txt.
+
+# Each generated object has functions in their own sections, a
+# function which no one calls (for --gc-sections), a function which is
+# identical in every object (for --icf), a number of COMDAT groups
+# shared with other objects, data which needs dynamic relocations in a
+# PIE, and DWARF debugging information whose .debug_str is mostly
+# shared with other objects.  The objects are put into archives, and
+# every object calls a function in another archive.
+
+# To compare zstd with zlib for compressed debug sections, the zdebug
+# and zstd links write compressed debug sections; their output sizes
+# give the compression ratio.  The read-zlib and read-zstd links read
+# one relocatable object holding the whole program, with its debug
+# sections compressed with zlib or zstd, and time decompression.  The
+# zstd links are skipped if gold was built without zstd support.
+
+# The inputs are only generated again if the parameters change.  These
+# environment variables control the benchmark:
+
+LD=${LD:-../ld-new}
+CC=${CC:-gcc}
+AR=${AR:-ar}
+# The directory holding the inputs and results.
+BENCH_DIR=${BENCH_DIR:-link_bench.dir}
+# The number of generated objects.
+BENCH_OBJECTS=${BENCH_OBJECTS:-20000}
+# The number of objects in each archive.
+BENCH_ARCHIVE_MEMBERS=${BENCH_ARCHIVE_MEMBERS:-100}
+# The number of distinct COMDAT groups, and how many each object has.
+BENCH_COMDATS=${BENCH_COMDATS:-2000}
+BENCH_COMDATS_PER_OBJECT=${BENCH_COMDATS_PER_OBJECT:-20}
+# The number of type names each object has in .debug_str.
+BENCH_DEBUG_TYPES=${BENCH_DEBUG_TYPES:-50}
+# The thread counts to link with; 1 means --no-threads.
+BENCH_THREADS=${BENCH_THREADS:-"1 4"}
+# The number of compiler jobs used to assemble the objects.
+BENCH_JOBS=${BENCH_JOBS:-4}
+# Extra options passed to every link.
+BENCH_LDFLAGS=${BENCH_LDFLAGS:-}
+
+params="$BENCH_OBJECTS $BENCH_ARCHIVE_MEMBERS $BENCH_COMDATS"
+params="$params $BENCH_COMDATS_PER_OBJECT $BENCH_DEBUG_TYPES"
+
+generate()
+{
+    echo "generating $BENCH_OBJECTS objects in $BENCH_DIR"
+    rm -rf "$BENCH_DIR"
+    mkdir -p "$BENCH_DIR/src" "$BENCH_DIR/results" || exit 1
+
+    awk -v n="$BENCH_OBJECTS" -v members="$BENCH_ARCHIVE_MEMBERS" \
+	-v ncomdats="$BENCH_COMDATS" -v comdats="$BENCH_COMDATS_PER_OBJECT" \
+	-v types="$BENCH_DEBUG_TYPES" -v dir="$BENCH_DIR/src" '
+function section(name, flags)
+{
+    printf("\t.section\t%s,\"%s\",@progbits\n", name, flags) > f;
+}
+function func(name, body)
+{
+    section(".text." name, "ax");
+    printf("\t.globl\t%s\n\t.type\t%s, @function\n%s:\n%s\tret\n", \
+	   name, name, name, body) > f;
+    printf("\t.size\t%s, .-%s\n", name, name) > f;
+}
+BEGIN {
+    for (i = 0; i < n; i++) {
+	f = sprintf("%s/bench_%d.s", dir, i);
+	next_obj = (i * 7919 + members) % n;
+	calls = sprintf("\tsubq\t$8, %%rsp\n\tcall\tf_%d@PLT\n", next_obj);
+	if (i % 10 < 8 && i + 1 < n)
+	    calls = calls "\tcall\tf_" (i + 1) "@PLT\n";
+	calls = calls "\tcall\tident_" i "@PLT\n";
+	calls = calls "\tleaq\t.Lptrs(%rip), %rax\n";
+	for (k = 0; k < comdats; k++) {
+	    c[k] = (i * 31 + k * 97) % ncomdats;
+	    if (k < 4)
+		calls = calls "\tcall\tcomdat_" c[k] "@PLT\n";
+	}
+	calls = calls "\taddq\t$8, %rsp\n";
+	func("f_" i, calls);
+	func("ident_" i, "\tmovl\t$42, %eax\n");
+	func("unused_" i, "\tmovl\t$" i ", %eax\n");
+	for (k = 0; k < comdats; k++) {
+	    name = "comdat_" c[k];
+	    printf("\t.section\t.text.%s,\"axG\",@progbits,%s,comdat\n", \
+		   name, name) > f;
+	    printf("\t.weak\t%s\n\t.type\t%s, @function\n", name, name) > f;
+	    printf("%s:\n\tmovl\t$%d, %%eax\n\tret\n", name, c[k]) > f;
+	    printf("\t.size\t%s, .-%s\n", name, name) > f;
+	}
+
+	section(".data.rel.ptrs_" i, "aw");
+	printf("\t.align\t8\n.Lptrs:\n\t.quad\tf_%d\n\t.quad\tident_%d\n", \
+	       i, i) > f;
+	printf("\t.quad\tf_%d\n", next_obj) > f;
+	for (k = 0; k < comdats; k++)
+	    printf("\t.quad\tcomdat_%d\n", c[k]) > f;
+
+	printf("\t.section\t.debug_abbrev,\"\",@progbits\n") > f;
+	printf(".Ldebug_abbrev0:\n") > f;
+	# 1: DW_TAG_compile_unit, with DW_AT_producer, DW_AT_name and
+	# DW_AT_comp_dir as DW_FORM_strp.
+	printf("\t.uleb128\t1\n\t.uleb128\t0x11\n\t.byte\t1\n") > f;
+	printf("\t.uleb128\t0x25\n\t.uleb128\t0xe\n") > f;
+	printf("\t.uleb128\t0x3\n\t.uleb128\t0xe\n") > f;
+	printf("\t.uleb128\t0x1b\n\t.uleb128\t0xe\n\t.byte\t0, 0\n") > f;
+	# 2: DW_TAG_subprogram, with DW_AT_name and DW_AT_low_pc.
+	printf("\t.uleb128\t2\n\t.uleb128\t0x2e\n\t.byte\t0\n") > f;
+	printf("\t.uleb128\t0x3\n\t.uleb128\t0xe\n") > f;
+	printf("\t.uleb128\t0x11\n\t.uleb128\t0x1\n\t.byte\t0, 0\n") > f;
+	# 3: DW_TAG_structure_type, with DW_AT_name.
+	printf("\t.uleb128\t3\n\t.uleb128\t0x13\n\t.byte\t0\n") > f;
+	printf("\t.uleb128\t0x3\n\t.uleb128\t0xe\n\t.byte\t0, 0\n") > f;
+	printf("\t.byte\t0\n") > f;
+
+	printf("\t.section\t.debug_info,\"\",@progbits\n") > f;
+	printf("\t.long\t.Ldebug_info_end - .Ldebug_info_start\n") > f;
+	printf(".Ldebug_info_start:\n\t.value\t4\n") > f;
+	printf("\t.long\t.Ldebug_abbrev0\n\t.byte\t8\n") > f;
+	printf("\t.uleb128\t1\n\t.long\t.LASF_producer\n") > f;
+	printf("\t.long\t.LASF_name\n\t.long\t.LASF_dir\n") > f;
+	split("f_ ident_ unused_", fns, " ");
+	for (k = 1; k <= 3; k++)
+	    printf("\t.uleb128\t2\n\t.long\t.LASF_%s\n\t.quad\t%s%d\n", \
+		   fns[k], fns[k], i) > f;
+	for (k = 0; k < types; k++)
+	    printf("\t.uleb128\t3\n\t.long\t.LASF_type%d\n", k) > f;
+	printf("\t.byte\t0\n.Ldebug_info_end:\n") > f;
+
+	printf("\t.section\t.debug_str,\"MS\",@progbits,1\n") > f;
+	printf(".LASF_producer:\n\t.string\t\"GNU C++17 synthetic -g -O2") > f;
+	printf(" -ffunction-sections -fdata-sections\"\n") > f;
+	printf(".LASF_name:\n\t.string\t\"src/module_%d/bench_%d.cc\"\n", \
+	       int(i / members), i) > f;
+	printf(".LASF_dir:\n\t.string\t\"/build/synthetic/link-bench\"\n") > f;
+	for (k = 1; k <= 3; k++)
+	    printf(".LASF_%s:\n\t.string\t\"%s%d\"\n", fns[k], fns[k], i) > f;
+	for (k = 0; k < types; k++) {
+	    t = (i * 13 + k * 7) % (types * 40);
+	    printf(".LASF_type%d:\n\t.string\t\"bench::detail::", k) > f;
+	    printf("type_%d<std::basic_string<char, ", t) > f;
+	    printf("std::char_traits<char>, std::allocator<char> > >\"\n") > f;
+	}
+	printf("\t.section\t.note.GNU-stack,\"\",@progbits\n") > f;
+	close(f);
+    }
+
+    # The entry point calls every tenth object, and the calls between
+    # objects pull in most of the rest, so that most archive members
+    # are loaded.
+    f = dir "/main.s";
+    printf("\t.text\n\t.globl\t_start\n\t.type\t_start, @function\n") > f;
+    printf("_start:\n\tsubq\t$8, %%rsp\n") > f;
+    for (i = 0; i < n; i += 10)
+	printf("\tcall\tf_%d@PLT\n", i) > f;
+    printf("\tmovl\t$60, %%eax\n\txorl\t%%edi, %%edi\n\tsyscall\n") > f;
+    printf("\t.section\t.note.GNU-stack,\"\",@progbits\n") > f;
+    close(f);
+}' || exit 1
+
+    echo "assembling"
+    (cd "$BENCH_DIR/src" \
+     && ls | xargs -n 100 -P "$BENCH_JOBS" $CC -c) || exit 1
+
+    echo "creating archives"
+    i=0
+    a=0
+    while test $i -lt "$BENCH_OBJECTS"; do
+	members=`awk -v s=$i -v m="$BENCH_ARCHIVE_MEMBERS" \
+		     -v n="$BENCH_OBJECTS" \
+		     'BEGIN { for (j = s; j < s + m && j < n; j++)
+				printf("bench_%d.o ", j) }'`
+	(cd "$BENCH_DIR/src" && $AR rc ../libbench_$a.a $members) || exit 1
+	i=`expr $i + $BENCH_ARCHIVE_MEMBERS`
+	a=`expr $a + 1`
+    done
+    mv "$BENCH_DIR/src/main.o" "$BENCH_DIR/main.o" || exit 1
+    rm -f "$BENCH_DIR"/src/*.o
+    echo "$params" > "$BENCH_DIR/params"
+}
+
+if test ! -f "$BENCH_DIR/params" \
+   || test "`cat "$BENCH_DIR/params"`" != "$params"; then
+    generate
+fi
+
+cd "$BENCH_DIR" || exit 1
+case "$LD" in
+/*) ;;
+*) LD=../$LD ;;
+esac
+mkdir -p results
+rm -f results/*.json results/summary.txt
+
+# Print the value of the counter NAME in the --stats-json file FILE.
+# This relies on gold writing one phase or counter per line.
+
+counter()
+{
+    sed -n -e "s/^ \"$2\":\([0-9]*\).*/\1/p" "$1"
+}
+
+phase()
+{
+    sed -n -e "s/^ \"$2\":{.*\"$3\":\([0-9]*\).*/\1/p" "$1"
+}
+
+configs="base gc icf zdebug"
+read_configs="read-zlib"
+if $LD -r -o zstd_probe.o --compress-debug-sections=zstd main.o \
+       > /dev/null 2>&1; then
+    configs="$configs zstd"
+    read_configs="$read_configs read-zstd"
+else
+    echo "gold was built without zstd support; skipping the zstd links"
+fi
+rm -f zstd_probe.o
+configs="$configs all $read_configs"
+
+# Build the relocatable objects read by the read-* links.
+for config in $read_configs; do
+    compress=`echo $config | sed -e 's/^read-//'`
+    if test ! -f $config.o; then
+	if ! $LD -r -o $config.o --compress-debug-sections=$compress \
+		--whole-archive libbench_*.a --no-whole-archive; then
+	    echo "link failed: $config.o"
+	    exit 1
+	fi
+    fi
+done
+
+printf "%-10s %7s %9s %9s %9s %10s %12s\n" config threads user_ms sys_ms \
+       wall_ms rss_kib output_bytes | tee results/summary.txt
+
+status=0
+for threads in $BENCH_THREADS; do
+    if test "$threads" = 1; then
+	thread_flags="--no-threads"
+    else
+	thread_flags="--threads --thread-count=$threads"
+    fi
+    for config in $configs; do
+	inputs="--start-group libbench_*.a --end-group"
+	case $config in
+	base) flags= ;;
+	gc) flags="--gc-sections" ;;
+	icf) flags="--icf=all" ;;
+	zdebug) flags="--compress-debug-sections=zlib" ;;
+	zstd) flags="--compress-debug-sections=zstd" ;;
+	all) flags="--gc-sections --icf=all --compress-debug-sections=zlib" ;;
+	read-*) flags= ; inputs=$config.o ;;
+	esac
+	json=results/$config-t$threads.json
+	if ! $LD -pie -e _start -o bench.out $thread_flags $flags \
+		$BENCH_LDFLAGS --stats-json=$json \
+		main.o $inputs; then
+	    echo "link failed: $config with $threads threads"
+	    status=1
+	    continue
+	fi
+	printf "%-10s %7s %9s %9s %9s %10s %12s\n" $config $threads \
+	       "`phase $json total user_ms`" "`phase $json total sys_ms`" \
+	       "`phase $json total wall_ms`" \
+	       "`counter $json 'peak resident set size in KiB'`" \
+	       "`counter $json 'output file size'`" | tee -a results/summary.txt
+    done
+done
+rm -f bench.out
+
+exit $status
@@ -0,0 +1,125 @@
+// parallel_sort_unittest.cc -- test Parallel_sort
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <utility>
+#include <vector>
+
+#include "parallel-sort.h"
+
+#include "test.h"
+
+namespace gold_testsuite
+{
+
+using namespace gold;
+
+// The elements are a key and the original position.  Only the key is
+// compared, so that we can check that equal keys stay in order.
+
+typedef std::pair<unsigned int, unsigned int> Element;
+typedef std::vector<Element> Element_list;
+
+struct Element_compare
+{
+  bool
+  operator()(const Element& e1, const Element& e2) const
+  { return e1.first < e2.first; }
+};
+
+// Append each merged element to a list.
+
+struct Append_element
+{
+  Append_element(Element_list* a_list)
+    : list(a_list)
+  { }
+
+  void
+  operator()(Element_list::const_iterator p)
+  { this->list->push_back(*p); }
+
+  Element_list* list;
+};
+
+// Sort SIZE elements with keys less than MAX_KEY in COUNT chunks, and
+// check that the result is the same as std::stable_sort.
+
+static void
+check_sort(size_t size, unsigned int max_key, unsigned int count)
+{
+  Element_list elements;
+  unsigned int seed = 12345 + size + max_key + count;
+  for (size_t i = 0; i < size; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      elements.push_back(std::make_pair((seed >> 8) % max_key, i));
+    }
+
+  Element_list expected(elements);
+  std::stable_sort(expected.begin(), expected.end(), Element_compare());
+
+  Parallel_sort<Element, Element_compare> sort(&elements, Element_compare(),
+					       count);
+  CHECK(sort.chunk_start(0) == 0);
+  CHECK(sort.chunk_start(count) == size);
+  for (unsigned int i = 0; i < count; ++i)
+    sort.sort_chunk(i);
+  sort.split_into_buckets();
+
+  // Merge the buckets in reverse order, to check that each bucket
+  // can be written out independently.
+  Element_list result(size);
+  for (unsigned int i = count; i > 0; --i)
+    {
+      Element_list bucket;
+      Append_element append(&bucket);
+      sort.merge_bucket(i - 1, append);
+      CHECK(bucket.size() == sort.bucket_size(i - 1));
+      std::copy(bucket.begin(), bucket.end(),
+		result.begin() + sort.bucket_start(i - 1));
+    }
+
+  CHECK(result == expected);
+}
+
+bool
+Parallel_sort_test(Test_report*)
+{
+  static const size_t sizes[] = { 0, 1, 2, 7, 100, 1000, 65537 };
+  static const unsigned int max_keys[] = { 1, 3, 50, 1000000 };
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    for (size_t j = 0; j < sizeof(max_keys) / sizeof(max_keys[0]); ++j)
+      for (unsigned int count = 1; count <= 9; ++count)
+	check_sort(sizes[i], max_keys[j], count);
+
+  CHECK(parallel_sort_chunk_count(0, 8) == 1);
+  CHECK(parallel_sort_chunk_count(100000, 0) == 1);
+  CHECK(parallel_sort_chunk_count(100000, 4) == 4);
+  CHECK(parallel_sort_chunk_count(100000, 64) == 100000 / 16384);
+
+  return true;
+}
+
+Register_test parallel_sort_register("Parallel_sort", Parallel_sort_test);
+
+} // End namespace gold_testsuite.
@@ -52,6 +52,10 @@ struct sym_info
 static struct claimed_file* first_claimed_file = NULL;
 static struct claimed_file* last_claimed_file = NULL;
 
+/* Protects the list of claimed files if the claim file hook may be
+   called concurrently.  */
+static int claimed_file_lock = 0;
+
 static ld_plugin_register_claim_file register_claim_file_hook = NULL;
 static ld_plugin_register_all_symbols_read register_all_symbols_read_hook = NULL;
 static ld_plugin_register_cleanup register_cleanup_hook = NULL;
@@ -70,6 +74,7 @@ static ld_plugin_get_input_section_contents get_input_section_contents = NULL;
 static ld_plugin_update_section_order update_section_order = NULL;
 static ld_plugin_allow_section_ordering allow_section_ordering = NULL;
 static ld_plugin_get_wrap_symbols get_wrap_symbols = NULL;
+static ld_plugin_get_api_version get_api_version = NULL;
 
 #define MAXOPTS 10
 
@@ -163,6 +168,9 @@ onload(struct ld_plugin_tv *tv)
 	case LDPT_GET_WRAP_SYMBOLS:
 	  get_wrap_symbols = *entry->tv_u.tv_get_wrap_symbols;
 	  break;
+	case LDPT_GET_API_VERSION:
+	  get_api_version = *entry->tv_u.tv_get_api_version;
+	  break;
         default:
           break;
         }
@@ -196,7 +204,29 @@ onload(struct ld_plugin_tv *tv)
   (*message)(LDPL_INFO, "gold version:  %d", gold_version);
 
   for (i = 0; i < nopts; ++i)
-    (*message)(LDPL_INFO, "option: %s", opts[i]);
+    {
+      (*message)(LDPL_INFO, "option: %s", opts[i]);
+      if (strcmp(opts[i], "concurrent-claim-file") == 0)
+	{
+	  const char* linker_identifier;
+	  const char* linker_version;
+
+	  if (get_api_version == NULL)
+	    {
+	      fprintf(stderr, "tv_get_api_version interface missing\n");
+	      return LDPS_ERR;
+	    }
+	  if ((*get_api_version)("plugin_test", "1.0", LAPI_V0, LAPI_V1,
+				 &linker_identifier, &linker_version)
+	      != LAPI_V1)
+	    {
+	      (*message)(LDPL_ERROR, "error negotiating API version");
+	      return LDPS_ERR;
+	    }
+	  (*message)(LDPL_INFO, "API level 1 negotiated with %s %s",
+		     linker_identifier, linker_version);
+	}
+    }
 
   if ((*register_claim_file_hook)(claim_file_hook) != LDPS_OK)
     {
@@ -423,11 +453,14 @@ claim_file_hook (const struct ld_plugin_input_file* file, int* claimed)
   claimed_file->nsyms = nsyms;
   claimed_file->syms = syms;
   claimed_file->next = NULL;
+  while (__sync_lock_test_and_set(&claimed_file_lock, 1))
+    ;
   if (last_claimed_file == NULL)
     first_claimed_file = claimed_file;
   else
     last_claimed_file->next = claimed_file;
   last_claimed_file = claimed_file;
+  __sync_lock_release(&claimed_file_lock);
 
   (*message)(LDPL_INFO, "%s: claiming file, adding %d symbols",
              file->name, nsyms);
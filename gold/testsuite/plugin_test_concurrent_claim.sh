@@ -0,0 +1,57 @@
+#!/bin/sh
+
+# plugin_test_concurrent_claim.sh -- test concurrent plugin claim_file calls.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with plugin_test.c, a simple plug-in library that
+# exercises the basic interfaces and prints out version numbers and
+# options passed to the plugin.  Here the plugin negotiates LAPI_V1,
+# which allows the linker to call its claim_file handler concurrently,
+# and the link uses several threads.  The files must be claimed and resolved as in plugin_test_1.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check plugin_test_concurrent_claim.err "option: concurrent-claim-file"
+check plugin_test_concurrent_claim.err "API level 1 negotiated with GNU gold"
+check plugin_test_concurrent_claim.err "two_file_test_main.o: claim file hook called"
+check plugin_test_concurrent_claim.err "two_file_test_1.o.syms: claiming file, adding 38 symbols"
+check plugin_test_concurrent_claim.err "two_file_test_1b.o.syms: claiming file"
+check plugin_test_concurrent_claim.err "two_file_test_2.o.syms: claiming file"
+check plugin_test_concurrent_claim.err "two_file_test_1.o.syms: _Z4f13iv: PREVAILING_DEF_IRONLY"
+check plugin_test_concurrent_claim.err "two_file_test_1.o.syms: _Z2t2v: PREVAILING_DEF_REG"
+check plugin_test_concurrent_claim.err "two_file_test_2.o.syms: _Z4f13iv: PREEMPTED_IR"
+check plugin_test_concurrent_claim.err "two_file_test_1.o: adding new input file"
+check plugin_test_concurrent_claim.err "two_file_test_1b.o: adding new input file"
+check plugin_test_concurrent_claim.err "two_file_test_2.o: adding new input file"
+check plugin_test_concurrent_claim.err "cleanup hook called"
+
+exit 0
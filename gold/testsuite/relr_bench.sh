@@ -0,0 +1,129 @@
+#!/bin/sh
+
+# relr_bench.sh -- measure the effect of -z pack-relative-relocs
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This is not a test; it is run by "make relr-bench", not by "make
+# check".  It generates a PIE with many pointers in its data, which
+# need RELATIVE relocations, and links it with and without
+# -z pack-relative-relocs.  For each link it prints the sizes of
+# .rela.dyn, .relr.dyn and the output file, and the startup time of
+# the program.  The startup time is the smallest "total startup time
+# in dynamic loader" reported by LD_DEBUG=statistics over
+# $BENCH_RUNS runs, with the part spent on relocation; these are
+# counted in CPU cycles, and need the GNU dynamic linker.
+
+# These environment variables control the benchmark:
+
+CC=${CC:-gcc}
+READELF=${READELF:-readelf}
+# The directory holding the "ld" to use, passed to $CC with -B.
+LD_DIR=${LD_DIR:-gcctestdir}
+# The directory holding the inputs and results.
+BENCH_DIR=${BENCH_DIR:-relr_bench.dir}
+# The number of pointers, and how many of them are followed by a hole
+# of unrelocated data; holes make the SHT_RELR encoding less dense.
+BENCH_POINTERS=${BENCH_POINTERS:-200000}
+BENCH_HOLE_EVERY=${BENCH_HOLE_EVERY:-100}
+# The number of times each program is run.
+BENCH_RUNS=${BENCH_RUNS:-20}
+
+case "$LD_DIR" in
+/*) ;;
+*) LD_DIR=`pwd`/$LD_DIR ;;
+esac
+
+rm -rf "$BENCH_DIR"
+mkdir -p "$BENCH_DIR" || exit 1
+cd "$BENCH_DIR" || exit 1
+
+awk -v n="$BENCH_POINTERS" -v hole="$BENCH_HOLE_EVERY" 'BEGIN {
+    printf("static int a[1024];\n");
+    printf("int* ptrs[] = {\n");
+    for (i = 0; i < n; i++) {
+	printf("  &a[%d],\n", i % 1024);
+	if (hole > 0 && i % hole == hole - 1)
+	    printf("  0, 0, 0, 0, 0, 0, 0, 0,\n");
+    }
+    printf("};\n");
+    printf("int main() { return ptrs[0] != &a[0]; }\n");
+}' > relr_bench.c || exit 1
+
+if ! $CC -c -O2 -fpie -o relr_bench.o relr_bench.c; then
+    echo "compile failed"
+    exit 1
+fi
+
+# Print the size in bytes of section NAME of FILE, or 0.
+
+section_size()
+{
+    hex=`$READELF -SW "$1" | awk -v name="$2" '
+$0 ~ /^ *\[/ {
+    sub(/^ *\[ *[0-9]+\] */, "");
+    if ($1 == name) { print $5; exit }
+}'`
+    printf "%d\n" 0x${hex:-0}
+}
+
+# Print the smallest value of the LD_DEBUG=statistics line matching
+# PATTERN over $BENCH_RUNS runs of PROGRAM.
+
+startup_cycles()
+{
+    i=0
+    while test $i -lt "$BENCH_RUNS"; do
+	LD_DEBUG=statistics ./$1 2>&1 | \
+	    sed -n -e "s/.*$2: *\([0-9,]*\) cycles.*/\1/p" | tr -d ,
+	i=`expr $i + 1`
+    done | sort -n | head -1
+}
+
+printf "%-6s %10s %10s %12s %14s %14s\n" relr rela_dyn relr_dyn \
+       output_bytes startup_cycles reloc_cycles | tee results.txt
+
+status=0
+for relr in no yes; do
+    case $relr in
+    no) flags= ;;
+    yes) flags=-Wl,-z,pack-relative-relocs ;;
+    esac
+    prog=relr_bench_$relr
+    if ! $CC -B"$LD_DIR"/ -pie -o $prog $flags relr_bench.o; then
+	echo "link failed: $prog"
+	status=1
+	continue
+    fi
+    if ! ./$prog; then
+	echo "run failed: $prog"
+	status=1
+	continue
+    fi
+    printf "%-6s %10s %10s %12s %14s %14s\n" $relr \
+	   "`section_size $prog .rela.dyn`" \
+	   "`section_size $prog .relr.dyn`" \
+	   "`wc -c < $prog | tr -d ' '`" \
+	   "`startup_cycles $prog 'total startup time in dynamic loader'`" \
+	   "`startup_cycles $prog 'time needed for relocation'`" \
+	| tee -a results.txt
+done
+
+exit $status
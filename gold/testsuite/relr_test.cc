@@ -0,0 +1,68 @@
+// relr_test.cc -- a test case for gold
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The goal of this program is to verify that -z pack-relative-relocs
+// produces a working position independent executable.  The pointers
+// are spread out so that the SHT_RELR section needs both address and
+// bitmap entries, and one pointer is not aligned, so that its reloc
+// must stay in the dynamic reloc section.
+
+static int a[100];
+
+int* near_ptrs[] = { &a[0], &a[1], &a[3], &a[5], &a[20], &a[42], 0, &a[2] };
+
+int* gap[200];
+
+int* far_ptrs[] = { &a[7], &a[99] };
+
+struct __attribute__((packed))
+{
+  char c;
+  int* p;
+} unaligned = { 1, &a[9] };
+
+const char* strings[] = { "hello", "world" };
+
+int
+main()
+{
+  static const int near_offsets[] = { 0, 1, 3, 5, 20, 42, -1, 2 };
+  for (int i = 0; i < 8; ++i)
+    {
+      if (near_offsets[i] < 0)
+	{
+	  if (near_ptrs[i] != 0)
+	    return 1;
+	}
+      else if (near_ptrs[i] != &a[near_offsets[i]])
+	return 1;
+    }
+  for (int i = 0; i < 200; ++i)
+    if (gap[i] != 0)
+      return 2;
+  if (far_ptrs[0] != &a[7] || far_ptrs[1] != &a[99])
+    return 3;
+  if (unaligned.p != &a[9])
+    return 4;
+  if (strings[0][0] != 'h' || strings[1][0] != 'w')
+    return 5;
+  return 0;
+}
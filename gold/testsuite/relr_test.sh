@@ -0,0 +1,74 @@
+#!/bin/sh
+
+# relr_test.sh -- test -z pack-relative-relocs
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# The goal of this program is to verify that -z pack-relative-relocs
+# creates a SHT_RELR section and the dynamic tags which describe it,
+# along with a reference to the GLIBC_ABI_DT_RELR version, and that
+# the resulting program runs.  If the C library does not define
+# GLIBC_ABI_DT_RELR, the linker must warn and not use DT_RELR.  The
+# shared library relr_test_nolibc.so is linked without a C library,
+# to test that case everywhere.
+
+set -e
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check relr_test.stdout "\.relr\.dyn"
+# Older versions of readelf do not know the names of the tags.
+if grep -q "^ *0x0*24 " relr_test.stdout
+then
+    check relr_test.stdout "^ *0x0*23 "
+    check relr_test.stdout "^ *0x0*25 "
+    check relr_test.stdout "GLIBC_ABI_DT_RELR"
+else
+    check relr_test.err "GLIBC_ABI_DT_RELR"
+fi
+
+./relr_test
+
+check relr_test_nolibc.err "ignoring -z pack-relative-relocs"
+check_missing relr_test_nolibc.stdout "^ *0x0*24 "
+check_missing relr_test_nolibc.stdout "GLIBC_ABI_DT_RELR"
+check relr_test_nolibc.stdout "RELATIVE"
+
+exit 0
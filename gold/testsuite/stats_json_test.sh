@@ -0,0 +1,76 @@
+#!/bin/sh
+
+# stats_json_test.sh -- test --stats-json
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# stats_json_test.json is written by --stats-json.  Check that it has
+# the run time of each phase and the counters printed by --stats.
+
+file=stats_json_test.json
+
+check()
+{
+    if ! grep -q -e "$2" "$1"; then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_count()
+{
+    if test "`grep -c -e "$2" "$1"`" != "$3"; then
+	echo "Expected $3 matches of $2 in $1:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check $file '^{"version":1,$'
+for phase in "initial tasks" "middle tasks" "final tasks" "total"; do
+    check $file "^ \"$phase\":{\"user_ms\":[0-9]*,\"sys_ms\":[0-9]*,\"wall_ms\":[0-9]*}"
+done
+check $file '^ "output file size":\[[1-9][0-9]*\],$'
+check $file '^ "symbol table entries":\[[1-9][0-9]*\],$'
+check $file '^ "total bytes mapped for read":\[[1-9][0-9]*\],$'
+check $file '^ "section name pool entries":\[[1-9][0-9]*\],$'
+check $file '^ "symbol table hash memory":\[[1-9][0-9]*\],$'
+check $file '^ "symbol GOT and PLT memory":\[[0-9]*\],$'
+check $file '^ "Free_list::allocate nodes visited":\[[0-9]*\]}}$'
+
+# Each counter is only written once, as an array of the values
+# recorded for it.  A counter reported for several sections with the
+# same name, like merged .rodata string sections with different entry
+# sizes, has one value for each of them.
+check_count $file '^ "total free lists":' 1
+check_count $file '^ ".debug_str merged strings input bytes":' 1
+check_count $file '^ ".rodata merged strings input bytes":' 1
+check $file '^ ".rodata merged strings input bytes":\[[0-9]*\(,[0-9]*\)*\],$'
+if grep -q -e '^ "[^"]*":[0-9]' $file; then
+    echo "Found a counter which is not an array in $file:"
+    cat $file
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,280 @@
+// stringpool_bench.cc -- time Stringpool operations
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This is not run by "make check".  Build it with
+// "make stringpool_bench" and run it as
+//   stringpool_bench [-r REPEAT] [-n COUNT | FILE]
+// FILE holds one name per line, for example the output of
+//   nm -P --defined-only LIBS | cut -d' ' -f1
+// Without FILE, COUNT names which look like mangled C++ symbols are
+// generated, about a third of them distinct.  Each operation is run
+// REPEAT times on a fresh Stringpool and the best user time is
+// printed.  Times come from gold's Timer, which counts clock ticks, so
+// use enough names that each operation takes a good part of a second.
+
+#include "gold.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "stringpool.h"
+#include "timer.h"
+
+using namespace gold;
+
+namespace
+{
+
+// Generate COUNT names.  The same seed always gives the same names.
+
+void
+generate_names(size_t count, std::vector<std::string>* names)
+{
+  static const char* const words[] =
+  {
+    "gold", "Output_section", "Symbol_table", "add", "Sized_relobj_file",
+    "do_layout", "Stringpool_template", "get_offset", "Layout",
+    "Relocate_info", "elfcpp", "Shdr", "std", "vector", "allocator",
+    "basic_string", "char_traits", "do_read_symbols", "Task_token"
+  };
+  const size_t nwords = sizeof words / sizeof words[0];
+
+  size_t distinct = count / 3 + 1;
+  unsigned int seed = 1;
+  names->reserve(count);
+  for (size_t i = 0; i < count; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      unsigned int n = (seed >> 8) % distinct;
+      std::string name("_ZN");
+      unsigned int v = n;
+      for (int j = 0; j < 4; ++j)
+	{
+	  const char* w = words[v % nwords];
+	  v /= nwords;
+	  char buf[20];
+	  snprintf(buf, sizeof buf, "%u",
+		   static_cast<unsigned int>(strlen(w)));
+	  name += buf;
+	  name += w;
+	}
+      char buf[30];
+      snprintf(buf, sizeof buf, "%uEv", n);
+      name += buf;
+      names->push_back(name);
+    }
+}
+
+// Read one name per line from FILENAME.
+
+bool
+read_names(const char* filename, std::vector<std::string>* names)
+{
+  FILE* f = fopen(filename, "r");
+  if (f == NULL)
+    return false;
+  char buf[4096];
+  while (fgets(buf, sizeof buf, f) != NULL)
+    {
+      size_t len = strlen(buf);
+      while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == '\r'))
+	--len;
+      if (len > 0)
+	names->push_back(std::string(buf, len));
+    }
+  fclose(f);
+  return true;
+}
+
+// The operations we time.
+
+enum Operation
+{
+  // Add every name, copying it.
+  OP_ADD,
+  // Add every name to a pool which already holds them all.
+  OP_ADD_EXISTING,
+  // Find every name.
+  OP_FIND,
+  // Lay out the string table.
+  OP_SET_OFFSETS,
+  // Get the offset of every name.
+  OP_GET_OFFSET
+};
+
+struct Operation_name
+{
+  Operation op;
+  const char* name;
+};
+
+const Operation_name operations[] =
+{
+  { OP_ADD, "add (copy)" },
+  { OP_ADD_EXISTING, "add, already present" },
+  { OP_FIND, "find" },
+  { OP_SET_OFFSETS, "set_string_offsets" },
+  { OP_GET_OFFSET, "get_offset" }
+};
+
+// Run OP once on NAMES and return the elapsed user time in
+// milliseconds.  Set *CHECKSUM from the results, so that the work can
+// not be optimized away and so that runs can be compared.
+
+long
+run(Operation op, const std::vector<std::string>& names,
+    unsigned long* checksum)
+{
+  Stringpool pool;
+  Stringpool::Key key;
+  unsigned long sum = 0;
+  size_t count = names.size();
+
+  if (op != OP_ADD)
+    for (size_t i = 0; i < count; ++i)
+      pool.add_with_length(names[i].data(), names[i].length(), true, &key);
+  if (op == OP_GET_OFFSET)
+    pool.set_string_offsets();
+
+  Timer timer;
+  timer.start();
+  switch (op)
+    {
+    case OP_ADD:
+    case OP_ADD_EXISTING:
+      for (size_t i = 0; i < count; ++i)
+	{
+	  pool.add_with_length(names[i].data(), names[i].length(), true,
+			       &key);
+	  sum += key;
+	}
+      break;
+    case OP_FIND:
+      for (size_t i = 0; i < count; ++i)
+	if (pool.find(names[i].c_str(), &key) != NULL)
+	  sum += key;
+      break;
+    case OP_SET_OFFSETS:
+      pool.set_string_offsets();
+      sum = pool.get_strtab_size();
+      break;
+    case OP_GET_OFFSET:
+      for (size_t i = 0; i < count; ++i)
+	sum += pool.get_offset_with_length(names[i].data(),
+					   names[i].length());
+      break;
+    default:
+      gold_unreachable();
+    }
+  Timer::TimeStats elapsed = timer.get_elapsed_time();
+
+  *checksum = sum;
+  return elapsed.user;
+}
+
+void
+usage()
+{
+  fprintf(stderr, "Usage: %s [-r REPEAT] [-n COUNT | FILE]\n",
+	  program_name);
+  exit(EXIT_FAILURE);
+}
+
+} // End anonymous namespace.
+
+int
+main(int argc, char** argv)
+{
+  program_name = argv[0];
+
+  int repeat = 5;
+  size_t count = 1000000;
+  const char* filename = NULL;
+  for (int i = 1; i < argc; ++i)
+    {
+      if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+	repeat = atoi(argv[++i]);
+      else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+	count = strtoul(argv[++i], NULL, 10);
+      else if (argv[i][0] != '-' && filename == NULL)
+	filename = argv[i];
+      else
+	usage();
+    }
+  if (repeat < 1 || count == 0)
+    usage();
+
+  std::vector<std::string> names;
+  if (filename == NULL)
+    generate_names(count, &names);
+  else if (!read_names(filename, &names))
+    {
+      fprintf(stderr, "%s: %s: %s\n", program_name, filename,
+	      strerror(errno));
+      return EXIT_FAILURE;
+    }
+
+  // Count the distinct names and their average length.  Keys are
+  // handed out in order, so the largest key is the number of distinct
+  // names.
+  Stringpool pool;
+  Stringpool::Key key;
+  Stringpool::Key distinct = 0;
+  unsigned long long bytes = 0;
+  for (size_t i = 0; i < names.size(); ++i)
+    {
+      pool.add_with_length(names[i].data(), names[i].length(), false, &key);
+      if (key > distinct)
+	distinct = key;
+      bytes += names[i].length();
+    }
+  printf("%lu names, %lu distinct, %.1f bytes on average\n",
+	 static_cast<unsigned long>(names.size()),
+	 static_cast<unsigned long>(distinct),
+	 names.empty() ? 0.0 : static_cast<double>(bytes) / names.size());
+
+  for (size_t i = 0; i < sizeof operations / sizeof operations[0]; ++i)
+    {
+      long best = 0;
+      unsigned long checksum = 0;
+      for (int j = 0; j < repeat; ++j)
+	{
+	  unsigned long sum;
+	  long t = run(operations[i].op, names, &sum);
+	  if (j == 0 || t < best)
+	    best = t;
+	  if (j > 0 && sum != checksum)
+	    {
+	      fprintf(stderr, "%s: %s: results differ between runs\n",
+		      program_name, operations[i].name);
+	      return EXIT_FAILURE;
+	    }
+	  checksum = sum;
+	}
+      printf("%-22s %6ld ms\n", operations[i].name, best);
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+// stringpool_unittest.cc -- test Stringpool
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "stringpool.h"
+
+#include "test.h"
+
+namespace gold_testsuite
+{
+
+using namespace gold;
+
+// Check adding and finding strings, including enough of them to make
+// the hash table grow several times.
+
+bool
+Stringpool_add_test(Test_report*)
+{
+  Stringpool pool;
+  Stringpool::Key key;
+
+  const char* abc = pool.add("abc", true, &key);
+  CHECK(key == 1);
+  CHECK(strcmp(abc, "abc") == 0);
+
+  std::string abc2("abc");
+  CHECK(pool.add(abc2, true, &key) == abc);
+  CHECK(key == 1);
+
+  // A string which is not null terminated.
+  CHECK(pool.add_with_length("abcdef", 3, true, &key) == abc);
+  CHECK(key == 1);
+  const char* ab = pool.add_with_length("abcdef", 2, true, &key);
+  CHECK(key == 2);
+  CHECK(strcmp(ab, "ab") == 0);
+
+  // A string which is not copied.
+  static const char nocopy[] = "not copied";
+  CHECK(pool.add(nocopy, false, &key) == nocopy);
+  CHECK(key == 3);
+
+  CHECK(pool.find("abc", &key) == abc);
+  CHECK(key == 1);
+  CHECK(pool.find("abcd", NULL) == NULL);
+
+  std::vector<std::string> names;
+  std::vector<const char*> strings;
+  char buf[100];
+  for (int i = 0; i < 100000; ++i)
+    {
+      snprintf(buf, sizeof buf, "_ZN4gold%dsymbol_nameEv%d", i % 977, i);
+      names.push_back(buf);
+      strings.push_back(pool.add(buf, true, &key));
+      CHECK(key == static_cast<Stringpool::Key>(i) + 4);
+    }
+  for (int i = 0; i < 100000; ++i)
+    {
+      CHECK(pool.find(names[i].c_str(), &key) == strings[i]);
+      CHECK(key == static_cast<Stringpool::Key>(i) + 4);
+      CHECK(pool.add(names[i], true, NULL) == strings[i]);
+    }
+  CHECK(pool.find(abc2.c_str(), NULL) == abc);
+
+  return true;
+}
+
+// Check the string table, with and without suffix merging.
+
+bool
+Stringpool_strtab_test(Test_report*)
+{
+  Stringpool pool;
+  pool.add("abc", true, NULL);
+  pool.add("xyz", true, NULL);
+  pool.add("bc", true, NULL);
+  pool.add("", true, NULL);
+  pool.set_string_offsets();
+  CHECK(pool.get_strtab_size() == 12);
+  CHECK(pool.get_offset("abc") == 1);
+  CHECK(pool.get_offset("xyz") == 5);
+  CHECK(pool.get_offset("bc") == 9);
+  CHECK(pool.get_offset("") == 0);
+  CHECK(pool.get_offset_from_key(3) == 9);
+
+  unsigned char buffer[12];
+  pool.write_to_buffer(buffer, sizeof buffer);
+  CHECK(memcmp(buffer, "\0abc\0xyz\0bc\0", 12) == 0);
+
+  Stringpool opt;
+  opt.set_optimize();
+  opt.add("abc", true, NULL);
+  opt.add("xyz", true, NULL);
+  opt.add("bc", true, NULL);
+  opt.set_string_offsets();
+  CHECK(opt.get_strtab_size() == 9);
+  CHECK(opt.get_offset("bc") == opt.get_offset("abc") + 1);
+
+  // A pool of wide strings.
+  Stringpool_template<uint16_t> wide;
+  static const uint16_t w1[] = { 'a', 'b', 0 };
+  static const uint16_t w2[] = { 'a', 'b', 'c', 0 };
+  Stringpool_template<uint16_t>::Key key;
+  const uint16_t* p1 = wide.add(w1, true, &key);
+  CHECK(key == 1);
+  wide.add(w2, true, &key);
+  CHECK(key == 2);
+  CHECK(wide.add_with_length(w2, 2, true, &key) == p1);
+  CHECK(key == 1);
+  wide.set_string_offsets();
+  CHECK(wide.get_strtab_size() == 2 + 6 + 8);
+  CHECK(wide.get_offset(w2) == 8);
+
+  return true;
+}
+
+Register_test stringpool_add_register("Stringpool_add", Stringpool_add_test);
+Register_test stringpool_strtab_register("Stringpool_strtab",
+					 Stringpool_strtab_test);
+
+} // End namespace gold_testsuite.
@@ -0,0 +1,223 @@
+// workqueue_bench.cc -- time the Workqueue with different thread counts
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This is not run by "make check".  Build it with
+// "make workqueue_bench" and run it as
+//   workqueue_bench [-r REPEAT] [-n TASKS] [-w WORK] [-l LOCKS] [-t MAX]
+// It queues TASKS small tasks, each of which holds one of LOCKS write
+// lock Task_tokens and spins WORK times, and runs them with 1, 2, 4,
+// and so on up to MAX threads.  Each thread count is run REPEAT times
+// on a fresh Workqueue and the best wall clock time is printed, along
+// with the user and system time of that run.  Small values of WORK
+// measure the overhead of the Workqueue itself; large values show how
+// well real work scales.
+
+#include "gold.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "options.h"
+#include "parameters.h"
+#include "timer.h"
+#include "workqueue.h"
+
+using namespace gold;
+
+namespace
+{
+
+// Shared state for one run.
+
+struct Bench_state
+{
+  Bench_state(int lock_count, unsigned int work)
+    : writers(), work(work), ran(0)
+  {
+    for (int i = 0; i < lock_count; ++i)
+      this->writers.push_back(new Task_token(false));
+  }
+
+  ~Bench_state()
+  {
+    for (size_t i = 0; i < this->writers.size(); ++i)
+      delete this->writers[i];
+  }
+
+  // The write lock tokens.
+  std::vector<Task_token*> writers;
+  // The number of iterations each task spins.
+  unsigned int work;
+  // The number of tasks which have run.
+  int ran;
+};
+
+// A task which holds one write lock while it spins.
+
+class Bench_task : public Task
+{
+ public:
+  Bench_task(Bench_state* state, int index)
+    : state_(state), index_(index)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    Task_token* writer = this->writer();
+    if (!writer->is_writable())
+      return writer;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->writer()); }
+
+  void
+  run(Workqueue*)
+  {
+    volatile unsigned int sum = 0;
+    for (unsigned int i = 0; i < this->state_->work; ++i)
+      sum += i * this->index_;
+    __sync_fetch_and_add(&this->state_->ran, 1);
+  }
+
+  std::string
+  get_name() const
+  { return "Bench_task"; }
+
+ private:
+  Task_token*
+  writer() const
+  {
+    return this->state_->writers[this->index_
+				 % this->state_->writers.size()];
+  }
+
+  Bench_state* state_;
+  int index_;
+};
+
+// Run TASK_COUNT tasks with THREAD_COUNT threads and return the
+// elapsed time.
+
+Timer::TimeStats
+run(const General_options& options, int thread_count, int task_count,
+    int lock_count, unsigned int work)
+{
+  // The state must outlive the Workqueue, whose destructor waits for
+  // the worker threads.
+  Bench_state state(lock_count, work);
+  Workqueue workqueue(options);
+
+  Timer timer;
+  timer.start();
+
+  for (int i = 0; i < task_count; ++i)
+    workqueue.queue(new Bench_task(&state, i));
+  workqueue.set_thread_count(thread_count);
+  workqueue.process(0);
+
+  Timer::TimeStats elapsed = timer.get_elapsed_time();
+
+  if (state.ran != task_count)
+    {
+      fprintf(stderr, "%s: %d tasks ran, expected %d\n",
+	      program_name, state.ran, task_count);
+      exit(EXIT_FAILURE);
+    }
+  return elapsed;
+}
+
+void
+usage()
+{
+  fprintf(stderr,
+	  "Usage: %s [-r REPEAT] [-n TASKS] [-w WORK] [-l LOCKS] [-t MAX]\n",
+	  program_name);
+  exit(EXIT_FAILURE);
+}
+
+} // End anonymous namespace.
+
+int
+main(int argc, char** argv)
+{
+  program_name = argv[0];
+
+  int repeat = 3;
+  int task_count = 100000;
+  unsigned int work = 2000;
+  int lock_count = 64;
+  int max_threads = 128;
+  for (int i = 1; i < argc; ++i)
+    {
+      if (i + 1 >= argc)
+	usage();
+      if (strcmp(argv[i], "-r") == 0)
+	repeat = atoi(argv[++i]);
+      else if (strcmp(argv[i], "-n") == 0)
+	task_count = atoi(argv[++i]);
+      else if (strcmp(argv[i], "-w") == 0)
+	work = strtoul(argv[++i], NULL, 10);
+      else if (strcmp(argv[i], "-l") == 0)
+	lock_count = atoi(argv[++i]);
+      else if (strcmp(argv[i], "-t") == 0)
+	max_threads = atoi(argv[++i]);
+      else
+	usage();
+    }
+  if (repeat < 1 || task_count < 1 || lock_count < 1 || max_threads < 1)
+    usage();
+
+  // The Lock class needs the options to know whether threads are
+  // being used.
+  static const char* ld_argv[] = { "ld", "--threads" };
+  static Command_line command_line;
+  command_line.process(2, ld_argv);
+  set_parameters_options(&command_line.options());
+
+  printf("%d tasks, %u iterations each, %d locks\n",
+	 task_count, work, lock_count);
+  for (int thread_count = 1;
+       thread_count <= max_threads;
+       thread_count *= 2)
+    {
+      Timer::TimeStats best;
+      for (int j = 0; j < repeat; ++j)
+	{
+	  Timer::TimeStats t = run(command_line.options(), thread_count,
+				   task_count, lock_count, work);
+	  if (j == 0 || t.wall < best.wall)
+	    best = t;
+	}
+      printf("%3d threads: wall %ld.%03ld user %ld.%03ld sys %ld.%03ld\n",
+	     thread_count,
+	     best.wall / 1000, best.wall % 1000,
+	     best.user / 1000, best.user % 1000,
+	     best.sys / 1000, best.sys % 1000);
+    }
+
+  return EXIT_SUCCESS;
+}
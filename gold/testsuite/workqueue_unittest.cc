@@ -0,0 +1,298 @@
+// workqueue_unittest.cc -- stress test for the Workqueue.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This runs a large number of small tasks, using both blocker and
+// writer Task_tokens, with different numbers of threads.  It checks
+// that every task runs, that no two tasks hold the same write lock at
+// the same time, and that a task waiting on a blocker does not run
+// before the blocker is released.
+
+#include "gold.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "options.h"
+#include "parameters.h"
+#include "workqueue.h"
+
+#include "test.h"
+
+namespace gold_testsuite
+{
+
+using namespace gold;
+
+// The number of write lock tokens the tasks share.
+static const int writer_count = 16;
+
+// The number of tasks which start the test.  Each one queues two
+// children, down to depth tree_depth.
+static const int root_count = 1024;
+static const int tree_depth = 5;
+
+// Shared state for one run of the test.
+
+struct Stress_state
+{
+  Stress_state()
+    : start_blocker(true), done_blocker(true), writers(), owners(),
+      ran(0), overlaps(0), early(0), started(false), final_ran(false),
+      final_count(0)
+  {
+    for (int i = 0; i < writer_count; ++i)
+      {
+	this->writers.push_back(new Task_token(false));
+	this->owners.push_back(0);
+      }
+  }
+
+  ~Stress_state()
+  {
+    for (int i = 0; i < writer_count; ++i)
+      delete this->writers[i];
+  }
+
+  // Released when the start task has run.
+  Task_token start_blocker;
+  // Released when every stress task has run.
+  Task_token done_blocker;
+  // The write lock tokens.
+  std::vector<Task_token*> writers;
+  // Set while a task holds the corresponding write lock.
+  std::vector<int> owners;
+  // The number of stress tasks which have run.
+  int ran;
+  // The number of times a write lock was found to be held twice.
+  int overlaps;
+  // The number of tasks which ran before the start task.
+  int early;
+  // Set by the start task.
+  volatile bool started;
+  // Set by the final task.
+  bool final_ran;
+  // The value of ran seen by the final task.
+  int final_count;
+};
+
+// The task which releases start_blocker.
+
+class Start_task : public Task
+{
+ public:
+  Start_task(Stress_state* state)
+    : state_(state)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, &this->state_->start_blocker); }
+
+  void
+  run(Workqueue*)
+  {
+    __sync_synchronize();
+    this->state_->started = true;
+  }
+
+  std::string
+  get_name() const
+  { return "Start_task"; }
+
+ private:
+  Stress_state* state_;
+};
+
+// A stress task.  It holds one write lock and one blocker of
+// done_blocker, and queues two children.
+
+class Stress_task : public Task
+{
+ public:
+  Stress_task(Stress_state* state, int index, int depth)
+    : state_(state), index_(index), depth_(depth)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->state_->start_blocker.is_blocked())
+      return &this->state_->start_blocker;
+    Task_token* writer = this->writer();
+    if (!writer->is_writable())
+      return writer;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    tl->add(this, this->writer());
+    tl->add(this, &this->state_->done_blocker);
+  }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    Stress_state* state = this->state_;
+    int w = this->index_ % writer_count;
+
+    if (!state->started)
+      __sync_fetch_and_add(&state->early, 1);
+
+    if (__sync_lock_test_and_set(&state->owners[w], 1) != 0)
+      __sync_fetch_and_add(&state->overlaps, 1);
+
+    // Do a little work while holding the lock.
+    volatile unsigned int sum = 0;
+    for (unsigned int i = 0; i < 2000; ++i)
+      sum += i * this->index_;
+
+    __sync_lock_release(&state->owners[w]);
+
+    __sync_fetch_and_add(&state->ran, 1);
+
+    if (this->depth_ > 0)
+      {
+	// We hold a blocker of done_blocker, so it can not be
+	// released before the children add theirs.
+	for (int i = 0; i < 2; ++i)
+	  {
+	    workqueue->add_blocker(&state->done_blocker);
+	    Task* t = new Stress_task(state, this->index_ * 2 + i,
+				      this->depth_ - 1);
+	    if (i == 0)
+	      workqueue->queue_soon(t);
+	    else
+	      workqueue->queue(t);
+	  }
+      }
+  }
+
+  std::string
+  get_name() const
+  { return "Stress_task"; }
+
+ private:
+  Task_token*
+  writer() const
+  { return this->state_->writers[this->index_ % writer_count]; }
+
+  Stress_state* state_;
+  int index_;
+  int depth_;
+};
+
+// The task which runs after all the stress tasks.
+
+class Final_task : public Task
+{
+ public:
+  Final_task(Stress_state* state)
+    : state_(state)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->state_->done_blocker.is_blocked())
+      return &this->state_->done_blocker;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*)
+  {
+    this->state_->final_count = this->state_->ran;
+    this->state_->final_ran = true;
+  }
+
+  std::string
+  get_name() const
+  { return "Final_task"; }
+
+ private:
+  Stress_state* state_;
+};
+
+// Run the stress test with THREAD_COUNT threads.
+
+static bool
+Workqueue_stress(Test_report*, const General_options& options,
+		 int thread_count)
+{
+  // The state must outlive the Workqueue, whose destructor waits for
+  // the worker threads.
+  Stress_state state;
+  Workqueue workqueue(options);
+
+  state.start_blocker.add_blocker();
+  for (int i = 0; i < root_count; ++i)
+    state.done_blocker.add_blocker();
+
+  // Queue the final task first, so that it has to wait on
+  // done_blocker.
+  workqueue.queue(new Final_task(&state));
+  for (int i = 0; i < root_count; ++i)
+    workqueue.queue(new Stress_task(&state, i, tree_depth));
+  workqueue.queue(new Start_task(&state));
+
+  workqueue.set_thread_count(thread_count);
+  workqueue.process(0);
+
+  int expected = root_count * ((2 << tree_depth) - 1);
+  CHECK(state.ran == expected);
+  CHECK(state.final_ran);
+  CHECK(state.final_count == expected);
+  CHECK(state.overlaps == 0);
+  CHECK(state.early == 0);
+  CHECK(!state.done_blocker.is_blocked());
+
+  return true;
+}
+
+bool
+Workqueue_stress_test(Test_report* report)
+{
+  // The Lock class needs the options to know whether threads are
+  // being used.
+  static const char* argv[] = { "ld", "--threads" };
+  static Command_line command_line;
+  command_line.process(2, argv);
+  set_parameters_options(&command_line.options());
+
+  for (int thread_count = 1; thread_count <= 128; thread_count *= 2)
+    if (!Workqueue_stress(report, command_line.options(), thread_count))
+      return false;
+  return true;
+}
+
+Register_test workqueue_register("Workqueue", Workqueue_stress_test);
+
+} // End namespace gold_testsuite.
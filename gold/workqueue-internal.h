@@ -54,6 +54,11 @@ class Workqueue_threader
   virtual void
   set_thread_count(int) = 0;
 
+  // Return the number of threads we want to have running.  This is 1
+  // when not using threads.
+  virtual int
+  thread_count() = 0;
+
   // Return whether to cancel the current thread.
   virtual bool
   should_cancel_thread(int thread_number) = 0;
@@ -82,14 +87,17 @@ class Workqueue_threader_threadpool : public Workqueue_threader
   void
   set_thread_count(int);
 
+  // Return the thread count.
+  int
+  thread_count();
+
   // Return whether to cancel a thread.
   bool
   should_cancel_thread(int thread_number);
 
   // Process all tasks.  This keeps running until told to cancel.
   void
-  process(int thread_number)
-  { this->get_workqueue()->process(thread_number); }
+  process(int thread_number);
 
  private:
   // This is set if we need to check the thread count.
@@ -102,6 +110,11 @@ class Workqueue_threader_threadpool : public Workqueue_threader
   int desired_thread_count_;
   // The number of threads currently running.
   int threads_;
+  // The number of threads which have not yet returned from
+  // Workqueue::process.  The destructor waits for this to be zero.
+  int live_threads_;
+  // Signalled when live_threads_ becomes zero.
+  Condvar exit_condvar_;
 };
 
 } // End namespace gold.
@@ -132,7 +132,9 @@ Workqueue_threader_threadpool::Workqueue_threader_threadpool(
     check_thread_count_(0),
     lock_(),
     desired_thread_count_(1),
-    threads_(1)
+    threads_(1),
+    live_threads_(0),
+    exit_condvar_(this->lock_)
 {
 }
 
@@ -140,8 +142,13 @@ Workqueue_threader_threadpool::Workqueue_threader_threadpool(
 
 Workqueue_threader_threadpool::~Workqueue_threader_threadpool()
 {
-  // Tell the threads to exit.
+  // Tell the threads to exit, and wait until none of them is using
+  // the Workqueue.
   this->get_workqueue()->set_thread_count(0);
+
+  Hold_lock hl(this->lock_);
+  while (this->live_threads_ > 0)
+    this->exit_condvar_.wait();
 }
 
 // Set the thread count.
@@ -157,6 +164,8 @@ Workqueue_threader_threadpool::set_thread_count(int thread_count)
     create = this->desired_thread_count_ - this->threads_;
     if (create < 0)
       this->check_thread_count_ = 1;
+    else
+      this->live_threads_ += create;
   }
 
   if (create > 0)
@@ -171,6 +180,29 @@ Workqueue_threader_threadpool::set_thread_count(int thread_count)
     }
 }
 
+// Process tasks in a thread.
+
+void
+Workqueue_threader_threadpool::process(int thread_number)
+{
+  this->get_workqueue()->process(thread_number);
+
+  // This thread no longer uses the Workqueue.
+  Hold_lock hl(this->lock_);
+  --this->live_threads_;
+  if (this->live_threads_ == 0)
+    this->exit_condvar_.broadcast();
+}
+
+// Return the thread count.
+
+int
+Workqueue_threader_threadpool::thread_count()
+{
+  Hold_lock hl(this->lock_);
+  return this->desired_thread_count_;
+}
+
 // Return whether the current thread should be cancelled.
 
 bool
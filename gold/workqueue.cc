@@ -24,6 +24,8 @@
 
 #include "debug.h"
 #include "options.h"
+#include "parameters.h"
+#include "task-trace.h"
 #include "timer.h"
 #include "workqueue.h"
 #include "workqueue-internal.h"
@@ -94,6 +96,26 @@ Task_list::pop_front()
   return ret;
 }
 
+// With --trace-tasks, record that T has started waiting for TOKEN.
+
+static inline void
+trace_wait_begin(Task* t, Task_token* token)
+{
+  Task_trace* trace = parameters->task_trace();
+  if (trace != NULL)
+    trace->wait_begin(t, token->is_blocker());
+}
+
+// With --trace-tasks, record that T is no longer waiting for TOKEN.
+
+static inline void
+trace_wait_end(Task* t, Task_token* token)
+{
+  Task_trace* trace = parameters->task_trace();
+  if (trace != NULL)
+    trace->wait_end(t, token->is_blocker());
+}
+
 // The simple single-threaded implementation of Workqueue_threader.
 
 class Workqueue_threader_single : public Workqueue_threader
@@ -109,20 +131,43 @@ class Workqueue_threader_single : public Workqueue_threader
   set_thread_count(int thread_count)
   { gold_assert(thread_count > 0); }
 
+  int
+  thread_count()
+  { return 1; }
+
   bool
   should_cancel_thread(int)
   { return false; }
 };
 
+// A run queue for one thread.  The tasks on it have been made
+// runnable when the thread released the locks of a task it ran.  The
+// thread prefers these tasks, and other threads take them when they
+// have nothing else to do.  Whether a task is runnable depends on the
+// Task_tokens, which are controlled by the Workqueue lock, so the run
+// queues are controlled by that lock too.
+
+struct Workqueue_runqueue
+{
+  // Tasks to execute soon.
+  Task_list first_tasks;
+  // Tasks to execute after the ones in first_tasks.
+  Task_list tasks;
+};
+
 // Workqueue methods.
 
 Workqueue::Workqueue(const General_options& options)
   : lock_(),
-    first_tasks_(),
-    tasks_(),
+    runqueues_(),
+    runqueue_count_(0),
     running_(0),
     waiting_(0),
     condvar_(this->lock_),
+    queue_lock_(),
+    first_tasks_(),
+    tasks_(),
+    idle_(0),
     threader_(NULL)
 {
   bool threads = options.threads();
@@ -143,32 +188,38 @@ Workqueue::Workqueue(const General_options& options)
 
 Workqueue::~Workqueue()
 {
+  // This waits for any threads to stop using the Workqueue.
+  delete this->threader_;
+  for (std::vector<Workqueue_runqueue*>::iterator p = this->runqueues_.begin();
+       p != this->runqueues_.end();
+       ++p)
+    delete *p;
 }
 
-// Add a task to the end of a specific queue, or put it on the list
-// waiting for a Token.
+// Add a task to the end of a specific shared queue.  We don't check
+// whether the task is runnable here, as that requires the Workqueue
+// lock; that is done when the task is removed from the queue.
 
 void
 Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
 {
-  Hold_lock hl(this->lock_);
+  bool wake;
+  {
+    Hold_lock hl(this->queue_lock_);
+    if (front)
+      queue->push_front(t);
+    else
+      queue->push_back(t);
+    wake = this->idle_ > 0;
+  }
 
-  Task_token* token = t->is_runnable();
-  if (token != NULL)
-    {
-      if (front)
-	token->add_waiting_front(t);
-      else
-	token->add_waiting(t);
-      ++this->waiting_;
-    }
-  else
+  // Tell a waiting thread that there is work to do.  A thread only
+  // waits after checking, with both locks held, that the shared
+  // queues are empty, so we must hold the Workqueue lock to be sure
+  // that the signal is not lost.
+  if (wake)
     {
-      if (front)
-	queue->push_front(t);
-      else
-	queue->push_back(t);
-      // Tell any waiting thread that there is work to do.
+      Hold_lock hl(this->lock_);
       this->condvar_.signal();
     }
 }
@@ -207,15 +258,59 @@ Workqueue::should_cancel_thread(int thread_number)
   return this->threader_->should_cancel_thread(thread_number);
 }
 
+// Return the run queue for THREAD_NUMBER, creating it if necessary.
+// The workqueue lock must be held when this is called.
+
+Workqueue_runqueue*
+Workqueue::runqueue(int thread_number)
+{
+  gold_assert(thread_number >= 0);
+  size_t n = thread_number;
+  while (this->runqueues_.size() <= n)
+    this->runqueues_.push_back(new Workqueue_runqueue());
+  return this->runqueues_[n];
+}
+
+// Remove the first task from TASKS.  IS_SHARED is true for
+// first_tasks_ and tasks_, which need queue_lock_.  The workqueue
+// lock must be held when this is called.
+
+inline Task*
+Workqueue::pop_task(Task_list* tasks, bool is_shared)
+{
+  if (!is_shared)
+    {
+      Task* t = tasks->pop_front();
+      if (t != NULL)
+	--this->runqueue_count_;
+      return t;
+    }
+
+  Hold_lock hl(this->queue_lock_);
+  return tasks->pop_front();
+}
+
+// Return whether there are any tasks on the queues.  The workqueue
+// lock must be held when this is called.
+
+bool
+Workqueue::has_queued_tasks()
+{
+  if (this->runqueue_count_ > 0)
+    return true;
+  Hold_lock hl(this->queue_lock_);
+  return !this->first_tasks_.empty() || !this->tasks_.empty();
+}
+
 // Find a runnable task in TASKS.  Return NULL if none could be found.
 // If we find a Task waiting for a Token, add it to the list for that
 // Token.  The workqueue lock must be held when this is called.
 
 Task*
-Workqueue::find_runnable_in_list(Task_list* tasks)
+Workqueue::find_runnable_in_list(Task_list* tasks, bool is_shared)
 {
   Task* t;
-  while ((t = tasks->pop_front()) != NULL)
+  while ((t = this->pop_task(tasks, is_shared)) != NULL)
     {
       Task_token* token = t->is_runnable();
 
@@ -224,21 +319,63 @@ Workqueue::find_runnable_in_list(Task_list* tasks)
 
       token->add_waiting(t);
       ++this->waiting_;
+      trace_wait_begin(t, token);
     }
 
   // We couldn't find any runnable task.
   return NULL;
 }
 
+// Find a runnable task on the run queue of a thread other than
+// THREAD_NUMBER.  If SOON, look at the tasks to execute soon,
+// otherwise look at the others.  The workqueue lock must be held when
+// this is called.
+
+Task*
+Workqueue::steal_runnable(int thread_number, bool soon)
+{
+  if (this->runqueue_count_ == 0)
+    return NULL;
+
+  // Start with the next thread, so that all threads don't take tasks
+  // from the same one.
+  size_t n = this->runqueues_.size();
+  for (size_t i = 1; i < n; ++i)
+    {
+      Workqueue_runqueue* rq = this->runqueues_[(thread_number + i) % n];
+      Task* t = this->find_runnable_in_list(soon
+					    ? &rq->first_tasks
+					    : &rq->tasks,
+					    false);
+      if (t != NULL)
+	return t;
+    }
+  return NULL;
+}
+
 // Find a runnable task.  Return NULL if none could be found.  The
 // workqueue lock must be held when this is called.
 
+// Tasks to execute soon come before any others.  Within each group
+// we look first at the shared queue, then at our own run queue, then
+// at the run queues of the other threads.  Looking at the shared
+// queue first preserves the ordering described in return_or_queue.
+
 Task*
-Workqueue::find_runnable()
+Workqueue::find_runnable(int thread_number)
 {
-  Task* t = this->find_runnable_in_list(&this->first_tasks_);
+  Workqueue_runqueue* rq = this->runqueue(thread_number);
+  Task* t = this->find_runnable_in_list(&this->first_tasks_, true);
+  if (t == NULL)
+    t = this->find_runnable_in_list(&rq->first_tasks, false);
+  if (t == NULL)
+    t = this->steal_runnable(thread_number, true);
+  if (t == NULL)
+    t = this->find_runnable_in_list(&this->tasks_, true);
   if (t == NULL)
-    t = this->find_runnable_in_list(&this->tasks_);
+    t = this->find_runnable_in_list(&rq->tasks, false);
+  if (t == NULL)
+    t = this->steal_runnable(thread_number, false);
   return t;
 }
 
@@ -249,13 +386,17 @@ Workqueue::find_runnable()
 Task*
 Workqueue::find_runnable_or_wait(int thread_number)
 {
-  Task* t = this->find_runnable();
+  Task* t = this->find_runnable(thread_number);
 
   while (t == NULL)
     {
-      if (this->running_ == 0
-	  && this->first_tasks_.empty()
-	  && this->tasks_.empty())
+      // Every run queue is now empty, as find_runnable moved all the
+      // tasks which could not run to the tokens they are waiting for.
+      // The shared queues may have been filled by a running task
+      // since we looked at them.
+      gold_assert(this->runqueue_count_ == 0);
+
+      if (this->running_ == 0 && !this->has_queued_tasks())
 	{
 	  // Kick all the threads to make them exit.
 	  this->condvar_.broadcast();
@@ -267,13 +408,34 @@ Workqueue::find_runnable_or_wait(int thread_number)
       if (this->should_cancel_thread(thread_number))
 	return NULL;
 
+      // Note that we are going to wait, unless a task was added to
+      // the shared queues since we looked at them.
+      bool is_empty;
+      {
+	Hold_lock hl(this->queue_lock_);
+	is_empty = this->first_tasks_.empty() && this->tasks_.empty();
+	if (is_empty)
+	  ++this->idle_;
+      }
+
+      if (!is_empty)
+	{
+	  t = this->find_runnable(thread_number);
+	  continue;
+	}
+
       gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
 
       this->condvar_.wait();
 
+      {
+	Hold_lock hl(this->queue_lock_);
+	--this->idle_;
+      }
+
       gold_debug(DEBUG_TASK, "%3d awake", thread_number);
 
-      t = this->find_runnable();
+      t = this->find_runnable(thread_number);
     }
 
   return t;
@@ -316,8 +478,16 @@ Workqueue::find_and_run_task(int thread_number)
       if (is_debugging_enabled(DEBUG_TASK))
         timer.start();
 
+      Task_trace* trace = parameters->task_trace();
+      uint64_t trace_start = 0;
+      if (trace != NULL)
+	trace_start = trace->task_start(t);
+
       t->run(this);
 
+      if (trace != NULL)
+	trace->task_end(thread_number, t, trace_start);
+
       if (is_debugging_enabled(DEBUG_TASK))
         {
           Timer::TimeStats elapsed = timer.get_elapsed_time();
@@ -339,10 +509,10 @@ Workqueue::find_and_run_task(int thread_number)
 
 	// Release the locks for the task.  This must be done with the
 	// workqueue lock held.  Get the next Task to run if any.
-	next = this->release_locks(t, &tl);
+	next = this->release_locks(t, &tl, this->runqueue(thread_number));
 
 	if (next == NULL)
-	  next = this->find_runnable();
+	  next = this->find_runnable(thread_number);
 
 	// If we have another Task to run, get the Locks.  This must
 	// be called while we are still holding the Workqueue lock.
@@ -370,8 +540,8 @@ Workqueue::find_and_run_task(int thread_number)
 // 1) If T is not runnable, queue it on the appropriate token.
 
 // 2) Otherwise, T is runnable.  If *PRET is not NULL, then we have
-// already decided which Task to run next.  Add T to the list of
-// runnable tasks, and signal another thread.
+// already decided which Task to run next.  Add T to the run queue RQ
+// of this thread, and signal another thread.
 
 // 3) Otherwise, *PRET is NULL.  If IS_BLOCKER is false, then T was
 // waiting on a write lock.  We can grab that lock now, so we run T
@@ -394,7 +564,8 @@ Workqueue::find_and_run_task(int thread_number)
 // Return true if we set *PRET to T, false otherwise.
 
 bool
-Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
+Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret,
+			   Workqueue_runqueue* rq)
 {
   Task_token* token = t->is_runnable();
 
@@ -402,6 +573,7 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
     {
       token->add_waiting(t);
       ++this->waiting_;
+      trace_wait_begin(t, token);
       return false;
     }
 
@@ -414,7 +586,7 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
     should_return = true;
   else if (t->should_run_soon())
     should_return = true;
-  else if (!this->first_tasks_.empty() || !this->tasks_.empty())
+  else if (this->has_queued_tasks())
     should_queue = true;
   else
     should_return = true;
@@ -428,10 +600,12 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
   else if (should_queue)
     {
       if (t->should_run_soon())
-	this->first_tasks_.push_back(t);
+	rq->first_tasks.push_back(t);
       else
-	this->tasks_.push_back(t);
-      this->condvar_.signal();
+	rq->tasks.push_back(t);
+      ++this->runqueue_count_;
+      if (this->idle_ > 0)
+	this->condvar_.signal();
       return false;
     }
 
@@ -440,11 +614,11 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
 
 // Release the locks associated with a Task.  Return the first
 // runnable Task that we find.  If we find more runnable tasks, add
-// them to the run queue and signal any other threads.  This must be
-// called with the Workqueue lock held.
+// them to the run queue RQ and signal any other threads.  This must
+// be called with the Workqueue lock held.
 
 Task*
-Workqueue::release_locks(Task* t, Task_locker* tl)
+Workqueue::release_locks(Task* t, Task_locker* tl, Workqueue_runqueue* rq)
 {
   Task* ret = NULL;
   for (Task_locker::iterator p = tl->begin(); p != tl->end(); ++p)
@@ -460,7 +634,8 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	      while ((t = token->remove_first_waiting()) != NULL)
 		{
 		  --this->waiting_;
-		  this->return_or_queue(t, true, &ret);
+		  trace_wait_end(t, token);
+		  this->return_or_queue(t, true, &ret, rq);
 		}
 	    }
 	}
@@ -477,7 +652,8 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	  while ((t = token->remove_first_waiting()) != NULL)
 	    {
 	      --this->waiting_;
-	      if (this->return_or_queue(t, false, &ret))
+	      trace_wait_end(t, token);
+	      if (this->return_or_queue(t, false, &ret, rq))
 		break;
 	    }
 	}
@@ -509,6 +685,15 @@ Workqueue::set_thread_count(int threads)
   this->condvar_.broadcast();
 }
 
+// Return the number of threads the workqueue is using.
+
+int
+Workqueue::thread_count()
+{
+  Hold_lock hl(this->lock_);
+  return this->threader_->thread_count();
+}
+
 // Add a new blocker to an existing Task_token.
 
 void
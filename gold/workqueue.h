@@ -28,6 +28,7 @@
 #define GOLD_WORKQUEUE_H
 
 #include <string>
+#include <vector>
 
 #include "gold-threads.h"
 #include "token.h"
@@ -194,6 +195,7 @@ class Task_function : public Task
 // The workqueue itself.
 
 class Workqueue_threader;
+struct Workqueue_runqueue;
 
 class Workqueue
 {
@@ -227,6 +229,10 @@ class Workqueue
   void
   set_thread_count(int);
 
+  // Return the desired thread count.
+  int
+  thread_count();
+
   // Add a new blocker to an existing Task_token. This must be done
   // with the workqueue lock held.  This should not be done routinely,
   // only in special circumstances.
@@ -242,17 +248,33 @@ class Workqueue
   void
   add_to_queue(Task_list* queue, Task* t, bool front);
 
+  // Return the run queue for a thread.
+  Workqueue_runqueue*
+  runqueue(int thread_number);
+
+  // Remove the first task from a list.
+  Task*
+  pop_task(Task_list*, bool is_shared);
+
+  // Return whether any task is queued and not yet examined.
+  bool
+  has_queued_tasks();
+
   // Find a runnable task, or wait for one.
   Task*
   find_runnable_or_wait(int thread_number);
 
   // Find a runnable task.
   Task*
-  find_runnable();
+  find_runnable(int thread_number);
 
   // Find a runnable task in a list.
   Task*
-  find_runnable_in_list(Task_list*);
+  find_runnable_in_list(Task_list*, bool is_shared);
+
+  // Find a runnable task on the run queue of another thread.
+  Task*
+  steal_runnable(int thread_number, bool soon);
 
   // Find an run a task.
   bool
@@ -260,23 +282,26 @@ class Workqueue
 
   // Release the locks for a Task.  Return the next Task to run.
   Task*
-  release_locks(Task*, Task_locker*);
+  release_locks(Task*, Task_locker*, Workqueue_runqueue*);
 
   // Store T into *PRET, or queue it as appropriate.
   bool
-  return_or_queue(Task* t, bool is_blocker, Task** pret);
+  return_or_queue(Task* t, bool is_blocker, Task** pret,
+		  Workqueue_runqueue*);
 
   // Return whether to cancel this thread.
   bool
   should_cancel_thread(int thread_number);
 
-  // Master Workqueue lock.  This controls access to the following
-  // member variables.
+  // Master Workqueue lock.  This controls access to the Task_tokens
+  // and to the following member variables.
   Lock lock_;
-  // List of tasks to execute soon.
-  Task_list first_tasks_;
-  // List of tasks to execute after the ones in first_tasks_.
-  Task_list tasks_;
+  // The run queues of the threads, indexed by thread number.  When a
+  // task releases its locks, the tasks which become runnable are put
+  // on the run queue of the thread which ran it.
+  std::vector<Workqueue_runqueue*> runqueues_;
+  // Number of tasks on all the run queues.
+  int runqueue_count_;
   // Number of tasks currently running.
   int running_;
   // Number of tasks waiting for a lock to release.
@@ -285,6 +310,21 @@ class Workqueue
   // there may be a new Task to execute.
   Condvar condvar_;
 
+  // Lock for the shared queues which hold the tasks passed to queue,
+  // queue_soon and queue_next.  Adding a task only takes this lock,
+  // not lock_; whether the task is runnable is checked when it is
+  // removed.  When both locks are needed, lock_ must be taken first.
+  // This controls access to the following member variables.
+  Lock queue_lock_;
+  // List of tasks to execute soon.
+  Task_list first_tasks_;
+  // List of tasks to execute after the ones in first_tasks_.
+  Task_list tasks_;
+  // Number of threads waiting on condvar_.  This is only changed
+  // while holding both lock_ and queue_lock_, so it may be read while
+  // holding either one.
+  int idle_;
+
   // The threading implementation.  This is set at construction time
   // and not changed thereafter.
   Workqueue_threader* threader_;
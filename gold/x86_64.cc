@@ -742,6 +742,17 @@ class Target_x86_64 : public Sized_target<size, false>
 	      size_t local_symbol_count,
 	      const unsigned char* plocal_symbols);
 
+  // Drop the relocations which scan_relocs would ignore.
+  bool
+  prescan_relocs(Symbol_table* symtab,
+		 Sized_relobj_file<size, false>* object,
+		 unsigned int sh_type,
+		 const unsigned char* prelocs,
+		 size_t reloc_count,
+		 size_t local_symbol_count,
+		 const unsigned char* plocal_symbols,
+		 std::vector<unsigned char>* deferred);
+
   // Finalize the sections.
   void
   do_finalize_sections(Layout*, const Input_objects*, Symbol_table*);
@@ -854,6 +865,12 @@ class Target_x86_64 : public Sized_target<size, false>
   do_can_check_for_function_pointers() const
   { return true; }
 
+  // We can tell which relocations need a GOT or PLT entry or a dynamic
+  // relocation without changing anything, so we can prescan them.
+  bool
+  do_can_prescan_relocs() const
+  { return true; }
+
   // Return the base for a DW_EH_PE_datarel encoding.
   uint64_t
   do_ehframe_datarel_base() const;
@@ -994,6 +1011,14 @@ class Target_x86_64 : public Sized_target<size, false>
     static inline int
     get_reference_flags(unsigned int r_type);
 
+    static inline bool
+    local_is_trivial(unsigned int r_type,
+		     const elfcpp::Sym<size, false>& lsym,
+		     bool is_discarded);
+
+    static inline bool
+    global_is_trivial(unsigned int r_type, const Symbol* gsym);
+
     inline void
     local(Symbol_table* symtab, Layout* layout, Target_x86_64* target,
 	  Sized_relobj_file<size, false>* object,
@@ -1553,6 +1578,9 @@ Target_x86_64<size>::rela_dyn_section(Layout* layout)
       layout->add_output_section_data(".rela.dyn", elfcpp::SHT_RELA,
 				      elfcpp::SHF_ALLOC, this->rela_dyn_,
 				      ORDER_DYNAMIC_RELOCS, false);
+      if (parameters->options().pack_relative_relocs())
+	this->rela_dyn_->set_pack_relative_relocs(
+	    layout, elfcpp::R_X86_64_RELATIVE);
     }
   return this->rela_dyn_;
 }
@@ -3541,6 +3569,94 @@ Target_x86_64<size>::Scan::reloc_needs_plt_for_ifunc(
   return flags != 0;
 }
 
+// Return true if Scan::local would do nothing for a relocation
+// against a local symbol.  This is used when prescanning relocs in
+// parallel, so it only looks at the relocation and the symbol.
+
+template<int size>
+inline bool
+Target_x86_64<size>::Scan::local_is_trivial(
+    unsigned int r_type,
+    const elfcpp::Sym<size, false>& lsym,
+    bool is_discarded)
+{
+  if (is_discarded)
+    return true;
+
+  // A local STT_GNU_IFUNC symbol may require a PLT entry.
+  if (lsym.get_st_type() == elfcpp::STT_GNU_IFUNC)
+    return false;
+
+  switch (r_type)
+    {
+    case elfcpp::R_X86_64_NONE:
+    case elfcpp::R_X86_64_GNU_VTINHERIT:
+    case elfcpp::R_X86_64_GNU_VTENTRY:
+    case elfcpp::R_X86_64_PC64:
+    case elfcpp::R_X86_64_PC32:
+    case elfcpp::R_X86_64_PC32_BND:
+    case elfcpp::R_X86_64_PC16:
+    case elfcpp::R_X86_64_PC8:
+    case elfcpp::R_X86_64_PLT32:
+    case elfcpp::R_X86_64_PLT32_BND:
+      return true;
+
+    case elfcpp::R_X86_64_64:
+    case elfcpp::R_X86_64_32:
+    case elfcpp::R_X86_64_32S:
+    case elfcpp::R_X86_64_16:
+    case elfcpp::R_X86_64_8:
+      // These need a dynamic relocation in position-independent output.
+      return !parameters->options().output_is_position_independent();
+
+    default:
+      return false;
+    }
+}
+
+// Return true if Scan::global would do nothing for a relocation
+// against GSYM.  We only say so for symbols defined in a regular
+// object which can not be preempted; scanning relocs does not change
+// whether a symbol is one of those.
+
+template<int size>
+inline bool
+Target_x86_64<size>::Scan::global_is_trivial(unsigned int r_type,
+					     const Symbol* gsym)
+{
+  if (gsym->type() == elfcpp::STT_GNU_IFUNC
+      || gsym->is_undefined()
+      || gsym->is_from_dynobj()
+      || gsym->is_preemptible())
+    return false;
+
+  switch (r_type)
+    {
+    case elfcpp::R_X86_64_NONE:
+    case elfcpp::R_X86_64_GNU_VTINHERIT:
+    case elfcpp::R_X86_64_GNU_VTENTRY:
+    case elfcpp::R_X86_64_PC64:
+    case elfcpp::R_X86_64_PC32:
+    case elfcpp::R_X86_64_PC32_BND:
+    case elfcpp::R_X86_64_PC16:
+    case elfcpp::R_X86_64_PC8:
+    case elfcpp::R_X86_64_PLT32:
+    case elfcpp::R_X86_64_PLT32_BND:
+      return true;
+
+    case elfcpp::R_X86_64_64:
+    case elfcpp::R_X86_64_32:
+    case elfcpp::R_X86_64_32S:
+    case elfcpp::R_X86_64_16:
+    case elfcpp::R_X86_64_8:
+      // These need a dynamic relocation in position-independent output.
+      return !parameters->options().output_is_position_independent();
+
+    default:
+      return false;
+    }
+}
+
 // Scan a relocation for a local symbol.
 
 template<int size>
@@ -4497,6 +4613,37 @@ Target_x86_64<size>::scan_relocs(Symbol_table* symtab,
     plocal_symbols);
 }
 
+// Drop the relocations which scan_relocs would ignore.
+
+template<int size>
+bool
+Target_x86_64<size>::prescan_relocs(Symbol_table* symtab,
+				    Sized_relobj_file<size, false>* object,
+				    unsigned int sh_type,
+				    const unsigned char* prelocs,
+				    size_t reloc_count,
+				    size_t local_symbol_count,
+				    const unsigned char* plocal_symbols,
+				    std::vector<unsigned char>* deferred)
+{
+  typedef gold::Default_classify_reloc<elfcpp::SHT_RELA, size, false>
+      Classify_reloc;
+
+  // Let scan_relocs report the error.
+  if (sh_type == elfcpp::SHT_REL)
+    return false;
+
+  gold::prescan_relocs<size, false, Scan, Classify_reloc>(
+    symtab,
+    object,
+    prelocs,
+    reloc_count,
+    local_symbol_count,
+    plocal_symbols,
+    deferred);
+  return true;
+}
+
 // Finalize the sections.
 
 template<int size>
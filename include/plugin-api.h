@@ -387,6 +387,38 @@ enum ld_plugin_status
 (*ld_plugin_get_wrap_symbols) (uint64_t *num_symbols,
                                const char ***wrap_symbol_list);
 
+/* The linker's interface for API version negotiation.  A plugin calls
+   the function (with its IDENTIFIER and VERSION), plus minimal and maximal
+   version of linker-plugin API. Linker then returns selected API version
+   and provides its IDENTIFIER and VERSION.  The returned value by linker
+   must be in range [MINIMAL_API_SUPPORTED, MAXIMAL_API_SUPPORTED].
+   Identifier pointers remain valid as long as the plugin is loaded.  */
+
+typedef
+int
+(*ld_plugin_get_api_version) (const char *plugin_identifier,
+			      const char *plugin_version,
+			      int minimal_api_supported,
+			      int maximal_api_supported,
+			      const char **linker_identifier,
+			      const char **linker_version);
+
+/* The API levels which may be negotiated with get_api_version.  */
+
+enum linker_api_version
+{
+  /* The linker/plugin do not implement any of the API levels below, the API
+     is determined solely via the transfer vector.  */
+  LAPI_V0,
+
+  /* API level v1.  The plugin's claim_file handler is thread-safe: the
+     linker may call it from several threads at once, each time for a
+     different input file.  While the handler runs, it may call
+     add_symbols, get_view, message and the get_input_section_*
+     interfaces for the handle of the file it was given.  */
+  LAPI_V1
+};
+
 enum ld_plugin_level
 {
   LDPL_INFO,
@@ -431,7 +463,9 @@ enum ld_plugin_tag
   LDPT_GET_INPUT_SECTION_ALIGNMENT = 29,
   LDPT_GET_INPUT_SECTION_SIZE = 30,
   LDPT_REGISTER_NEW_INPUT_HOOK = 31,
-  LDPT_GET_WRAP_SYMBOLS = 32
+  LDPT_GET_WRAP_SYMBOLS = 32,
+  LDPT_ADD_SYMBOLS_V2 = 33,
+  LDPT_GET_API_VERSION = 34
 };
 
 /* The plugin transfer vector.  */
@@ -467,6 +501,7 @@ struct ld_plugin_tv
     ld_plugin_get_input_section_size tv_get_input_section_size;
     ld_plugin_register_new_input tv_register_new_input;
     ld_plugin_get_wrap_symbols tv_get_wrap_symbols;
+    ld_plugin_get_api_version tv_get_api_version;
   } tv_u;
 };
 